@@ -64,7 +64,7 @@
 
 // IPC.
 // Уведомления потоков.
-#define configUSE_TASK_NOTIFICATIONS                0
+#define configUSE_TASK_NOTIFICATIONS                1
 // Мютексы.
 #define configUSE_MUTEXES                           0
 // Рекурсивные мютексы.
@@ -133,7 +133,7 @@ extern uint32_t getHiresCounterValue(void);
 #define INCLUDE_xTaskResumeFromISR                  1
 #define INCLUDE_vTaskDelayUntil                     0
 #define INCLUDE_vTaskDelay                          1
-#define INCLUDE_xTaskGetSchedulerState              0
+#define INCLUDE_xTaskGetSchedulerState              1
 #define INCLUDE_xTaskGetCurrentTaskHandle           0
 #define INCLUDE_uxTaskGetStackHighWaterMark         0
 #define INCLUDE_xTaskGetIdleTaskHandle              0
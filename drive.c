@@ -10,7 +10,9 @@
 #include "drive_motor.h"
 #include "drive_selfstart.h"
 #include "drive_selftuning.h"
+#include "drive_prof.h"
 #include "utils/critical.h"
+#include "utils/utils.h"
 #include <string.h>
 #include <stdio.h>
 
@@ -33,8 +35,6 @@
 
 //#define DRIVE_PHASE_SYNC_DEBUG
 
-//#define DRIVE_MEASURE_ITERS_TIME_DEBUG
-
 //! Необходимые для готовности флаги.
 #define DRIVE_READY_FLAGS (DRIVE_FLAG_POWER_DATA_AVAIL)
 
@@ -144,12 +144,85 @@ typedef struct _Drive {
     drive_warning_callback_t on_warning_occured; //!< Каллбэк при предупреждении.
     drive_reset_callback_t on_reset_callback; //!< Каллбэк при сбросе.
     set_adc_rate_proc_t set_adc_rate_proc; //!< Функция установки частоты АЦП.
+    set_adc_period_proc_t set_adc_period_proc; //!< Функция установки периода АЦП.
+    uint32_t period_us; //!< Измеренный период сети, мкс.
 } drive_t;
 
 //! Состояние привода.
 static drive_t drive;
 
 
+/*
+ * Группы настроек привода - разделы параметров (parameters_ids.h),
+ * соответствующие группам меню параметров.
+ * При изменении параметров обновляются только подсистемы,
+ * использующие параметры изменённых групп.
+ */
+
+//! Группы настроек привода.
+typedef enum _Drive_Settings_Group {
+    DRIVE_SETTINGS_GROUP_SHARED = 0, //!< Общие с загрузчиком (применяются при перезапуске).
+    DRIVE_SETTINGS_GROUP_POWER_NOM, //!< Питание - номинальные значения.
+    DRIVE_SETTINGS_GROUP_MOTOR, //!< Двигатель.
+    DRIVE_SETTINGS_GROUP_CALC, //!< Вычисление значений питания.
+    DRIVE_SETTINGS_GROUP_REGULATOR, //!< Режим регулирования.
+    DRIVE_SETTINGS_GROUP_OVERLOAD, //!< Перегруз.
+    DRIVE_SETTINGS_GROUP_EXC, //!< Возбуждение.
+    DRIVE_SETTINGS_GROUP_RAMP, //!< Рампа.
+    DRIVE_SETTINGS_GROUP_SELFSTART, //!< Самозапуск.
+    DRIVE_SETTINGS_GROUP_PID, //!< ПИД якоря и возбуждения.
+    DRIVE_SETTINGS_GROUP_TIMES, //!< Время ожидания запуска и останова.
+    DRIVE_SETTINGS_GROUP_TRIACS, //!< Тиристоры.
+    DRIVE_SETTINGS_GROUP_FANS, //!< Управление вентиляторами.
+    DRIVE_SETTINGS_GROUP_SELFTUNE, //!< Самонастройка.
+    DRIVE_SETTINGS_GROUP_PROT, //!< Защита, защита питания, отклонения нулей.
+    DRIVE_SETTINGS_GROUP_DIO, //!< Входа - выхода.
+    DRIVE_SETTINGS_GROUP_GUI, //!< Интерфейс панели (применяются при использовании).
+    DRIVE_SETTINGS_GROUP_ADC, //!< АЦП.
+    DRIVE_SETTINGS_GROUP_DEBUG, //!< Отладочные (применяются при использовании).
+    DRIVE_SETTINGS_GROUPS_COUNT
+} drive_settings_group_t;
+
+//! Тип маски групп настроек привода.
+typedef uint32_t drive_settings_groups_t;
+
+//! Бит группы настроек привода в маске.
+#define DRIVE_SETTINGS_GROUP_BIT(group) ((drive_settings_groups_t)1 << (group))
+
+//! Маска всех групп настроек привода.
+#define DRIVE_SETTINGS_GROUPS_ALL ((drive_settings_groups_t)((1UL << DRIVE_SETTINGS_GROUPS_COUNT) - 1))
+
+//! Диапазоны идентификаторов групп настроек привода.
+static settings_handle_t drive_settings_handles[DRIVE_SETTINGS_GROUPS_COUNT] = {
+    [DRIVE_SETTINGS_GROUP_SHARED] = SETTINGS_HANDLE_RANGE(1, 99),
+    [DRIVE_SETTINGS_GROUP_POWER_NOM] = SETTINGS_HANDLE_RANGE(100, 199),
+    [DRIVE_SETTINGS_GROUP_MOTOR] = SETTINGS_HANDLE_RANGE(200, 999),
+    [DRIVE_SETTINGS_GROUP_CALC] = SETTINGS_HANDLE_RANGE(1000, 1124),
+    [DRIVE_SETTINGS_GROUP_REGULATOR] = SETTINGS_HANDLE_RANGE(1125, 1134),
+    [DRIVE_SETTINGS_GROUP_OVERLOAD] = SETTINGS_HANDLE_RANGE(1135, 1149),
+    [DRIVE_SETTINGS_GROUP_EXC] = SETTINGS_HANDLE_RANGE(1150, 1199),
+    [DRIVE_SETTINGS_GROUP_RAMP] = SETTINGS_HANDLE_RANGE(1200, 1219),
+    [DRIVE_SETTINGS_GROUP_SELFSTART] = SETTINGS_HANDLE_RANGE(1220, 1249),
+    // 1250 - 1259 - синхронизация с фазами (подписка drive_phase_sync).
+    [DRIVE_SETTINGS_GROUP_PID] = SETTINGS_HANDLE_RANGE(1260, 1299),
+    [DRIVE_SETTINGS_GROUP_TIMES] = SETTINGS_HANDLE_RANGE(1300, 1349),
+    [DRIVE_SETTINGS_GROUP_TRIACS] = SETTINGS_HANDLE_RANGE(1350, 1499),
+    [DRIVE_SETTINGS_GROUP_FANS] = SETTINGS_HANDLE_RANGE(1500, 1599),
+    [DRIVE_SETTINGS_GROUP_SELFTUNE] = SETTINGS_HANDLE_RANGE(1600, 1999),
+    [DRIVE_SETTINGS_GROUP_PROT] = SETTINGS_HANDLE_RANGE(2000, 4999),
+    [DRIVE_SETTINGS_GROUP_DIO] = SETTINGS_HANDLE_RANGE(5000, 5999),
+    [DRIVE_SETTINGS_GROUP_GUI] = SETTINGS_HANDLE_RANGE(6000, 6999),
+    [DRIVE_SETTINGS_GROUP_ADC] = SETTINGS_HANDLE_RANGE(7000, 7999),
+    // 8000 - 8999 - виртуальные параметры.
+    [DRIVE_SETTINGS_GROUP_DEBUG] = SETTINGS_HANDLE_RANGE(9000, 9999)
+};
+
+static void drive_settings_changed(void);
+
+//! Подписка на изменение настроек привода.
+SETTINGS_SUBSCRIPTION(drive_settings_subscription, drive_settings_handles, drive_settings_changed);
+
+
 #define ARRAY_LEN(arr) (sizeof(arr) / sizeof(arr[0]))
 
 
@@ -1728,15 +1801,16 @@ static bool drive_regulate_current(void)
 }
 
 /**
- * Запускает открытие тиристоров.
+ * Вычисляет открытие тиристоров.
+ * Таймеры запускаются функцией drive_triacs_fire.
  */
-static void drive_setup_triacs_open(phase_t phase, phase_t last_open_phase, phase_time_t sensor_time)
+static void drive_prepare_triacs_open(phase_t phase, phase_t last_open_phase, phase_time_t sensor_time)
 {
     if(!drive_oneshot_enabled() || drive_oneshot_process()){
-    	drive_triacs_setup_next_pair(phase, last_open_phase, sensor_time);
+    	drive_triacs_prepare_next_pair(phase, last_open_phase, sensor_time);
     }
     
-    drive_triacs_setup_exc(phase, last_open_phase, sensor_time);
+    drive_triacs_prepare_exc(phase, last_open_phase, sensor_time);
 }
 
 /*
@@ -2346,15 +2420,38 @@ static fixed32_t drive_get_null_timer_angle(void)
     if(!drive.tim_null) return 0;
     
     uint32_t tim_null_ticks = TIM_GetCounter(drive.tim_null);
+    uint32_t tim_null_period = drive.tim_null->ARR + 1;
     
-    // time [0...40000) -> [0...60).
-    // 40000:60 == 2000:3
+    // time [0...period) -> [0...60).
+    // Период таймера подстраивается ФАПЧ под частоту сети.
     
-    fixed32_t res = (fixed32_t)fixed32_make_from_fract((uint64_t)(tim_null_ticks * 3), 2000);
+    fixed32_t res = (fixed32_t)fixed32_make_from_fract((uint64_t)tim_null_ticks * DRIVE_MAIN_TIMER_ANGLE, tim_null_period);
     
     return res;
 }
 
+/**
+ * Устанавливает измеренный период сети
+ * по периоду таймера нуля, подстроенному ФАПЧ.
+ * Частота АЦП и перевод углов в тики таймеров
+ * следуют за частотой сети.
+ * @param tim_null_ticks Число тиков таймера нуля.
+ */
+static void drive_set_power_period(uint32_t tim_null_ticks)
+{
+    uint32_t period_us = tim_null_ticks * DRIVE_MAIN_TIMER_PERIOD_ITERS / DRIVE_MAIN_TIMER_TICKS_PER_US;
+    
+    if(drive.period_us == period_us) return;
+    
+    drive.period_us = period_us;
+    
+    CRITICAL_ENTER();
+    drive_phase_sync_set_period_us(period_us);
+    drive_triacs_set_period_us(period_us);
+    if(drive.set_adc_period_proc) drive.set_adc_period_proc(period_us);
+    CRITICAL_EXIT();
+}
+
 static int16_t drive_get_null_timer_time(void)
 {
     if(!drive.tim_null) return 0;
@@ -2381,6 +2478,7 @@ err_t drive_init(void)
     
     drive.adc_prescaler = 0;
     drive.adc_rate = DRIVE_ADC_RATE_NORMAL;
+    drive.period_us = POWER_PERIOD_US;
     
     drive_phase_sync_init();
     drive_phase_sync_set_angle_callback(drive_get_null_timer_angle);
@@ -2398,9 +2496,11 @@ err_t drive_init(void)
     
     drive_dio_init();
     
+    // Отклонение периода таймера нуля
+    // ограничено диапазоном частоты сети.
     drive_phase_sync_pll_pid_clamp(
-            -fixed32_make_from_int(DRIVE_MAIN_TIMER_OFFSET_TICKS_MAX),
-            fixed32_make_from_int(DRIVE_MAIN_TIMER_OFFSET_TICKS_MAX)
+            -fixed32_make_from_int(DRIVE_MAIN_TIMER_CNT_TICKS_MAX - DRIVE_MAIN_TIMER_CNT_TICKS),
+            fixed32_make_from_int(DRIVE_MAIN_TIMER_CNT_TICKS - DRIVE_MAIN_TIMER_CNT_TICKS_MIN)
             );
     
     drive_motor_init();
@@ -2411,6 +2511,8 @@ err_t drive_init(void)
     
     drive_update_settings();
     
+    RETURN_ERR_IF_FAIL(settings_subscribe(&drive_settings_subscription));
+    
     drive_set_static_prot_masks();
     
     drive_update_prot_masks();
@@ -2454,16 +2556,23 @@ err_t drive_init(void)
     return E_NO_ERROR;
 }
 
-err_t drive_update_settings(void)
+/**
+ * Обновляет настройки вычисления значений питания.
+ */
+static void drive_update_calc_settings(void)
 {
-    drive_protection_update_settings(); //thread-safe.
-
     drive_power_set_phase_calc_current((phase_t)settings_valueu(PARAM_ID_CALC_PHASE_CURRENT));
     drive_power_set_phase_calc_voltage((phase_t)settings_valueu(PARAM_ID_CALC_PHASE_VOLTAGE));
     drive_power_set_rot_calc_current(settings_valueu(PARAM_ID_CALC_ROT_CURRENT));
     drive_power_set_rot_calc_voltage(settings_valueu(PARAM_ID_CALC_ROT_VOLTAGE));
     drive_power_set_exc_calc_current(settings_valueu(PARAM_ID_CALC_EXC_CURRENT));
-    
+}
+
+/**
+ * Обновляет общие настройки привода.
+ */
+static void drive_update_common_settings(void)
+{
     drive.settings.stop_mode = settings_valueu(PARAM_ID_RAMP_STOP_MODE);
     drive.settings.stop_rot_iters = settings_valueu(PARAM_ID_ROT_STOP_TIME) * DRIVE_MAIN_ITER_FREQ;
     drive.settings.stop_exc_iters = settings_valueu(PARAM_ID_EXC_STOP_TIME) * DRIVE_MAIN_ITER_FREQ;
@@ -2474,7 +2583,13 @@ err_t drive_update_settings(void)
     drive.settings.zero_speed_exc_off_enabled = settings_valueu(PARAM_ID_ZERO_SPEED_EXC_OFF_ENABLED);
     drive.settings.zero_speed_exc_off_iters = settings_valueu(PARAM_ID_ZERO_SPEED_EXC_OFF_TIMEOUT) * DRIVE_MAIN_ITER_FREQ;
     drive.settings.selftune_pause_iters = settings_valueu(PARAM_ID_SELFTUNE_PAUSE_TIME_MS) * DRIVE_MAIN_ITER_FREQ / 1000;
-    
+}
+
+/**
+ * Обновляет настройки тиристоров.
+ */
+static void drive_update_triacs_settings(void)
+{
     drive_triacs_set_exc_mode(settings_valueu(PARAM_ID_EXC_MODE));
     drive_triacs_set_pairs_open_time_us(settings_valueu(PARAM_ID_TRIACS_PAIRS_OPEN_TIME));
     drive_triacs_set_exc_open_time_us(settings_valueu(PARAM_ID_TRIAC_EXC_OPEN_TIME));
@@ -2489,6 +2604,7 @@ err_t drive_update_settings(void)
     drive_triacs_set_exc_open_delay_us(settings_valueu(PARAM_ID_TRIAC_EXC_OPEN_DELAY));
     
     drive_triacs_set_pairs_pulse_train_enabled(settings_valueu(PARAM_ID_TRIACS_PAIRS_PULSE_TRAIN_ENABLED));
+    drive_triacs_set_pairs_pulse_train_mode(settings_valueu(PARAM_ID_TRIACS_PAIRS_PULSE_TRAIN_MODE));
     drive_triacs_set_pairs_pulse_train_width(settings_valuef(PARAM_ID_TRIACS_PAIRS_PULSE_TRAIN_WIDTH));
     drive_triacs_set_pairs_pulse_train_duty_ratio(settings_valuef(PARAM_ID_TRIACS_PAIRS_PULSE_TRAIN_DUTY_RATIO) / 100);
     drive_triacs_set_pairs_pulse_train_angle_min(settings_valuef(PARAM_ID_TRIACS_PAIRS_PULSE_TRAIN_ANGLE_MIN));
@@ -2496,25 +2612,22 @@ err_t drive_update_settings(void)
     drive_triacs_set_exc_pulse_train_width(settings_valuef(PARAM_ID_TRIAC_EXC_PULSE_TRAIN_WIDTH));
     drive_triacs_set_exc_pulse_train_duty_ratio(settings_valuef(PARAM_ID_TRIAC_EXC_PULSE_TRAIN_DUTY_RATIO) / 100);
     drive_triacs_set_exc_pulse_train_angle_min(settings_valuef(PARAM_ID_TRIAC_EXC_PULSE_TRAIN_ANGLE_MIN));
+}
 
+/**
+ * Обновляет настройки двигателя.
+ */
+static void drive_update_motor_settings(void)
+{
     drive_motor_update_settings();
     drive_motor_set_ir_compensation_enabled(settings_valueu(PARAM_ID_REGULATOR_IR_COMPENSATION));
-    
-    drive_regulator_update_settings();
-    
-    drive_overload_update_settings();
-    
-    drive_selfstart_update_settings();
-    
-    drive_selftuning_update_settings();
-    
-    drive_phase_sync_set_pll_pid(settings_valuef(PARAM_ID_PHASE_SYNC_PLL_PID_K_P),
-                                 settings_valuef(PARAM_ID_PHASE_SYNC_PLL_PID_K_I),
-                                 settings_valuef(PARAM_ID_PHASE_SYNC_PLL_PID_K_D));
-    drive_phase_sync_set_accuracy(settings_valuef(PARAM_ID_PHASE_SYNC_ACCURACY));
-    
-    drive_power_update_settings();
-    
+}
+
+/**
+ * Обновляет настройки цифровых входов и выходов.
+ */
+static void drive_update_dio_settings(void)
+{
     drive_dio_input_setup(DRIVE_DIO_INPUT_1, settings_valueu(PARAM_ID_DIGITAL_IN_1_TYPE),
                                              settings_valueu(PARAM_ID_DIGITAL_IN_1_INVERSION));
     drive_dio_input_setup(DRIVE_DIO_INPUT_2, settings_valueu(PARAM_ID_DIGITAL_IN_2_TYPE),
@@ -2536,6 +2649,96 @@ err_t drive_update_settings(void)
                                                settings_valueu(PARAM_ID_DIGITAL_OUT_4_INVERSION));
     
     drive_dio_set_deadtime(settings_valuef(PARAM_ID_DIGITAL_IO_DEADTIME_MS));
+}
+
+/**
+ * Обновляет настройки подсистем привода,
+ * использующих параметры заданных групп.
+ * @param groups Маска групп настроек.
+ */
+static void drive_update_settings_groups(drive_settings_groups_t groups)
+{
+    if(groups & (DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_POWER_NOM) |
+                 DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_MOTOR) |
+                 DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_EXC) |
+                 DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_FANS) |
+                 DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_PROT))){
+        drive_protection_update_settings(); //thread-safe.
+    }
+    
+    if(groups & DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_CALC)){
+        drive_update_calc_settings();
+    }
+    
+    if(groups & (DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_RAMP) |
+                 DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_TIMES) |
+                 DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_SELFTUNE))){
+        drive_update_common_settings();
+    }
+    
+    if(groups & (DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_EXC) |
+                 DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_TRIACS))){
+        drive_update_triacs_settings();
+    }
+    
+    if(groups & (DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_MOTOR) |
+                 DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_REGULATOR) |
+                 DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_ADC))){
+        drive_update_motor_settings();
+    }
+    
+    if(groups & (DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_MOTOR) |
+                 DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_REGULATOR) |
+                 DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_EXC) |
+                 DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_RAMP) |
+                 DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_PID) |
+                 DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_TRIACS))){
+        drive_regulator_update_settings();
+    }
+    
+    if(groups & DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_OVERLOAD)){
+        drive_overload_update_settings();
+    }
+    
+    if(groups & DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_SELFSTART)){
+        drive_selfstart_update_settings();
+    }
+    
+    if(groups & (DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_MOTOR) |
+                 DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_SELFTUNE))){
+        drive_selftuning_update_settings();
+    }
+    
+    if(groups & (DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_PROT) |
+                 DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_ADC))){
+        drive_power_update_settings();
+    }
+    
+    if(groups & DRIVE_SETTINGS_GROUP_BIT(DRIVE_SETTINGS_GROUP_DIO)){
+        drive_update_dio_settings();
+    }
+}
+
+/**
+ * Применяет изменённые группы настроек привода.
+ */
+static void drive_settings_changed(void)
+{
+    drive_settings_groups_t groups = 0;
+    
+    size_t i;
+    for(i = 0; i < DRIVE_SETTINGS_GROUPS_COUNT; i ++){
+        if(drive_settings_handles[i].changed){
+            groups |= DRIVE_SETTINGS_GROUP_BIT(i);
+        }
+    }
+    
+    drive_update_settings_groups(groups);
+}
+
+err_t drive_update_settings(void)
+{
+    drive_update_settings_groups(DRIVE_SETTINGS_GROUPS_ALL);
     
     return E_NO_ERROR;
 }
@@ -2835,6 +3038,21 @@ void drive_set_adc_rate_proc(set_adc_rate_proc_t proc)
     drive.set_adc_rate_proc = proc;
 }
 
+set_adc_period_proc_t drive_adc_period_proc(void)
+{
+    return drive.set_adc_period_proc;
+}
+
+void drive_set_adc_period_proc(set_adc_period_proc_t proc)
+{
+    drive.set_adc_period_proc = proc;
+}
+
+uint32_t drive_power_period_us(void)
+{
+    return drive.period_us;
+}
+
 err_t drive_set_null_timer(TIM_TypeDef* TIM)
 {
     if(TIM == NULL) return E_NULL_POINTER;
@@ -2867,22 +3085,23 @@ static int32_t angle_phC = 0;
 static int32_t angle_pid_val = 0;
 #endif
 
-#ifdef DRIVE_MEASURE_ITERS_TIME_DEBUG
-#include <sys/time.h>
-#include "drive_hires_timer.h"
-#endif
-
 void drive_process_sync_iter(void)
 {
+    uint32_t prof_begin = drive_prof_begin();
+    
     phase_t phase = drive_phase_sync_next_phase();
     
     drive_phase_state_handle(phase);
     
-    drive_phase_sync_swap_buffers_if_needed();
+    drive_phase_sync_mark_reference();
+    
+    drive_prof_end(DRIVE_PROF_SYNC_ITER, prof_begin);
 }
 
 void drive_process_triacs_iter(void)
 {
+    uint32_t prof_begin = drive_prof_begin();
+    
     drive_phase_state_half_handle();
     
     phase_t phase = drive_phase_state_current_phase();
@@ -2900,27 +3119,25 @@ void drive_process_triacs_iter(void)
         
         phase_t last_open_phase = drive_phase_state_half_phase();
         
-        int16_t offset = 0;
+        int16_t offset = drive_phase_sync_offset(phase);
         
-        CRITICAL_ENTER();
+        // Значения сравнения вычисляются с разрешёнными прерываниями,
+        // время таймера нуля учитывается при запуске таймеров.
+        drive_prepare_triacs_open(phase, last_open_phase, offset);
         
-        offset += drive_phase_sync_offset(phase);
-        offset += drive_get_null_timer_time();
+        CRITICAL_ENTER();
         
-        drive_setup_triacs_open(phase, last_open_phase, offset);
+        drive_triacs_fire(drive_get_null_timer_time());
         
         CRITICAL_EXIT();
     }
+    
+    drive_prof_end(DRIVE_PROF_TRIACS_ITER, prof_begin);
 }
 
 void drive_process_iter(void)
 {
-#ifdef DRIVE_MEASURE_ITERS_TIME_DEBUG
-    CRITICAL_ENTER();
-    struct timeval tv_prev;
-    //gettimeofday(&tv_prev, NULL);
-    drive_hires_timer_value(&tv_prev);
-#endif
+    uint32_t prof_begin = drive_prof_begin();
     
     if(drive_phase_sync_process()){
     
@@ -2930,6 +3147,8 @@ void drive_process_iter(void)
             int16_t period_delta = (int16_t)fixed32_get_int(period_deltaf);
 
             drive.tim_null->ARR = DRIVE_MAIN_TIMER_CNT_PERIOD - period_delta;
+            
+            drive_set_power_period(DRIVE_MAIN_TIMER_CNT_TICKS - period_delta);
 
     #ifdef DRIVE_PHASE_SYNC_DEBUG
             angle_pid_val = period_delta;
@@ -2957,15 +3176,7 @@ void drive_process_iter(void)
 
     drive_states_process();
     
-#ifdef DRIVE_MEASURE_ITERS_TIME_DEBUG
-    struct timeval tv_next;
-    drive_hires_timer_value(&tv_next);
-    CRITICAL_EXIT();
-    timersub(&tv_next, &tv_prev, &tv_next);
-    
-    param_t* p_adc_tick_time = settings_param_by_id(PARAM_ID_DEBUG_0);
-    if(p_adc_tick_time) settings_param_set_valuei(p_adc_tick_time, tv_next.tv_usec);
-#endif
+    drive_prof_end(DRIVE_PROF_MAIN_ITER, prof_begin);
 }
 
 bool drive_calculate_power(void)
@@ -2996,11 +3207,11 @@ bool drive_calculate_power(void)
     return false;
 }
 
-err_t drive_process_power_adc_values(power_channels_t channels, uint16_t* adc_values)
+err_t drive_process_power_adc_values(power_channels_t channels, uint16_t* adc_values, size_t frames_count)
 {
     err_t err = E_NO_ERROR;
 
-    err = drive_power_process_adc_values(channels, adc_values);
+    err = drive_power_process_adc_values(channels, adc_values, frames_count);
 
     drive_check_prots_inst();
 
@@ -36,8 +36,12 @@
 #define DRIVE_MAIN_TIMER_FREQ (POWER_FREQ * 6)
 //! Угол таймера нуля.
 #define DRIVE_MAIN_TIMER_ANGLE (60)
-//! Отклонение таймера нуля для синхронизации.
-#define DRIVE_MAIN_TIMER_OFFSET_TICKS_MAX (1500) // 125 мкс
+//! Минимальное число тиков (максимальная частота сети).
+#define DRIVE_MAIN_TIMER_CNT_TICKS_MIN (DRIVE_MAIN_TIMER_CNT_TICKS * POWER_FREQ / POWER_FREQ_MAX)
+//! Максимальное число тиков (минимальная частота сети).
+#define DRIVE_MAIN_TIMER_CNT_TICKS_MAX (DRIVE_MAIN_TIMER_CNT_TICKS * POWER_FREQ / POWER_FREQ_MIN)
+//! Число тиков в микросекунде.
+#define DRIVE_MAIN_TIMER_TICKS_PER_US (12)
 //! Коэффициент тик/градус отклонения.
 #define DRIVE_MAIN_TIMER_TICKS_PER_DEG 667//400
 //! Число срабатываний таймера за период.
@@ -62,6 +66,8 @@
 #define DRIVE_ADC_RATE_FAST 10
 //! Функция установки частоты АЦП.
 typedef void (*set_adc_rate_proc_t)(uint32_t rate);
+//! Функция установки периода АЦП по периоду сети.
+typedef void (*set_adc_period_proc_t)(uint32_t period_us);
 
 
 
@@ -667,6 +673,25 @@ extern set_adc_rate_proc_t drive_adc_rate_proc(void);
  */
 extern void drive_set_adc_rate_proc(set_adc_rate_proc_t callback);
 
+/**
+ * Получает функцию установки периода АЦП.
+ * @return Функция установки периода АЦП.
+ */
+extern set_adc_period_proc_t drive_adc_period_proc(void);
+
+/**
+ * Устанавливает функцию установки периода АЦП.
+ * Функция вызывается при изменении измеренного периода сети.
+ * @param proc Функция установки периода АЦП.
+ */
+extern void drive_set_adc_period_proc(set_adc_period_proc_t proc);
+
+/**
+ * Получает измеренный период сети.
+ * @return Период сети, мкс.
+ */
+extern uint32_t drive_power_period_us(void);
+
 /**
  * Устанавливает порт ввода-вывода для цифрового входа.
  * @param input Цифровой вход.
@@ -727,6 +752,18 @@ ALWAYS_INLINE static  err_t drive_set_triacs_pairs_timer(size_t index, TIM_TypeD
     return drive_triacs_set_pairs_timer(index, TIM);
 }
 
+/**
+ * Устанавливает канал DMA гребёнки таймера тиристоров.
+ * @param index Индекс таймера.
+ * @param dma_channel Канал DMA.
+ * @param dma_flags Флаги канала DMA.
+ * @return Код ошибки.
+ */
+ALWAYS_INLINE static err_t drive_set_triacs_pairs_timer_dma(size_t index, DMA_Channel_TypeDef* dma_channel, uint32_t dma_flags)
+{
+    return drive_triacs_set_pairs_timer_dma(index, dma_channel, dma_flags);
+}
+
 /**
  * Устанавливает таймер для открытия симистора возбуждения.
  * @param TIM Таймер.
@@ -776,12 +813,13 @@ extern void drive_process_triacs_iter(void);
 extern void drive_process_iter(void);
 
 /**
- * Обрабатывает очередные значения АЦП.
+ * Обрабатывает очередной блок кадров значений АЦП.
  * @param channels Маска каналов АЦП.
  * @param adc_values Значения АЦП.
+ * @param frames_count Число кадров.
  * @return Код ошибки.
  */
-extern err_t drive_process_power_adc_values(power_channels_t channels, uint16_t* adc_values);
+extern err_t drive_process_power_adc_values(power_channels_t channels, uint16_t* adc_values, size_t frames_count);
 
 /**
  * Обрабатывает накопленные данные АЦП.
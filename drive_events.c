@@ -2,8 +2,10 @@
 #include <string.h>
 #include "crc/crc16_ccitt.h"
 #include "utils/utils.h"
+#include "utils/critical.h"
 #include <time.h>
 #include "storage.h"
+#include "osc_codec.h"
 #ifdef USE_ZERO_SENSORS
 #include "drive_phase_state.h"
 #else
@@ -25,10 +27,20 @@
 #define DRIVE_EVENTS_COUNT_MAX (STORAGE_RGN_EVENTS_SIZE / DRIVE_EVENT_SIZE)
 
 //! Размер осциллограммы в хранилище.
+//! Вмещает заголовок и несжатые каналы осциллограмм питания,
+//! тренд записывается в оставшееся место.
 #define DRIVE_OSC_SIZE 4096
 //! Число осциллограмм в хранилище.
 #define DRIVE_OSCS_COUNT_MAX (STORAGE_RGN_OSC_SIZE / DRIVE_OSC_SIZE)
 
+//! Число точек тренда в блоке записи в хранилище.
+#define DRIVE_OSC_TREND_BLOCK_LEN OSC_CODEC_BLOCK_LEN
+//! Максимальный размер сжатого блока тренда.
+#define DRIVE_OSC_TREND_BLOCK_SIZE_MAX (DRIVE_POWER_OSC_CHANNELS_COUNT * OSC_CODEC_BLOCK_SIZE_MAX)
+//! Число точек предыстории тренда
+//! (с запасом на время записи осциллограмм питания).
+#define DRIVE_OSC_TREND_PRE_LEN 40
+
 #pragma pack(push, 1)
 //! Тип карты событий.
 typedef struct _Drive_Events_Map {
@@ -49,11 +61,78 @@ typedef struct _Drive_Events_Map {
 } drive_events_map_t;
 #pragma pack(pop)
 
+//! Число осциллограмм в карте событий прежних версий
+//! (осциллограммы хранились с адреса 0x1000 без сжатия).
+#define DRIVE_OSCS_COUNT_LEGACY 15
+
+#pragma pack(push, 1)
+//! Тип карты событий прежних версий.
+typedef struct _Drive_Events_Map_Legacy {
+    drive_event_index_t events_count; //!< Число событий.
+    drive_event_index_t event_index; //!< Индекс последнего события.
+    drive_event_id_t event_id; //!< Идентификатор последнего события.
+    drive_event_index_t osc_count; //!< Число осциллограмм.
+    drive_event_index_t osc_index; //!< Индекс следующей осциллограммы.
+    drive_event_id_t osc_event_ids[DRIVE_OSCS_COUNT_LEGACY]; //!< Принадлежность осциллограмм событиям.
+    uint16_t crc; //!< Контрольная сумма.
+} drive_events_map_legacy_t;
+#pragma pack(pop)
+
+_Static_assert(sizeof(drive_events_map_t) <= STORAGE_RGN_EVMAP_SIZE &&
+               sizeof(drive_events_map_legacy_t) <= STORAGE_RGN_EVMAP_SIZE,
+               "Events map does not fit the events map storage region");
+
+#pragma pack(push, 1)
+/**
+ * Тип заголовка осциллограммы в хранилище.
+ * За заголовком следуют данные каналов осциллограмм питания,
+ * канал размером DRIVE_POWER_OSC_CHANNEL_SIZE хранится без сжатия.
+ * Далее следуют сжатые блоки тренда, каждый из которых
+ * содержит по блоку кодека на каждый канал.
+ */
+typedef struct _Drive_Osc_Header {
+    //! Размеры данных каналов осциллограмм питания.
+    uint16_t channel_sizes[DRIVE_POWER_OSC_CHANNELS_COUNT];
+    //! Период точек тренда в мкс (период сети при записи).
+    uint16_t trend_period_us;
+    //! Число записанных точек тренда.
+    uint16_t trend_count;
+    //! Контрольная сумма заголовка.
+    uint16_t crc;
+} drive_osc_header_t;
+#pragma pack(pop)
+
+// Число точек тренда и контрольная сумма перезаписываются вместе.
+_Static_assert(offsetof(drive_osc_header_t, crc) == offsetof(drive_osc_header_t, trend_count) + sizeof(uint16_t),
+               "Oscillogram header trend count must precede the header crc");
+
+//! Число точек тренда в заголовке, если
+//! ни один блок тренда не поместился в осциллограмму.
+#define DRIVE_OSC_TREND_COUNT_NONE 0xffff
+
+
+//! Тип записи тренда.
+typedef struct _Drive_Events_Osc_Trend {
+    bool active; //!< Флаг записи тренда.
+    drive_osc_index_t osc_index; //!< Индекс осциллограммы.
+    drive_osc_header_t header; //!< Заголовок осциллограммы.
+    uint32_t first_number; //!< Номер первой точки тренда.
+    size_t offset; //!< Смещение следующего блока в осциллограмме.
+    size_t count; //!< Число точек, записанных в хранилище.
+    size_t block_count; //!< Число точек в блоке.
+    osc_codec_state_t states[DRIVE_POWER_OSC_CHANNELS_COUNT]; //!< Состояния кодека каналов.
+    osc_value_t block[DRIVE_POWER_OSC_CHANNELS_COUNT][DRIVE_OSC_TREND_BLOCK_LEN]; //!< Блок точек.
+} drive_events_osc_trend_t;
 
 //! Тип событий привода.
 typedef struct _Drive_Events {
     drive_events_map_t events_map; //!< Карта событий.
     drive_power_osc_channel_t osc_buf; //!< Буфер для чтения/записи осциллограмм.
+    uint8_t codec_buf[DRIVE_POWER_OSC_CHANNEL_SIZE]; //!< Буфер сжатых данных.
+    drive_osc_header_t osc_header; //!< Заголовок последней записанной осциллограммы.
+    uint16_t readed_osc_trend_period_us; //!< Период точек тренда считанной осциллограммы.
+    drive_events_osc_trend_t osc_trend; //!< Запись тренда.
+    drive_event_info_t index[DRIVE_EVENTS_COUNT_MAX]; //!< Индекс событий.
 } drive_events_t;
 
 static drive_events_t events;
@@ -68,7 +147,40 @@ err_t drive_events_init(void)
 
 void drive_events_reset(void)
 {
+    drive_events_osc_trend_cancel();
+    
+    CRITICAL_ENTER();
     memset(&events.events_map, 0x0, sizeof(drive_events_map_t));
+    memset(events.index, 0x0, sizeof(events.index));
+    CRITICAL_EXIT();
+}
+
+/**
+ * Читает карту событий прежних версий.
+ * События переносятся, осциллограммы прежнего формата
+ * и расположения не читаются и отбрасываются.
+ * @return Код ошибки.
+ */
+static err_t drive_events_read_legacy(void)
+{
+    drive_events_map_legacy_t map;
+    
+    RETURN_ERR_IF_FAIL(
+            storage_read(STORAGE_RGN_EVMAP_ADDRESS, &map,
+                         sizeof(drive_events_map_legacy_t))
+        );
+    uint16_t crc = crc16_ccitt(&map,
+            sizeof(drive_events_map_legacy_t) - sizeof(uint16_t));
+    
+    if(crc != map.crc) return E_CRC;
+    
+    memset(&events.events_map, 0x0, sizeof(drive_events_map_t));
+    
+    events.events_map.events_count = map.events_count;
+    events.events_map.event_index = map.event_index;
+    events.events_map.event_id = map.event_id;
+    
+    return E_NO_ERROR;
 }
 
 err_t drive_events_read(void)
@@ -80,7 +192,7 @@ err_t drive_events_read(void)
      uint16_t crc = crc16_ccitt(&events.events_map,
              sizeof(drive_events_map_t) - sizeof(uint16_t));
      
-     if(crc != events.events_map.crc) return E_CRC;
+     if(crc != events.events_map.crc) return drive_events_read_legacy();
      
      return E_NO_ERROR;
 }
@@ -168,6 +280,154 @@ static storage_address_t drive_events_get_address(drive_event_index_t event_inde
     return STORAGE_RGN_EVENTS_ADDRESS + (uint32_t)event_index * DRIVE_EVENT_SIZE;
 }
 
+/**
+ * Помещает информацию о событии в индекс.
+ * Индекс изменяется задачей хранилища и читается
+ * задачами Modbus и интерфейса, поэтому вызывается
+ * в критической секции.
+ * @param index Индекс события.
+ * @param event Событие.
+ */
+static void drive_events_index_put(drive_event_index_t index, const drive_event_t* event)
+{
+    drive_event_info_t* info = &events.index[index];
+    
+    info->time = event->time;
+    info->id = event->id;
+    info->type = event->type;
+    info->osc_index = DRIVE_EVENTS_OSC_INDEX_NONE;
+    info->valid = true;
+}
+
+/**
+ * Привязывает в индексе осциллограмму к событию.
+ * Предыдущая привязка осциллограммы снимается.
+ * @param osc_index Индекс осциллограммы.
+ * @param event_id Идентификатор события.
+ */
+static void drive_events_index_link_osc(drive_osc_index_t osc_index, drive_event_id_t event_id)
+{
+    CRITICAL_ENTER();
+    
+    size_t i;
+    for(i = 0; i < DRIVE_EVENTS_COUNT_MAX; i ++){
+        if(events.index[i].osc_index == osc_index){
+            events.index[i].osc_index = DRIVE_EVENTS_OSC_INDEX_NONE;
+        }
+    }
+    
+    drive_event_index_t event_index = 0;
+    
+    if(drive_events_index_by_id(event_id, &event_index)){
+        events.index[event_index].osc_index = osc_index;
+    }
+    
+    CRITICAL_EXIT();
+}
+
+err_t drive_events_read_index(void)
+{
+    CRITICAL_ENTER();
+    memset(events.index, 0x0, sizeof(events.index));
+    CRITICAL_EXIT();
+    
+    drive_event_t event;
+    drive_event_index_t index = drive_events_first_index();
+    err_t err = E_NO_ERROR;
+    
+    size_t i;
+    for(i = 0; i < drive_events_count(); i ++){
+        err = drive_events_read_event(&event, index);
+        
+        if(err == E_NO_ERROR){
+            CRITICAL_ENTER();
+            drive_events_index_put(index, &event);
+            CRITICAL_EXIT();
+        }else if(err != E_CRC){
+            return err;
+        }
+        
+        index = drive_events_next_index(index);
+    }
+    
+    for(i = 0; i < drive_events_oscillograms_count(); i ++){
+        drive_events_index_link_osc((drive_osc_index_t)i, events.events_map.osc_event_ids[i]);
+    }
+    
+    return E_NO_ERROR;
+}
+
+bool drive_events_info(drive_event_index_t index, drive_event_info_t* info)
+{
+    if(index >= DRIVE_EVENTS_COUNT_MAX) return false;
+    
+    CRITICAL_ENTER();
+    *info = events.index[index];
+    CRITICAL_EXIT();
+    
+    return info->valid;
+}
+
+bool drive_events_index_by_id(drive_event_id_t id, drive_event_index_t* index)
+{
+    // Идентификаторы последовательных событий отличаются на единицу,
+    // последнее событие имеет идентификатор из карты событий.
+    drive_event_id_t offset = events.events_map.event_id - id;
+    
+    if((size_t)offset >= drive_events_count()) return false;
+    
+    size_t event_index = (size_t)events.events_map.event_index + DRIVE_EVENTS_COUNT_MAX - offset;
+    if(event_index >= DRIVE_EVENTS_COUNT_MAX) event_index -= DRIVE_EVENTS_COUNT_MAX;
+    
+    const drive_event_info_t* info = &events.index[event_index];
+    
+    if(!info->valid || info->id != id) return false;
+    
+    if(index) *index = (drive_event_index_t)event_index;
+    
+    return true;
+}
+
+size_t drive_events_select(uint8_t types_mask, uint32_t time_from, size_t skip,
+                           size_t* numbers, drive_event_info_t* infos, size_t count, size_t* total)
+{
+    drive_event_info_t info;
+    size_t selected = 0;
+    size_t matched = 0;
+    size_t index;
+    
+    // Номера событий отсчитываются от первого события
+    // на момент начала выборки.
+    CRITICAL_ENTER();
+    size_t number = drive_events_count();
+    size_t first = drive_events_first_index();
+    CRITICAL_EXIT();
+    
+    while(number > 0){
+        number --;
+        
+        index = first + number;
+        if(index >= DRIVE_EVENTS_COUNT_MAX) index -= DRIVE_EVENTS_COUNT_MAX;
+        
+        if(!drive_events_info((drive_event_index_t)index, &info)) continue;
+        if(info.type > DRIVE_EVENT_TYPE_ERROR) continue;
+        if(!(types_mask & DRIVE_EVENT_TYPE_MASK(info.type))) continue;
+        if(info.time < time_from) continue;
+        
+        if(matched >= skip && selected < count){
+            if(numbers) numbers[selected] = number;
+            if(infos) infos[selected] = info;
+            selected ++;
+        }
+        
+        matched ++;
+    }
+    
+    if(total) *total = matched;
+    
+    return selected;
+}
+
 err_t drive_events_write_event(drive_event_t* event)
 {
     drive_event_index_t event_index = 0;
@@ -185,12 +445,18 @@ err_t drive_events_write_event(drive_event_t* event)
     err = storage_write(event_address, event, sizeof(drive_event_t));
     if(err != E_NO_ERROR) return err;
     
+    CRITICAL_ENTER();
+    
     events.events_map.event_id ++;
     events.events_map.event_index = event_index;
     if(events.events_map.events_count < DRIVE_EVENTS_COUNT_MAX){
         events.events_map.events_count ++;
     }
     
+    drive_events_index_put(event_index, event);
+    
+    CRITICAL_EXIT();
+    
     return E_NO_ERROR;
 }
 
@@ -250,15 +516,58 @@ drive_event_id_t drive_events_osc_event_id(drive_osc_index_t index)
     return events.events_map.osc_event_ids[index];
 }
 
-static storage_address_t drive_events_get_osc_channel_address(drive_osc_index_t osc_index, size_t osc_ch_index)
+static storage_address_t drive_events_get_osc_address(drive_osc_index_t osc_index)
 {
-    return STORAGE_RGN_OSC_ADDRESS + osc_index * DRIVE_OSC_SIZE  + (uint32_t)osc_ch_index * sizeof(drive_power_osc_channel_t);
+    return STORAGE_RGN_OSC_ADDRESS + (uint32_t)osc_index * DRIVE_OSC_SIZE;
 }
 
-static err_t drive_events_write_osc_channel_impl(drive_osc_index_t osc_index, size_t osc_ch_index, drive_power_osc_channel_t* osc)
+/**
+ * Вычисляет контрольную сумму заголовка осциллограммы.
+ * @param header Заголовок осциллограммы.
+ * @return Контрольная сумма.
+ */
+static uint16_t drive_events_osc_header_crc(const drive_osc_header_t* header)
 {
-    storage_address_t address = drive_events_get_osc_channel_address(osc_index, osc_ch_index);
-    return storage_write(address, osc, sizeof(drive_power_osc_channel_t));
+    return crc16_ccitt(header, offsetof(drive_osc_header_t, crc));
+}
+
+/**
+ * Получает смещение конца данных каналов осциллограмм питания.
+ * @param header Заголовок осциллограммы.
+ * @param osc_ch_index Индекс канала, до которого вычисляется смещение.
+ * @return Смещение от начала осциллограммы.
+ */
+static size_t drive_events_osc_channel_offset(const drive_osc_header_t* header, size_t osc_ch_index)
+{
+    size_t offset = sizeof(drive_osc_header_t);
+    
+    size_t i;
+    for(i = 0; i < osc_ch_index; i ++){
+        offset += header->channel_sizes[i];
+    }
+    
+    return offset;
+}
+
+/**
+ * Сжимает и записывает канал осциллограммы из буфера.
+ * Если канал не сжимается - записывает его без сжатия.
+ * @param address Адрес канала.
+ * @param size Размер записанных данных канала.
+ * @return Код ошибки.
+ */
+static err_t drive_events_write_osc_channel_impl(storage_address_t address, size_t* size)
+{
+    size_t codec_size = osc_codec_encode(events.osc_buf.data, DRIVE_POWER_OSC_CHANNEL_LEN,
+                                         events.codec_buf, DRIVE_POWER_OSC_CHANNEL_SIZE - 1);
+    
+    if(codec_size == 0){
+        *size = DRIVE_POWER_OSC_CHANNEL_SIZE;
+        return storage_write(address, events.osc_buf.data, DRIVE_POWER_OSC_CHANNEL_SIZE);
+    }
+    
+    *size = codec_size;
+    return storage_write(address, events.codec_buf, codec_size);
 }
 
 #ifdef DRIVE_EVENTS_OSC_SELFTUNE
@@ -344,6 +653,13 @@ err_t drive_events_write_current_oscillogram(drive_event_id_t event_id)
         osc_index = drive_events_oscillograms_next_index(events.events_map.osc_index);
     }
     
+    drive_osc_header_t* header = &events.osc_header;
+    memset(header, 0x0, sizeof(drive_osc_header_t));
+    
+    storage_address_t osc_address = drive_events_get_osc_address(osc_index);
+    storage_address_t address = osc_address + sizeof(drive_osc_header_t);
+    size_t size = 0;
+    
     for(; osc_ch_index < DRIVE_POWER_OSC_CHANNELS_COUNT; osc_ch_index ++){
         
         switch(osc_ch_index){
@@ -365,9 +681,17 @@ err_t drive_events_write_current_oscillogram(drive_event_id_t event_id)
                 RETURN_ERR_IF_FAIL(drive_power_osc_channel_get(osc_ch_index, &events.osc_buf));
                 break;
         }
-        RETURN_ERR_IF_FAIL(drive_events_write_osc_channel_impl(osc_index, osc_ch_index, &events.osc_buf));
+        RETURN_ERR_IF_FAIL(drive_events_write_osc_channel_impl(address, &size));
+        
+        header->channel_sizes[osc_ch_index] = (uint16_t)size;
+        address += size;
     }
     
+    header->trend_period_us = (uint16_t)drive_power_osc_trend_period_us();
+    header->crc = drive_events_osc_header_crc(header);
+    
+    RETURN_ERR_IF_FAIL(storage_write(osc_address, header, sizeof(drive_osc_header_t)));
+    
     if(events.events_map.osc_count < DRIVE_OSCS_COUNT_MAX){
         events.events_map.osc_count ++;
     }
@@ -375,17 +699,324 @@ err_t drive_events_write_current_oscillogram(drive_event_id_t event_id)
     events.events_map.osc_event_ids[osc_index] = event_id;
     events.events_map.osc_index = osc_index;
     
+    drive_events_index_link_osc(osc_index, event_id);
+    
+    return E_NO_ERROR;
+}
+
+/**
+ * Записывает число точек тренда в заголовок осциллограммы.
+ * @param trend_count Число точек тренда.
+ * @return Код ошибки.
+ */
+static err_t drive_events_osc_trend_write_count(uint16_t trend_count)
+{
+    drive_events_osc_trend_t* trend = &events.osc_trend;
+    
+    trend->header.trend_count = trend_count;
+    trend->header.crc = drive_events_osc_header_crc(&trend->header);
+    
+    storage_address_t osc_address = drive_events_get_osc_address(trend->osc_index);
+    
+    return storage_write(osc_address + offsetof(drive_osc_header_t, trend_count),
+                         &trend->header.trend_count, sizeof(uint16_t) * 2);
+}
+
+/**
+ * Записывает накопленный блок точек тренда в хранилище.
+ * @return Код ошибки.
+ */
+static err_t drive_events_osc_trend_flush(void)
+{
+    drive_events_osc_trend_t* trend = &events.osc_trend;
+    
+    if(trend->block_count == 0) return E_NO_ERROR;
+    
+    // Состояния кодека обновляются только после успешной записи.
+    osc_codec_state_t states[DRIVE_POWER_OSC_CHANNELS_COUNT];
+    memcpy(states, trend->states, sizeof(states));
+    
+    size_t size = 0;
+    size_t i;
+    for(i = 0; i < DRIVE_POWER_OSC_CHANNELS_COUNT; i ++){
+        size += osc_codec_encode_block(&states[i], trend->block[i], trend->block_count, events.codec_buf + size);
+    }
+    
+    // Место в осциллограмме закончилось - тренд обрезается.
+    if(trend->offset + size > DRIVE_OSC_SIZE){
+        // Ни одна точка тренда не поместилась -
+        // тренд осциллограммы помечается отсутствующим.
+        if(trend->count == 0){
+            RETURN_ERR_IF_FAIL(drive_events_osc_trend_write_count(DRIVE_OSC_TREND_COUNT_NONE));
+        }
+        
+        trend->active = false;
+        
+        return (trend->count == 0) ? E_OUT_OF_MEMORY : E_NO_ERROR;
+    }
+    
+    storage_address_t osc_address = drive_events_get_osc_address(trend->osc_index);
+    
+    RETURN_ERR_IF_FAIL(storage_write(osc_address + trend->offset, events.codec_buf, size));
+    
+    RETURN_ERR_IF_FAIL(drive_events_osc_trend_write_count((uint16_t)(trend->count + trend->block_count)));
+    
+    memcpy(trend->states, states, sizeof(states));
+    trend->offset += size;
+    trend->count += trend->block_count;
+    trend->block_count = 0;
+    
+    if(trend->count >= DRIVE_POWER_OSC_TREND_LEN){
+        trend->active = false;
+    }
+    
+    return E_NO_ERROR;
+}
+
+/**
+ * Помещает точку тренда в блок.
+ * @param point Точка тренда.
+ */
+static void drive_events_osc_trend_put(const drive_power_osc_trend_point_t* point)
+{
+    drive_events_osc_trend_t* trend = &events.osc_trend;
+    
+    size_t i;
+    for(i = 0; i < DRIVE_POWER_OSC_CHANNELS_COUNT; i ++){
+        trend->block[i][trend->block_count] = point->data[i];
+    }
+    
+    trend->block_count ++;
+}
+
+/**
+ * Получает флаг заполненности блока тренда.
+ * @return Флаг заполненности блока тренда.
+ */
+static bool drive_events_osc_trend_block_full(void)
+{
+    drive_events_osc_trend_t* trend = &events.osc_trend;
+    
+    return trend->block_count >= DRIVE_OSC_TREND_BLOCK_LEN ||
+           (trend->count + trend->block_count) >= DRIVE_POWER_OSC_TREND_LEN;
+}
+
+/**
+ * Дописывает тренд нулями до полной длины.
+ * @return Код ошибки.
+ */
+static err_t drive_events_osc_trend_finish(void)
+{
+    drive_events_osc_trend_t* trend = &events.osc_trend;
+    
+    drive_power_osc_trend_point_t point;
+    memset(&point, 0x0, sizeof(drive_power_osc_trend_point_t));
+    
+    while(trend->active){
+        while(!drive_events_osc_trend_block_full()){
+            drive_events_osc_trend_put(&point);
+        }
+        RETURN_ERR_IF_FAIL(drive_events_osc_trend_flush());
+    }
+    
+    return E_NO_ERROR;
+}
+
+err_t drive_events_osc_trend_begin(uint32_t trigger_number)
+{
+    drive_events_osc_trend_t* trend = &events.osc_trend;
+    
+    if(trend->active){
+        // Забираем доступные точки предыдущего тренда.
+        err_t err = drive_events_osc_trend_process();
+        if(err == E_NO_ERROR) err = drive_events_osc_trend_finish();
+        // Непоместившийся тренд уже отмечен в своей осциллограмме.
+        if(err != E_NO_ERROR && err != E_OUT_OF_MEMORY) return err;
+    }
+    
+    if(events.events_map.osc_count == 0) return E_STATE;
+    
+    uint32_t pre_len = DRIVE_OSC_TREND_PRE_LEN;
+    if(trigger_number < pre_len) pre_len = trigger_number;
+    
+    trend->osc_index = events.events_map.osc_index;
+    trend->header = events.osc_header;
+    trend->first_number = trigger_number - pre_len;
+    trend->offset = drive_events_osc_channel_offset(&trend->header, DRIVE_POWER_OSC_CHANNELS_COUNT);
+    trend->count = 0;
+    trend->block_count = 0;
+    
+    size_t i;
+    for(i = 0; i < DRIVE_POWER_OSC_CHANNELS_COUNT; i ++){
+        osc_codec_state_init(&trend->states[i]);
+    }
+    
+    trend->active = true;
+    
+    return drive_events_osc_trend_process();
+}
+
+err_t drive_events_osc_trend_process(void)
+{
+    drive_events_osc_trend_t* trend = &events.osc_trend;
+    
+    drive_power_osc_trend_point_t point;
+    uint32_t number;
+    
+    while(trend->active){
+        while(!drive_events_osc_trend_block_full()){
+            number = trend->first_number + trend->count + trend->block_count;
+            
+            if(drive_power_osc_trend_point_get(number, &point) != E_NO_ERROR){
+                // Точка ещё не записана.
+                if(number == drive_power_osc_trend_count()) return E_NO_ERROR;
+                // Точка уже перезаписана.
+                memset(&point, 0x0, sizeof(drive_power_osc_trend_point_t));
+            }
+            
+            drive_events_osc_trend_put(&point);
+        }
+        
+        RETURN_ERR_IF_FAIL(drive_events_osc_trend_flush());
+    }
+    
+    return E_NO_ERROR;
+}
+
+void drive_events_osc_trend_cancel(void)
+{
+    events.osc_trend.active = false;
+}
+
+bool drive_events_osc_trend_active(void)
+{
+    return events.osc_trend.active;
+}
+
+/**
+ * Проверяет заголовок осциллограммы.
+ * @param header Заголовок осциллограммы.
+ * @return Код ошибки.
+ */
+static err_t drive_events_osc_header_check(const drive_osc_header_t* header)
+{
+    if(header->crc != drive_events_osc_header_crc(header)) return E_CRC;
+    
+    size_t i;
+    for(i = 0; i < DRIVE_POWER_OSC_CHANNELS_COUNT; i ++){
+        if(header->channel_sizes[i] == 0 ||
+           header->channel_sizes[i] > DRIVE_POWER_OSC_CHANNEL_SIZE) return E_CRC;
+    }
+    
+    if(header->trend_period_us < 1000000 / POWER_FREQ_MAX ||
+       header->trend_period_us > 1000000 / POWER_FREQ_MIN) return E_CRC;
+    
+    if(header->trend_count > DRIVE_POWER_OSC_TREND_LEN &&
+       header->trend_count != DRIVE_OSC_TREND_COUNT_NONE) return E_CRC;
+    
+    return E_NO_ERROR;
+}
+
+/**
+ * Считывает и распаковывает канал тренда в буфер.
+ * @param osc_address Адрес осциллограммы.
+ * @param header Заголовок осциллограммы.
+ * @param trend_channel Канал тренда.
+ * @param data Буфер для данных канала.
+ * @return Код ошибки.
+ */
+static err_t drive_events_read_osc_trend_channel(storage_address_t osc_address,
+        const drive_osc_header_t* header, size_t trend_channel, osc_value_t* data)
+{
+    memset(data, 0x0, DRIVE_POWER_OSC_CHANNEL_SIZE);
+    
+    if(header->trend_count == DRIVE_OSC_TREND_COUNT_NONE) return E_OUT_OF_MEMORY;
+    
+    osc_codec_state_t state;
+    osc_codec_state_init(&state);
+    
+    size_t offset = drive_events_osc_channel_offset(header, DRIVE_POWER_OSC_CHANNELS_COUNT);
+    size_t count = 0;
+    size_t n, size, pos, block_size;
+    size_t i;
+    
+    while(count < header->trend_count){
+        n = MIN(DRIVE_OSC_TREND_BLOCK_LEN, header->trend_count - count);
+        size = MIN(DRIVE_OSC_TREND_BLOCK_SIZE_MAX, DRIVE_OSC_SIZE - offset);
+        
+        if(size == 0) return E_CRC;
+        
+        RETURN_ERR_IF_FAIL(storage_read(osc_address + offset, events.codec_buf, size));
+        
+        pos = 0;
+        for(i = 0; i < DRIVE_POWER_OSC_CHANNELS_COUNT; i ++){
+            if(pos >= size) return E_CRC;
+            
+            if(i == trend_channel){
+                block_size = osc_codec_decode_block(&state, events.codec_buf + pos, size - pos,
+                                                    &data[count], n);
+            }else{
+                block_size = osc_codec_block_size(events.codec_buf[pos], n);
+            }
+            
+            if(block_size == 0 || pos + block_size > size) return E_CRC;
+            
+            pos += block_size;
+        }
+        
+        offset += pos;
+        count += n;
+    }
+    
     return E_NO_ERROR;
 }
 
 err_t drive_events_read_osc_channel(drive_osc_index_t index, size_t osc_channel)
 {
+    return drive_events_read_osc_channel_data(index, osc_channel, events.osc_buf.data);
+}
+
+err_t drive_events_read_osc_channel_data(drive_osc_index_t index, size_t osc_channel, osc_value_t* data)
+{
+    if(data == NULL) return E_NULL_POINTER;
     if(index >= events.events_map.osc_count) return E_OUT_OF_RANGE;
-    storage_address_t address = drive_events_get_osc_channel_address(index, osc_channel);
-    return storage_read(address, &events.osc_buf, sizeof(drive_power_osc_channel_t));
+    if(osc_channel >= DRIVE_EVENTS_OSC_CHANNELS_COUNT) return E_OUT_OF_RANGE;
+    
+    storage_address_t osc_address = drive_events_get_osc_address(index);
+    drive_osc_header_t header;
+    
+    RETURN_ERR_IF_FAIL(storage_read(osc_address, &header, sizeof(drive_osc_header_t)));
+    RETURN_ERR_IF_FAIL(drive_events_osc_header_check(&header));
+    
+    events.readed_osc_trend_period_us = header.trend_period_us;
+    
+    if(osc_channel >= DRIVE_EVENTS_OSC_TREND_CHANNEL_FIRST){
+        return drive_events_read_osc_trend_channel(osc_address, &header,
+                osc_channel - DRIVE_EVENTS_OSC_TREND_CHANNEL_FIRST, data);
+    }
+    
+    storage_address_t address = osc_address + drive_events_osc_channel_offset(&header, osc_channel);
+    size_t size = header.channel_sizes[osc_channel];
+    
+    if(size == DRIVE_POWER_OSC_CHANNEL_SIZE){
+        return storage_read(address, data, size);
+    }
+    
+    RETURN_ERR_IF_FAIL(storage_read(address, events.codec_buf, size));
+    
+    if(osc_codec_decode(events.codec_buf, size, data, DRIVE_POWER_OSC_CHANNEL_LEN) != E_NO_ERROR){
+        return E_CRC;
+    }
+    
+    return E_NO_ERROR;
 }
 
 const osc_value_t* drive_events_readed_osc_data(void)
 {
     return events.osc_buf.data;
 }
+
+uint32_t drive_events_readed_osc_trend_period_us(void)
+{
+    return events.readed_osc_trend_period_us;
+}
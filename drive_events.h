@@ -14,7 +14,13 @@
 
 
 //! Максимальное число осциллограмм.
-#define DRIVE_OSCILLOGRAMS_COUNT_MAX 15
+#define DRIVE_OSCILLOGRAMS_COUNT_MAX 14
+
+//! Первый канал тренда в осциллограмме.
+#define DRIVE_EVENTS_OSC_TREND_CHANNEL_FIRST DRIVE_POWER_OSC_CHANNELS_COUNT
+
+//! Число каналов осциллограммы (каналы осциллограмм питания и каналы тренда).
+#define DRIVE_EVENTS_OSC_CHANNELS_COUNT (DRIVE_POWER_OSC_CHANNELS_COUNT * 2)
 
 //! Тип идентификатора события.
 typedef uint8_t drive_event_id_t;
@@ -32,6 +38,25 @@ typedef enum _Drive_Event_Type {
     DRIVE_EVENT_TYPE_ERROR = 2 //!< Ошибка.
 } drive_event_type_t;
 
+//! Маска типа события для выборки событий.
+#define DRIVE_EVENT_TYPE_MASK(type) (1 << (type))
+//! Маска всех типов событий.
+#define DRIVE_EVENT_TYPES_ALL (DRIVE_EVENT_TYPE_MASK(DRIVE_EVENT_TYPE_STATUS) |\
+                               DRIVE_EVENT_TYPE_MASK(DRIVE_EVENT_TYPE_WARNING) |\
+                               DRIVE_EVENT_TYPE_MASK(DRIVE_EVENT_TYPE_ERROR))
+
+//! Индекс осциллограммы события без осциллограммы.
+#define DRIVE_EVENTS_OSC_INDEX_NONE 0xff
+
+//! Тип краткой информации о событии в индексе событий.
+typedef struct _Drive_Event_Info {
+    uint32_t time; //!< Время возникновения события.
+    drive_event_id_t id; //!< Идентификатор события.
+    uint8_t type; //!< Тип события.
+    drive_osc_index_t osc_index; //!< Индекс осциллограммы события.
+    bool valid; //!< Флаг действительности информации.
+} drive_event_info_t;
+
 #pragma pack(push, 1)
 //! Тип события.
 typedef struct _Drive_Event {
@@ -82,6 +107,14 @@ extern void drive_events_reset(void);
  */
 extern err_t drive_events_read(void);
 
+/**
+ * Строит индекс событий по событиям в хранилище.
+ * События, которые не удалось прочитать,
+ * отмечаются в индексе недействительными.
+ * @return Код ошибки.
+ */
+extern err_t drive_events_read_index(void);
+
 /**
  * Записывает информацию о событиях в хранилищие.
  * @return Код ошибки.
@@ -144,6 +177,40 @@ extern err_t drive_events_write_event(drive_event_t* event);
  */
 extern err_t drive_events_read_event(drive_event_t* event, drive_event_index_t index);
 
+/**
+ * Получает копию краткой информации о событии из индекса.
+ * Индекс изменяется задачей хранилища,
+ * копия снимается в критической секции.
+ * @param index Индекс события.
+ * @param info Информация о событии.
+ * @return Флаг наличия информации о событии.
+ */
+extern bool drive_events_info(drive_event_index_t index, drive_event_info_t* info);
+
+/**
+ * Получает индекс события по идентификатору.
+ * @param id Идентификатор события.
+ * @param index Индекс события.
+ * @return Флаг наличия события.
+ */
+extern bool drive_events_index_by_id(drive_event_id_t id, drive_event_index_t* index);
+
+/**
+ * Выбирает из индекса события заданных типов,
+ * возникшие не ранее заданного времени.
+ * События перебираются от последнего к первому.
+ * @param types_mask Маска типов событий.
+ * @param time_from Время, начиная с которого выбираются события.
+ * @param skip Число пропускаемых подходящих событий.
+ * @param numbers Номера выбранных событий, может быть NULL.
+ * @param infos Копии информации о выбранных событиях, может быть NULL.
+ * @param count Максимальное число выбираемых событий.
+ * @param total Общее число подходящих событий, может быть NULL.
+ * @return Число выбранных событий.
+ */
+extern size_t drive_events_select(uint8_t types_mask, uint32_t time_from, size_t skip,
+                                  size_t* numbers, drive_event_info_t* infos, size_t count, size_t* total);
+
 /**
  * Получает число осциллограмм.
  * @return Число осциллограмм.
@@ -191,19 +258,69 @@ extern drive_event_id_t drive_events_osc_event_id(drive_osc_index_t index);
  */
 extern err_t drive_events_write_current_oscillogram(drive_event_id_t event_id);
 
+/**
+ * Начинает запись тренда в последнюю записанную осциллограмму.
+ * Тренд содержит предысторию до момента события
+ * и дописывается в хранилище по мере поступления точек.
+ * Незавершённая запись предыдущего тренда
+ * дополняется нулями.
+ * @param trigger_number Номер точки тренда в момент события.
+ * @return Код ошибки, E_OUT_OF_MEMORY если
+ * ни одна точка тренда не поместилась в осциллограмму.
+ */
+extern err_t drive_events_osc_trend_begin(uint32_t trigger_number);
+
+/**
+ * Записывает в хранилище поступившие точки тренда.
+ * @return Код ошибки, E_OUT_OF_MEMORY если
+ * ни одна точка тренда не поместилась в осциллограмму.
+ */
+extern err_t drive_events_osc_trend_process(void);
+
+/**
+ * Отменяет запись тренда.
+ */
+extern void drive_events_osc_trend_cancel(void);
+
+/**
+ * Получает флаг записи тренда.
+ * @return Флаг записи тренда.
+ */
+extern bool drive_events_osc_trend_active(void);
+
 /**
  * Считывает канал осциллограммы
  * питания привода в буфер.
+ * Каналы начиная с DRIVE_EVENTS_OSC_TREND_CHANNEL_FIRST
+ * содержат тренд.
  * @param index Индекс осциллограммы.
  * @param osc_channel Канал осциллограммы.
  * @return Код ошибки.
  */
 extern err_t drive_events_read_osc_channel(drive_osc_index_t index, size_t osc_channel);
 
+/**
+ * Считывает канал осциллограммы
+ * питания привода в заданный буфер.
+ * @param index Индекс осциллограммы.
+ * @param osc_channel Канал осциллограммы.
+ * @param data Буфер размером DRIVE_POWER_OSC_CHANNEL_SIZE.
+ * @return Код ошибки, E_OUT_OF_MEMORY для канала тренда,
+ * если тренд не поместился в осциллограмму.
+ */
+extern err_t drive_events_read_osc_channel_data(drive_osc_index_t index, size_t osc_channel, osc_value_t* data);
+
 /**
  * Получает указатель на данные считанного канала осциллограммы.
  * @return Указатель на данные канала осциллограммы.
  */
 extern const osc_value_t* drive_events_readed_osc_data(void);
 
+/**
+ * Получает период точек тренда
+ * последней считанной осциллограммы.
+ * @return Период точек тренда в мкс.
+ */
+extern uint32_t drive_events_readed_osc_trend_period_us(void);
+
 #endif /* DRIVE_EVENTS_H */
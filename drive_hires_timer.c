@@ -25,6 +25,13 @@ static void init_timer_priph(TIM_TypeDef* TIM)
     TIM->SR  = 0;
 }
 
+static void init_cycle_counter(void)
+{
+    DRIVE_HIRES_TIMER_DEMCR |= DRIVE_HIRES_TIMER_DEMCR_TRCENA;
+    DRIVE_HIRES_TIMER_DWT_CYCCNT = 0;
+    DRIVE_HIRES_TIMER_DWT_CTRL |= DRIVE_HIRES_TIMER_DWT_CTRL_CYCCNTENA;
+}
+
 
 err_t drive_hires_timer_init(TIM_TypeDef* timer)
 {
@@ -34,6 +41,8 @@ err_t drive_hires_timer_init(TIM_TypeDef* timer)
     
     init_timer_priph(timer);
     
+    init_cycle_counter();
+    
     return E_NO_ERROR;
 }
 
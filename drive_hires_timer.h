@@ -10,6 +10,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <sys/time.h>
+#include "defs/defs.h"
 
 
 
@@ -21,6 +22,18 @@
 //! Предделитель таймера.
 #define DRIVE_HIRES_TIMER_PRESCALER 72
 
+// Счётчик тактов ядра (DWT).
+//! Регистр управления DWT.
+#define DRIVE_HIRES_TIMER_DWT_CTRL (*(volatile uint32_t*)0xE0001000)
+//! Регистр счётчика тактов DWT.
+#define DRIVE_HIRES_TIMER_DWT_CYCCNT (*(volatile uint32_t*)0xE0001004)
+//! Регистр DEMCR отладочного блока ядра.
+#define DRIVE_HIRES_TIMER_DEMCR (*(volatile uint32_t*)0xE000EDFC)
+//! Бит разрешения трассировки в DEMCR.
+#define DRIVE_HIRES_TIMER_DEMCR_TRCENA (1UL << 24)
+//! Бит разрешения счётчика тактов в DWT_CTRL.
+#define DRIVE_HIRES_TIMER_DWT_CTRL_CYCCNTENA (1UL << 0)
+
 
 
 /**
@@ -93,5 +106,25 @@ extern void drive_hires_timer_reset(void);
  */
 extern void drive_hires_timer_value(struct timeval* tv);
 
+/**
+ * Получает значение счётчика тактов ядра.
+ * Переполняется каждые ~59.6 секунд (при 72 МГц),
+ * разность двух значений корректна при переполнении.
+ * @return Значение счётчика тактов.
+ */
+ALWAYS_INLINE static uint32_t drive_hires_timer_cycles(void)
+{
+    return DRIVE_HIRES_TIMER_DWT_CYCCNT;
+}
+
+/**
+ * Получает число тактов ядра в микросекунде.
+ * @return Число тактов в микросекунде.
+ */
+ALWAYS_INLINE static uint32_t drive_hires_timer_cycles_per_us(void)
+{
+    return SystemCoreClock / 1000000;
+}
+
 #endif /* DRIVE_HIRES_TIMER_H */
 
@@ -101,46 +101,49 @@ fixed32_t fixed32_lerp(fixed32_t a, fixed32_t b, fixed32_t t)
     return at + bt;
 }
 
+//! Число бит индекса таблицы начальных приближений корня.
+#define SQRT_TABLE_INDEX_BITS 6
+//! Минимальный индекс таблицы (старшие биты нормализованного значения).
+#define SQRT_TABLE_INDEX_MIN (1 << (SQRT_TABLE_INDEX_BITS - 2))
+//! Размер таблицы начальных приближений корня.
+#define SQRT_TABLE_SIZE ((1 << SQRT_TABLE_INDEX_BITS) - SQRT_TABLE_INDEX_MIN)
+
+/**
+ * Таблица начальных приближений корня.
+ * Элемент i равен round(sqrt(i + SQRT_TABLE_INDEX_MIN + 0.5) * 32).
+ */
+static const uint8_t sqrt_table[SQRT_TABLE_SIZE] = {
+    0x82, 0x86, 0x8a, 0x8d, 0x91, 0x94, 0x98, 0x9b, 0x9e, 0xa2, 0xa5, 0xa8,
+    0xab, 0xae, 0xb1, 0xb4, 0xb6, 0xb9, 0xbc, 0xbf, 0xc1, 0xc4, 0xc7, 0xc9,
+    0xcc, 0xce, 0xd1, 0xd3, 0xd5, 0xd8, 0xda, 0xdd, 0xdf, 0xe1, 0xe3, 0xe6,
+    0xe8, 0xea, 0xec, 0xee, 0xf1, 0xf3, 0xf5, 0xf7, 0xf9, 0xfb, 0xfd, 0xff,
+};
+
 uint32_t bsqrti(uint32_t value)
 {
-    uint32_t rem = 0;
-    uint32_t root = 0;
+    if(value == 0) return 0;
+    
+    // Нормализация на чётное число бит,
+    // старшие два бита не равны нулю.
+    uint32_t shift = (uint32_t)__builtin_clz(value) & ~1UL;
+    uint32_t norm = value << shift;
     
-    uint32_t i = 0;
+    // Начальное приближение по таблице (~1%).
+    uint32_t index = (norm >> (32 - SQRT_TABLE_INDEX_BITS)) - SQRT_TABLE_INDEX_MIN;
+    uint32_t root = ((uint32_t)sqrt_table[index] << 8) >> (shift >> 1);
     
-    for(; i < 16; i ++){
-        root <<= 1;
-        rem = ((rem << 2) + (value >> 30));
-        value <<= 2;
-        root ++;
-        if(root <= rem){
-            rem -= root;
-            root ++;
-        }else{
-            root --;
-        }
-    }
-    return root >> 1;
+    // Две итерации Ньютона.
+    root = (root + value / root) >> 1;
+    root = (root + value / root) >> 1;
+    
+    // Коррекция до целой части корня.
+    while(root * root > value) root --;
+    while(root < 0xffff && (root + 1) * (root + 1) <= value) root ++;
+    
+    return root;
 }
 
 fixed32_t bsqrtf(fixed32_t value)
 {
-    uint32_t rem = 0;
-    uint32_t root = 0;
-    
-    uint32_t i = 0;
-    
-    for(; i < 16; i ++){
-        root <<= 1;
-        rem = ((rem << 2) + ((uint32_t)value >> 30));
-        value <<= 2;
-        root ++;
-        if(root <= rem){
-            rem -= root;
-            root ++;
-        }else{
-            root --;
-        }
-    }
-    return (fixed32_t)(root << 7);
+    return (fixed32_t)(bsqrti((uint32_t)value) << 8);
 }
@@ -34,8 +34,10 @@ fixed32_t fixed32_lerp(fixed32_t a, fixed32_t b, fixed32_t t);
 /**
  * Вычисляет квадратный корень
  * от целочисленного числа.
+ * Начальное приближение по таблице
+ * с нормализацией, уточнение методом Ньютона.
  * @param value Значение.
- * @return Корень.
+ * @return Целая часть корня.
  */
 uint32_t bsqrti(uint32_t value);
 
@@ -4,10 +4,16 @@
 #include "drive_tasks.h"
 #include "drive_dio.h"
 #include "drive_nvdata.h"
+#include "drive_prof.h"
+#include "drive_modbus_timer.h"
+#include "drive_power.h"
+#include "drive_motor.h"
+#include "drive_temp.h"
 #include "settings.h"
 #include "future/future.h"
 #include "utils/utils.h"
 #include "utils/net.h"
+#include "utils/critical.h"
 #include <string.h>
 #include <time.h>
 #include <sys/time.h>
@@ -31,20 +37,6 @@ typedef struct _DriveModbusId {
 #define DRIVE_ID_NAME  "Drive"
 
 
-//! Тип интерфейса Modbus привода.
-typedef struct _Drive_modbus {
-    drive_modbus_id_t id;
-    apply_settings_callback_t apply_settings_callback;
-    save_settings_callback_t save_settings_callback;
-    drive_event_t event_buf;
-    future_t event_future;
-    future_t osc_future;
-} drive_modbus_t;
-
-//! Интерфейс привода.
-static drive_modbus_t drive_modbus;
-
-
 #define DRIVE_MODBUS_HOLD_REG_
 #define DRIVE_MODBUS_INPUT_REG_
 #define DRIVE_MODBUS_DIN_
@@ -86,6 +78,83 @@ static drive_modbus_t drive_modbus;
 #define DRIVE_MODBUS_INPUT_REG_FAN_RUNTIME (DRIVE_MODBUS_INPUT_REGS_START + 32)
 //! Время работы после включения.
 #define DRIVE_MODBUS_INPUT_REG_LAST_RUNTIME (DRIVE_MODBUS_INPUT_REGS_START + 33)
+//! Число потерянных кадров АЦП.
+#define DRIVE_MODBUS_INPUT_REG_ADC_OVERRUNS (DRIVE_MODBUS_INPUT_REGS_START + 34)
+//! Время оборота последнего запроса RS485, мкс.
+#define DRIVE_MODBUS_INPUT_REG_TURNAROUND (DRIVE_MODBUS_INPUT_REGS_START + 35)
+//! Максимальное время оборота запроса RS485, мкс.
+#define DRIVE_MODBUS_INPUT_REG_TURNAROUND_MAX (DRIVE_MODBUS_INPUT_REGS_START + 36)
+//! Число кадров RS485, разорванных паузой больше t1.5.
+#define DRIVE_MODBUS_INPUT_REG_SPLIT_ERRORS (DRIVE_MODBUS_INPUT_REGS_START + 37)
+//! Число кадров RS485 с межкадровой паузой меньше t3.5.
+#define DRIVE_MODBUS_INPUT_REG_GAP_ERRORS (DRIVE_MODBUS_INPUT_REGS_START + 38)
+//! Число открытий тиристорных пар в режиме гребёнки DMA, выполненных в прерываниях.
+#define DRIVE_MODBUS_INPUT_REG_PT_DMA_FALLBACKS (DRIVE_MODBUS_INPUT_REGS_START + 39)
+// Профилирование.
+//! Начало блока регистров профилирования.
+#define DRIVE_MODBUS_INPUT_REG_PROF_START (DRIVE_MODBUS_INPUT_REGS_START + 40)
+//! Число регистров на один участок профилирования.
+#define DRIVE_MODBUS_INPUT_REG_PROF_SECTION_REGS 8
+//! Конец блока регистров профилирования.
+#define DRIVE_MODBUS_INPUT_REG_PROF_END (DRIVE_MODBUS_INPUT_REG_PROF_START +\
+                    DRIVE_PROF_SECTIONS_COUNT * DRIVE_MODBUS_INPUT_REG_PROF_SECTION_REGS)
+// Быстрое состояние.
+/*
+ * Регистры блока заполняются из одного снимка,
+ * публикуемого раз в итерацию основного цикла,
+ * и при чтении блока одним запросом согласованы между собой.
+ */
+//! Начало блока регистров быстрого состояния.
+#define DRIVE_MODBUS_INPUT_REG_STATUS_START (DRIVE_MODBUS_INPUT_REGS_START + 400)
+// Смещения регистров быстрого состояния.
+//! Счётчик снимков.
+#define DRIVE_MODBUS_STATUS_REG_SEQ 0
+//! Состояние.
+#define DRIVE_MODBUS_STATUS_REG_STATE 1
+//! Полуслова ошибок.
+#define DRIVE_MODBUS_STATUS_REG_ERRORS0 2
+#define DRIVE_MODBUS_STATUS_REG_ERRORS1 3
+//! Полуслова предупреждений.
+#define DRIVE_MODBUS_STATUS_REG_WARNINGS0 4
+#define DRIVE_MODBUS_STATUS_REG_WARNINGS1 5
+//! Полуслова ошибок питания.
+#define DRIVE_MODBUS_STATUS_REG_PWR_ERRORS0 6
+#define DRIVE_MODBUS_STATUS_REG_PWR_ERRORS1 7
+//! Полуслова предупреждений питания.
+#define DRIVE_MODBUS_STATUS_REG_PWR_WARNINGS0 8
+#define DRIVE_MODBUS_STATUS_REG_PWR_WARNINGS1 9
+//! Полуслова ошибок фаз.
+#define DRIVE_MODBUS_STATUS_REG_PHASE_ERRORS0 10
+#define DRIVE_MODBUS_STATUS_REG_PHASE_ERRORS1 11
+//! Напряжение якоря, В * 10.
+#define DRIVE_MODBUS_STATUS_REG_U_ROT 12
+//! Ток якоря, А * 10.
+#define DRIVE_MODBUS_STATUS_REG_I_ROT 13
+//! Ток возбуждения, А * 10.
+#define DRIVE_MODBUS_STATUS_REG_I_EXC 14
+//! Обороты двигателя, об/мин.
+#define DRIVE_MODBUS_STATUS_REG_RPM 15
+//! Температура радиатора, °C * 10.
+#define DRIVE_MODBUS_STATUS_REG_HEATSINK_TEMP 16
+//! Число регистров быстрого состояния.
+#define DRIVE_MODBUS_STATUS_REGS_COUNT 17
+//! Конец блока регистров быстрого состояния.
+#define DRIVE_MODBUS_INPUT_REG_STATUS_END (DRIVE_MODBUS_INPUT_REG_STATUS_START + DRIVE_MODBUS_STATUS_REGS_COUNT)
+// Смещения регистров участка профилирования.
+//! Число измерений, младшее полуслово.
+#define DRIVE_MODBUS_PROF_REG_COUNT_LO 0
+//! Число измерений, старшее полуслово.
+#define DRIVE_MODBUS_PROF_REG_COUNT_HI 1
+//! Минимальное время, мкс * 10.
+#define DRIVE_MODBUS_PROF_REG_MIN 2
+//! Максимальное время, мкс * 10.
+#define DRIVE_MODBUS_PROF_REG_MAX 3
+//! Среднее время, мкс * 10.
+#define DRIVE_MODBUS_PROF_REG_MEAN 4
+//! 99-й процентиль времени, мкс * 10.
+#define DRIVE_MODBUS_PROF_REG_P99 5
+//! Загрузка процессора, % * 10.
+#define DRIVE_MODBUS_PROF_REG_LOAD 6
 // Регистры хранения.
 //! Задание.
 #define DRIVE_MODBUS_HOLD_REG_REFERENCE (DRIVE_MODBUS_HOLD_REGS_START + 0)
@@ -130,6 +199,10 @@ static drive_modbus_t drive_modbus;
 #define DRIVE_MODBUS_COIL_RESET_FAN_RUNTIME (DRIVE_MODBUS_COILS_START + 11)
 //! Самонастройка.
 #define DRIVE_MODBUS_COIL_SELFTUNE (DRIVE_MODBUS_COILS_START + 12)
+//! Сброс статистики профилирования.
+#define DRIVE_MODBUS_COIL_PROF_RESET (DRIVE_MODBUS_COILS_START + 13)
+//! Сброс статистики обмена RS485.
+#define DRIVE_MODBUS_COIL_MODBUS_STAT_RESET (DRIVE_MODBUS_COILS_START + 14)
 
 
 /** Пользовательские функции и коды.
@@ -187,6 +260,34 @@ static drive_modbus_t drive_modbus;
  * data - данные события, N байт.
  */
 #define DRIVE_MODBUS_CODE_GET_READED_EVENT 3
+/**
+ * Код выборки событий из индекса
+ * по типу и времени возникновения.
+ * События выбираются от последнего к первому.
+ * Запрос: | 65 | 4 | MASK | T | SKIP |
+ * Ответ:  | 65 | 4 | M | N | records |
+ * MASK - маска типов событий, 1 байт
+ *        (бит 0 - состояние, 1 - предупреждение, 2 - ошибка);
+ * T - время, начиная с которого выбираются события, 4 байта, старшим вперёд;
+ * SKIP - число пропускаемых подходящих событий, 1 байт;
+ * M - общее число подходящих событий, 1 байт;
+ * N - число записей в ответе, 1 байт;
+ * records - записи событий, N записей вида:
+ * | NUM | ID | TYPE | OSC | TIME |
+ * NUM - номер события, 1 байт;
+ * ID - идентификатор события, 1 байт;
+ * TYPE - тип события, 1 байт;
+ * OSC - индекс осциллограммы события, 0xff - нет осциллограммы, 1 байт;
+ * TIME - время возникновения события, 4 байта, старшим вперёд.
+ */
+#define DRIVE_MODBUS_CODE_SELECT_EVENTS 4
+//! Размер заголовка ответа выборки событий.
+#define DRIVE_MODBUS_SELECT_EVENTS_HEADER_SIZE 3
+//! Размер записи события в ответе выборки событий.
+#define DRIVE_MODBUS_SELECT_EVENTS_RECORD_SIZE 8
+//! Максимальное число записей событий в ответе выборки событий.
+#define DRIVE_MODBUS_SELECT_EVENTS_COUNT_MAX ((MODBUS_RTU_DATA_SIZE_MAX - DRIVE_MODBUS_SELECT_EVENTS_HEADER_SIZE)\
+                                               / DRIVE_MODBUS_SELECT_EVENTS_RECORD_SIZE)
 
 //! Функция доступа к осциллограммам.
 #define DRIVE_MODBUS_FUNC_OSC_ACCESS 66
@@ -239,6 +340,100 @@ static drive_modbus_t drive_modbus;
  * data - данные осциллограммы, N байт.
  */
 #define DRIVE_MODBUS_CODE_GET_READED_OSC 4
+/**
+ * Код начала потоковой передачи
+ * всех каналов осциллограммы
+ * с заданным номером.
+ * Запрос: | 66 | 5 | N |
+ * Ответ:  | 66 | 5 | N | ST | C |
+ * N - номер осциллограммы, 1 байт.
+ * ST - состояние, 1 байт:
+ *     1 - передача начата;
+ *     2 - чтение предыдущей передачи в процессе, запрос нужно повторить.
+ * C - число блоков осциллограммы, 2 байта, старшим вперёд.
+ */
+#define DRIVE_MODBUS_CODE_STREAM_OSC 5
+/**
+ * Код получения блока потоковой
+ * передачи осциллограммы.
+ * Блок с номером S содержит часть канала S / K
+ * по смещению (S % K) * B, где K - число блоков в канале,
+ * B - размер блока. Повторный запрос блока
+ * возвращает те же данные, запрос блока следующего канала
+ * подтверждает приём текущего канала.
+ * Запрос: | 66 | 6 | S |
+ * Ответ:  | 66 | 6 | S | ST | CH | N | data |
+ * S - номер блока, 2 байта, старшим вперёд.
+ * ST - состояние блока, 1 байт:
+ *     0 - передача завершена или не начата;
+ *     1 - блок прочитан;
+ *     2 - чтение в процессе, запрос нужно повторить;
+ *     3 - ошибка чтения (+ код ошибки), запрос нужно повторить.
+ * CH - канал осциллограммы, 1 байт.
+ * N - размер данных блока, 1 байт;
+ * data - данные блока, N байт.
+ */
+#define DRIVE_MODBUS_CODE_GET_OSC_STREAM_BLOCK 6
+/**
+ * Код получения периода точек тренда
+ * прочитанной осциллограммы.
+ * Тренд записывается раз в период сети,
+ * период измеряется при записи осциллограммы.
+ * Запрос: | 66 | 7 |
+ * Ответ:  | 66 | 7 | P |
+ * P - период точек тренда в мкс, 2 байта, старшим вперёд.
+ */
+#define DRIVE_MODBUS_CODE_OSC_TREND_PERIOD 7
+
+// Потоковая передача осциллограмм.
+//! Размер заголовка ответа с блоком потока.
+#define DRIVE_MODBUS_OSC_STREAM_HEADER_SIZE 6
+//! Максимальный размер данных блока потока.
+#define DRIVE_MODBUS_OSC_STREAM_DATA_SIZE_MAX (MODBUS_RTU_DATA_SIZE_MAX - DRIVE_MODBUS_OSC_STREAM_HEADER_SIZE)
+//! Число блоков потока в канале.
+#define DRIVE_MODBUS_OSC_STREAM_CHANNEL_BLOCKS\
+            ((DRIVE_POWER_OSC_CHANNEL_SIZE + DRIVE_MODBUS_OSC_STREAM_DATA_SIZE_MAX - 1) / DRIVE_MODBUS_OSC_STREAM_DATA_SIZE_MAX)
+//! Размер блока потока.
+#define DRIVE_MODBUS_OSC_STREAM_BLOCK_SIZE\
+            ((DRIVE_POWER_OSC_CHANNEL_SIZE + DRIVE_MODBUS_OSC_STREAM_CHANNEL_BLOCKS - 1) / DRIVE_MODBUS_OSC_STREAM_CHANNEL_BLOCKS)
+//! Число блоков потока осциллограммы.
+#define DRIVE_MODBUS_OSC_STREAM_BLOCKS (DRIVE_EVENTS_OSC_CHANNELS_COUNT * DRIVE_MODBUS_OSC_STREAM_CHANNEL_BLOCKS)
+//! Число буферов каналов потока.
+#define DRIVE_MODBUS_OSC_STREAM_BUFFERS 2
+
+
+
+//! Тип буфера канала потоковой передачи осциллограммы.
+typedef struct _Drive_Modbus_Osc_Stream_Buf {
+    future_t future; //!< Будущее чтения канала.
+    size_t channel; //!< Канал осциллограммы.
+    osc_value_t data[DRIVE_POWER_OSC_CHANNEL_LEN]; //!< Данные канала.
+} drive_modbus_osc_stream_buf_t;
+
+//! Тип потоковой передачи осциллограммы.
+typedef struct _Drive_Modbus_Osc_Stream {
+    bool active; //!< Флаг активности передачи.
+    drive_osc_index_t osc_index; //!< Индекс осциллограммы.
+    size_t cur; //!< Индекс буфера передаваемого канала.
+    drive_modbus_osc_stream_buf_t bufs[DRIVE_MODBUS_OSC_STREAM_BUFFERS]; //!< Буферы каналов.
+} drive_modbus_osc_stream_t;
+
+//! Тип интерфейса Modbus привода.
+typedef struct _Drive_modbus {
+    drive_modbus_id_t id;
+    apply_settings_callback_t apply_settings_callback;
+    save_settings_callback_t save_settings_callback;
+    drive_event_t event_buf;
+    future_t event_future;
+    future_t osc_future;
+    drive_modbus_osc_stream_t osc_stream;
+    uint16_t status_regs[DRIVE_MODBUS_STATUS_REGS_COUNT]; //!< Опубликованный снимок быстрого состояния.
+    uint16_t status_read_regs[DRIVE_MODBUS_STATUS_REGS_COUNT]; //!< Снимок быстрого состояния текущего запроса.
+    bool status_latched; //!< Флаг снимка быстрого состояния, зафиксированного текущим запросом.
+} drive_modbus_t;
+
+//! Интерфейс привода.
+static drive_modbus_t drive_modbus;
 
 
 
@@ -256,8 +451,115 @@ static modbus_rtu_error_t drive_modbus_on_read_din(uint16_t address, modbus_rtu_
     return MODBUS_RTU_ERROR_NONE;
 }
 
+//! Насыщение значения до полуслова.
+#define DRIVE_MODBUS_SAT_U16(V) (((V) > 0xffff) ? 0xffff : (uint16_t)(V))
+
+static modbus_rtu_error_t drive_modbus_read_prof_reg(uint16_t address, uint16_t* value)
+{
+    uint16_t offset = address - DRIVE_MODBUS_INPUT_REG_PROF_START;
+    drive_prof_section_t section = (drive_prof_section_t)(offset / DRIVE_MODBUS_INPUT_REG_PROF_SECTION_REGS);
+    
+    drive_prof_stat_t stat;
+    if(drive_prof_stat(section, &stat) != E_NO_ERROR){
+        return MODBUS_RTU_ERROR_INVALID_ADDRESS;
+    }
+    
+    switch(offset % DRIVE_MODBUS_INPUT_REG_PROF_SECTION_REGS){
+        default:
+            *value = 0;
+            break;
+        case DRIVE_MODBUS_PROF_REG_COUNT_LO:
+            *value = stat.count & 0xffff;
+            break;
+        case DRIVE_MODBUS_PROF_REG_COUNT_HI:
+            *value = (stat.count >> 16) & 0xffff;
+            break;
+        case DRIVE_MODBUS_PROF_REG_MIN:
+            *value = DRIVE_MODBUS_SAT_U16(stat.min);
+            break;
+        case DRIVE_MODBUS_PROF_REG_MAX:
+            *value = DRIVE_MODBUS_SAT_U16(stat.max);
+            break;
+        case DRIVE_MODBUS_PROF_REG_MEAN:
+            *value = DRIVE_MODBUS_SAT_U16(stat.mean);
+            break;
+        case DRIVE_MODBUS_PROF_REG_P99:
+            *value = DRIVE_MODBUS_SAT_U16(stat.p99);
+            break;
+        case DRIVE_MODBUS_PROF_REG_LOAD:
+            *value = DRIVE_MODBUS_SAT_U16(stat.load);
+            break;
+    }
+    
+    return MODBUS_RTU_ERROR_NONE;
+}
+
+//! Переводит значение с фиксированной запятой в полуслово с одним знаком после запятой.
+ALWAYS_INLINE static uint16_t drive_modbus_pack_f32_x10(fixed32_t value)
+{
+    return (uint16_t)(int16_t)fixed32_get_int(fixed32_round(value * 10));
+}
+
+void drive_modbus_update_status(void)
+{
+    uint16_t regs[DRIVE_MODBUS_STATUS_REGS_COUNT];
+    
+    drive_errors_t errors = drive_errors();
+    drive_warnings_t warnings = drive_warnings();
+    drive_power_errors_t pwr_errors = drive_power_errors();
+    drive_power_warnings_t pwr_warnings = drive_power_warnings();
+    drive_phase_errors_t phase_errors = drive_phase_errors();
+    
+    regs[DRIVE_MODBUS_STATUS_REG_SEQ] = drive_modbus.status_regs[DRIVE_MODBUS_STATUS_REG_SEQ] + 1;
+    regs[DRIVE_MODBUS_STATUS_REG_STATE] = drive_state();
+    regs[DRIVE_MODBUS_STATUS_REG_ERRORS0] = errors & 0xffff;
+    regs[DRIVE_MODBUS_STATUS_REG_ERRORS1] = (errors >> 16) & 0xffff;
+    regs[DRIVE_MODBUS_STATUS_REG_WARNINGS0] = warnings & 0xffff;
+    regs[DRIVE_MODBUS_STATUS_REG_WARNINGS1] = (warnings >> 16) & 0xffff;
+    regs[DRIVE_MODBUS_STATUS_REG_PWR_ERRORS0] = pwr_errors & 0xffff;
+    regs[DRIVE_MODBUS_STATUS_REG_PWR_ERRORS1] = (pwr_errors >> 16) & 0xffff;
+    regs[DRIVE_MODBUS_STATUS_REG_PWR_WARNINGS0] = pwr_warnings & 0xffff;
+    regs[DRIVE_MODBUS_STATUS_REG_PWR_WARNINGS1] = (pwr_warnings >> 16) & 0xffff;
+    regs[DRIVE_MODBUS_STATUS_REG_PHASE_ERRORS0] = phase_errors & 0xffff;
+    regs[DRIVE_MODBUS_STATUS_REG_PHASE_ERRORS1] = (phase_errors >> 16) & 0xffff;
+    regs[DRIVE_MODBUS_STATUS_REG_U_ROT] = drive_modbus_pack_f32_x10(drive_power_channel_real_value(DRIVE_POWER_Urot));
+    regs[DRIVE_MODBUS_STATUS_REG_I_ROT] = drive_modbus_pack_f32_x10(drive_power_channel_real_value(DRIVE_POWER_Irot));
+    regs[DRIVE_MODBUS_STATUS_REG_I_EXC] = drive_modbus_pack_f32_x10(drive_power_channel_real_value(DRIVE_POWER_Iexc));
+    regs[DRIVE_MODBUS_STATUS_REG_RPM] = (uint16_t)(int16_t)fixed32_get_int(fixed32_round(drive_motor_rpm()));
+    regs[DRIVE_MODBUS_STATUS_REG_HEATSINK_TEMP] = drive_temp_heatsink_temp_avail() ?
+                                    drive_modbus_pack_f32_x10(drive_temp_heatsink_temp()) : 0;
+    
+    CRITICAL_ENTER();
+    memcpy(drive_modbus.status_regs, regs, sizeof(regs));
+    CRITICAL_EXIT();
+}
+
+static modbus_rtu_error_t drive_modbus_read_status_reg(uint16_t address, uint16_t* value)
+{
+    // Снимок фиксируется первым чтением в запросе.
+    if(!drive_modbus.status_latched){
+        CRITICAL_ENTER();
+        memcpy(drive_modbus.status_read_regs, drive_modbus.status_regs, sizeof(drive_modbus.status_regs));
+        CRITICAL_EXIT();
+        
+        drive_modbus.status_latched = true;
+    }
+    
+    *value = drive_modbus.status_read_regs[address - DRIVE_MODBUS_INPUT_REG_STATUS_START];
+    
+    return MODBUS_RTU_ERROR_NONE;
+}
+
 static modbus_rtu_error_t drive_modbus_on_read_inp_reg(uint16_t address, uint16_t* value)
 {
+    if(address >= DRIVE_MODBUS_INPUT_REG_STATUS_START && address < DRIVE_MODBUS_INPUT_REG_STATUS_END){
+        return drive_modbus_read_status_reg(address, value);
+    }
+    
+    if(address >= DRIVE_MODBUS_INPUT_REG_PROF_START && address < DRIVE_MODBUS_INPUT_REG_PROF_END){
+        return drive_modbus_read_prof_reg(address, value);
+    }
+    
     param_t* param = NULL;
     switch(address){
         default:
@@ -312,6 +614,24 @@ static modbus_rtu_error_t drive_modbus_on_read_inp_reg(uint16_t address, uint16_
         case DRIVE_MODBUS_INPUT_REG_LAST_RUNTIME:
             *value = drive_nvdata_last_runtime() / 3600;
             break;
+        case DRIVE_MODBUS_INPUT_REG_ADC_OVERRUNS:
+            *value = DRIVE_MODBUS_SAT_U16(drive_task_adc_overruns());
+            break;
+        case DRIVE_MODBUS_INPUT_REG_TURNAROUND:
+            *value = DRIVE_MODBUS_SAT_U16(drive_modbus_timer_turnaround_us());
+            break;
+        case DRIVE_MODBUS_INPUT_REG_TURNAROUND_MAX:
+            *value = DRIVE_MODBUS_SAT_U16(drive_modbus_timer_turnaround_max_us());
+            break;
+        case DRIVE_MODBUS_INPUT_REG_SPLIT_ERRORS:
+            *value = DRIVE_MODBUS_SAT_U16(drive_modbus_timer_split_errors());
+            break;
+        case DRIVE_MODBUS_INPUT_REG_GAP_ERRORS:
+            *value = DRIVE_MODBUS_SAT_U16(drive_modbus_timer_gap_errors());
+            break;
+        case DRIVE_MODBUS_INPUT_REG_PT_DMA_FALLBACKS:
+            *value = DRIVE_MODBUS_SAT_U16(drive_triacs_pairs_pulse_train_dma_fallbacks());
+            break;
     }
     return MODBUS_RTU_ERROR_NONE;
 }
@@ -489,6 +809,15 @@ static modbus_rtu_error_t drive_modbus_on_write_coil(uint16_t address, modbus_rt
         case DRIVE_MODBUS_COIL_SELFTUNE:
             drive_selftune();
             break;
+        case DRIVE_MODBUS_COIL_PROF_RESET:
+            if(value){
+                drive_prof_reset();
+                drive_triacs_reset_pairs_pulse_train_dma_fallbacks();
+            }
+            break;
+        case DRIVE_MODBUS_COIL_MODBUS_STAT_RESET:
+            if(value) drive_modbus_timer_reset_stat();
+            break;
     }
     return MODBUS_RTU_ERROR_NONE;
 }
@@ -592,6 +921,53 @@ modbus_rtu_error_t drive_modbus_events_access_get_event(void* tx_data, size_t* t
     return MODBUS_RTU_ERROR_NONE;
 }
 
+modbus_rtu_error_t drive_modbus_events_access_select(const void* rx_data, size_t rx_size, void* tx_data, size_t* tx_size)
+{
+    if(rx_size != 7) return MODBUS_RTU_ERROR_INVALID_DATA;
+    
+    const uint8_t* rx = (const uint8_t*)rx_data;
+    uint8_t* tx = (uint8_t*)tx_data;
+    
+    uint8_t types_mask = rx[1];
+    uint32_t time_from = ((uint32_t)rx[2] << 24) | ((uint32_t)rx[3] << 16) |
+                         ((uint32_t)rx[4] << 8) | (uint32_t)rx[5];
+    size_t skip = (size_t)rx[6];
+    
+    // Буферы выборки вынесены из стека задачи Modbus.
+    static size_t numbers[DRIVE_MODBUS_SELECT_EVENTS_COUNT_MAX];
+    static drive_event_info_t infos[DRIVE_MODBUS_SELECT_EVENTS_COUNT_MAX];
+    size_t total = 0;
+    size_t count = drive_events_select(types_mask, time_from, skip, numbers, infos,
+                                       DRIVE_MODBUS_SELECT_EVENTS_COUNT_MAX, &total);
+    
+    tx[0] = DRIVE_MODBUS_CODE_SELECT_EVENTS;
+    tx[1] = (uint8_t)total;
+    tx[2] = (uint8_t)count;
+    
+    const drive_event_info_t* info = NULL;
+    uint8_t* record = &tx[DRIVE_MODBUS_SELECT_EVENTS_HEADER_SIZE];
+    
+    size_t i;
+    for(i = 0; i < count; i ++){
+        info = &infos[i];
+        
+        record[0] = (uint8_t)numbers[i];
+        record[1] = (uint8_t)info->id;
+        record[2] = info->type;
+        record[3] = (uint8_t)info->osc_index;
+        record[4] = (uint8_t)(info->time >> 24);
+        record[5] = (uint8_t)(info->time >> 16);
+        record[6] = (uint8_t)(info->time >> 8);
+        record[7] = (uint8_t)(info->time & 0xff);
+        
+        record += DRIVE_MODBUS_SELECT_EVENTS_RECORD_SIZE;
+    }
+    
+    *tx_size = DRIVE_MODBUS_SELECT_EVENTS_HEADER_SIZE + count * DRIVE_MODBUS_SELECT_EVENTS_RECORD_SIZE;
+    
+    return MODBUS_RTU_ERROR_NONE;
+}
+
 modbus_rtu_error_t drive_modbus_events_access(const void* rx_data, size_t rx_size, void* tx_data, size_t* tx_size)
 {
     if(rx_size == 0) return MODBUS_RTU_ERROR_INVALID_DATA;
@@ -609,6 +985,8 @@ modbus_rtu_error_t drive_modbus_events_access(const void* rx_data, size_t rx_siz
             return drive_modbus_events_access_status(tx_data, tx_size);
         case DRIVE_MODBUS_CODE_GET_READED_EVENT:
             return drive_modbus_events_access_get_event(tx_data, tx_size);
+        case DRIVE_MODBUS_CODE_SELECT_EVENTS:
+            return drive_modbus_events_access_select(rx_data, rx_size, tx_data, tx_size);
     }
     
     return MODBUS_RTU_ERROR_NONE;
@@ -702,6 +1080,151 @@ modbus_rtu_error_t drive_modbus_osc_access_get_osc(const void* rx_data, size_t r
     return MODBUS_RTU_ERROR_NONE;
 }
 
+/**
+ * Запускает чтение канала осциллограммы в буфер потока.
+ * При невозможности поставить чтение в очередь
+ * буфер остаётся не начатым и чтение повторяется
+ * при следующем запросе блока канала.
+ * @param buf Буфер потока.
+ * @param channel Канал осциллограммы.
+ */
+static void drive_modbus_osc_stream_fetch(drive_modbus_osc_stream_buf_t* buf, size_t channel)
+{
+    buf->channel = channel;
+    
+    future_init(&buf->future);
+    
+    if(channel >= DRIVE_EVENTS_OSC_CHANNELS_COUNT) return;
+    
+    future_start(&buf->future);
+    
+    if(drive_tasks_read_osc_channel_data(&buf->future, drive_modbus.osc_stream.osc_index,
+                                         channel, buf->data) != E_NO_ERROR){
+        future_init(&buf->future);
+    }
+}
+
+/**
+ * Проверяет выполнение чтения в буферы потока.
+ * @return Флаг выполнения чтения.
+ */
+static bool drive_modbus_osc_stream_busy(void)
+{
+    size_t i;
+    for(i = 0; i < DRIVE_MODBUS_OSC_STREAM_BUFFERS; i ++){
+        if(future_running(&drive_modbus.osc_stream.bufs[i].future)) return true;
+    }
+    return false;
+}
+
+modbus_rtu_error_t drive_modbus_osc_access_stream(const void* rx_data, size_t rx_size, void* tx_data, size_t* tx_size)
+{
+    if(rx_size != 2) return MODBUS_RTU_ERROR_INVALID_DATA;
+    
+    size_t index = (size_t)((uint8_t*)rx_data)[1];
+    
+    if(index >= drive_events_oscillograms_count()) return MODBUS_RTU_ERROR_INVALID_DATA;
+    
+    drive_modbus_osc_stream_t* stream = &drive_modbus.osc_stream;
+    uint8_t res = DRIVE_MODBUS_ASYNC_OP_DONE;
+    
+    // Буферы нельзя переиспользовать до завершения чтения в них.
+    if(drive_modbus_osc_stream_busy()){
+        res = DRIVE_MODBUS_ASYNC_OP_RUNNING;
+    }else{
+        stream->active = true;
+        stream->osc_index = drive_events_osc_index_by_number(index);
+        stream->cur = 0;
+        
+        size_t i;
+        for(i = 0; i < DRIVE_MODBUS_OSC_STREAM_BUFFERS; i ++){
+            drive_modbus_osc_stream_fetch(&stream->bufs[i], i);
+        }
+    }
+    
+    ((uint8_t*)tx_data)[0] = DRIVE_MODBUS_CODE_STREAM_OSC;
+    ((uint8_t*)tx_data)[1] = (uint8_t)index;
+    ((uint8_t*)tx_data)[2] = res;
+    ((uint8_t*)tx_data)[3] = (uint8_t)(DRIVE_MODBUS_OSC_STREAM_BLOCKS >> 8);
+    ((uint8_t*)tx_data)[4] = (uint8_t)(DRIVE_MODBUS_OSC_STREAM_BLOCKS & 0xff);
+    *tx_size = 5;
+    
+    return MODBUS_RTU_ERROR_NONE;
+}
+
+modbus_rtu_error_t drive_modbus_osc_access_stream_block(const void* rx_data, size_t rx_size, void* tx_data, size_t* tx_size)
+{
+    if(rx_size != 3) return MODBUS_RTU_ERROR_INVALID_DATA;
+    
+    uint8_t* pseq = (uint8_t*)rx_data + 1;
+    size_t seq = ((size_t)pseq[0] << 8) | pseq[1];
+    
+    drive_modbus_osc_stream_t* stream = &drive_modbus.osc_stream;
+    
+    size_t channel = seq / DRIVE_MODBUS_OSC_STREAM_CHANNEL_BLOCKS;
+    size_t offset = (seq % DRIVE_MODBUS_OSC_STREAM_CHANNEL_BLOCKS) * DRIVE_MODBUS_OSC_STREAM_BLOCK_SIZE;
+    size_t size = 0;
+    uint8_t res = DRIVE_MODBUS_ASYNC_OP_IDLE;
+    
+    drive_modbus_osc_stream_buf_t* cur = &stream->bufs[stream->cur];
+    drive_modbus_osc_stream_buf_t* next = &stream->bufs[stream->cur ^ 1];
+    
+    if(!stream->active || seq >= DRIVE_MODBUS_OSC_STREAM_BLOCKS){
+        stream->active = false;
+    }else{
+        // Запрос следующего канала подтверждает приём текущего,
+        // его буфер используется для чтения канала после следующего.
+        if(channel == next->channel && !future_running(&cur->future)){
+            stream->cur ^= 1;
+            drive_modbus_osc_stream_fetch(cur, channel + 1);
+            cur = next;
+        }
+        
+        if(channel != cur->channel) return MODBUS_RTU_ERROR_INVALID_DATA;
+        
+        if(future_done(&cur->future)){
+            err_t err = pvoid_to_int(err_t, future_result(&cur->future));
+            if(err == E_NO_ERROR){
+                res = DRIVE_MODBUS_ASYNC_OP_DONE;
+                size = MIN(DRIVE_MODBUS_OSC_STREAM_BLOCK_SIZE, DRIVE_POWER_OSC_CHANNEL_SIZE - offset);
+                memcpy(&((uint8_t*)tx_data)[DRIVE_MODBUS_OSC_STREAM_HEADER_SIZE],
+                       (const uint8_t*)cur->data + offset, size);
+            }else{
+                res = DRIVE_MODBUS_ASYNC_OP_ERROR + err;
+                // Повторим чтение при следующем запросе.
+                future_init(&cur->future);
+            }
+        }else{
+            res = DRIVE_MODBUS_ASYNC_OP_RUNNING;
+            if(!future_running(&cur->future)){
+                drive_modbus_osc_stream_fetch(cur, channel);
+            }
+        }
+    }
+    
+    ((uint8_t*)tx_data)[0] = DRIVE_MODBUS_CODE_GET_OSC_STREAM_BLOCK;
+    ((uint8_t*)tx_data)[1] = pseq[0];
+    ((uint8_t*)tx_data)[2] = pseq[1];
+    ((uint8_t*)tx_data)[3] = res;
+    ((uint8_t*)tx_data)[4] = (uint8_t)channel;
+    ((uint8_t*)tx_data)[5] = (uint8_t)size;
+    *tx_size = size + DRIVE_MODBUS_OSC_STREAM_HEADER_SIZE;
+    
+    return MODBUS_RTU_ERROR_NONE;
+}
+
+modbus_rtu_error_t drive_modbus_osc_access_trend_period(void* tx_data, size_t* tx_size)
+{
+    uint32_t period_us = drive_events_readed_osc_trend_period_us();
+    
+    ((uint8_t*)tx_data)[0] = DRIVE_MODBUS_CODE_OSC_TREND_PERIOD;
+    ((uint8_t*)tx_data)[1] = (uint8_t)(period_us >> 8);
+    ((uint8_t*)tx_data)[2] = (uint8_t)period_us;
+    *tx_size = 3;
+    
+    return MODBUS_RTU_ERROR_NONE;
+}
+
 modbus_rtu_error_t drive_modbus_osc_access(const void* rx_data, size_t rx_size, void* tx_data, size_t* tx_size)
 {
     if(rx_size == 0) return MODBUS_RTU_ERROR_INVALID_DATA;
@@ -721,6 +1244,12 @@ modbus_rtu_error_t drive_modbus_osc_access(const void* rx_data, size_t rx_size,
             return drive_modbus_osc_access_status(tx_data, tx_size);
         case DRIVE_MODBUS_CODE_GET_READED_OSC:
             return drive_modbus_osc_access_get_osc(rx_data, rx_size, tx_data, tx_size);
+        case DRIVE_MODBUS_CODE_STREAM_OSC:
+            return drive_modbus_osc_access_stream(rx_data, rx_size, tx_data, tx_size);
+        case DRIVE_MODBUS_CODE_GET_OSC_STREAM_BLOCK:
+            return drive_modbus_osc_access_stream_block(rx_data, rx_size, tx_data, tx_size);
+        case DRIVE_MODBUS_CODE_OSC_TREND_PERIOD:
+            return drive_modbus_osc_access_trend_period(tx_data, tx_size);
     }
     
     return MODBUS_RTU_ERROR_NONE;
@@ -753,20 +1282,46 @@ err_t drive_modbus_init(drive_modbus_init_t* drive_modbus_is)
     return E_NO_ERROR;
 }
 
+//! Обработчики запросов.
+static const drive_modbus_handlers_t drive_modbus_handlers_table = {
+    .read_coil = drive_modbus_on_read_coil,
+    .read_din = drive_modbus_on_read_din,
+    .read_hold_reg = drive_modbus_on_read_hold_reg,
+    .read_inp_reg = drive_modbus_on_read_inp_reg,
+    .write_coil = drive_modbus_on_write_coil,
+    .write_reg = drive_modbus_on_write_reg,
+    .report_slave_id = drive_modbus_on_report_slave_id,
+    .read_file_record = drive_modbus_rtu_read_file_record,
+    .write_file_record = drive_modbus_rtu_write_file_record,
+    .custom_func = drive_modbus_on_custom_func
+};
+
+const drive_modbus_handlers_t* drive_modbus_handlers(void)
+{
+    return &drive_modbus_handlers_table;
+}
+
+void drive_modbus_begin_request(void)
+{
+    drive_modbus.status_latched = false;
+}
+
 err_t drive_modbus_setup(modbus_rtu_t* modbus)
 {
     if(modbus == NULL) return E_NULL_POINTER;
-
-    modbus_rtu_set_read_coil_callback(modbus, drive_modbus_on_read_coil);
-    modbus_rtu_set_read_din_callback(modbus, drive_modbus_on_read_din);
-    modbus_rtu_set_read_holding_reg_callback(modbus, drive_modbus_on_read_hold_reg);
-    modbus_rtu_set_read_input_reg_callback(modbus, drive_modbus_on_read_inp_reg);
-    modbus_rtu_set_write_coil_callback(modbus, drive_modbus_on_write_coil);
-    modbus_rtu_set_write_holding_reg_callback(modbus, drive_modbus_on_write_reg);
-    modbus_rtu_set_report_slave_id_callback(modbus, drive_modbus_on_report_slave_id);
-    modbus_rtu_set_read_file_record_callback(modbus, drive_modbus_rtu_read_file_record);
-    modbus_rtu_set_write_file_record_callback(modbus, drive_modbus_rtu_write_file_record);
-    modbus_rtu_set_custom_function_callback(modbus, drive_modbus_on_custom_func);
+    
+    const drive_modbus_handlers_t* handlers = drive_modbus_handlers();
+    
+    modbus_rtu_set_read_coil_callback(modbus, handlers->read_coil);
+    modbus_rtu_set_read_din_callback(modbus, handlers->read_din);
+    modbus_rtu_set_read_holding_reg_callback(modbus, handlers->read_hold_reg);
+    modbus_rtu_set_read_input_reg_callback(modbus, handlers->read_inp_reg);
+    modbus_rtu_set_write_coil_callback(modbus, handlers->write_coil);
+    modbus_rtu_set_write_holding_reg_callback(modbus, handlers->write_reg);
+    modbus_rtu_set_report_slave_id_callback(modbus, handlers->report_slave_id);
+    modbus_rtu_set_read_file_record_callback(modbus, handlers->read_file_record);
+    modbus_rtu_set_write_file_record_callback(modbus, handlers->write_file_record);
+    modbus_rtu_set_custom_function_callback(modbus, handlers->custom_func);
     
     return E_NO_ERROR;
 }
@@ -14,6 +14,35 @@ typedef void (*apply_settings_callback_t)(void);
 //! Каллбэк сохранения настроек.
 typedef void (*save_settings_callback_t)(void);
 
+/**
+ * Тип обработчиков запросов Modbus привода.
+ * Обработчики не зависят от транспорта и используются
+ * как интерфейсом Modbus RTU, так и Modbus TCP.
+ * Вызовы обработчиков должны быть последовательными.
+ */
+typedef struct _Drive_Modbus_Handlers {
+    //! Чтение регистра флагов.
+    modbus_rtu_error_t (*read_coil)(uint16_t address, modbus_rtu_coil_value_t* value);
+    //! Чтение цифрового входа.
+    modbus_rtu_error_t (*read_din)(uint16_t address, modbus_rtu_din_value_t* value);
+    //! Чтение регистра хранения.
+    modbus_rtu_error_t (*read_hold_reg)(uint16_t address, uint16_t* value);
+    //! Чтение регистра ввода.
+    modbus_rtu_error_t (*read_inp_reg)(uint16_t address, uint16_t* value);
+    //! Запись регистра флагов.
+    modbus_rtu_error_t (*write_coil)(uint16_t address, modbus_rtu_coil_value_t value);
+    //! Запись регистра хранения.
+    modbus_rtu_error_t (*write_reg)(uint16_t address, uint16_t value);
+    //! Получение идентификатора устройства.
+    modbus_rtu_error_t (*report_slave_id)(modbus_rtu_slave_id_t* slave_id);
+    //! Чтение записей файла.
+    modbus_rtu_error_t (*read_file_record)(uint16_t file, uint16_t record, uint16_t count, uint16_t* values);
+    //! Запись записей файла.
+    modbus_rtu_error_t (*write_file_record)(uint16_t file, uint16_t record, uint16_t count, const uint16_t* values);
+    //! Пользовательская функция.
+    modbus_rtu_error_t (*custom_func)(modbus_rtu_func_t func, const void* rx_data, size_t rx_size, void* tx_data, size_t* tx_size);
+} drive_modbus_handlers_t;
+
 typedef struct _Drive_Modbus_Init {
     apply_settings_callback_t apply_settings_callback;
     save_settings_callback_t save_settings_callback;
@@ -25,6 +54,12 @@ typedef struct _Drive_Modbus_Init {
  */
 extern err_t drive_modbus_init(drive_modbus_init_t* drive_modbus_is);
 
+/**
+ * Получает обработчики запросов Modbus привода.
+ * @return Обработчики запросов.
+ */
+extern const drive_modbus_handlers_t* drive_modbus_handlers(void);
+
 /**
  * Настраивает интерфейс modbus на взаимодействие с приводом.
  * @param modbus Интерфейс Modbus.
@@ -32,5 +67,19 @@ extern err_t drive_modbus_init(drive_modbus_init_t* drive_modbus_is);
  */
 extern err_t drive_modbus_setup(modbus_rtu_t* modbus);
 
+/**
+ * Начинает обработку запроса.
+ * Должна вызываться перед разбором каждого кадра,
+ * чтобы регистры быстрого состояния одного запроса
+ * читались из одного снимка.
+ */
+extern void drive_modbus_begin_request(void);
+
+/**
+ * Обновляет снимок регистров быстрого состояния.
+ * Должна вызываться раз в итерацию основного цикла.
+ */
+extern void drive_modbus_update_status(void);
+
 #endif /* DRIVE_MODBUS_H */
 
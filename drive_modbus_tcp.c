@@ -0,0 +1,407 @@
+#include "drive_modbus_tcp.h"
+#include "drive_modbus.h"
+#include "defs/defs.h"
+#include <string.h>
+
+
+//! Идентификатор протокола Modbus в заголовке MBAP.
+#define DRIVE_MODBUS_TCP_PROTOCOL_ID 0
+
+// Смещения полей заголовка MBAP.
+//! Идентификатор транзакции.
+#define DRIVE_MODBUS_TCP_MBAP_TRANSACTION 0
+//! Идентификатор протокола.
+#define DRIVE_MODBUS_TCP_MBAP_PROTOCOL 2
+//! Длина (идентификатор устройства + PDU).
+#define DRIVE_MODBUS_TCP_MBAP_LENGTH 4
+//! Идентификатор устройства.
+#define DRIVE_MODBUS_TCP_MBAP_UNIT 6
+
+// Функции.
+#define DRIVE_MODBUS_TCP_FUNC_READ_COILS 0x01
+#define DRIVE_MODBUS_TCP_FUNC_READ_DINS 0x02
+#define DRIVE_MODBUS_TCP_FUNC_READ_HOLD_REGS 0x03
+#define DRIVE_MODBUS_TCP_FUNC_READ_INP_REGS 0x04
+#define DRIVE_MODBUS_TCP_FUNC_WRITE_COIL 0x05
+#define DRIVE_MODBUS_TCP_FUNC_WRITE_REG 0x06
+#define DRIVE_MODBUS_TCP_FUNC_WRITE_COILS 0x0f
+#define DRIVE_MODBUS_TCP_FUNC_WRITE_REGS 0x10
+#define DRIVE_MODBUS_TCP_FUNC_REPORT_SLAVE_ID 0x11
+//! Флаг исключения в коде функции ответа.
+#define DRIVE_MODBUS_TCP_FUNC_EXCEPTION 0x80
+
+// Коды исключений.
+#define DRIVE_MODBUS_TCP_EXC_ILLEGAL_FUNC 0x01
+#define DRIVE_MODBUS_TCP_EXC_ILLEGAL_ADDRESS 0x02
+#define DRIVE_MODBUS_TCP_EXC_ILLEGAL_VALUE 0x03
+#define DRIVE_MODBUS_TCP_EXC_DEVICE_FAILURE 0x04
+
+// Ограничения числа элементов в запросе.
+//! Максимальное число читаемых битов.
+#define DRIVE_MODBUS_TCP_READ_BITS_MAX 2000
+//! Максимальное число читаемых регистров.
+#define DRIVE_MODBUS_TCP_READ_REGS_MAX 125
+//! Максимальное число записываемых битов.
+#define DRIVE_MODBUS_TCP_WRITE_BITS_MAX 1968
+//! Максимальное число записываемых регистров.
+#define DRIVE_MODBUS_TCP_WRITE_REGS_MAX 123
+
+//! Значение включения флага.
+#define DRIVE_MODBUS_TCP_COIL_ON 0xff00
+//! Значение выключения флага.
+#define DRIVE_MODBUS_TCP_COIL_OFF 0x0000
+//! Значение состояния работы в ответе идентификатора устройства.
+#define DRIVE_MODBUS_TCP_RUN_STATUS_ON 0xff
+
+
+ALWAYS_INLINE static uint16_t drive_modbus_tcp_get_u16(const uint8_t* data)
+{
+    return ((uint16_t)data[0] << 8) | data[1];
+}
+
+ALWAYS_INLINE static void drive_modbus_tcp_put_u16(uint8_t* data, uint16_t value)
+{
+    data[0] = (uint8_t)(value >> 8);
+    data[1] = (uint8_t)(value & 0xff);
+}
+
+/**
+ * Получает код исключения по ошибке обработчика.
+ * @param err Ошибка обработчика.
+ * @return Код исключения.
+ */
+static uint8_t drive_modbus_tcp_exception(modbus_rtu_error_t err)
+{
+    switch(err){
+        case MODBUS_RTU_ERROR_FUNC:
+        case MODBUS_RTU_ERROR_INVALID_FUNC:
+            return DRIVE_MODBUS_TCP_EXC_ILLEGAL_FUNC;
+        case MODBUS_RTU_ERROR_INVALID_ADDRESS:
+            return DRIVE_MODBUS_TCP_EXC_ILLEGAL_ADDRESS;
+        case MODBUS_RTU_ERROR_INVALID_DATA:
+            return DRIVE_MODBUS_TCP_EXC_ILLEGAL_VALUE;
+        default:
+            break;
+    }
+    return DRIVE_MODBUS_TCP_EXC_DEVICE_FAILURE;
+}
+
+/**
+ * Читает биты (флаги или цифровые входы).
+ * @return Код исключения, 0 при успехе.
+ */
+static uint8_t drive_modbus_tcp_read_bits(uint8_t func, const uint8_t* req, size_t req_size, uint8_t* resp, size_t* resp_size)
+{
+    if(req_size != 5) return DRIVE_MODBUS_TCP_EXC_ILLEGAL_VALUE;
+    
+    const drive_modbus_handlers_t* handlers = drive_modbus_handlers();
+    
+    uint16_t address = drive_modbus_tcp_get_u16(&req[1]);
+    uint16_t count = drive_modbus_tcp_get_u16(&req[3]);
+    
+    if(count == 0 || count > DRIVE_MODBUS_TCP_READ_BITS_MAX) return DRIVE_MODBUS_TCP_EXC_ILLEGAL_VALUE;
+    
+    size_t bytes = (count + 7) / 8;
+    memset(&resp[2], 0x0, bytes);
+    
+    modbus_rtu_error_t err = MODBUS_RTU_ERROR_NONE;
+    modbus_rtu_coil_value_t coil;
+    modbus_rtu_din_value_t din;
+    bool bit;
+    
+    uint16_t i;
+    for(i = 0; i < count; i ++){
+        if(func == DRIVE_MODBUS_TCP_FUNC_READ_COILS){
+            err = handlers->read_coil(address + i, &coil);
+            bit = (coil == MODBUS_RTU_COIL_ON);
+        }else{
+            err = handlers->read_din(address + i, &din);
+            bit = (din != 0);
+        }
+        if(err != MODBUS_RTU_ERROR_NONE) return drive_modbus_tcp_exception(err);
+        
+        if(bit) resp[2 + i / 8] |= 1 << (i % 8);
+    }
+    
+    resp[1] = (uint8_t)bytes;
+    *resp_size = 2 + bytes;
+    
+    return 0;
+}
+
+/**
+ * Читает регистры хранения или ввода.
+ * @return Код исключения, 0 при успехе.
+ */
+static uint8_t drive_modbus_tcp_read_regs(uint8_t func, const uint8_t* req, size_t req_size, uint8_t* resp, size_t* resp_size)
+{
+    if(req_size != 5) return DRIVE_MODBUS_TCP_EXC_ILLEGAL_VALUE;
+    
+    const drive_modbus_handlers_t* handlers = drive_modbus_handlers();
+    
+    uint16_t address = drive_modbus_tcp_get_u16(&req[1]);
+    uint16_t count = drive_modbus_tcp_get_u16(&req[3]);
+    
+    if(count == 0 || count > DRIVE_MODBUS_TCP_READ_REGS_MAX) return DRIVE_MODBUS_TCP_EXC_ILLEGAL_VALUE;
+    
+    modbus_rtu_error_t err = MODBUS_RTU_ERROR_NONE;
+    uint16_t value = 0;
+    
+    uint16_t i;
+    for(i = 0; i < count; i ++){
+        if(func == DRIVE_MODBUS_TCP_FUNC_READ_HOLD_REGS){
+            err = handlers->read_hold_reg(address + i, &value);
+        }else{
+            err = handlers->read_inp_reg(address + i, &value);
+        }
+        if(err != MODBUS_RTU_ERROR_NONE) return drive_modbus_tcp_exception(err);
+        
+        drive_modbus_tcp_put_u16(&resp[2 + i * 2], value);
+    }
+    
+    resp[1] = (uint8_t)(count * 2);
+    *resp_size = 2 + count * 2;
+    
+    return 0;
+}
+
+/**
+ * Записывает флаг.
+ * @return Код исключения, 0 при успехе.
+ */
+static uint8_t drive_modbus_tcp_write_coil(const uint8_t* req, size_t req_size, uint8_t* resp, size_t* resp_size)
+{
+    if(req_size != 5) return DRIVE_MODBUS_TCP_EXC_ILLEGAL_VALUE;
+    
+    uint16_t address = drive_modbus_tcp_get_u16(&req[1]);
+    uint16_t value = drive_modbus_tcp_get_u16(&req[3]);
+    
+    if(value != DRIVE_MODBUS_TCP_COIL_ON && value != DRIVE_MODBUS_TCP_COIL_OFF){
+        return DRIVE_MODBUS_TCP_EXC_ILLEGAL_VALUE;
+    }
+    
+    modbus_rtu_error_t err = drive_modbus_handlers()->write_coil(address,
+                                    (value == DRIVE_MODBUS_TCP_COIL_ON) ? MODBUS_RTU_COIL_ON : MODBUS_RTU_COIL_OFF);
+    if(err != MODBUS_RTU_ERROR_NONE) return drive_modbus_tcp_exception(err);
+    
+    // Ответ повторяет запрос.
+    memcpy(&resp[1], &req[1], 4);
+    *resp_size = 5;
+    
+    return 0;
+}
+
+/**
+ * Записывает регистр хранения.
+ * @return Код исключения, 0 при успехе.
+ */
+static uint8_t drive_modbus_tcp_write_reg(const uint8_t* req, size_t req_size, uint8_t* resp, size_t* resp_size)
+{
+    if(req_size != 5) return DRIVE_MODBUS_TCP_EXC_ILLEGAL_VALUE;
+    
+    uint16_t address = drive_modbus_tcp_get_u16(&req[1]);
+    uint16_t value = drive_modbus_tcp_get_u16(&req[3]);
+    
+    modbus_rtu_error_t err = drive_modbus_handlers()->write_reg(address, value);
+    if(err != MODBUS_RTU_ERROR_NONE) return drive_modbus_tcp_exception(err);
+    
+    // Ответ повторяет запрос.
+    memcpy(&resp[1], &req[1], 4);
+    *resp_size = 5;
+    
+    return 0;
+}
+
+/**
+ * Записывает несколько флагов.
+ * @return Код исключения, 0 при успехе.
+ */
+static uint8_t drive_modbus_tcp_write_coils(const uint8_t* req, size_t req_size, uint8_t* resp, size_t* resp_size)
+{
+    if(req_size < 6) return DRIVE_MODBUS_TCP_EXC_ILLEGAL_VALUE;
+    
+    uint16_t address = drive_modbus_tcp_get_u16(&req[1]);
+    uint16_t count = drive_modbus_tcp_get_u16(&req[3]);
+    size_t bytes = req[5];
+    
+    if(count == 0 || count > DRIVE_MODBUS_TCP_WRITE_BITS_MAX) return DRIVE_MODBUS_TCP_EXC_ILLEGAL_VALUE;
+    if(bytes != (size_t)((count + 7) / 8) || req_size != 6 + bytes) return DRIVE_MODBUS_TCP_EXC_ILLEGAL_VALUE;
+    
+    const drive_modbus_handlers_t* handlers = drive_modbus_handlers();
+    modbus_rtu_error_t err = MODBUS_RTU_ERROR_NONE;
+    
+    uint16_t i;
+    for(i = 0; i < count; i ++){
+        err = handlers->write_coil(address + i,
+                    ((req[6 + i / 8] >> (i % 8)) & 0x1) ? MODBUS_RTU_COIL_ON : MODBUS_RTU_COIL_OFF);
+        if(err != MODBUS_RTU_ERROR_NONE) return drive_modbus_tcp_exception(err);
+    }
+    
+    memcpy(&resp[1], &req[1], 4);
+    *resp_size = 5;
+    
+    return 0;
+}
+
+/**
+ * Записывает несколько регистров хранения.
+ * @return Код исключения, 0 при успехе.
+ */
+static uint8_t drive_modbus_tcp_write_regs(const uint8_t* req, size_t req_size, uint8_t* resp, size_t* resp_size)
+{
+    if(req_size < 6) return DRIVE_MODBUS_TCP_EXC_ILLEGAL_VALUE;
+    
+    uint16_t address = drive_modbus_tcp_get_u16(&req[1]);
+    uint16_t count = drive_modbus_tcp_get_u16(&req[3]);
+    size_t bytes = req[5];
+    
+    if(count == 0 || count > DRIVE_MODBUS_TCP_WRITE_REGS_MAX) return DRIVE_MODBUS_TCP_EXC_ILLEGAL_VALUE;
+    if(bytes != (size_t)count * 2 || req_size != 6 + bytes) return DRIVE_MODBUS_TCP_EXC_ILLEGAL_VALUE;
+    
+    const drive_modbus_handlers_t* handlers = drive_modbus_handlers();
+    modbus_rtu_error_t err = MODBUS_RTU_ERROR_NONE;
+    
+    uint16_t i;
+    for(i = 0; i < count; i ++){
+        err = handlers->write_reg(address + i, drive_modbus_tcp_get_u16(&req[6 + i * 2]));
+        if(err != MODBUS_RTU_ERROR_NONE) return drive_modbus_tcp_exception(err);
+    }
+    
+    memcpy(&resp[1], &req[1], 4);
+    *resp_size = 5;
+    
+    return 0;
+}
+
+/**
+ * Получает идентификатор устройства.
+ * @return Код исключения, 0 при успехе.
+ */
+static uint8_t drive_modbus_tcp_report_slave_id(size_t req_size, uint8_t* resp, size_t* resp_size)
+{
+    if(req_size != 1) return DRIVE_MODBUS_TCP_EXC_ILLEGAL_VALUE;
+    
+    modbus_rtu_slave_id_t slave_id;
+    memset(&slave_id, 0x0, sizeof(modbus_rtu_slave_id_t));
+    
+    modbus_rtu_error_t err = drive_modbus_handlers()->report_slave_id(&slave_id);
+    if(err != MODBUS_RTU_ERROR_NONE) return drive_modbus_tcp_exception(err);
+    
+    if(3 + slave_id.data_size > DRIVE_MODBUS_TCP_PDU_SIZE_MAX) return DRIVE_MODBUS_TCP_EXC_DEVICE_FAILURE;
+    
+    resp[1] = (uint8_t)(2 + slave_id.data_size);
+    resp[2] = (uint8_t)slave_id.id;
+    resp[3] = (slave_id.status == MODBUS_RTU_RUN_STATUS_ON) ? DRIVE_MODBUS_TCP_RUN_STATUS_ON : 0;
+    if(slave_id.data_size) memcpy(&resp[4], slave_id.data, slave_id.data_size);
+    *resp_size = 4 + slave_id.data_size;
+    
+    return 0;
+}
+
+/**
+ * Выполняет пользовательскую функцию.
+ * @return Код исключения, 0 при успехе.
+ */
+static uint8_t drive_modbus_tcp_custom_func(uint8_t func, const uint8_t* req, size_t req_size, uint8_t* resp, size_t* resp_size)
+{
+    // Обработчики рассчитаны на буфер ответа размером MODBUS_RTU_DATA_SIZE_MAX.
+    uint8_t tx_data[MODBUS_RTU_DATA_SIZE_MAX];
+    size_t tx_size = 0;
+    
+    modbus_rtu_error_t err = drive_modbus_handlers()->custom_func((modbus_rtu_func_t)func,
+                                    &req[1], req_size - 1, tx_data, &tx_size);
+    if(err != MODBUS_RTU_ERROR_NONE) return drive_modbus_tcp_exception(err);
+    
+    if(1 + tx_size > DRIVE_MODBUS_TCP_PDU_SIZE_MAX) return DRIVE_MODBUS_TCP_EXC_DEVICE_FAILURE;
+    
+    memcpy(&resp[1], tx_data, tx_size);
+    *resp_size = 1 + tx_size;
+    
+    return 0;
+}
+
+/**
+ * Обрабатывает PDU запроса.
+ * @param req PDU запроса.
+ * @param req_size Размер PDU запроса.
+ * @param resp Буфер PDU ответа размером DRIVE_MODBUS_TCP_PDU_SIZE_MAX.
+ * @param resp_size Размер PDU ответа.
+ */
+static void drive_modbus_tcp_process_pdu(const uint8_t* req, size_t req_size, uint8_t* resp, size_t* resp_size)
+{
+    uint8_t func = req[0];
+    uint8_t exc = 0;
+    
+    resp[0] = func;
+    
+    switch(func){
+        case DRIVE_MODBUS_TCP_FUNC_READ_COILS:
+        case DRIVE_MODBUS_TCP_FUNC_READ_DINS:
+            exc = drive_modbus_tcp_read_bits(func, req, req_size, resp, resp_size);
+            break;
+        case DRIVE_MODBUS_TCP_FUNC_READ_HOLD_REGS:
+        case DRIVE_MODBUS_TCP_FUNC_READ_INP_REGS:
+            exc = drive_modbus_tcp_read_regs(func, req, req_size, resp, resp_size);
+            break;
+        case DRIVE_MODBUS_TCP_FUNC_WRITE_COIL:
+            exc = drive_modbus_tcp_write_coil(req, req_size, resp, resp_size);
+            break;
+        case DRIVE_MODBUS_TCP_FUNC_WRITE_REG:
+            exc = drive_modbus_tcp_write_reg(req, req_size, resp, resp_size);
+            break;
+        case DRIVE_MODBUS_TCP_FUNC_WRITE_COILS:
+            exc = drive_modbus_tcp_write_coils(req, req_size, resp, resp_size);
+            break;
+        case DRIVE_MODBUS_TCP_FUNC_WRITE_REGS:
+            exc = drive_modbus_tcp_write_regs(req, req_size, resp, resp_size);
+            break;
+        case DRIVE_MODBUS_TCP_FUNC_REPORT_SLAVE_ID:
+            exc = drive_modbus_tcp_report_slave_id(req_size, resp, resp_size);
+            break;
+        default:
+            // Коды исключений в функциях не используются.
+            if(func & DRIVE_MODBUS_TCP_FUNC_EXCEPTION){
+                exc = DRIVE_MODBUS_TCP_EXC_ILLEGAL_FUNC;
+            }else{
+                exc = drive_modbus_tcp_custom_func(func, req, req_size, resp, resp_size);
+            }
+            break;
+    }
+    
+    if(exc != 0){
+        resp[0] = func | DRIVE_MODBUS_TCP_FUNC_EXCEPTION;
+        resp[1] = exc;
+        *resp_size = 2;
+    }
+}
+
+size_t drive_modbus_tcp_adu_size(const uint8_t* data, size_t size)
+{
+    if(data == NULL || size < DRIVE_MODBUS_TCP_MBAP_SIZE) return 0;
+    
+    // Поле длины включает идентификатор устройства.
+    return DRIVE_MODBUS_TCP_MBAP_UNIT + drive_modbus_tcp_get_u16(&data[DRIVE_MODBUS_TCP_MBAP_LENGTH]);
+}
+
+err_t drive_modbus_tcp_process(const uint8_t* rx_adu, size_t rx_size, uint8_t* tx_adu, size_t* tx_size)
+{
+    if(rx_adu == NULL || tx_adu == NULL || tx_size == NULL) return E_NULL_POINTER;
+    if(rx_size <= DRIVE_MODBUS_TCP_MBAP_SIZE || rx_size > DRIVE_MODBUS_TCP_ADU_SIZE_MAX) return E_INVALID_VALUE;
+    if(drive_modbus_tcp_get_u16(&rx_adu[DRIVE_MODBUS_TCP_MBAP_PROTOCOL]) != DRIVE_MODBUS_TCP_PROTOCOL_ID) return E_INVALID_VALUE;
+    if(drive_modbus_tcp_adu_size(rx_adu, rx_size) != rx_size) return E_INVALID_VALUE;
+    
+    size_t pdu_size = 0;
+    
+    drive_modbus_begin_request();
+    
+    drive_modbus_tcp_process_pdu(&rx_adu[DRIVE_MODBUS_TCP_MBAP_SIZE], rx_size - DRIVE_MODBUS_TCP_MBAP_SIZE,
+                                 &tx_adu[DRIVE_MODBUS_TCP_MBAP_SIZE], &pdu_size);
+    
+    // Заголовок ответа повторяет заголовок запроса, кроме длины.
+    memcpy(tx_adu, rx_adu, DRIVE_MODBUS_TCP_MBAP_SIZE);
+    drive_modbus_tcp_put_u16(&tx_adu[DRIVE_MODBUS_TCP_MBAP_LENGTH], (uint16_t)(1 + pdu_size));
+    
+    *tx_size = DRIVE_MODBUS_TCP_MBAP_SIZE + pdu_size;
+    
+    return E_NO_ERROR;
+}
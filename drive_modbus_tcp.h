@@ -0,0 +1,47 @@
+/**
+ * @file drive_modbus_tcp.h Обработка кадров Modbus TCP привода.
+ * Кадры разбираются поверх обработчиков запросов drive_modbus
+ * и не зависят от способа передачи: приём и отправка
+ * данных соединений выполняются вызывающей стороной.
+ * Запросы разных соединений должны обрабатываться последовательно.
+ */
+
+#ifndef DRIVE_MODBUS_TCP_H
+#define DRIVE_MODBUS_TCP_H
+
+#include "errors/errors.h"
+#include <stdint.h>
+#include <stddef.h>
+
+
+//! Размер заголовка MBAP.
+#define DRIVE_MODBUS_TCP_MBAP_SIZE 7
+//! Максимальный размер PDU.
+#define DRIVE_MODBUS_TCP_PDU_SIZE_MAX 253
+//! Максимальный размер кадра (ADU).
+#define DRIVE_MODBUS_TCP_ADU_SIZE_MAX (DRIVE_MODBUS_TCP_MBAP_SIZE + DRIVE_MODBUS_TCP_PDU_SIZE_MAX)
+//! Стандартный порт Modbus TCP.
+#define DRIVE_MODBUS_TCP_PORT 502
+
+
+/**
+ * Получает полный размер кадра по заголовку MBAP.
+ * Используется для выделения кадров из потока данных соединения.
+ * @param data Принятые данные.
+ * @param size Размер принятых данных.
+ * @return Размер кадра, 0 если заголовок принят не полностью.
+ */
+extern size_t drive_modbus_tcp_adu_size(const uint8_t* data, size_t size);
+
+/**
+ * Обрабатывает кадр Modbus TCP.
+ * @param rx_adu Кадр запроса.
+ * @param rx_size Размер кадра запроса.
+ * @param tx_adu Буфер кадра ответа размером DRIVE_MODBUS_TCP_ADU_SIZE_MAX.
+ * @param tx_size Размер кадра ответа.
+ * @return Код ошибки, при ошибке ответ не отправляется,
+ * а соединение следует закрыть.
+ */
+extern err_t drive_modbus_tcp_process(const uint8_t* rx_adu, size_t rx_size, uint8_t* tx_adu, size_t* tx_size);
+
+#endif /* DRIVE_MODBUS_TCP_H */
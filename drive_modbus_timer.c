@@ -0,0 +1,176 @@
+#include "drive_modbus_timer.h"
+#include "drive_hires_timer.h"
+#include <stddef.h>
+#include <string.h>
+
+
+//! Тип структуры таймера Modbus.
+typedef struct _Drive_Modbus_Timer {
+    TIM_TypeDef* timer; //!< Периферия таймера.
+    drive_modbus_timer_callback_t frame_callback; //!< Каллбэк готовности кадра.
+    uint32_t char_us; //!< Время передачи символа, мкс.
+    uint32_t t15_us; //!< Интервал t1.5, мкс.
+    uint32_t t35_us; //!< Интервал t3.5, мкс.
+    uint32_t frame_end_cycles; //!< Такты ядра на момент обнаружения конца кадра.
+    bool frame_pending; //!< Флаг ожидания окончания интервала t3.5.
+    bool response_pending; //!< Флаг ожидания окончания передачи ответа.
+    uint32_t turnaround_us; //!< Время оборота последнего запроса.
+    uint32_t turnaround_max_us; //!< Максимальное время оборота запроса.
+    uint32_t split_errors; //!< Число разорванных кадров.
+    uint32_t gap_errors; //!< Число нарушений межкадрового интервала.
+} drive_modbus_timer_t;
+
+//! Таймер Modbus.
+static drive_modbus_timer_t modbus_timer;
+
+
+
+static void init_timer_priph(TIM_TypeDef* TIM, uint32_t delay_us)
+{
+    TIM->CR1 = TIM_CR1_OPM | TIM_CR1_URS;
+    TIM->CR2 = 0;
+    TIM->DIER = 0;
+    TIM->PSC = DRIVE_MODBUS_TIMER_PRESCALER - 1;
+    TIM->ARR = delay_us - 1;
+    TIM->CNT = 0;
+    // Загрузим предделитель.
+    TIM->EGR = TIM_EGR_UG;
+    TIM->SR  = 0;
+    TIM->DIER = TIM_DIER_UIE;
+}
+
+/**
+ * Получает время, прошедшее с обнаружения конца кадра.
+ * @return Время, мкс.
+ */
+static uint32_t drive_modbus_timer_elapsed_us(void)
+{
+    uint32_t cycles = drive_hires_timer_cycles() - modbus_timer.frame_end_cycles;
+    
+    return cycles / drive_hires_timer_cycles_per_us();
+}
+
+
+err_t drive_modbus_timer_init(drive_modbus_timer_init_t* timer_is)
+{
+    if(timer_is == NULL) return E_NULL_POINTER;
+    if(timer_is->timer == NULL) return E_NULL_POINTER;
+    if(timer_is->baud == 0) return E_INVALID_VALUE;
+    
+    uint32_t char_bits_us = DRIVE_MODBUS_TIMER_CHAR_BITS * 1000000;
+    
+    // Интервалы с округлением вверх.
+    uint32_t char_us = (char_bits_us + timer_is->baud - 1) / timer_is->baud;
+    uint32_t t15_us = (char_bits_us * 3 + timer_is->baud * 2 - 1) / (timer_is->baud * 2);
+    uint32_t t35_us = (char_bits_us * 7 + timer_is->baud * 2 - 1) / (timer_is->baud * 2);
+    
+    // Простой линии обнаруживается через символ после конца кадра,
+    // таймер отсчитывает оставшуюся часть интервала t3.5.
+    uint32_t delay_us = t35_us - char_us;
+    if(delay_us < DRIVE_MODBUS_TIMER_DELAY_MIN_US) delay_us = DRIVE_MODBUS_TIMER_DELAY_MIN_US;
+    if(delay_us > DRIVE_MODBUS_TIMER_DELAY_MAX_US) return E_OUT_OF_RANGE;
+    
+    memset(&modbus_timer, 0x0, sizeof(drive_modbus_timer_t));
+    
+    modbus_timer.timer = timer_is->timer;
+    modbus_timer.frame_callback = timer_is->frame_callback;
+    modbus_timer.char_us = char_us;
+    modbus_timer.t15_us = t15_us;
+    modbus_timer.t35_us = t35_us;
+    
+    init_timer_priph(modbus_timer.timer, delay_us);
+    
+    return E_NO_ERROR;
+}
+
+uint32_t drive_modbus_timer_char_us(void)
+{
+    return modbus_timer.char_us;
+}
+
+uint32_t drive_modbus_timer_t15_us(void)
+{
+    return modbus_timer.t15_us;
+}
+
+uint32_t drive_modbus_timer_t35_us(void)
+{
+    return modbus_timer.t35_us;
+}
+
+void drive_modbus_timer_frame_end(void)
+{
+    modbus_timer.frame_end_cycles = drive_hires_timer_cycles();
+    modbus_timer.frame_pending = true;
+    modbus_timer.response_pending = true;
+    
+    modbus_timer.timer->CNT = 0;
+    modbus_timer.timer->CR1 |= TIM_CR1_CEN;
+}
+
+void drive_modbus_timer_byte_received(void)
+{
+    if(!modbus_timer.frame_pending) return;
+    
+    // Пауза между концом кадра и началом байта
+    // равна времени с момента обнаружения простоя линии.
+    if(drive_modbus_timer_elapsed_us() < modbus_timer.t15_us){
+        modbus_timer.split_errors ++;
+    }else{
+        modbus_timer.gap_errors ++;
+    }
+}
+
+void drive_modbus_timer_response_sent(void)
+{
+    if(!modbus_timer.response_pending) return;
+    
+    modbus_timer.response_pending = false;
+    
+    uint32_t turnaround_us = drive_modbus_timer_elapsed_us() + modbus_timer.char_us;
+    
+    modbus_timer.turnaround_us = turnaround_us;
+    
+    if(turnaround_us > modbus_timer.turnaround_max_us){
+        modbus_timer.turnaround_max_us = turnaround_us;
+    }
+}
+
+void drive_modbus_timer_irq_handler(void)
+{
+    if(modbus_timer.timer->SR & TIM_SR_UIF){
+        modbus_timer.timer->SR = ~TIM_SR_UIF;
+        
+        modbus_timer.frame_pending = false;
+        
+        if(modbus_timer.frame_callback) modbus_timer.frame_callback();
+    }
+}
+
+uint32_t drive_modbus_timer_turnaround_us(void)
+{
+    return modbus_timer.turnaround_us;
+}
+
+uint32_t drive_modbus_timer_turnaround_max_us(void)
+{
+    return modbus_timer.turnaround_max_us;
+}
+
+uint32_t drive_modbus_timer_split_errors(void)
+{
+    return modbus_timer.split_errors;
+}
+
+uint32_t drive_modbus_timer_gap_errors(void)
+{
+    return modbus_timer.gap_errors;
+}
+
+void drive_modbus_timer_reset_stat(void)
+{
+    modbus_timer.turnaround_us = 0;
+    modbus_timer.turnaround_max_us = 0;
+    modbus_timer.split_errors = 0;
+    modbus_timer.gap_errors = 0;
+}
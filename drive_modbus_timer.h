@@ -0,0 +1,123 @@
+/**
+ * @file drive_modbus_timer.h Библиотека таймера межкадровых интервалов Modbus RTU.
+ * Конец кадра определяется по простою линии USART (один символ),
+ * оставшаяся до t3.5 часть интервала отсчитывается аппаратным таймером,
+ * после чего кадр передаётся на обработку.
+ * Интервалы t1.5 и t3.5 вычисляются из скорости обмена.
+ */
+
+#ifndef DRIVE_MODBUS_TIMER_H
+#define DRIVE_MODBUS_TIMER_H
+
+#include "errors/errors.h"
+#include <stm32f10x.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+
+// Параметры таймера.
+//! Предделитель таймера (1 тик = 1 мкс).
+#define DRIVE_MODBUS_TIMER_PRESCALER 72
+//! Число бит в символе Modbus RTU (старт, 8 бит данных, чётность или стоп, стоп).
+#define DRIVE_MODBUS_TIMER_CHAR_BITS 11
+//! Минимальный интервал таймера, мкс.
+#define DRIVE_MODBUS_TIMER_DELAY_MIN_US 2
+//! Максимальный интервал таймера (16-битный ARR), мкс.
+#define DRIVE_MODBUS_TIMER_DELAY_MAX_US 0x10000
+
+
+//! Тип каллбэка готовности кадра.
+typedef void (*drive_modbus_timer_callback_t)(void);
+
+//! Тип структуры инициализации таймера Modbus.
+typedef struct _Drive_Modbus_Timer_Init {
+    TIM_TypeDef* timer; //!< Периферия таймера.
+    uint32_t baud; //!< Скорость обмена, бит/с.
+    drive_modbus_timer_callback_t frame_callback; //!< Каллбэк готовности кадра, вызывается из прерывания.
+} drive_modbus_timer_init_t;
+
+
+/**
+ * Инициализирует таймер межкадровых интервалов Modbus.
+ * Скорость, при которой интервал t3.5 не помещается
+ * в таймер, отвергается с ошибкой E_OUT_OF_RANGE.
+ * @param timer_is Структура инициализации.
+ * @return Код ошибки.
+ */
+extern err_t drive_modbus_timer_init(drive_modbus_timer_init_t* timer_is);
+
+/**
+ * Получает время передачи символа.
+ * @return Время передачи символа, мкс.
+ */
+extern uint32_t drive_modbus_timer_char_us(void);
+
+/**
+ * Получает интервал t1.5.
+ * @return Интервал t1.5, мкс.
+ */
+extern uint32_t drive_modbus_timer_t15_us(void);
+
+/**
+ * Получает интервал t3.5.
+ * @return Интервал t3.5, мкс.
+ */
+extern uint32_t drive_modbus_timer_t35_us(void);
+
+/**
+ * Обрабатывает окончание приёма кадра
+ * по простою линии.
+ * Вызывается из прерывания.
+ */
+extern void drive_modbus_timer_frame_end(void);
+
+/**
+ * Обрабатывает приём байта.
+ * Вызывается из прерывания.
+ */
+extern void drive_modbus_timer_byte_received(void);
+
+/**
+ * Обрабатывает окончание передачи ответа.
+ * Вызывается из прерывания.
+ */
+extern void drive_modbus_timer_response_sent(void);
+
+/**
+ * Обработчик прерывания таймера.
+ */
+extern void drive_modbus_timer_irq_handler(void);
+
+/**
+ * Получает время оборота последнего запроса:
+ * от конца запроса до конца передачи ответа.
+ * @return Время оборота, мкс.
+ */
+extern uint32_t drive_modbus_timer_turnaround_us(void);
+
+/**
+ * Получает максимальное время оборота запроса.
+ * @return Максимальное время оборота, мкс.
+ */
+extern uint32_t drive_modbus_timer_turnaround_max_us(void);
+
+/**
+ * Получает число кадров, разорванных
+ * паузой между символами больше t1.5.
+ * @return Число разорванных кадров.
+ */
+extern uint32_t drive_modbus_timer_split_errors(void);
+
+/**
+ * Получает число кадров, следующих
+ * с паузой меньше t3.5.
+ * @return Число нарушений межкадрового интервала.
+ */
+extern uint32_t drive_modbus_timer_gap_errors(void);
+
+/**
+ * Сбрасывает статистику.
+ */
+extern void drive_modbus_timer_reset_stat(void);
+
+#endif /* DRIVE_MODBUS_TIMER_H */
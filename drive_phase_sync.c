@@ -1,8 +1,5 @@
 #include "drive_phase_sync.h"
 #include "stm32f10x.h"
-#include <arm_math.h>
-#include <arm_const_structs.h>
-#include <stdlib.h>
 #include <string.h>
 #include "defs/defs.h"
 #include "utils/critical.h"
@@ -10,37 +7,26 @@
 #include "cordic/cordic32.h"
 #include "pid_controller/pid_controller.h"
 #include "drive_power.h"
+#include "phase_sync_filter.h"
 #include "settings.h"
 
 
 
-//! Размер FFT.
-#define FFT_SIZE 32
-#define FFT_SIZE2 (FFT_SIZE * 2)
+//! Размер окна скользящего ДПФ (число отсчётов за период).
+#define SDFT_SIZE 32
 
-//! Флаг реверса бит FFT.
-#define FFT_BIT_REVERSE 1
+//! Маска индекса в окне скользящего ДПФ.
+#define SDFT_INDEX_MASK (SDFT_SIZE - 1)
 
-//! Число буферов FFT.
-#define FFT_BUFFERS_COUNT 2
+//! Сдвиг индекса синуса относительно косинуса в таблице (четверть периода).
+#define SDFT_SIN_OFFSET (SDFT_SIZE - SDFT_SIZE / 4)
 
-//! Индекс действительной части первой гармоники.
-#define FFT_BUFFER_FIRST_VALUE_REAL 2
-
-//! Индекс мнимой части первой гармоники.
-#define FFT_BUFFER_FIRST_VALUE_IMAG 3
+//! Угол между соседними отсчётами окна.
+#define SDFT_SAMPLE_ANGLE (CORDIC32_ANGLE_360 / SDFT_SIZE)
 
 //! Максимальное значение счётчика пропусков значений АЦП.
-#define FFT_ADC_PRESCALER (POWER_ADC_FREQ / POWER_FREQ / FFT_SIZE)
-
-//! Размер фильтра FFT.
-#define FFT_FILTER_SIZE 7
-
-//! Отбрасывать минимальных значений фильтра.
-#define FFT_FILTER_SKIP_MIN 2
-
-//! Отбрасывать максимальных значений фильтра.
-#define FFT_FILTER_SKIP_MAX 2
+//! Частота АЦП следует за частотой сети, число измерений за период постоянно.
+#define SDFT_ADC_PRESCALER (POWER_ADC_MEASUREMENTS_PER_PERIOD / SDFT_SIZE)
 
 //! Время регулирования ФАПЧ.
 #define PLL_PID_DT 0x1b5//0x51f
@@ -48,11 +34,11 @@
 //! Максимальный угол регулирования ФАПЧ в обе стороны.
 #define PLL_PID_MAX_ANGLE 0xAA0000 // 170
 
-//! Число микросекунд в электрическом градусе.
+//! Число микросекунд в электрическом градусе при номинальной частоте сети.
 #define US_PER_DEGREE (0x378E38) // 55.(5)
 
 //! Преобразование агла в микросекунды.
-#define ANGLE_TO_US(A) (fixed32_mul((int64_t)(A), US_PER_DEGREE))
+#define ANGLE_TO_US(A) (fixed32_mul((int64_t)(A), phase_sync.us_per_degree))
 
 //! Угол в 120 градусов.
 #define ANGLE_120 (0x780000)
@@ -60,60 +46,74 @@
 //! Угол в 240 градусов.
 #define ANGLE_240 (0xF00000)
 
-//! Тип числа FFT.
-typedef int16_t fft_int_t;
-
-//! Тип индекса в буфере данных FFT.
-typedef uint8_t fft_buffer_index_t;
-
-
-//! Структура буфера исходных FFT.
-typedef struct _Phase_Sync_Fft_Buffer {
-    fft_int_t data[FFT_SIZE2]; //!< Данные буфера исходных данных FFT.
-} phase_sync_fft_buffer_t;
-
-//! Структура буферов FFT.
-typedef struct _Phase_Sync_Fft_Buffers {
-    phase_sync_fft_buffer_t buffer_a; //!< Буфер фазы A.
-    phase_sync_fft_buffer_t buffer_b; //!< Буфер фазы B.
-    phase_sync_fft_buffer_t buffer_c; //!< Буфер фазы C.
-    fft_buffer_index_t index; //!< Индекс в данных буфера FFT.
-    fixed32_t first_angle; //!< Угол первой точки буфера.
-} phase_sync_fft_buffers_t;
-
-/*
-//! Структура значения фильтра FFT.
-typedef struct _Phase_Sync_Fft_Filter_Value {
-    int16_t x;
-    int16_t y;
-} phase_sync_fft_filter_value_t;
-
-//! Структура фильтра значений FFT.
-typedef struct _Phase_Sync_Fft_Filter {
-    phase_sync_fft_filter_value_t values[FFT_FILTER_SIZE];
-    fft_buffer_index_t index;
-    fft_buffer_index_t count;
-} phase_sync_fft_filter_t;
-*/
-
-//! Структура значения FFT.
-typedef struct _Phase_Sync_Fft_Value {
+//! Угол сектора основной итерации (два сектора таймера нуля).
+#define ANGLE_ITER (ANGLE_120)
+
+//! Тип отсчёта скользящего ДПФ.
+typedef int16_t sdft_int_t;
+
+//! Тип индекса в окне скользящего ДПФ.
+typedef uint8_t sdft_index_t;
+
+
+/**
+ * Косинус угла 2*pi*i/SDFT_SIZE в формате q15.
+ * Синус получается смещением индекса на SDFT_SIN_OFFSET.
+ */
+static const int16_t sdft_cos_table[SDFT_SIZE] = {
+     32767,  32137,  30273,  27245,  23170,  18204,  12539,   6393,
+         0,  -6393, -12539, -18204, -23170, -27245, -30273, -32137,
+    -32767, -32137, -30273, -27245, -23170, -18204, -12539,  -6393,
+         0,   6393,  12539,  18204,  23170,  27245,  30273,  32137
+};
+
+/**
+ * Структура скользящего ДПФ первой гармоники.
+ * Вклады отсчётов вычисляются с фиксированной
+ * (по индексу отсчёта в окне) фазой поворачивающего множителя,
+ * поэтому вычитание вклада выбывающего отсчёта точно
+ * компенсирует его добавление и ошибка не накапливается.
+ */
+typedef struct _Phase_Sync_Sdft {
+    sdft_int_t window[SDFT_SIZE]; //!< Отсчёты окна.
+    int32_t re; //!< Действительная часть первой гармоники.
+    int32_t im; //!< Мнимая часть первой гармоники.
+} phase_sync_sdft_t;
+
+//! Структура скользящих ДПФ фаз.
+typedef struct _Phase_Sync_Sdfts {
+    phase_sync_sdft_t sdft_a; //!< ДПФ фазы A.
+    phase_sync_sdft_t sdft_b; //!< ДПФ фазы B.
+    phase_sync_sdft_t sdft_c; //!< ДПФ фазы C.
+    sdft_index_t index; //!< Индекс следующего отсчёта в окне.
+    sdft_index_t count; //!< Число отсчётов в окне.
+} phase_sync_sdfts_t;
+
+//! Структура опорного отсчёта.
+typedef struct _Phase_Sync_Ref {
+    bool pending; //!< Флаг ожидания опорного отсчёта.
+    uint8_t pending_iters; //!< Число основных итераций от сектора фазы A для ожидаемого отсчёта.
+    sdft_index_t index; //!< Индекс опорного отсчёта в окне.
+    uint8_t iters; //!< Число основных итераций от сектора фазы A.
+    fixed32_t angle; //!< Угол таймера нуля в момент опорного отсчёта.
+} phase_sync_ref_t;
+
+//! Структура значения угла фазы.
+typedef struct _Phase_Sync_Value {
     fixed32_t angle;
     fixed32_t offset_angle;
     fixed32_t delta_angle;
     int16_t offset_time;
     int16_t delta_time;
-    fixed32_t filter[FFT_FILTER_SIZE];
-    fft_buffer_index_t filter_index;
-    fft_buffer_index_t filter_count;
-} phase_sync_fft_value_t;
-
-//! Структура значений FFT.
-typedef struct _Phase_Sync_Fft_Values {
-    phase_sync_fft_value_t value_a;
-    phase_sync_fft_value_t value_b;
-    phase_sync_fft_value_t value_c;
-} phase_sync_fft_values_t;
+    phase_sync_filter_t filter;
+} phase_sync_value_t;
+
+//! Структура значений углов фаз.
+typedef struct _Phase_Sync_Values {
+    phase_sync_value_t value_a;
+    phase_sync_value_t value_b;
+    phase_sync_value_t value_c;
+} phase_sync_values_t;
 
 //! Перечисление состояний синхронизации фаз.
 typedef enum _Drive_Phase_Sync_Calc_State {
@@ -132,14 +132,14 @@ typedef struct _Drive_Phase_Sync_Pll {
 typedef struct _Drive_Phase_Sync {
     uint8_t adc_counter; //!< Счётчик пропусков значений АЦП.
     drive_phase_sync_angle_callback_t angle_callback; //!< Каллбэк получения угла.
-    phase_sync_fft_buffers_t buffers[FFT_BUFFERS_COUNT]; //!< Буферы FFT.
-    fft_buffer_index_t put_buffers; //!< Индекс текущих буферов FFT для записи.
-    fft_buffer_index_t get_buffers; //!< Индекс текущих буферов FFT для чтения.
-    phase_sync_fft_values_t values; //!< Значения FFT.
+    phase_sync_sdfts_t sdfts; //!< Скользящие ДПФ.
+    phase_sync_ref_t ref; //!< Опорный отсчёт.
+    phase_sync_values_t values; //!< Значения углов фаз.
     drive_phase_sync_calc_state_t calc_state; //!< Состояние синхронизации фаз.
     uint8_t calc_phases_counter; //!< Счётчик пропусков вычисления фаз.
     drive_phase_sync_pll_t pll; //!< ФАПЧ.
     fixed32_t accuracy_angle; //!< Точность синхронизации.
+    fixed32_t us_per_degree; //!< Число микросекунд в электрическом градусе.
     // Обновляемые параметры.
     param_t* param_pid_val; //!< Значение ПИД-регулятора.
 } drive_phase_sync_t;
@@ -148,17 +148,54 @@ typedef struct _Drive_Phase_Sync {
 static drive_phase_sync_t phase_sync;
 
 
+//! Настройки синхронизации с фазами.
+typedef struct _Drive_Phase_Sync_Settings {
+    fixed32_t pll_pid_kp; //!< Коэффициент P ПИД ФАПЧ.
+    fixed32_t pll_pid_ki; //!< Коэффициент I ПИД ФАПЧ.
+    fixed32_t pll_pid_kd; //!< Коэффициент D ПИД ФАПЧ.
+} drive_phase_sync_settings_t;
+
+//! Настройки синхронизации с фазами.
+static drive_phase_sync_settings_t phase_sync_settings;
+
+//! Дескрипторы параметров синхронизации с фазами.
+static settings_handle_t phase_sync_handles[] = {
+    SETTINGS_HANDLE(PARAM_ID_PHASE_SYNC_PLL_PID_K_P, PARAM_VALUE_TYPE_FIXED, &phase_sync_settings.pll_pid_kp),
+    SETTINGS_HANDLE(PARAM_ID_PHASE_SYNC_PLL_PID_K_I, PARAM_VALUE_TYPE_FIXED, &phase_sync_settings.pll_pid_ki),
+    SETTINGS_HANDLE(PARAM_ID_PHASE_SYNC_PLL_PID_K_D, PARAM_VALUE_TYPE_FIXED, &phase_sync_settings.pll_pid_kd),
+    SETTINGS_HANDLE(PARAM_ID_PHASE_SYNC_ACCURACY, PARAM_VALUE_TYPE_FIXED, &phase_sync.accuracy_angle)
+};
+
+static void phase_sync_settings_changed(void);
+
+//! Подписка на изменение параметров синхронизации с фазами.
+SETTINGS_SUBSCRIPTION(phase_sync_subscription, phase_sync_handles, phase_sync_settings_changed);
+
+/**
+ * Применяет изменённые настройки синхронизации с фазами.
+ */
+static void phase_sync_settings_changed(void)
+{
+    drive_phase_sync_set_pll_pid(phase_sync_settings.pll_pid_kp,
+                                 phase_sync_settings.pll_pid_ki,
+                                 phase_sync_settings.pll_pid_kd);
+}
+
+
 err_t drive_phase_sync_init(void)
 {
     memset(&phase_sync, 0x0, sizeof(drive_phase_sync_t));
     
     pid_controller_init(&phase_sync.pll.pid, 0, 0, 0);
     
-    phase_sync.put_buffers = 0;
-    phase_sync.get_buffers = 1;
+    phase_sync.us_per_degree = US_PER_DEGREE;
     
     phase_sync.param_pid_val = settings_param_by_id(PARAM_ID_PID_PHASE_SYNC);
     
+    RETURN_ERR_IF_FAIL(settings_subscribe(&phase_sync_subscription));
+    
+    phase_sync_settings_changed();
+    
     return E_NO_ERROR;
 }
 
@@ -166,15 +203,13 @@ void drive_phase_sync_reset(void)
 {
     CRITICAL_ENTER();
     
-    memset(&phase_sync.buffers, 0x0, sizeof(phase_sync_fft_buffers_t) * FFT_BUFFERS_COUNT);
-    memset(&phase_sync.values, 0x0, sizeof(phase_sync_fft_values_t));
+    memset(&phase_sync.sdfts, 0x0, sizeof(phase_sync_sdfts_t));
+    memset(&phase_sync.ref, 0x0, sizeof(phase_sync_ref_t));
+    memset(&phase_sync.values, 0x0, sizeof(phase_sync_values_t));
     
     phase_sync.adc_counter = 0;
     phase_sync.calc_phases_counter = 0;
     
-    phase_sync.put_buffers = 0;
-    phase_sync.get_buffers = 1;
-    
     phase_sync.calc_state = DRIVE_PHASE_SYNC_CALC_INIT;
     pid_controller_reset(&phase_sync.pll.pid);
     
@@ -186,165 +221,112 @@ void drive_phase_sync_set_angle_callback(drive_phase_sync_angle_callback_t callb
     phase_sync.angle_callback = callback;
 }
 
-/**
- * Получает буферы FFT для записи.
- * @return Буферы FFT.
- */
-ALWAYS_INLINE static phase_sync_fft_buffers_t* phase_sync_cur_put_fft_buffers(void)
+void drive_phase_sync_set_period_us(uint32_t period_us)
 {
-    return &phase_sync.buffers[phase_sync.put_buffers];
+    phase_sync.us_per_degree = fixed32_make_from_fract(period_us, 360);
 }
 
+// fixed32_t -> sdft_int_t ==> val >> 12;
 /**
- * Получает буферы FFT для чтения.
- * @return Буферы FFT.
- */
-ALWAYS_INLINE static phase_sync_fft_buffers_t* phase_sync_cur_get_fft_buffers(void)
-{
-    return &phase_sync.buffers[phase_sync.get_buffers];
-}
-
-/**
- * Получает следующий индекс буферов данных FFT.
- * @param index Текущий индекс.
- * @return Следующий индекс.
+ * Преобразует значение напряжения к типу отсчёта ДПФ.
+ * @param val Значение напряжения.
+ * @return Отсчёт ДПФ.
  */
-ALWAYS_INLINE static fft_buffer_index_t phase_sync_fft_buffer_next_index(fft_buffer_index_t index)
+ALWAYS_INLINE static sdft_int_t fixed32_to_sdft_int(fixed32_t val)
 {
-    if(index < FFT_BUFFERS_COUNT - 1) return index + 1;
-    return 0;
+    return val >> 12;
 }
 
 /**
- * Сбрасывает буферы записи FFT.
+ * Получает вклад отсчёта в гармонику.
+ * @param val Отсчёт.
+ * @param k Значение поворачивающего множителя в формате q15.
+ * @return Вклад отсчёта.
  */
-ALWAYS_INLINE static void phase_sync_reset_fft_put_buffers(void)
+ALWAYS_INLINE static int32_t sdft_term(sdft_int_t val, int16_t k)
 {
-    phase_sync_fft_buffers_t* fft_buffers = phase_sync_cur_put_fft_buffers();
-    
-    fft_buffers->index = 0;
-    fft_buffers->first_angle = 0;
+    return ((int32_t)val * k) >> 15;
 }
 
 /**
- * Переключает буферы данных FFT.
+ * Добавляет отсчёт в скользящее ДПФ
+ * с вытеснением отсчёта, полученного период назад.
+ * @param sdft Скользящее ДПФ.
+ * @param index Индекс отсчёта в окне.
+ * @param val Значение напряжения.
  */
-ALWAYS_INLINE static void phase_sync_swap_fft_buffers(void)
+ALWAYS_INLINE static void phase_sync_sdft_put(phase_sync_sdft_t* sdft, sdft_index_t index, fixed32_t val)
 {
-    CRITICAL_ENTER();
+    sdft_int_t x_new = fixed32_to_sdft_int(val);
+    sdft_int_t x_old = sdft->window[index];
     
-    phase_sync.put_buffers = phase_sync_fft_buffer_next_index(phase_sync.put_buffers);
-    phase_sync.get_buffers = phase_sync_fft_buffer_next_index(phase_sync.get_buffers);
+    int16_t k_cos = sdft_cos_table[index];
+    int16_t k_sin = sdft_cos_table[(index + SDFT_SIN_OFFSET) & SDFT_INDEX_MASK];
     
-    phase_sync_reset_fft_put_buffers();
+    // X = sum(x * exp(-j * 2 * pi * i / N)).
+    sdft->re += sdft_term(x_new, k_cos) - sdft_term(x_old, k_cos);
+    sdft->im -= sdft_term(x_new, k_sin) - sdft_term(x_old, k_sin);
     
-    phase_sync.adc_counter = 0;
-    
-    CRITICAL_EXIT();
-}
-
-// fixed32_t -> fft_int_t ==> val >> 11;
-/**
- * Преобразует значение напряжения к типу FFT.
- * @param val Значение напряжения.
- * @return Значение для FFT.
- */
-ALWAYS_INLINE static fft_int_t fixed32_to_fft_int(fixed32_t val)
-{
-    return val >> 12;
-}
-
-/**
- * Преобразует выходное значение RFFT в число с фиксированной запятой fixed32.
- * @param val Значение RFFT.
- * @return Число с фиксированной запятой.
- */
-ALWAYS_INLINE static fixed32_t fft_value_to_fixed32(fft_int_t val)
-{
-    return (fixed32_t)val << 5;
+    sdft->window[index] = x_new;
 }
 
-static void phase_sync_fft_buffer_put(phase_sync_fft_buffer_t* fft_buffer, fft_buffer_index_t index, fixed32_t val)
-{
-    fft_buffer_index_t index2 = index * 2;
-    fft_buffer->data[index2] = fixed32_to_fft_int(val);
-    fft_buffer->data[index2 + 1] = 0;//index * 41;
-}
-
-/*
-static void phase_sync_fft_buffer_put_raw(phase_sync_fft_buffer_t* fft_buffer, fft_buffer_index_t index, int16_t val)
-{
-    fft_buffer_index_t index2 = index * 2;
-    fft_buffer->data[index2] = val;
-    fft_buffer->data[index2 + 1] = 0;//index * 41;
-}
-*/
-
 void drive_phase_sync_append_data(void)
 {
     if(phase_sync.adc_counter == 0){
         
-        phase_sync_fft_buffers_t* fft_buffers = phase_sync_cur_put_fft_buffers();
-
-        if(fft_buffers->index < FFT_SIZE){
-
-            if(fft_buffers->index == 0){
-                if(phase_sync.angle_callback){
-                    fft_buffers->first_angle = phase_sync.angle_callback();
-                }else{
-                    fft_buffers->first_angle = 0;
-                }
-            }
-            
-            fixed32_t Ua = drive_power_channel_real_value_inst(DRIVE_POWER_Ua);
-            fixed32_t Ub = drive_power_channel_real_value_inst(DRIVE_POWER_Ub);
-            fixed32_t Uc = drive_power_channel_real_value_inst(DRIVE_POWER_Uc);
-
-            phase_sync_fft_buffer_put(&fft_buffers->buffer_a, fft_buffers->index,
-                    Ub - Ua);
-
-            phase_sync_fft_buffer_put(&fft_buffers->buffer_b, fft_buffers->index,
-                    Uc - Ub);
-
-            phase_sync_fft_buffer_put(&fft_buffers->buffer_c, fft_buffers->index,
-                    Ua - Uc);
-
-            fft_buffers->index ++;
+        phase_sync_sdfts_t* sdfts = &phase_sync.sdfts;
+        phase_sync_ref_t* ref = &phase_sync.ref;
+        
+        if(ref->pending){
+            ref->pending = false;
+            ref->index = sdfts->index;
+            ref->iters = ref->pending_iters;
+            ref->angle = phase_sync.angle_callback ? phase_sync.angle_callback() : 0;
         }
+        
+        fixed32_t Ua = drive_power_channel_real_value_inst(DRIVE_POWER_Ua);
+        fixed32_t Ub = drive_power_channel_real_value_inst(DRIVE_POWER_Ub);
+        fixed32_t Uc = drive_power_channel_real_value_inst(DRIVE_POWER_Uc);
+        
+        phase_sync_sdft_put(&sdfts->sdft_a, sdfts->index, Ub - Ua);
+        phase_sync_sdft_put(&sdfts->sdft_b, sdfts->index, Uc - Ub);
+        phase_sync_sdft_put(&sdfts->sdft_c, sdfts->index, Ua - Uc);
+        
+        sdfts->index = (sdfts->index + 1) & SDFT_INDEX_MASK;
+        if(sdfts->count < SDFT_SIZE) sdfts->count ++;
     }
     phase_sync.adc_counter ++;
-    if(phase_sync.adc_counter >= FFT_ADC_PRESCALER){
+    if(phase_sync.adc_counter >= SDFT_ADC_PRESCALER){
         phase_sync.adc_counter = 0;
     }
 }
 
 /**
- * Получает буфер FFT для заданной фазы.
- * @param fft_buffers Буферы FFT.
+ * Получает скользящее ДПФ для заданной фазы.
  * @param phase Фаза.
- * @return Буфер FFT.
+ * @return Скользящее ДПФ.
  */
-static phase_sync_fft_buffer_t* phase_sync_get_buffer(phase_sync_fft_buffers_t* fft_buffers, phase_t phase)
+static phase_sync_sdft_t* phase_sync_get_sdft(phase_t phase)
 {
     switch(phase){
         default:
             break;
         case PHASE_A:
-            return &fft_buffers->buffer_a;
+            return &phase_sync.sdfts.sdft_a;
         case PHASE_B:
-            return &fft_buffers->buffer_b;
+            return &phase_sync.sdfts.sdft_b;
         case PHASE_C:
-            return &fft_buffers->buffer_c;
+            return &phase_sync.sdfts.sdft_c;
     }
     return NULL;
 }
 
 /**
- * Получает значение FFT для заданной фазы.
+ * Получает значение угла для заданной фазы.
  * @param phase Фаза.
- * @return Значение FFT.
+ * @return Значение угла.
  */
-static phase_sync_fft_value_t* phase_sync_get_value(phase_t phase)
+static phase_sync_value_t* phase_sync_get_value(phase_t phase)
 {
     switch(phase){
         default:
@@ -360,193 +342,112 @@ static phase_sync_fft_value_t* phase_sync_get_value(phase_t phase)
 }
 
 /**
- * Получает флаг пустоты буфера.
- * @param fft_buffer Буфер.
- * @return Флаг пустоты буфера.
+ * Приводит угол к интервалу -180 ... +180.
+ * @param angle Угол.
+ * @return Приведённый угол.
  */
-ALWAYS_INLINE static bool phase_sync_buffers_empty(phase_sync_fft_buffers_t* fft_buffers)
+ALWAYS_INLINE static fixed32_t phase_sync_angle_normalize(fixed32_t angle)
 {
-    return fft_buffers->index == 0;
-}
-
-/**
- * Получает флаг полноты буфера.
- * @param fft_buffer Буфер.
- * @return Флаг полноты буфера.
- */
-ALWAYS_INLINE static bool phase_sync_buffers_full(phase_sync_fft_buffers_t* fft_buffers)
-{
-    return fft_buffers->index >= FFT_SIZE;
-}
-
-/**
- * Очищает незаполненную часть буфера.
- * @param fft_buffers Буферы FFT.
- * @param fft_buffer Буфер для очистки.
- */
-ALWAYS_INLINE static void phase_sync_buffer_clear_tail(phase_sync_fft_buffers_t* fft_buffers, phase_sync_fft_buffer_t* fft_buffer)
-{
-    fft_buffer_index_t index2 = fft_buffers->index * 2;
-    memset(&fft_buffer->data[index2], 0x0, (FFT_SIZE2 - index2) * sizeof(fft_int_t));
-}
-
-/**
- * Добавляет данные в буфер фильтра.
- * @param fft_value Значение FFT.
- * @param angle Вычисленный угол.
- */
-static void phase_sync_filter_put(phase_sync_fft_value_t* fft_value, fixed32_t angle)
-{
-    fft_value->filter[fft_value->filter_index] = angle;
-    
-    if(++ fft_value->filter_index >= FFT_FILTER_SIZE) fft_value->filter_index = 0;
-    if(fft_value->filter_count < FFT_FILTER_SIZE) fft_value->filter_count ++;
-}
-
-/**
- * Функция сравнения двух значений.
- * @param a Значение А.
- * @param b Значение Б.
- * @return Результат сравнения.
- */
-static int fft_filter_cmp(const void* a, const void* b)
-{
-    return (*(fixed32_t*)a - *(fixed32_t*)b);
-}
-
-/**
- * Вычисляет значение фильтра.
- * @param fft_value Значение FFT.
- * @return Вычисленное значение фильтра.
- */
-static fixed32_t phase_sync_filter_calc(phase_sync_fft_value_t* fft_value)
-{
-    if(fft_value->filter_count == 0) return 0;
-    
-    size_t count = fft_value->filter_count;
-    
-    fixed32_t buffer[count];
-    
-    memcpy(buffer, fft_value->filter, sizeof(fixed32_t) * count);
-    
-    qsort(buffer, count, sizeof(fixed32_t), fft_filter_cmp);
-    
-    fixed32_t val = 0;
-    size_t from = 0;
-    size_t to = count;
-    
-    if(count > (FFT_FILTER_SKIP_MIN + FFT_FILTER_SKIP_MAX)){
-        from += FFT_FILTER_SKIP_MIN;
-        to -= FFT_FILTER_SKIP_MAX;
-        count -= (FFT_FILTER_SKIP_MIN + FFT_FILTER_SKIP_MAX);
-    }
-    
-    while(from < to){
-        val  += buffer[from];
-        from ++;
-    }
-    
-    val /= (fixed32_t)count;
+    while(angle > CORDIC32_ANGLE_180) angle -= CORDIC32_ANGLE_360;
+    while(angle <= -CORDIC32_ANGLE_180) angle += CORDIC32_ANGLE_360;
     
-    return val;
+    return angle;
 }
 
 /**
- * Получает флаг заполнения фильтра значения FFT.
- * @param fft_value Значение FFT.
+ * Получает флаг заполнения фильтра значения угла.
+ * @param value Значение угла.
  * @return Флаг заполнения фильтра.
  */
-static bool phase_sync_filter_full(phase_sync_fft_value_t* fft_value)
+static bool drive_phase_sync_value_filter_full(phase_sync_value_t* value)
 {
-    return fft_value->filter_count == FFT_FILTER_SIZE;
+    return phase_sync_filter_full(&value->filter);
 }
 
 /**
- * Вычисляет значение угла фазы для буфера FFT.
- * @param fft_buffers Буферы данных FFT.
- * @param fft_buffer Буфер для вычисления.
- * @param fft_value Значение FFT.
+ * Вычисляет значение угла фазы по скользящему ДПФ.
+ * @param sdft Скользящее ДПФ.
+ * @param value Значение угла.
  * @return Код ошибки.
  */
-static err_t drive_phase_sync_calc_buffer(phase_sync_fft_buffers_t* fft_buffers, phase_sync_fft_buffer_t* fft_buffer, phase_sync_fft_value_t* fft_value)
+static err_t drive_phase_sync_calc_sdft(phase_sync_sdft_t* sdft, phase_sync_value_t* value)
 {
-    if(phase_sync_buffers_empty(fft_buffers)) return E_OUT_OF_RANGE;
+    if(!drive_phase_sync_window_full()) return E_OUT_OF_RANGE;
     
-    if(!phase_sync_buffers_full(fft_buffers)) phase_sync_buffer_clear_tail(fft_buffers, fft_buffer);
+    CRITICAL_ENTER();
+    
+    fixed32_t x = (fixed32_t)sdft->re;
+    fixed32_t y = (fixed32_t)sdft->im;
+    sdft_index_t ref_index = phase_sync.ref.index;
+    uint8_t ref_iters = phase_sync.ref.iters;
+    fixed32_t ref_angle = phase_sync.ref.angle;
     
-    arm_cfft_q15(&arm_cfft_sR_q15_len32, fft_buffer->data, 0, FFT_BIT_REVERSE);
+    CRITICAL_EXIT();
     
-    fixed32_t x = (fixed32_t)fft_value_to_fixed32(fft_buffer->data[FFT_BUFFER_FIRST_VALUE_REAL]);
-    fixed32_t y = (fixed32_t)fft_value_to_fixed32(fft_buffer->data[FFT_BUFFER_FIRST_VALUE_IMAG]);
     fixed32_t angle = 0;
     
+    // Угол первой гармоники на отсчёте окна с индексом 0.
     cordic32_atan2_hyp(x, y, &angle, NULL);
-
-    /**/
-    // Учтём начальный угол.
-    angle -= fft_buffers->first_angle;
+    
+    // Перейдём к углу на опорном отсчёте.
+    angle += (fixed32_t)ref_index * SDFT_SAMPLE_ANGLE;
+    // Учтём угол таймера нуля на опорном отсчёте.
+    angle -= ref_angle;
+    // Перейдём к началу сектора фазы A.
+    angle -= (fixed32_t)ref_iters * ANGLE_ITER;
     // Прибавим 90 градусов чтобы получить фазу синусоиды.
     angle += CORDIC32_ANGLE_90;
-    // Нормализуем значение.
-    if(angle >= CORDIC32_ANGLE_360) angle -= CORDIC32_ANGLE_360;
     
     // Приведём к интервалу -180 ... +180.
-    if(angle > CORDIC32_ANGLE_180) angle = -(CORDIC32_ANGLE_360 - angle);
-    /**/
+    angle = phase_sync_angle_normalize(angle);
     
     // Отфильтруем.
-    phase_sync_filter_put(fft_value, angle);
-    angle = phase_sync_filter_calc(fft_value);
+    phase_sync_filter_put(&value->filter, angle);
+    angle = phase_sync_filter_calc(&value->filter);
     
-    fft_value->angle = angle;
+    value->angle = angle;
     
     return E_NO_ERROR;
 }
 
-bool drive_phase_sync_put_buffers_full(void)
+bool drive_phase_sync_window_full(void)
 {
-    phase_sync_fft_buffers_t* fft_buffers = phase_sync_cur_put_fft_buffers();
-    
-    return phase_sync_buffers_full(fft_buffers);
+    return phase_sync.sdfts.count >= SDFT_SIZE;
 }
 
-bool drive_phase_sync_get_buffers_full(void)
+void drive_phase_sync_mark_reference(void)
 {
-    phase_sync_fft_buffers_t* fft_buffers = phase_sync_cur_get_fft_buffers();
+    uint8_t iters = 0;
     
-    return phase_sync_buffers_full(fft_buffers);
-}
-
-void drive_phase_sync_reset_put_buffers(void)
-{
-    phase_sync_reset_fft_put_buffers();
-}
-
-void drive_phase_sync_swap_buffers(void)
-{
-    phase_sync_swap_fft_buffers();
-}
-
-void drive_phase_sync_swap_buffers_if_needed(void)
-{
-    if(phase_sync.calc_state == DRIVE_PHASE_SYNC_CALC_INIT ||
-       phase_sync.calc_state == DRIVE_PHASE_SYNC_CALC_PHASE_A){
-        phase_sync_swap_fft_buffers();
+    switch(phase_sync.calc_state){
+        default:
+            break;
+        case DRIVE_PHASE_SYNC_CALC_PHASE_B:
+            iters = 1;
+            break;
+        case DRIVE_PHASE_SYNC_CALC_PHASE_C:
+            iters = 2;
+            break;
     }
+    
+    CRITICAL_ENTER();
+    
+    phase_sync.ref.pending_iters = iters;
+    phase_sync.ref.pending = true;
+    
+    CRITICAL_EXIT();
 }
 
 err_t drive_phase_sync_calc(phase_t phase)
 {
     if(phase == PHASE_UNK) return E_INVALID_VALUE;
     
-    phase_sync_fft_buffers_t* fft_buffers = phase_sync_cur_get_fft_buffers();
+    phase_sync_sdft_t* sdft = phase_sync_get_sdft(phase);
+    phase_sync_value_t* value = phase_sync_get_value(phase);
     
-    phase_sync_fft_buffer_t* fft_buffer = phase_sync_get_buffer(fft_buffers, phase);
-    phase_sync_fft_value_t* fft_value = phase_sync_get_value(phase);
+    if(!sdft || !value) return E_NULL_POINTER;
     
-    if(!fft_buffer || !fft_value) return E_NULL_POINTER;
-    
-    return drive_phase_sync_calc_buffer(fft_buffers, fft_buffer, fft_value);
+    return drive_phase_sync_calc_sdft(sdft, value);
 }
 
 err_t drive_phase_sync_angle(phase_t phase, fixed32_t* angle)
@@ -554,11 +455,11 @@ err_t drive_phase_sync_angle(phase_t phase, fixed32_t* angle)
     if(phase == PHASE_UNK) return E_INVALID_VALUE;
     if(angle == NULL) return E_NULL_POINTER;
     
-    phase_sync_fft_value_t* fft_value = phase_sync_get_value(phase);
+    phase_sync_value_t* value = phase_sync_get_value(phase);
     
-    if(!fft_value) return E_NULL_POINTER;
+    if(!value) return E_NULL_POINTER;
     
-    *angle = fft_value->angle;
+    *angle = value->angle;
     
     return E_NO_ERROR;
 }
@@ -567,44 +468,44 @@ int16_t drive_phase_sync_offset(phase_t phase)
 {
     if(phase == PHASE_UNK) return 0;
     
-    phase_sync_fft_value_t* fft_value = phase_sync_get_value(phase);
+    phase_sync_value_t* value = phase_sync_get_value(phase);
     
-    if(!fft_value) return 0;
+    if(!value) return 0;
     
-    return fft_value->offset_time;
+    return value->offset_time;
 }
 
 fixed32_t drive_phase_sync_offset_angle(phase_t phase)
 {
     if(phase == PHASE_UNK) return 0;
     
-    phase_sync_fft_value_t* fft_value = phase_sync_get_value(phase);
+    phase_sync_value_t* value = phase_sync_get_value(phase);
     
-    if(!fft_value) return 0;
+    if(!value) return 0;
     
-    return fft_value->offset_angle;
+    return value->offset_angle;
 }
 
 int16_t drive_phase_sync_delta(phase_t phase)
 {
     if(phase == PHASE_UNK) return 0;
     
-    phase_sync_fft_value_t* fft_value = phase_sync_get_value(phase);
+    phase_sync_value_t* value = phase_sync_get_value(phase);
     
-    if(!fft_value) return 0;
+    if(!value) return 0;
     
-    return fft_value->delta_time;
+    return value->delta_time;
 }
 
 fixed32_t drive_phase_sync_delta_angle(phase_t phase)
 {
     if(phase == PHASE_UNK) return 0;
     
-    phase_sync_fft_value_t* fft_value = phase_sync_get_value(phase);
+    phase_sync_value_t* value = phase_sync_get_value(phase);
     
-    if(!fft_value) return 0;
+    if(!value) return 0;
     
-    return fft_value->delta_angle;
+    return value->delta_angle;
 }
 
 fixed32_t drive_phase_sync_diff_delta_angle(phase_t phase)
@@ -612,13 +513,25 @@ fixed32_t drive_phase_sync_diff_delta_angle(phase_t phase)
     return drive_phase_sync_delta_angle(phase) - ANGLE_120;
 }
 
+/**
+ * Вычисляет углы всех фаз.
+ * @return Код ошибки.
+ */
+static err_t drive_phase_sync_calc_phases(void)
+{
+    RETURN_ERR_IF_FAIL(drive_phase_sync_calc(PHASE_A));
+    RETURN_ERR_IF_FAIL(drive_phase_sync_calc(PHASE_B));
+    RETURN_ERR_IF_FAIL(drive_phase_sync_calc(PHASE_C));
+    
+    return E_NO_ERROR;
+}
+
 err_t drive_phase_sync_process_calc(void)
 {
     err_t err = E_NO_ERROR;
     
     switch(phase_sync.calc_state){
         case DRIVE_PHASE_SYNC_CALC_INIT:
-            //drive_phase_sync_swap_buffers();
             phase_sync.calc_phases_counter = 0;
             phase_sync.calc_state = DRIVE_PHASE_SYNC_CALC_DATA_WAIT;
         case DRIVE_PHASE_SYNC_CALC_DATA_WAIT:
@@ -627,17 +540,16 @@ err_t drive_phase_sync_process_calc(void)
                 phase_sync.calc_phases_counter = 0;
             }
             break;
+        // Углы всех фаз вычисляются раз в период,
+        // фильтры углов и ФАПЧ получают по значению за период.
         case DRIVE_PHASE_SYNC_CALC_PHASE_A:
-            //drive_phase_sync_swap_buffers();
-            err = drive_phase_sync_calc(PHASE_A);
+            err = drive_phase_sync_calc_phases();
             phase_sync.calc_state = DRIVE_PHASE_SYNC_CALC_PHASE_B;
             break;
         case DRIVE_PHASE_SYNC_CALC_PHASE_B:
-            err = drive_phase_sync_calc(PHASE_B);
             phase_sync.calc_state = DRIVE_PHASE_SYNC_CALC_PHASE_C;
             break;
         case DRIVE_PHASE_SYNC_CALC_PHASE_C:
-            err = drive_phase_sync_calc(PHASE_C);
             phase_sync.calc_state = DRIVE_PHASE_SYNC_CALC_PHASE_A;
             break;
     }
@@ -647,9 +559,9 @@ err_t drive_phase_sync_process_calc(void)
 
 bool drive_phase_sync_data_avail(void)
 {
-    return phase_sync_filter_full(&phase_sync.values.value_a) &&
-           phase_sync_filter_full(&phase_sync.values.value_b) &&
-           phase_sync_filter_full(&phase_sync.values.value_c);
+    return drive_phase_sync_value_filter_full(&phase_sync.values.value_a) &&
+           drive_phase_sync_value_filter_full(&phase_sync.values.value_b) &&
+           drive_phase_sync_value_filter_full(&phase_sync.values.value_c);
 }
 
 void drive_phase_sync_set_pll_pid(fixed32_t kp, fixed32_t ki, fixed32_t kd)
@@ -683,6 +595,7 @@ bool drive_phase_sync_pll_regulate(void)
 {
     if(!drive_phase_sync_data_avail()) return false;
     
+    // Регулирование сразу после вычисления углов, раз в период (PLL_PID_DT).
     if(phase_sync.calc_state != DRIVE_PHASE_SYNC_CALC_PHASE_B) return false;
     
     fixed32_t angle_err = phase_sync.values.value_a.angle;
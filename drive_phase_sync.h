@@ -39,36 +39,30 @@ extern void drive_phase_sync_reset(void);
 extern void drive_phase_sync_set_angle_callback(drive_phase_sync_angle_callback_t callback);
 
 /**
- * Добавляет текущие мгновенные значения питания в буфер FFT.
+ * Устанавливает период сети.
+ * Число отсчётов АЦП за период не зависит от частоты сети,
+ * от периода зависит перевод углов во время.
+ * @param period_us Период сети, мкс.
  */
-extern void drive_phase_sync_append_data(void);
-
-/**
- * Получает флаг заполненности буферов записи.
- * @return Флаг заполненности буферов записи.
- */
-bool drive_phase_sync_put_buffers_full(void);
+extern void drive_phase_sync_set_period_us(uint32_t period_us);
 
 /**
- * Получает флаг заполненности буферов чтения.
- * @return Флаг заполненности буферов чтения.
+ * Добавляет текущие мгновенные значения питания
+ * в окна скользящего ДПФ.
  */
-bool drive_phase_sync_get_buffers_full(void);
-
-/**
- * Сбрасываент буферы записи.
- */
-extern void drive_phase_sync_reset_put_buffers(void);
+extern void drive_phase_sync_append_data(void);
 
 /**
- * Переключает буферы чтения и записи.
+ * Получает флаг заполненности окон скользящего ДПФ.
+ * @return Флаг заполненности окон.
  */
-extern void drive_phase_sync_swap_buffers(void);
+extern bool drive_phase_sync_window_full(void);
 
 /**
- * Переключает буферы чтения и записи при необходимости.
+ * Отмечает начало сектора основной итерации.
+ * Следующий отсчёт становится опорным для вычисления углов фаз.
  */
-extern void drive_phase_sync_swap_buffers_if_needed(void);
+extern void drive_phase_sync_mark_reference(void);
 
 /**
  * Производит вычисления для заданной фазы.
@@ -78,10 +72,11 @@ extern void drive_phase_sync_swap_buffers_if_needed(void);
 extern err_t drive_phase_sync_calc(phase_t phase);
 
 /**
- * Получает угол заданной фазы на момент начала записи буфера FFT.
+ * Получает угол заданной фазы на момент начала
+ * сектора таймера нуля, в котором вычисляется фаза A.
  * Угол возвращается в интервале
- * от -180 (фаза опережает буфер)
- * до +180 (фаза отстаёт от буфера).
+ * от -180 (фаза опережает сектор)
+ * до +180 (фаза отстаёт от сектора).
  * @param phase Фаза.
  * @param angle Угол от -180 до +180 градусов.
  * @return Код ошибки.
@@ -128,7 +123,8 @@ extern fixed32_t drive_phase_sync_delta_angle(phase_t phase);
 extern fixed32_t drive_phase_sync_diff_delta_angle(phase_t phase);
 
 /**
- * Вычисляет угол очередной фазы.
+ * Вычисляет углы фаз по окнам скользящего ДПФ
+ * и переходит к следующей фазе.
  * @return Код ошибки.
  */
 extern err_t drive_phase_sync_process_calc(void);
@@ -41,6 +41,12 @@ typedef struct _Oscillogram_Buf {
     size_t skip_counter; //!< Счётчик числа пропущенных точек АЦП.
 } oscillogram_buf_t;
 
+//! Тип буфера предыстории тренда.
+typedef struct _Oscillogram_Trend_Buf {
+    drive_power_osc_trend_point_t points[DRIVE_POWER_OSC_TREND_BUF_LEN]; //!< Точки тренда.
+    uint32_t count; //!< Число записанных точек.
+} oscillogram_trend_buf_t;
+
 
 /////////////////////////////
 // Диагностика тиристоров. //
@@ -141,15 +147,20 @@ typedef struct _Triacs_Diag {
 //! Общий размер данных фильтров.
 #define CHANNEL_FILTERS_DATA_SIZE (CF_DATA_OFFSET_Erot + CF_DATA_SIZE_Erot)
 
+//! Число скользящих окон вычисления значений каналов.
+#define DRIVE_POWER_WINDOWS_COUNT 6
+
 
 //! Тип питания привода.
 typedef struct _Drive_Power {
     power_value_t power_values[DRIVE_POWER_CHANNELS_COUNT]; //!< Значение каналов АЦП.
     fixed32_t channel_filters_data[CHANNEL_FILTERS_DATA_SIZE]; //!< Данные фильтров каналов АЦП.
     channel_filter_t channel_filters[DRIVE_POWER_CHANNELS_COUNT]; //!< Фильтры каналов АЦП.
+    power_window_t windows[DRIVE_POWER_WINDOWS_COUNT]; //!< Скользящие окна каналов АЦП.
     power_t power; //!< Питание.
     size_t period_iters; //!< Счётчик периода измерений АЦП.
     oscillogram_buf_t osc_buf; //!< Буфер осциллограмм.
+    oscillogram_trend_buf_t osc_trend_buf; //!< Буфер тренда.
     phase_t phase_calc_current; //!< Вычислять ток заданной фазы.
     phase_t phase_calc_voltage; //!< Вычислять напряжение заданной фазы.
     bool rot_calc_current; //!< Вычислять ток якоря.
@@ -167,6 +178,16 @@ typedef struct _Drive_Power {
 //! Питание привода.
 static drive_power_t drive_power;
 
+//! Идентификаторы параметров вычисления каналов в скользящем окне.
+static const param_id_t drive_power_window_param_ids[DRIVE_POWER_CHANNELS_COUNT] = {
+    PARAM_ID_SLIDING_WINDOW_Ua, PARAM_ID_SLIDING_WINDOW_Ia,
+    PARAM_ID_SLIDING_WINDOW_Ub, PARAM_ID_SLIDING_WINDOW_Ib,
+    PARAM_ID_SLIDING_WINDOW_Uc, PARAM_ID_SLIDING_WINDOW_Ic,
+    PARAM_ID_SLIDING_WINDOW_Urot, PARAM_ID_SLIDING_WINDOW_Irot,
+    PARAM_ID_SLIDING_WINDOW_Iexc, PARAM_ID_SLIDING_WINDOW_Iref,
+    PARAM_ID_SLIDING_WINDOW_Ifan, PARAM_ID_SLIDING_WINDOW_Erot
+};
+
 
 
 static void drive_power_reset_channel_filters(void)
@@ -257,6 +278,29 @@ err_t drive_power_init(void)
     return E_NO_ERROR;
 }
 
+/**
+ * Назначает скользящие окна каналам согласно настройкам.
+ * Окна выделяются по порядку номеров каналов,
+ * каналы сверх числа окон вычисляются по блокам.
+ */
+static void drive_power_update_windows(void)
+{
+    size_t window_n = 0;
+    power_window_t* windows[DRIVE_POWER_CHANNELS_COUNT];
+    
+    size_t i;
+    for(i = 0; i < DRIVE_POWER_CHANNELS_COUNT; i ++){
+        windows[i] = NULL;
+        
+        if(settings_valueu(drive_power_window_param_ids[i]) &&
+           window_n < DRIVE_POWER_WINDOWS_COUNT){
+            windows[i] = &drive_power.windows[window_n ++];
+        }
+    }
+    
+    power_set_windows(&drive_power.power, windows);
+}
+
 err_t drive_power_update_settings(void)
 {
     drive_power.triacs_diag.I_zero_noise = settings_valuef(PARAM_ID_PROT_I_IN_IDLE_FAULT_LEVEL_VALUE);
@@ -312,6 +356,10 @@ err_t drive_power_update_settings(void)
     channel_filter_resize_ms(&drive_power.channel_filters[DRIVE_POWER_Ifan], settings_valueu(PARAM_ID_AVERAGING_TIME_Ifan));
     channel_filter_resize_ms(&drive_power.channel_filters[DRIVE_POWER_Erot], settings_valueu(PARAM_ID_AVERAGING_TIME_Erot));
     
+    drive_power_update_windows();
+    
+    power_set_adc_channels(&drive_power.power, DRIVE_POWER_ADC_CHANNELS);
+    
     return E_NO_ERROR;
 }
 
@@ -606,6 +654,59 @@ static void drive_power_append_osc_data(void)
     }
 }
 
+uint32_t drive_power_osc_trend_count(void)
+{
+    return drive_power.osc_trend_buf.count;
+}
+
+uint32_t drive_power_osc_trend_period_us(void)
+{
+    return drive_power_period_us();
+}
+
+err_t drive_power_osc_trend_point_get(uint32_t number, drive_power_osc_trend_point_t* point)
+{
+    if(point == NULL) return E_NULL_POINTER;
+    
+    err_t err = E_NO_ERROR;
+    
+    CRITICAL_ENTER();
+    
+    uint32_t age = drive_power.osc_trend_buf.count - number;
+    
+    // Точка ещё не записана, либо уже перезаписана.
+    if(age == 0 || age >= DRIVE_POWER_OSC_TREND_BUF_LEN){
+        err = E_OUT_OF_RANGE;
+    }else{
+        memcpy(point, &drive_power.osc_trend_buf.points[number & (DRIVE_POWER_OSC_TREND_BUF_LEN - 1)],
+                sizeof(drive_power_osc_trend_point_t));
+    }
+    
+    CRITICAL_EXIT();
+    
+    return err;
+}
+
+static void drive_power_osc_trend_put_data(void)
+{
+    drive_power_osc_trend_point_t point;
+    
+    size_t i = 0;
+    for(; i < DRIVE_POWER_OSC_CHANNELS_COUNT; i ++){
+        point.data[i] = drive_power_osc_value_from_fixed32(drive_power_channel_real_value(
+                drive_power_osc_channels_nums[i]
+            ));
+    }
+    
+    CRITICAL_ENTER();
+    
+    memcpy(&drive_power.osc_trend_buf.points[drive_power.osc_trend_buf.count & (DRIVE_POWER_OSC_TREND_BUF_LEN - 1)],
+            &point, sizeof(drive_power_osc_trend_point_t));
+    drive_power.osc_trend_buf.count ++;
+    
+    CRITICAL_EXIT();
+}
+
 static void drive_power_calc_phase_current(void)
 {
     if(drive_power.phase_calc_current == PHASE_UNK) return;
@@ -923,9 +1024,9 @@ static void drive_power_calc_e_rot(void)
     power_process_soft_channel_value(&drive_power.power, DRIVE_POWER_Erot, Erot);
 }
 
-err_t drive_power_process_adc_values(power_channels_t channels, uint16_t* adc_values)
+err_t drive_power_process_adc_values(power_channels_t channels, uint16_t* adc_values, size_t frames_count)
 {
-    err_t err = power_process_adc_values(&drive_power.power, channels, adc_values);
+    err_t err = power_process_adc_values_block(&drive_power.power, channels, adc_values, frames_count);
     
     drive_power_calc_e_rot();
     
@@ -1179,6 +1280,7 @@ void drive_power_process_iter(void)
     if(++ drive_power.period_iters >= DRIVE_POWER_PERIOD_ITERS){
         drive_power.period_iters = 0;
         drive_power_diag_triac_pairs();
+        drive_power_osc_trend_put_data();
     }
 }
 
@@ -1266,6 +1368,10 @@ fixed32_t drive_power_channel_real_value_inst(size_t channel)
 fixed32_t drive_power_channel_real_value(size_t channel)
 {
     if(channel >= DRIVE_POWER_CHANNELS_COUNT) return 0;
+    // Значение в скользящем окне не требует дополнительного усреднения.
+    if(power_channel_window_enabled(&drive_power.power, channel)){
+        return power_channel_real_value(&drive_power.power, channel);
+    }
     return channel_filter_value(&drive_power.channel_filters[channel]);
     //return power_channel_real_value(&drive_power.power, channel);
 }
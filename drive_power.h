@@ -122,6 +122,24 @@ typedef struct _Drive_Power_Osc_Channel {
 } drive_power_osc_channel_t;
 #pragma pack(pop)
 
+// Точка тренда (медленной осциллограммы) записывается
+// раз в период сети, период точек равен измеренному
+// периоду сети (см. drive_power_osc_trend_period_us).
+
+//! Длина буфера предыстории тренда (степень двойки).
+#define DRIVE_POWER_OSC_TREND_BUF_LEN (64)
+
+//! Длина канала тренда.
+#define DRIVE_POWER_OSC_TREND_LEN DRIVE_POWER_OSC_CHANNEL_LEN
+
+//! Номинальное время канала тренда при частоте сети POWER_FREQ (225 * 20).
+#define DRIVE_POWER_OSC_TREND_TIME_MS (DRIVE_POWER_OSC_TREND_LEN * POWER_PERIOD_US / 1000)
+
+//! Тип точки тренда - действующие (средние) значения каналов осциллограмм за период.
+typedef struct _Drive_Power_Osc_Trend_Point {
+    osc_value_t data[DRIVE_POWER_OSC_CHANNELS_COUNT]; //!< Значения каналов.
+} drive_power_osc_trend_point_t;
+
 
 /**
  * Инициализирует питание привода.
@@ -319,6 +337,28 @@ extern osc_value_t drive_power_osc_channel_data(size_t osc_channel, size_t index
  */
 extern err_t drive_power_osc_channel_get(size_t osc_channel, drive_power_osc_channel_t* osc);
 
+/**
+ * Получает число точек тренда, записанных с момента включения.
+ * @return Число точек тренда.
+ */
+extern uint32_t drive_power_osc_trend_count(void);
+
+/**
+ * Получает период точек тренда -
+ * измеренный период сети.
+ * @return Период точек тренда в мкс.
+ */
+extern uint32_t drive_power_osc_trend_period_us(void);
+
+/**
+ * Получает точку тренда с заданным номером.
+ * В буфере доступны последние DRIVE_POWER_OSC_TREND_BUF_LEN - 1 точек.
+ * @param number Номер точки.
+ * @param point Точка тренда.
+ * @return Код ошибки.
+ */
+extern err_t drive_power_osc_trend_point_get(uint32_t number, drive_power_osc_trend_point_t* point);
+
 /**
  * Преобразует значение fixed32_t в значение осциллограммы.
  * @param value Значение fixed32_t.
@@ -340,12 +380,13 @@ ALWAYS_INLINE static fixed32_t drive_power_osc_value_to_fixed32(osc_value_t valu
 }
 
 /**
- * Обрабатывает очередные значения АЦП.
+ * Обрабатывает очередной блок кадров значений АЦП.
  * @param channels Маска каналов АЦП.
  * @param adc_values Значения АЦП.
+ * @param frames_count Число кадров.
  * @return Код ошибки.
  */
-extern err_t drive_power_process_adc_values(power_channels_t channels, uint16_t* adc_values);
+extern err_t drive_power_process_adc_values(power_channels_t channels, uint16_t* adc_values, size_t frames_count);
 
 /**
  * Обрабатывает накопленные данные АЦП.
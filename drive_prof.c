@@ -0,0 +1,265 @@
+#include "drive_prof.h"
+#include <string.h>
+#include <sys/time.h>
+#include "utils/critical.h"
+#include "settings.h"
+
+
+//! Максимальное значение счётчика гистограммы.
+#define DRIVE_PROF_HIST_COUNT_MAX 0xffff
+
+//! Максимальное сырое значение параметра.
+#define DRIVE_PROF_PARAM_RAW_MAX 0xffff
+
+//! Макрос для обновления сырого значения параметра с насыщением.
+#define DRIVE_PROF_UPDATE_PARAM_RAW(PARAM, VALUE)\
+    do {\
+        if(PARAM) settings_param_set_value_raw(PARAM,\
+                (param_data_t)(((VALUE) > DRIVE_PROF_PARAM_RAW_MAX) ? DRIVE_PROF_PARAM_RAW_MAX : (VALUE)));\
+    }while(0)
+
+//! Тип данных измерений участка.
+typedef struct _Drive_Prof_Data {
+    uint32_t count; //!< Число измерений.
+    uint32_t min; //!< Минимальное время, такты.
+    uint32_t max; //!< Максимальное время, такты.
+    uint64_t sum; //!< Суммарное время, такты.
+    uint16_t hist[DRIVE_PROF_HIST_SIZE]; //!< Гистограмма времени.
+} drive_prof_data_t;
+
+//! Тип параметров участка.
+typedef struct _Drive_Prof_Params {
+    param_t* param_max; //!< Максимальное время.
+    param_t* param_p99; //!< 99-й процентиль времени.
+    param_t* param_load; //!< Загрузка процессора.
+} drive_prof_params_t;
+
+//! Тип профилирования.
+typedef struct _Drive_Prof {
+    drive_prof_data_t data[DRIVE_PROF_SECTIONS_COUNT]; //!< Данные измерений.
+    uint64_t load_sum[DRIVE_PROF_SECTIONS_COUNT]; //!< Суммарное время на момент вычисления загрузки.
+    uint32_t load[DRIVE_PROF_SECTIONS_COUNT]; //!< Загрузка процессора, % * 10.
+    struct timeval load_time; //!< Время вычисления загрузки.
+    drive_prof_params_t params[DRIVE_PROF_SECTIONS_COUNT]; //!< Параметры.
+} drive_prof_t;
+
+//! Профилирование.
+static drive_prof_t prof;
+
+//! Идентификаторы параметров участков (макс, 99%, загрузка).
+static const param_id_t prof_param_ids[DRIVE_PROF_SECTIONS_COUNT][3] = {
+    {PARAM_ID_PROF_ADC_DMA_IRQ_MAX, PARAM_ID_PROF_ADC_DMA_IRQ_P99, PARAM_ID_PROF_ADC_DMA_IRQ_LOAD},
+    {PARAM_ID_PROF_TRIACS_PAIRS0_IRQ_MAX, PARAM_ID_PROF_TRIACS_PAIRS0_IRQ_P99, PARAM_ID_PROF_TRIACS_PAIRS0_IRQ_LOAD},
+    {PARAM_ID_PROF_TRIAC_EXC_IRQ_MAX, PARAM_ID_PROF_TRIAC_EXC_IRQ_P99, PARAM_ID_PROF_TRIAC_EXC_IRQ_LOAD},
+    {PARAM_ID_PROF_ADC_TASK_MAX, PARAM_ID_PROF_ADC_TASK_P99, PARAM_ID_PROF_ADC_TASK_LOAD},
+    {PARAM_ID_PROF_TRIACS_ITER_MAX, PARAM_ID_PROF_TRIACS_ITER_P99, PARAM_ID_PROF_TRIACS_ITER_LOAD},
+    {PARAM_ID_PROF_SYNC_ITER_MAX, PARAM_ID_PROF_SYNC_ITER_P99, PARAM_ID_PROF_SYNC_ITER_LOAD},
+    {PARAM_ID_PROF_MAIN_ITER_MAX, PARAM_ID_PROF_MAIN_ITER_P99, PARAM_ID_PROF_MAIN_ITER_LOAD},
+    {PARAM_ID_PROF_TRIACS_PAIRS1_IRQ_MAX, PARAM_ID_PROF_TRIACS_PAIRS1_IRQ_P99, PARAM_ID_PROF_TRIACS_PAIRS1_IRQ_LOAD},
+};
+
+
+
+static void drive_prof_data_reset(drive_prof_data_t* data)
+{
+    memset(data, 0x0, sizeof(drive_prof_data_t));
+    data->min = UINT32_MAX;
+}
+
+err_t drive_prof_init(void)
+{
+    memset(&prof, 0x0, sizeof(drive_prof_t));
+
+    size_t i;
+    for(i = 0; i < DRIVE_PROF_SECTIONS_COUNT; i ++){
+        drive_prof_data_reset(&prof.data[i]);
+
+        prof.params[i].param_max = settings_param_by_id(prof_param_ids[i][0]);
+        prof.params[i].param_p99 = settings_param_by_id(prof_param_ids[i][1]);
+        prof.params[i].param_load = settings_param_by_id(prof_param_ids[i][2]);
+    }
+
+    drive_hires_timer_value(&prof.load_time);
+
+    return E_NO_ERROR;
+}
+
+void drive_prof_reset(void)
+{
+    CRITICAL_ENTER();
+
+    size_t i;
+    for(i = 0; i < DRIVE_PROF_SECTIONS_COUNT; i ++){
+        drive_prof_data_reset(&prof.data[i]);
+        prof.load_sum[i] = 0;
+        prof.load[i] = 0;
+    }
+
+    drive_hires_timer_value(&prof.load_time);
+
+    CRITICAL_EXIT();
+}
+
+/**
+ * Получает индекс элемента гистограммы для времени.
+ * Ниже 2^DRIVE_PROF_HIST_MIN_BITS тактов - нулевой элемент,
+ * далее каждая октава делится на 2^DRIVE_PROF_HIST_SUB_BITS элементов.
+ * @param cycles Время в тактах.
+ * @return Индекс элемента гистограммы.
+ */
+static size_t drive_prof_hist_index(uint32_t cycles)
+{
+    if(cycles < (1UL << DRIVE_PROF_HIST_MIN_BITS)) return 0;
+
+    uint32_t msb = 31 - __CLZ(cycles);
+    uint32_t sub = (cycles >> (msb - DRIVE_PROF_HIST_SUB_BITS)) & ((1UL << DRIVE_PROF_HIST_SUB_BITS) - 1);
+
+    size_t index = (((msb - DRIVE_PROF_HIST_MIN_BITS) << DRIVE_PROF_HIST_SUB_BITS) | sub) + 1;
+
+    if(index >= DRIVE_PROF_HIST_SIZE) index = DRIVE_PROF_HIST_SIZE - 1;
+
+    return index;
+}
+
+/**
+ * Получает верхнюю границу элемента гистограммы.
+ * @param index Индекс элемента гистограммы.
+ * @return Верхняя граница времени в тактах.
+ */
+static uint32_t drive_prof_hist_upper(size_t index)
+{
+    if(index == 0) return (1UL << DRIVE_PROF_HIST_MIN_BITS);
+
+    index --;
+
+    uint32_t msb = (index >> DRIVE_PROF_HIST_SUB_BITS) + DRIVE_PROF_HIST_MIN_BITS;
+    uint32_t sub = index & ((1UL << DRIVE_PROF_HIST_SUB_BITS) - 1);
+    uint32_t shift = msb - DRIVE_PROF_HIST_SUB_BITS;
+
+    return ((1UL << DRIVE_PROF_HIST_SUB_BITS) + sub + 1) << shift;
+}
+
+void drive_prof_end(drive_prof_section_t section, uint32_t begin)
+{
+    uint32_t cycles = drive_hires_timer_cycles() - begin;
+
+    drive_prof_data_t* data = &prof.data[section];
+
+    data->count ++;
+    data->sum += cycles;
+
+    if(cycles < data->min) data->min = cycles;
+    if(cycles > data->max) data->max = cycles;
+
+    size_t index = drive_prof_hist_index(cycles);
+
+    // При переполнении счётчика уменьшим вдвое всю гистограмму,
+    // распределение при этом сохраняется.
+    if(data->hist[index] == DRIVE_PROF_HIST_COUNT_MAX){
+        size_t i;
+        for(i = 0; i < DRIVE_PROF_HIST_SIZE; i ++){
+            data->hist[i] >>= 1;
+        }
+    }
+
+    data->hist[index] ++;
+}
+
+/**
+ * Переводит такты в десятые доли микросекунды.
+ * @param cycles Такты.
+ * @return Время, мкс * 10.
+ */
+static uint32_t drive_prof_cycles_to_us10(uint64_t cycles)
+{
+    return (uint32_t)((cycles * 10) / drive_hires_timer_cycles_per_us());
+}
+
+void drive_prof_update(void)
+{
+    struct timeval tv_now, tv_dt;
+    uint64_t sum[DRIVE_PROF_SECTIONS_COUNT];
+    size_t i;
+
+    CRITICAL_ENTER();
+
+    drive_hires_timer_value(&tv_now);
+    for(i = 0; i < DRIVE_PROF_SECTIONS_COUNT; i ++){
+        sum[i] = prof.data[i].sum;
+    }
+
+    CRITICAL_EXIT();
+
+    timersub(&tv_now, &prof.load_time, &tv_dt);
+    prof.load_time = tv_now;
+
+    uint64_t dt_us = (uint64_t)tv_dt.tv_sec * 1000000 + tv_dt.tv_usec;
+    uint64_t dt_cycles = dt_us * drive_hires_timer_cycles_per_us();
+
+    drive_prof_stat_t stat;
+
+    for(i = 0; i < DRIVE_PROF_SECTIONS_COUNT; i ++){
+        if(dt_cycles != 0){
+            prof.load[i] = (uint32_t)(((sum[i] - prof.load_sum[i]) * 1000) / dt_cycles);
+        }
+        prof.load_sum[i] = sum[i];
+
+        if(drive_prof_stat((drive_prof_section_t)i, &stat) != E_NO_ERROR) continue;
+
+        DRIVE_PROF_UPDATE_PARAM_RAW(prof.params[i].param_max, stat.max);
+        DRIVE_PROF_UPDATE_PARAM_RAW(prof.params[i].param_p99, stat.p99);
+        DRIVE_PROF_UPDATE_PARAM_RAW(prof.params[i].param_load, stat.load);
+    }
+}
+
+err_t drive_prof_stat(drive_prof_section_t section, drive_prof_stat_t* stat)
+{
+    if(stat == NULL) return E_NULL_POINTER;
+    if(section >= DRIVE_PROF_SECTIONS_COUNT) return E_INVALID_VALUE;
+
+    drive_prof_data_t data;
+
+    CRITICAL_ENTER();
+    memcpy(&data, &prof.data[section], sizeof(drive_prof_data_t));
+    CRITICAL_EXIT();
+
+    stat->count = data.count;
+    stat->load = prof.load[section];
+
+    if(data.count == 0){
+        stat->min = 0;
+        stat->max = 0;
+        stat->mean = 0;
+        stat->p99 = 0;
+        return E_NO_ERROR;
+    }
+
+    stat->min = drive_prof_cycles_to_us10(data.min);
+    stat->max = drive_prof_cycles_to_us10(data.max);
+    stat->mean = drive_prof_cycles_to_us10(data.sum / data.count);
+
+    uint32_t total = 0;
+    size_t i;
+    for(i = 0; i < DRIVE_PROF_HIST_SIZE; i ++){
+        total += data.hist[i];
+    }
+
+    // Число измерений, не превышающих 99-й процентиль.
+    uint32_t target = total - total / 100;
+    uint32_t acc = 0;
+    uint32_t p99_cycles = data.max;
+
+    for(i = 0; i < DRIVE_PROF_HIST_SIZE; i ++){
+        acc += data.hist[i];
+        if(acc >= target){
+            p99_cycles = drive_prof_hist_upper(i);
+            break;
+        }
+    }
+
+    if(p99_cycles > data.max) p99_cycles = data.max;
+
+    stat->p99 = drive_prof_cycles_to_us10(p99_cycles);
+
+    return E_NO_ERROR;
+}
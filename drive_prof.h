@@ -0,0 +1,94 @@
+/**
+ * @file drive_prof.h Библиотека профилирования времени выполнения участков кода привода.
+ */
+
+#ifndef DRIVE_PROF_H
+#define DRIVE_PROF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "errors/errors.h"
+#include "defs/defs.h"
+#include "drive_hires_timer.h"
+
+
+//! Тип участка профилирования.
+typedef enum _Drive_Prof_Section {
+    DRIVE_PROF_ADC_DMA_IRQ = 0, //!< Прерывание DMA АЦП.
+    DRIVE_PROF_TRIACS_PAIRS0_IRQ, //!< Прерывание первого таймера пар тиристоров (TIM2).
+    DRIVE_PROF_TRIAC_EXC_IRQ, //!< Прерывание таймера тиристора возбуждения.
+    DRIVE_PROF_ADC_TASK, //!< Обработка данных АЦП в задаче.
+    DRIVE_PROF_TRIACS_ITER, //!< Итерация открытия тиристоров.
+    DRIVE_PROF_SYNC_ITER, //!< Итерация синхронизации с фазами.
+    DRIVE_PROF_MAIN_ITER, //!< Основная итерация привода.
+    DRIVE_PROF_TRIACS_PAIRS1_IRQ //!< Прерывание второго таймера пар тиристоров (TIM3).
+} drive_prof_section_t;
+
+//! Число участков профилирования.
+#define DRIVE_PROF_SECTIONS_COUNT 8
+
+//! Число бит младшего (линейного) диапазона гистограммы.
+#define DRIVE_PROF_HIST_MIN_BITS 6
+//! Число бит разбиения октавы гистограммы.
+#define DRIVE_PROF_HIST_SUB_BITS 2
+//! Число элементов гистограммы.
+#define DRIVE_PROF_HIST_SIZE 64
+
+//! Период обновления загрузки в мс.
+#define DRIVE_PROF_UPDATE_PERIOD_MS 1000
+
+//! Тип статистики участка профилирования.
+typedef struct _Drive_Prof_Stat {
+    uint32_t count; //!< Число измерений.
+    uint32_t min; //!< Минимальное время, мкс * 10.
+    uint32_t max; //!< Максимальное время, мкс * 10.
+    uint32_t mean; //!< Среднее время, мкс * 10.
+    uint32_t p99; //!< 99-й процентиль времени, мкс * 10.
+    uint32_t load; //!< Загрузка процессора, % * 10.
+} drive_prof_stat_t;
+
+
+/**
+ * Инициализирует профилирование.
+ * @return Код ошибки.
+ */
+EXTERN err_t drive_prof_init(void);
+
+/**
+ * Сбрасывает накопленную статистику.
+ */
+EXTERN void drive_prof_reset(void);
+
+/**
+ * Начинает измерение участка.
+ * @return Метка времени начала участка.
+ */
+ALWAYS_INLINE static uint32_t drive_prof_begin(void)
+{
+    return drive_hires_timer_cycles();
+}
+
+/**
+ * Завершает измерение участка.
+ * Участок должен выполняться только из одного контекста
+ * (одного прерывания или одной задачи).
+ * @param section Участок.
+ * @param begin Метка времени начала участка.
+ */
+EXTERN void drive_prof_end(drive_prof_section_t section, uint32_t begin);
+
+/**
+ * Обновляет загрузку процессора и параметры профилирования.
+ * Вызывается с периодом DRIVE_PROF_UPDATE_PERIOD_MS.
+ */
+EXTERN void drive_prof_update(void);
+
+/**
+ * Получает статистику участка.
+ * @param section Участок.
+ * @param stat Статистика.
+ * @return Код ошибки.
+ */
+EXTERN err_t drive_prof_stat(drive_prof_section_t section, drive_prof_stat_t* stat);
+
+#endif /* DRIVE_PROF_H */
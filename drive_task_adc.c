@@ -1,28 +1,30 @@
 #include "drive_task_adc.h"
 #include <FreeRTOS.h>
 #include <task.h>
-#include <timers.h>
-#include <queue.h>
 #include <stddef.h>
 #include <string.h>
+#include "stm32f10x.h"
 #include "drive.h"
 #include "drive_power.h"
+#include "drive_prof.h"
 
 
 #define TASK_ADC_STACK_SIZE (configMINIMAL_STACK_SIZE * 2)
-#define QUEUE_ADC_SIZE 8
 
+//! Число блоков кольцевого буфера (степень двойки).
+#define TASK_ADC_BLOCKS_COUNT 4
+//! Маска индекса блока.
+#define TASK_ADC_BLOCKS_MASK (TASK_ADC_BLOCKS_COUNT - 1)
 
-// Команды задачи.
-//! Сохранение.
-#define TASK_ADC_CMD_SAVE 0
-//! Применение.
-#define TASK_ADC_CMD_APPLY 1
+#if (TASK_ADC_BLOCKS_COUNT & TASK_ADC_BLOCKS_MASK) != 0
+#error TASK_ADC_BLOCKS_COUNT must be a power of two!
+#endif
 
-//! Структура элемента очереди.
-typedef struct _Task_Adc_Cmd {
-    uint16_t data[DRIVE_POWER_ADC_CHANNELS_COUNT];
-} task_adc_cmd_t;
+//! Структура блока кадров данных АЦП.
+typedef struct _Task_Adc_Block {
+    uint16_t data[DRIVE_TASK_ADC_BLOCK_FRAMES_MAX * DRIVE_POWER_ADC_CHANNELS_COUNT]; //!< Кадры.
+    size_t frames_count; //!< Число кадров.
+} task_adc_block_t;
 
 
 typedef struct _Task_Adc {
@@ -30,10 +32,13 @@ typedef struct _Task_Adc {
     StackType_t task_stack[TASK_ADC_STACK_SIZE]; //!< Стэк задачи.
     StaticTask_t task_buffer; //!< Буфер задачи.
     TaskHandle_t task_handle; //!< Идентификатор задачи.
-    // Очередь.
-    task_adc_cmd_t queue_storage[QUEUE_ADC_SIZE]; //!< Данные очереди.
-    StaticQueue_t queue_buffer; //!< Буфер очереди.
-    QueueHandle_t queue_handle; //!< Идентификатор очереди.
+    // Кольцевой буфер блоков.
+    // Один писатель (прерывание DMA) и один читатель (задача),
+    // индексы свободно переполняются, маскируются при доступе.
+    task_adc_block_t blocks[TASK_ADC_BLOCKS_COUNT]; //!< Блоки.
+    volatile uint32_t blocks_head; //!< Индекс записи, изменяется только прерыванием.
+    volatile uint32_t blocks_tail; //!< Индекс чтения, изменяется только задачей.
+    volatile uint32_t overruns; //!< Число потерянных блоков.
 } task_adc_t;
 
 
@@ -52,39 +57,71 @@ err_t drive_task_adc_init(uint32_t priority)
     
     if(adc_task.task_handle == NULL) return E_INVALID_VALUE;
     
-    
-    adc_task.queue_handle = xQueueCreateStatic(QUEUE_ADC_SIZE, sizeof(task_adc_cmd_t),
-                                               (uint8_t*)adc_task.queue_storage, &adc_task.queue_buffer);
-    
-    if(adc_task.queue_handle == NULL) return E_INVALID_VALUE;
-    
     return E_NO_ERROR;
 }
 
-static void adc_task_process_data_impl(task_adc_cmd_t* cmd)
+static void adc_task_process_data_impl(task_adc_block_t* block)
 {
-    drive_process_power_adc_values(DRIVE_POWER_ADC_CHANNELS, cmd->data);
+    uint32_t prof_begin = drive_prof_begin();
+    
+    drive_process_power_adc_values(DRIVE_POWER_ADC_CHANNELS, block->data, block->frames_count);
+    
+    drive_prof_end(DRIVE_PROF_ADC_TASK, prof_begin);
 }
 
 static void adc_task_proc(void* arg)
 {
-    static task_adc_cmd_t cmd;
+    uint32_t tail;
+    
     for(;;){
-        if(xQueueReceive(adc_task.queue_handle, &cmd, portMAX_DELAY) == pdTRUE){
-            adc_task_process_data_impl(&cmd);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        
+        tail = adc_task.blocks_tail;
+        
+        while(tail != adc_task.blocks_head){
+            // Данные блока читаются после индекса записи.
+            __DMB();
+            
+            adc_task_process_data_impl(&adc_task.blocks[tail & TASK_ADC_BLOCKS_MASK]);
+            
+            // Освобождение блока после его обработки.
+            __DMB();
+            
+            tail ++;
+            adc_task.blocks_tail = tail;
         }
     }
 }
 
-err_t drive_task_adc_process_data_isr(uint16_t* adc_data, BaseType_t* pxHigherPriorityTaskWoken)
+uint16_t* drive_task_adc_block_isr(void)
 {
-    task_adc_cmd_t cmd;
-    
-    memcpy(cmd.data, adc_data, sizeof(uint16_t) * DRIVE_POWER_ADC_CHANNELS_COUNT);
+    uint32_t head = adc_task.blocks_head;
     
-    if(xQueueSendToBackFromISR(adc_task.queue_handle, &cmd, pxHigherPriorityTaskWoken) != pdTRUE){
-        return E_OUT_OF_MEMORY;
+    if(head - adc_task.blocks_tail >= TASK_ADC_BLOCKS_COUNT){
+        adc_task.overruns ++;
+        return NULL;
     }
     
-    return E_NO_ERROR;
+    return adc_task.blocks[head & TASK_ADC_BLOCKS_MASK].data;
+}
+
+void drive_task_adc_block_commit_isr(size_t frames_count, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    uint32_t head = adc_task.blocks_head;
+    
+    if(frames_count > DRIVE_TASK_ADC_BLOCK_FRAMES_MAX) frames_count = DRIVE_TASK_ADC_BLOCK_FRAMES_MAX;
+    
+    adc_task.blocks[head & TASK_ADC_BLOCKS_MASK].frames_count = frames_count;
+    
+    // Данные блока должны быть записаны до публикации индекса.
+    __DMB();
+    
+    adc_task.blocks_head = head + 1;
+    
+    vTaskNotifyGiveFromISR(adc_task.task_handle, pxHigherPriorityTaskWoken);
+}
+
+uint32_t drive_task_adc_overruns(void)
+{
+    return adc_task.overruns;
 }
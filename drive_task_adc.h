@@ -6,9 +6,14 @@
 
 #include "errors/errors.h"
 #include <stdint.h>
+#include <stddef.h>
 #include <FreeRTOS.h>
 
 
+//! Максимальное число кадров в блоке данных АЦП.
+#define DRIVE_TASK_ADC_BLOCK_FRAMES_MAX 10
+
+
 /**
  * Создаёт задачу АЦП.
  * @param priority Приоритет.
@@ -17,14 +22,33 @@
 extern err_t drive_task_adc_init(uint32_t priority);
 
 /**
- * Запускает применение настроек.
- * Число данных в массиве должно быть равно
- * DRIVE_POWER_ADC_CHANNELS_COUNT.
- * @param adc_data Данные АЦП.
+ * Получает свободный блок кольцевого буфера
+ * для записи данных АЦП из прерывания.
+ * Блок вмещает до DRIVE_TASK_ADC_BLOCK_FRAMES_MAX
+ * следующих друг за другом кадров, число данных
+ * в кадре равно DRIVE_POWER_ADC_CHANNELS_COUNT.
+ * При заполненном буфере увеличивает
+ * счётчик переполнений.
+ * @return Блок для записи, либо NULL
+ * если буфер заполнен.
+ */
+extern uint16_t* drive_task_adc_block_isr(void);
+
+/**
+ * Передаёт заполненный блок задаче АЦП.
+ * Вызывается только после успешного
+ * получения блока drive_task_adc_block_isr.
+ * @param frames_count Число кадров в блоке.
  * @param pxHigherPriorityTaskWoken Флаг необходимости переключения контекста.
- * @return Код ошибки.
  */
-extern err_t drive_task_adc_process_data_isr(uint16_t* adc_data, BaseType_t* pxHigherPriorityTaskWoken);
+extern void drive_task_adc_block_commit_isr(size_t frames_count, BaseType_t* pxHigherPriorityTaskWoken);
+
+/**
+ * Получает число потерянных из-за
+ * переполнения буфера блоков АЦП.
+ * @return Число потерянных блоков.
+ */
+extern uint32_t drive_task_adc_overruns(void);
 
 
 #endif /* DRIVE_TASK_ADC_H */
@@ -1,5 +1,6 @@
 #include "drive_task_main.h"
 #include "drive.h"
+#include "drive_modbus.h"
 #include <stddef.h>
 #include <string.h>
 #include <FreeRTOS.h>
@@ -38,6 +39,8 @@ static void main_task_proc(void* arg)
         vTaskSuspend(NULL);
         
         drive_process_iter();
+        
+        drive_modbus_update_status();
     }
 }
 
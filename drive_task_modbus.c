@@ -1,4 +1,5 @@
 #include "drive_task_modbus.h"
+#include "drive_modbus.h"
 #include <stddef.h>
 #include <string.h>
 #include <FreeRTOS.h>
@@ -71,6 +72,8 @@ static void modbus_task_proc(void* arg)
             if(cmd.modbus){
                 if(cmd.is_rs485 && modbus_task.rs485_set_out) modbus_task.rs485_set_out();
 
+                drive_modbus_begin_request();
+
                 if(modbus_rtu_dispatch(cmd.modbus) != E_NO_ERROR){
                     if(cmd.is_rs485 && modbus_task.rs485_set_in) modbus_task.rs485_set_in();
                 }
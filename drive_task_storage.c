@@ -17,6 +17,9 @@
 
 #define STORAGE_WAIT 0
 
+//! Период записи тренда в хранилище.
+#define STORAGE_OSC_TREND_WAIT pdMS_TO_TICKS(100)
+
 
 // Команды задачи.
 //! Запись события.
@@ -44,6 +47,7 @@ typedef struct _Write_Event_Cmd {
 //! Запись события с осциллограммой.
 typedef struct _Write_Event_Ocs_Cmd {
     drive_event_t event; //!< Событие.
+    uint32_t trend_number; //!< Номер точки тренда в момент события.
 } write_event_osc_cmd_t;
 //! Чтение события.
 typedef struct _Read_Event_Cmd {
@@ -56,6 +60,7 @@ typedef struct _Read_Osc_Cmd {
     future_t* future; //!< Будущее.
     drive_osc_index_t index; //!< Индекс осциллограммы.
     uint8_t channel; //!< Канал осциллограммы.
+    osc_value_t* data; //!< Буфер для данных канала, NULL - общий буфер событий.
 } read_osc_cmd_t;
 //! Очистка событий.
 typedef struct _Clear_Events_Cmd {
@@ -164,11 +169,32 @@ static void storage_task_write_osc_impl(write_event_osc_cmd_t* cmd)
         return;
     }
     
+    // Тренд дописывается в только что записанную осциллограмму.
+    do {
+        err = drive_events_osc_trend_begin(cmd->trend_number);
+    } while(err == E_BUSY);
+    
+    if(err != E_NO_ERROR){
+        drive_events_osc_trend_cancel();
+    }
+    
     do {
         err = drive_events_write();
     } while(err == E_BUSY);
 }
 
+static void storage_task_osc_trend_impl(void)
+{
+    err_t err = E_NO_ERROR;
+    do {
+        err = drive_events_osc_trend_process();
+    } while(err == E_BUSY);
+    
+    if(err != E_NO_ERROR){
+        drive_events_osc_trend_cancel();
+    }
+}
+
 static void storage_task_read_event_impl(read_event_cmd_t* cmd)
 {
     err_t err = E_NO_ERROR;
@@ -183,7 +209,11 @@ static void storage_task_read_osc_impl(read_osc_cmd_t* cmd)
 {
     err_t err = E_NO_ERROR;
     do {
-        err = drive_events_read_osc_channel(cmd->index, cmd->channel);
+        if(cmd->data){
+            err = drive_events_read_osc_channel_data(cmd->index, cmd->channel, cmd->data);
+        }else{
+            err = drive_events_read_osc_channel(cmd->index, cmd->channel);
+        }
     } while(err == E_BUSY);
     
     if(cmd->future) future_finish(cmd->future, int_to_pvoid(err));
@@ -218,8 +248,12 @@ static void storage_task_save_nvdata_impl(save_nvdata_cmd_t* cmd)
 static void storage_task_proc(void* arg)
 {
     static task_storage_cmd_t cmd;
+    TickType_t wait;
     for(;;){
-        if(xQueueReceive(storage_task.queue_handle, &cmd, portMAX_DELAY) == pdTRUE){
+        // При записи тренда периодически дописываем его в хранилище.
+        wait = drive_events_osc_trend_active() ? STORAGE_OSC_TREND_WAIT : portMAX_DELAY;
+        
+        if(xQueueReceive(storage_task.queue_handle, &cmd, wait) == pdTRUE){
             switch(cmd.type){
                 default:
                     break;
@@ -246,6 +280,10 @@ static void storage_task_proc(void* arg)
                     break;
             }
         }
+        
+        if(drive_events_osc_trend_active()){
+            storage_task_osc_trend_impl();
+        }
     }
 }
 
@@ -258,6 +296,7 @@ err_t drive_task_storage_write_event(drive_event_type_t type, bool need_osc)
     if(need_osc){
         cmd.type = TASK_STORAGE_CMD_WRITE_OSC;
         drive_events_make_event(&cmd.write_event_osc.event, type);
+        cmd.write_event_osc.trend_number = drive_power_osc_trend_count();
         
         portENTER_CRITICAL();
         
@@ -311,12 +350,19 @@ err_t drive_task_storage_read_event(future_t* future, drive_event_index_t event_
 }
 
 err_t drive_task_storage_read_osc_channel(future_t* future, drive_osc_index_t osc_index, size_t osc_channel)
+{
+    return drive_task_storage_read_osc_channel_data(future, osc_index, osc_channel, NULL);
+}
+
+err_t drive_task_storage_read_osc_channel_data(future_t* future, drive_osc_index_t osc_index,
+                                               size_t osc_channel, osc_value_t* data)
 {
     task_storage_cmd_t cmd;
     cmd.type = TASK_STORAGE_CMD_READ_OSC;
     cmd.read_osc.future = future;
     cmd.read_osc.index = osc_index;
     cmd.read_osc.channel = (uint8_t)osc_channel;
+    cmd.read_osc.data = data;
     
     if(xQueueSendToBack(storage_task.queue_handle, &cmd, STORAGE_WAIT) != pdTRUE){
         return E_OUT_OF_MEMORY;
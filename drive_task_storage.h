@@ -63,6 +63,17 @@ extern err_t drive_task_storage_read_event(future_t* future, drive_event_index_t
  */
 extern err_t drive_task_storage_read_osc_channel(future_t* future, drive_osc_index_t osc_index, size_t osc_channel);
 
+/**
+ * Читает канал осциллограммы в заданный буфер.
+ * @param future Будущее.
+ * @param osc_index Индекс осциллограммы.
+ * @param osc_channel Канал осциллограммы.
+ * @param data Буфер размером DRIVE_POWER_OSC_CHANNEL_SIZE.
+ * @return Код ошибки.
+ */
+extern err_t drive_task_storage_read_osc_channel_data(future_t* future, drive_osc_index_t osc_index,
+                                                      size_t osc_channel, osc_value_t* data);
+
 /**
  * Очищает события.
  */
@@ -7,6 +7,8 @@
 #include <string.h>
 #include "drive_temp.h"
 #include "drive_task_storage.h"
+#include "drive_prof.h"
+#include "settings.h"
 
 
 
@@ -19,10 +21,13 @@
 #define TASK_UTILS_WAIT 0
 
 // Число таймеров.
-#define TIMERS_COUNT 1
+#define TIMERS_COUNT 2
 // Таймер записи наработки.
 #define TIMER_NVDATA 0
 #define TIMER_NVDATA_PERIOD_MS (60*60*1000)
+// Таймер обновления профилирования.
+#define TIMER_PROF 1
+#define TIMER_PROF_PERIOD_MS DRIVE_PROF_UPDATE_PERIOD_MS
 
 // Команды задачи.
 //! Применение настроек.
@@ -53,6 +58,7 @@ static task_utils_t utils_task;
 
 
 static void utils_task_nvdata_proc(void*);
+static void utils_task_prof_proc(void*);
 static void utils_task_proc(void*);
 
 err_t drive_task_utils_init(uint32_t priority)
@@ -77,6 +83,13 @@ err_t drive_task_utils_init(uint32_t priority)
     if(utils_task.timer_handle[TIMER_NVDATA] == NULL) return E_INVALID_VALUE;
     if(xTimerStart(utils_task.timer_handle[TIMER_NVDATA], 0) != pdPASS) return E_STATE;
     
+    
+    utils_task.timer_handle[TIMER_PROF] = xTimerCreateStatic("prof_timer", pdMS_TO_TICKS(TIMER_PROF_PERIOD_MS),
+                                                  pdTRUE, NULL, utils_task_prof_proc, &utils_task.timer_buffer[TIMER_PROF]);
+    
+    if(utils_task.timer_handle[TIMER_PROF] == NULL) return E_INVALID_VALUE;
+    if(xTimerStart(utils_task.timer_handle[TIMER_PROF], 0) != pdPASS) return E_STATE;
+    
     return E_NO_ERROR;
 }
 
@@ -87,6 +100,10 @@ void drive_task_utils_set_reset_ui_callback(drive_task_utils_callback_t callback
 
 static void utils_task_apply_impl(void)
 {
+    // Модули с подпиской обновляются только по изменению их параметров,
+    // остальные - при изменении любых прочих параметров.
+    if(!settings_apply_changes()) return;
+    
     drive_update_settings();
     drive_temp_update_settings();
 }
@@ -124,6 +141,13 @@ void utils_task_nvdata_proc(void* arg)
     drive_task_storage_save_nvdata();
 }
 
+void utils_task_prof_proc(void* arg)
+{
+    (void) arg;
+    
+    drive_prof_update();
+}
+
 err_t drive_task_settings_apply(void)
 {
     uint8_t cmd = TASK_UTILS_CMD_APPLY_SETTINGS;
@@ -64,6 +64,12 @@ err_t drive_tasks_read_osc_channel(future_t* future, drive_osc_index_t osc_index
     return drive_task_storage_read_osc_channel(future, osc_index, osc_channel);
 }
 
+err_t drive_tasks_read_osc_channel_data(future_t* future, drive_osc_index_t osc_index,
+                                        size_t osc_channel, osc_value_t* data)
+{
+    return drive_task_storage_read_osc_channel_data(future, osc_index, osc_channel, data);
+}
+
 err_t drive_tasks_clear_events(void)
 {
     return drive_task_storage_clear_events();
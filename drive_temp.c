@@ -53,6 +53,14 @@ typedef struct _Drive_Temp {
 //! Температура привода.
 static drive_temp_t drive_temp;
 
+//! Параметры управления вентиляторами.
+static settings_handle_t drive_temp_handles[] = {
+    SETTINGS_HANDLE_RANGE(PARAM_ID_FAN_CONTROL_ENABLE, PARAM_ID_FAN_ECO_COOLING_TIME)
+};
+
+//! Подписка на изменение параметров управления вентиляторами.
+SETTINGS_SUBSCRIPTION(drive_temp_subscription, drive_temp_handles, drive_temp_update_settings);
+
 
 
 ALWAYS_INLINE static fixed32_t fixed16_to_32(fixed16_t f)
@@ -98,6 +106,8 @@ err_t drive_temp_init(drive_temp_init_t* temp_is)
     
     drive_temp_update_settings();
     
+    RETURN_ERR_IF_FAIL(settings_subscribe(&drive_temp_subscription));
+    
     drive_temp.heatsink_temp_param = settings_param_by_id(PARAM_ID_HEATSINK_TEMP);
     drive_temp.heatsink_fan_rpm_param = settings_param_by_id(PARAM_ID_HEATSINK_FAN_RPM);
     
@@ -2,6 +2,8 @@
 #include <string.h>
 #include "defs/defs.h"
 #include "utils/utils.h"
+#include "utils/critical.h"
+#include "dma/dma.h"
 #include "triac.h"
 #include "triac_pair.h"
 
@@ -9,29 +11,24 @@
 
 //! Минимальный угол открытия тиристоров в тиках таймера.
 #define TRIACS_TIM_MIN_TICKS (1)
-//! Максимальный угол открытия тиристоров в тиках таймера.
-#define TRIACS_TIM_MAX_TICKS (TRIACS_TIM_TICKS / 3)
 //! Максимальный угол открытия тиристоров.
 #define TRIACS_TIM_MAX_TICKS_ANGLE (360 / 3)
-//! Смещение между первой и второй парой тиристоров.
-#define TRIACS_TIM_OFFSET (TRIACS_TIM_MAX_TICKS / 2)
 
 
 //! Минимальное число тиков таймера для открытия симистора возбуждения.
 #define TRIAC_EXC_MIN_TICKS (1)
-//! Минимальный угол включения симистора возбуждения в тиках таймера.
-#define TRIAC_EXC_MAX_TICKS (TRIAC_EXC_TIM_TICKS / 2)
 //! Минимальный угол включения симистора возбуждения.
 #define TRIAC_EXC_MAX_TICKS_ANGLE (360 / 2)
-//! Смещение между полупериодами.
-#define TRIAC_EXC_TIM_HALF_CYCLE_OFFSET (TRIAC_EXC_TIM_TICKS / 2)
-//! Смещение до начала периода.
-#define TRIAC_EXC_OFFSET (TRIAC_EXC_TIM_TICKS * 30 / 360)
+//! Смещение до начала периода в градусах.
+#define TRIAC_EXC_OFFSET_ANGLE (30)
 
 
 //! Максимальный коэффициент заполнения гребёнки.
 #define TRIACS_PULSE_TRAIN_DUTY_RATIO_MAX (0x8000) // 0.5f
 
+//! Значение сравнения, недостижимое счётчиком таймера.
+#define TRIACS_TIM_NO_COMPARE (0xffff)
+
 
 // Смещения в массивах последовательностей направления для датчиков нуля.
 //! Датчик нуля фазы A.
@@ -68,13 +65,41 @@ typedef struct _Timer_Triacs {
     //triac_pair_number_t triacs_b; //!< Пара тиристоров B.
     uint16_t pulse_train_remain; //!< Оставшееся время гребёнки.
     int16_t pulse_train_offset; //!< Смещение импульса открытия.
+    DMA_Channel_TypeDef* dma_channel; //!< Канал DMA гребёнки.
+    uint32_t dma_flags; //!< Флаги канала DMA.
+    bool dma_active; //!< Флаг передачи гребёнки по DMA.
+    uint16_t dma_slot_ticks; //!< Длительность слота гребёнки в тиках таймера.
+    uint16_t dma_slots; //!< Число слотов гребёнки.
+    uint32_t dma_bsrr[TRIACS_PULSE_TRAIN_DMA_SLOTS_MAX]; //!< Значения регистра BSRR слотов гребёнки.
 } timer_triacs_t;
 
+/**
+ * Тип предварительно вычисленного открытия.
+ * Значения сравнения вычисляются без учёта времени,
+ * прошедшего с начала сектора таймера нуля,
+ * которое вычитается при запуске таймера.
+ */
+typedef struct _Triacs_Fire {
+    bool pending; //!< Флаг ожидания запуска таймера.
+    triac_pair_number_t pair; //!< Пара тиристоров.
+    int32_t limit_ticks; //!< Предельное время до запуска в тиках таймера.
+    int32_t open_ticks; //!< Значение сравнения открытия.
+    int32_t close_ticks; //!< Значение сравнения закрытия.
+    int32_t pt_offset_ticks; //!< Смещение открытия гребёнки.
+    bool pt_dma; //!< Флаг гребёнки, вычисленной для передачи по DMA.
+} triacs_fire_t;
+
 //! Тип структуры тиристоров привода.
 typedef struct _Drive_Triacs {
     bool pairs_enabled; //!< Разрешение подачи импульсов на тиристорные пары.
     bool exc_enabled; //!< Разрешение подачи импульсов на симистор возбуждения.
     
+    uint16_t period_ticks; //!< Период сети в тиках таймера.
+    uint16_t pairs_max_ticks; //!< Максимальный угол открытия тиристоров в тиках таймера.
+    uint16_t exc_max_ticks; //!< Максимальный угол включения симистора возбуждения в тиках таймера.
+    uint16_t exc_half_cycle_ticks; //!< Смещение между полупериодами в тиках таймера.
+    uint16_t exc_offset_ticks; //!< Смещение до начала периода в тиках таймера.
+    
     fixed32_t triacs_pairs_min_angle; //!< Минимальный угол открытия тиристорных пар.
     fixed32_t triacs_pairs_max_angle; //!< Максимальный угол открытия тиристорных пар.
     
@@ -95,6 +120,8 @@ typedef struct _Drive_Triacs {
 
     bool triacs_pairs_pt_enabled; //!< Разрешение гребёнки тиристорных пар.
     bool triac_exc_pt_enabled; //!< Разрешение гребёнки симистора возбуждения.
+    drive_triacs_pulse_train_mode_t triacs_pairs_pt_mode; //!< Режим формирования гребёнки тиристорных пар.
+    uint32_t triacs_pairs_pt_dma_fallbacks; //!< Число открытий в режиме DMA, выполненных в прерываниях.
 
     fixed32_t triacs_pairs_pt_width; //!< Длина гребёнки тиристорных пар.
     uint16_t triacs_pairs_pt_width_ticks; //!< Длина гребёнки тиристорных пар в тиках таймера.
@@ -115,6 +142,8 @@ typedef struct _Drive_Triacs {
     triac_t triac_exc; //!< Тиристор возбуждения.
     
     timer_triacs_t timers_triacs[TRIACS_TIMERS_COUNT]; //!< Тиристоры таймеров и таймеры.
+    triacs_fire_t pairs_fire; //!< Открытие тиристорных пар.
+    triacs_fire_t exc_fire; //!< Открытие симистора возбуждения.
     size_t current_timer_triacs; //!< Текущий индекс таймеров тиристоров.
     
     TIM_TypeDef* timer_exc; //!< Таймер для открытия симистора возбуждения.
@@ -134,17 +163,92 @@ typedef struct _Drive_Triacs {
 static drive_triacs_t drive_triacs;
 
 
+/**
+ * Вычисляет длительности углов в тиках таймеров
+ * для заданного периода сети.
+ * @param period_ticks Период сети в тиках таймера.
+ */
+static void drive_triacs_set_period_ticks(uint16_t period_ticks)
+{
+    drive_triacs.period_ticks = period_ticks;
+    drive_triacs.pairs_max_ticks = period_ticks / 3;
+    drive_triacs.exc_max_ticks = period_ticks / 2;
+    drive_triacs.exc_half_cycle_ticks = period_ticks / 2;
+    drive_triacs.exc_offset_ticks = (uint32_t)period_ticks * TRIAC_EXC_OFFSET_ANGLE / 360;
+}
+
+/**
+ * Переводит угол тиристорных пар в тики таймера.
+ * @param angle Угол.
+ * @return Тики таймера.
+ */
+ALWAYS_INLINE static uint16_t pairs_angle_to_ticks(fixed32_t angle)
+{
+    angle /= TRIACS_TIM_MAX_TICKS_ANGLE;
+    return fixed32_mul(angle, drive_triacs.pairs_max_ticks);
+}
+
+/**
+ * Переводит угол симистора возбуждения в тики таймера.
+ * @param angle Угол.
+ * @return Тики таймера.
+ */
+ALWAYS_INLINE static uint16_t exc_angle_to_ticks(fixed32_t angle)
+{
+    angle /= TRIAC_EXC_MAX_TICKS_ANGLE;
+    return fixed32_mul(angle, drive_triacs.exc_max_ticks);
+}
+
+/**
+ * Проверяет, передаётся ли гребёнка таймера по DMA.
+ * @param tim_triacs Таймер тиристоров.
+ * @return Флаг передачи гребёнки.
+ */
+ALWAYS_INLINE static bool timer_triacs_dma_busy(timer_triacs_t* tim_triacs)
+{
+    return tim_triacs->dma_active && tim_triacs->dma_channel->CNDTR != 0;
+}
+
+/**
+ * Останавливает передачу гребёнки по DMA,
+ * освобождает канал DMA и возвращает таймер
+ * в режим одного импульса.
+ * @param tim_triacs Таймер тиристоров.
+ */
+static void timer_triacs_dma_stop(timer_triacs_t* tim_triacs)
+{
+    if(!tim_triacs->dma_active) return;
+    
+    TIM_TypeDef* TIM = tim_triacs->timer;
+    
+    TIM_Cmd(TIM, DISABLE);
+    TIM_DMACmd(TIM, TIM_DMA_Update, DISABLE);
+    TIM_ITConfig(TIM, TRIACS_A_CLOSE_CHANNEL_IT, DISABLE);
+    TIM_OC2PreloadConfig(TIM, TIM_OCPreload_Disable);
+    TIM_ARRPreloadConfig(TIM, DISABLE);
+    TIM_SetAutoreload(TIM, drive_triacs.period_ticks - 1);
+    TIM_SelectOnePulseMode(TIM, TIM_OPMode_Single);
+    
+    tim_triacs->dma_channel->CCR &= ~(DMA_CCR1_TCIE | DMA_CCR1_EN);
+    DMA_ClearFlag(tim_triacs->dma_flags);
+    dma_channel_unlock(tim_triacs->dma_channel);
+    
+    tim_triacs->dma_active = false;
+}
+
 
 err_t drive_triacs_init(void)
 {
     memset(&drive_triacs, 0x0, sizeof(drive_triacs_t));
     
+    drive_triacs_set_period_ticks(TRIACS_TIM_TICKS);
+    
     drive_triacs.triacs_pairs_min_angle = TRIACS_PAIRS_ANGLE_MIN_F;
     drive_triacs.triacs_pairs_max_angle = TRIACS_PAIRS_ANGLE_MAX_F;
     
     drive_triacs.triac_exc_min_angle = TRIAC_EXC_ANGLE_MIN_F;
     drive_triacs.triac_exc_max_angle = TRIAC_EXC_ANGLE_MAX_F;
-    drive_triacs.triac_exc_max_angle_ticks = TRIAC_EXC_MAX_TICKS;
+    drive_triacs.triac_exc_max_angle_ticks = drive_triacs.exc_max_ticks;
     
     drive_triacs.triacs_pairs_open_ticks = TRIACS_TIM_OPEN_TIME_DEFAULT;
     drive_triacs.triac_exc_open_ticks = TRIAC_EXC_TIM_OPEN_TIME_DEFAULT;
@@ -246,6 +350,25 @@ void drive_triacs_set_pairs_enabled(bool enabled)
 {
     if(enabled && !drive_triacs.pairs_enabled) drive_triacs.last_opened_pair = TRIAC_PAIR_NONE;
     drive_triacs.pairs_enabled = enabled;
+    
+    // Гребёнку по DMA прерывания не остановят.
+    if(!enabled){
+        CRITICAL_ENTER();
+        
+        size_t i;
+        for(i = 0; i < TRIACS_TIMERS_COUNT; i ++){
+            timer_triacs_t* tim_triacs = &drive_triacs.timers_triacs[i];
+            if(!tim_triacs->dma_active) continue;
+            
+            timer_triacs_dma_stop(tim_triacs);
+            
+            if(TRIAC_PAIR_VALID(tim_triacs->triacs_a)){
+                triac_pair_close(&drive_triacs.triac_pairs[tim_triacs->triacs_a]);
+            }
+        }
+        
+        CRITICAL_EXIT();
+    }
 }
 
 bool drive_triacs_exc_enabled(void)
@@ -293,6 +416,7 @@ static void drive_triacs_stop_timers(void)
 {
     size_t i;
     for(i = 0; i < TRIACS_TIMERS_COUNT; i ++) {
+        timer_triacs_dma_stop(&drive_triacs.timers_triacs[i]);
         TIM_Cmd(drive_triacs.timers_triacs[i].timer, DISABLE);
     }
     TIM_Cmd(drive_triacs.timer_exc, DISABLE);
@@ -363,8 +487,7 @@ err_t drive_triacs_clamp_exc_open_angle(fixed32_t angle_min, fixed32_t angle_max
     drive_triacs.triac_exc_min_angle = angle_min;
     drive_triacs.triac_exc_max_angle = angle_max;
     
-    angle_max /= TRIAC_EXC_MAX_TICKS_ANGLE;
-    drive_triacs.triac_exc_max_angle_ticks = fixed32_mul(angle_max, TRIAC_EXC_MAX_TICKS);
+    drive_triacs.triac_exc_max_angle_ticks = exc_angle_to_ticks(angle_max);
 
     return err;
 }
@@ -394,8 +517,7 @@ err_t drive_triacs_set_pairs_open_angle(fixed32_t angle)
     
     drive_triacs.triacs_pairs_open_angle = angle;
     
-    angle /= TRIACS_TIM_MAX_TICKS_ANGLE;
-    drive_triacs.triacs_pairs_angle_ticks = fixed32_mul(angle, TRIACS_TIM_MAX_TICKS);
+    drive_triacs.triacs_pairs_angle_ticks = pairs_angle_to_ticks(angle);
     return err;
 }
 
@@ -427,8 +549,7 @@ err_t drive_triacs_set_exc_open_angle(fixed32_t angle)
     
     drive_triacs.triac_exc_open_angle = angle;
     
-    angle /= TRIAC_EXC_MAX_TICKS_ANGLE;
-    drive_triacs.triac_exc_angle_ticks = fixed32_mul(angle, TRIAC_EXC_MAX_TICKS);
+    drive_triacs.triac_exc_angle_ticks = exc_angle_to_ticks(angle);
     return err;
 }
 
@@ -494,6 +615,26 @@ void drive_triacs_set_pairs_pulse_train_enabled(bool enabled)
     drive_triacs.triacs_pairs_pt_enabled = enabled;
 }
 
+drive_triacs_pulse_train_mode_t drive_triacs_pairs_pulse_train_mode(void)
+{
+    return drive_triacs.triacs_pairs_pt_mode;
+}
+
+void drive_triacs_set_pairs_pulse_train_mode(drive_triacs_pulse_train_mode_t mode)
+{
+    drive_triacs.triacs_pairs_pt_mode = mode;
+}
+
+uint32_t drive_triacs_pairs_pulse_train_dma_fallbacks(void)
+{
+    return drive_triacs.triacs_pairs_pt_dma_fallbacks;
+}
+
+void drive_triacs_reset_pairs_pulse_train_dma_fallbacks(void)
+{
+    drive_triacs.triacs_pairs_pt_dma_fallbacks = 0;
+}
+
 bool drive_triacs_exc_pulse_train_enabled(void)
 {
     return drive_triacs.triac_exc_pt_enabled;
@@ -518,8 +659,7 @@ void drive_triacs_set_pairs_pulse_train_width(fixed32_t width)
 
     drive_triacs.triacs_pairs_pt_width = width;
 
-    width /= TRIACS_TIM_MAX_TICKS_ANGLE;
-    drive_triacs.triacs_pairs_pt_width_ticks = fixed32_mul(width, TRIACS_TIM_MAX_TICKS);
+    drive_triacs.triacs_pairs_pt_width_ticks = pairs_angle_to_ticks(width);
 }
 
 fixed32_t drive_triacs_exc_pulse_train_width(void)
@@ -536,8 +676,7 @@ void drive_triacs_set_exc_pulse_train_width(fixed32_t width)
 
     drive_triacs.triac_exc_pt_width = width;
 
-    width /= TRIAC_EXC_MAX_TICKS_ANGLE;
-    drive_triacs.triac_exc_pt_width_ticks = fixed32_mul(width, TRIAC_EXC_MAX_TICKS);
+    drive_triacs.triac_exc_pt_width_ticks = exc_angle_to_ticks(width);
 }
 
 fixed32_t drive_triacs_pairs_pulse_train_duty_ratio(void)
@@ -593,8 +732,7 @@ void drive_triacs_set_pairs_pulse_train_angle_min(fixed32_t angle_min)
 
     drive_triacs.triacs_pairs_pt_angle_min = angle_min;
 
-    angle_min /= TRIACS_TIM_MAX_TICKS_ANGLE;
-    drive_triacs.triacs_pairs_pt_angle_min_ticks = fixed32_mul(angle_min, TRIACS_TIM_MAX_TICKS);
+    drive_triacs.triacs_pairs_pt_angle_min_ticks = pairs_angle_to_ticks(angle_min);
 }
 
 fixed32_t drive_triacs_exc_pulse_train_angle_min(void)
@@ -608,8 +746,7 @@ void drive_triacs_set_exc_pulse_train_angle_min(fixed32_t angle_min)
 
     drive_triacs.triac_exc_pt_angle_min = angle_min;
 
-    angle_min /= TRIAC_EXC_MAX_TICKS_ANGLE;
-    drive_triacs.triac_exc_pt_angle_min_ticks = fixed32_mul(angle_min, TRIAC_EXC_MAX_TICKS);
+    drive_triacs.triac_exc_pt_angle_min_ticks = exc_angle_to_ticks(angle_min);
 }
 
 phase_t drive_triacs_exc_phase(void)
@@ -647,6 +784,17 @@ err_t drive_triacs_set_pairs_timer(size_t index, TIM_TypeDef* TIM)
     return E_NO_ERROR;
 }
 
+err_t drive_triacs_set_pairs_timer_dma(size_t index, DMA_Channel_TypeDef* dma_channel, uint32_t dma_flags)
+{
+    if(index >= TRIACS_TIMERS_COUNT) return E_OUT_OF_RANGE;
+    if(dma_channel == NULL) return E_NULL_POINTER;
+    
+    drive_triacs.timers_triacs[index].dma_channel = dma_channel;
+    drive_triacs.timers_triacs[index].dma_flags = dma_flags;
+    
+    return E_NO_ERROR;
+}
+
 err_t drive_triacs_set_exc_timer(TIM_TypeDef* TIM)
 {
     if(TIM == NULL) return E_NULL_POINTER;
@@ -656,6 +804,39 @@ err_t drive_triacs_set_exc_timer(TIM_TypeDef* TIM)
     return E_NO_ERROR;
 }
 
+void drive_triacs_set_period_us(uint16_t period_us)
+{
+    uint16_t period_ticks = TIME_TO_TICKS(period_us);
+    
+    if(drive_triacs.period_ticks == period_ticks) return;
+    
+    drive_triacs_set_period_ticks(period_ticks);
+    
+    // Таймеры работают в режиме одного импульса,
+    // период ограничивает каналы сравнения.
+    // Период таймеров с гребёнкой по DMA
+    // восстанавливается при её остановке.
+    size_t i;
+    for(i = 0; i < TRIACS_TIMERS_COUNT; i ++){
+        if(drive_triacs.timers_triacs[i].dma_active) continue;
+        if(drive_triacs.timers_triacs[i].timer){
+            TIM_SetAutoreload(drive_triacs.timers_triacs[i].timer, period_ticks - 1);
+        }
+    }
+    if(drive_triacs.timer_exc){
+        TIM_SetAutoreload(drive_triacs.timer_exc, period_ticks - 1);
+    }
+    
+    // Пересчитаем углы в тики таймеров.
+    drive_triacs.triac_exc_max_angle_ticks = exc_angle_to_ticks(drive_triacs.triac_exc_max_angle);
+    drive_triacs.triacs_pairs_angle_ticks = pairs_angle_to_ticks(drive_triacs.triacs_pairs_open_angle);
+    drive_triacs.triac_exc_angle_ticks = exc_angle_to_ticks(drive_triacs.triac_exc_open_angle);
+    drive_triacs.triacs_pairs_pt_width_ticks = pairs_angle_to_ticks(drive_triacs.triacs_pairs_pt_width);
+    drive_triacs.triac_exc_pt_width_ticks = exc_angle_to_ticks(drive_triacs.triac_exc_pt_width);
+    drive_triacs.triacs_pairs_pt_angle_min_ticks = pairs_angle_to_ticks(drive_triacs.triacs_pairs_pt_angle_min);
+    drive_triacs.triac_exc_pt_angle_min_ticks = exc_angle_to_ticks(drive_triacs.triac_exc_pt_angle_min);
+}
+
 /**
  * Получает таймер тиристоров с заданным номером.
  * @param n Номер таймера тиристоров.
@@ -687,6 +868,18 @@ static timer_triacs_t* timer_triacs_next(void)
     return timer_triacs_current();
 }
 
+/**
+ * Получает следующий таймер тиристоров
+ * без его установки.
+ * @return Следующий таймер тиристоров.
+ */
+ALWAYS_INLINE static timer_triacs_t* timer_triacs_peek_next(void)
+{
+    size_t index = drive_triacs.current_timer_triacs + 1;
+    if(index >= TRIACS_TIMERS_COUNT) index = 0;
+    return &drive_triacs.timers_triacs[index];
+}
+
 ALWAYS_INLINE static void drive_triacs_on_open_pair(void)
 {
     if(drive_triacs.open_pair_callback) drive_triacs.open_pair_callback(drive_triacs.last_opened_pair);
@@ -695,6 +888,7 @@ ALWAYS_INLINE static void drive_triacs_on_open_pair(void)
 static void drive_triacs_pairs_pulse_train_setup_next(timer_triacs_t* tim_triacs)
 {
     if(!drive_triacs.triacs_pairs_pt_enabled) return;
+    if(tim_triacs->dma_active) return;
 
     uint16_t cur_ticks = TIM_GetCounter(tim_triacs->timer);
     uint16_t pulse = drive_triacs.triacs_pairs_open_ticks + drive_triacs.triacs_pairs_pt_open_delta;
@@ -706,7 +900,7 @@ static void drive_triacs_pairs_pulse_train_setup_next(timer_triacs_t* tim_triacs
     uint16_t next_open_pulse = cur_ticks + drive_triacs.triacs_pairs_pt_open_delta;
     uint16_t next_close_pulse = cur_ticks + pulse;
 
-    if(next_close_pulse < TRIACS_TIM_MAX_TICKS -
+    if(next_close_pulse < drive_triacs.pairs_max_ticks -
             drive_triacs.triacs_pairs_pt_angle_min_ticks - tim_triacs->pulse_train_offset){
         TIM_SetCompare1(tim_triacs->timer, next_open_pulse);
         TIM_SetCompare2(tim_triacs->timer, next_close_pulse);
@@ -782,6 +976,27 @@ void drive_triacs_timer1_irq_handler(void)
     drive_triacs_timer_irq_handler_impl(tim_triacs);
 }
 
+static bool drive_triacs_dma_irq_handler_impl(timer_triacs_t* tim_triacs)
+{
+    if(!tim_triacs->dma_active) return false;
+    if(tim_triacs->dma_channel->CNDTR != 0) return false;
+    
+    // Последнее слово гребёнки передано - закрытие пары.
+    timer_triacs_dma_stop(tim_triacs);
+    
+    return true;
+}
+
+bool drive_triacs_timer0_dma_irq_handler(void)
+{
+    return drive_triacs_dma_irq_handler_impl(get_timer_triacs(TRIACS_TIMER_0));
+}
+
+bool drive_triacs_timer1_dma_irq_handler(void)
+{
+    return drive_triacs_dma_irq_handler_impl(get_timer_triacs(TRIACS_TIMER_1));
+}
+
 static void drive_triacs_exc_pulse_train_setup_next_first(void)
 {
     if(!drive_triacs.triac_exc_pt_enabled) return;
@@ -796,7 +1011,7 @@ static void drive_triacs_exc_pulse_train_setup_next_first(void)
     uint16_t next_open_pulse = cur_ticks + drive_triacs.triac_exc_pt_open_delta;
     uint16_t next_close_pulse = cur_ticks + pulse;
 
-    if(next_close_pulse < TRIAC_EXC_MAX_TICKS + TRIAC_EXC_OFFSET -
+    if(next_close_pulse < drive_triacs.exc_max_ticks + drive_triacs.exc_offset_ticks -
             drive_triacs.triac_exc_pt_angle_min_ticks - drive_triacs.exc_pulse_train_offset){
         TIM_SetCompare1(drive_triacs.timer_exc, next_open_pulse);
         TIM_SetCompare2(drive_triacs.timer_exc, next_close_pulse);
@@ -820,7 +1035,7 @@ static void drive_triacs_exc_pulse_train_setup_next_second(void)
     uint16_t next_open_pulse = cur_ticks + drive_triacs.triac_exc_pt_open_delta;
     uint16_t next_close_pulse = cur_ticks + pulse;
 
-    if(next_close_pulse < TRIAC_EXC_MAX_TICKS + TRIAC_EXC_OFFSET + TRIAC_EXC_TIM_HALF_CYCLE_OFFSET -
+    if(next_close_pulse < drive_triacs.exc_max_ticks + drive_triacs.exc_offset_ticks + drive_triacs.exc_half_cycle_ticks -
             drive_triacs.triac_exc_pt_angle_min_ticks - drive_triacs.exc_pulse_train_offset){
         TIM_SetCompare3(drive_triacs.timer_exc, next_open_pulse);
         TIM_SetCompare4(drive_triacs.timer_exc, next_close_pulse);
@@ -875,32 +1090,155 @@ void drive_triacs_exc_timer_irq_handler(void)
 ALWAYS_INLINE static uint16_t timer_triacs_clamp(int32_t ticks)
 {
     if(ticks < TRIACS_TIM_MIN_TICKS) return TRIACS_TIM_MIN_TICKS;
-    if(ticks > TRIACS_TIM_MAX_TICKS - 1) return TRIACS_TIM_MAX_TICKS - 1;
+    if(ticks > drive_triacs.pairs_max_ticks - 1) return drive_triacs.pairs_max_ticks - 1;
     return (uint16_t)ticks;
 }
 
 ALWAYS_INLINE static uint16_t timer_exc_clamp(int32_t ticks)
 {
     if(ticks < TRIAC_EXC_MIN_TICKS) return TRIAC_EXC_MIN_TICKS;
-    if(ticks > TRIAC_EXC_TIM_TICKS - 1) return TRIAC_EXC_TIM_TICKS - 1;
+    if(ticks > drive_triacs.period_ticks - 1) return drive_triacs.period_ticks - 1;
     return (uint16_t)ticks;
 }
 
 /**
- * Инициализирует таймер для открытия пары тиристоров.
- * @param triacs_pair Номер первой пары тиристоров.
- * @param offset_ticks Компенсация времени до запуска открытия тиристоров в тиках таймера.
+ * Вычисляет гребёнку тиристорной пары для передачи по DMA.
+ * Гребёнка разбивается на слоты длительностью импульса открытия,
+ * в каждом слоте в регистр BSRR записывается открытие, закрытие
+ * или ноль; пауза между импульсами округляется до целого числа слотов.
+ * Число импульсов ограничивается так же, как в прерываниях.
+ * @param tim_triacs Таймер тиристоров.
+ * @param fire Вычисленное открытие.
  * @param angle_ticks Угол открытия в тиках таймера.
- * @param open_ticks Время открытия в тиках таймера.
- * @param delay_ticks Задержка открытия в тиках таймера.
+ * @return Флаг вычисленной гребёнки.
+ */
+static bool timer_triacs_dma_prepare(timer_triacs_t* tim_triacs, const triacs_fire_t* fire, int32_t angle_ticks)
+{
+    if(!drive_triacs.triacs_pairs_pt_enabled) return false;
+    if(drive_triacs.triacs_pairs_pt_mode != DRIVE_TRIACS_PULSE_TRAIN_DMA) return false;
+    if(tim_triacs->dma_channel == NULL) return false;
+    // Буфер ещё передаётся предыдущей гребёнкой.
+    if(timer_triacs_dma_busy(tim_triacs)) return false;
+    
+    triac_pair_t* pair = get_triac_pair(fire->pair);
+    // Пара записывается в BSRR одного порта.
+    if(pair->triac_a.gpio != pair->triac_b.gpio) return false;
+    
+    int32_t open_ticks = drive_triacs.triacs_pairs_open_ticks;
+    int32_t delta_ticks = drive_triacs.triacs_pairs_pt_open_delta;
+    
+    // Нужен период слота не меньше двух тиков.
+    if(open_ticks < 2) return false;
+    
+    int32_t gap_slots = (delta_ticks + open_ticks / 2) / open_ticks;
+    if(gap_slots < 1) gap_slots = 1;
+    
+    uint32_t set_bits = pair->triac_a.pin | pair->triac_b.pin;
+    uint32_t reset_bits = set_bits << 16;
+    
+    uint32_t* bsrr = tim_triacs->dma_bsrr;
+    size_t slots = 0;
+    
+    // Первый импульс.
+    bsrr[slots ++] = set_bits;
+    bsrr[slots ++] = reset_bits;
+    
+    // Время отсчитывается от открытия первого импульса
+    // по фактическому положению слотов.
+    int32_t width_ticks = drive_triacs.triacs_pairs_pt_width_ticks;
+    int32_t close_max_ticks = angle_ticks - drive_triacs.triacs_pairs_pt_angle_min_ticks;
+    
+    for(;;){
+        // Закрытие следующего импульса - в начале слота после него.
+        int32_t close_ticks = (int32_t)(slots + gap_slots) * open_ticks;
+        
+        if(close_ticks - open_ticks > width_ticks) break;
+        if(close_ticks >= close_max_ticks) break;
+        // Гребёнка не помещается в буфер.
+        if(slots + (size_t)gap_slots + 1 > TRIACS_PULSE_TRAIN_DMA_SLOTS_MAX) return false;
+        
+        int32_t i;
+        for(i = 1; i < gap_slots; i ++){
+            bsrr[slots ++] = 0;
+        }
+        bsrr[slots ++] = set_bits;
+        bsrr[slots ++] = reset_bits;
+    }
+    
+    // Одиночный импульс формируется прерываниями.
+    if(slots == 2) return false;
+    
+    tim_triacs->dma_slot_ticks = open_ticks;
+    tim_triacs->dma_slots = slots;
+    
+    return true;
+}
+
+/**
+ * Запускает передачу гребёнки по DMA.
+ * Первое событие обновления таймера происходит в момент открытия,
+ * последующие - через длительность слота. Прерывания разрешаются
+ * на закрытие первого импульса и окончание передачи DMA.
+ * @param tim_triacs Таймер тиристоров.
+ * @param open_ticks Значение сравнения открытия.
+ * @return Флаг запуска гребёнки.
  */
-static void timer_triacs_setup_next_pair(triac_pair_number_t triacs_pair, int32_t offset_ticks,
-                                         int32_t angle_ticks, int32_t open_ticks, int32_t delay_ticks)
+static bool timer_triacs_dma_start(timer_triacs_t* tim_triacs, int32_t open_ticks)
+{
+    uint16_t open_cmp = timer_triacs_clamp(open_ticks);
+    
+    // Нужен период первого слота не меньше двух тиков.
+    if(open_cmp < 2) return false;
+    // Канал DMA общий с другой периферией.
+    if(!dma_channel_trylock(tim_triacs->dma_channel)) return false;
+    
+    TIM_TypeDef* TIM = tim_triacs->timer;
+    DMA_Channel_TypeDef* dma_ch = tim_triacs->dma_channel;
+    triac_pair_t* pair = get_triac_pair(tim_triacs->triacs_a);
+    
+    dma_ch->CCR = 0;
+    DMA_ClearFlag(tim_triacs->dma_flags);
+    dma_ch->CPAR = (uint32_t)&pair->triac_a.gpio->BSRR;
+    dma_ch->CMAR = (uint32_t)tim_triacs->dma_bsrr;
+    dma_ch->CNDTR = tim_triacs->dma_slots;
+    // Канал освобождается по окончании передачи.
+    dma_ch->CCR = DMA_CCR1_DIR | DMA_CCR1_MINC | DMA_CCR1_PSIZE_1 |
+                  DMA_CCR1_MSIZE_1 | DMA_CCR1_PL_1 | DMA_CCR1_TCIE | DMA_CCR1_EN;
+    
+    TIM_ITConfig(TIM, TRIACS_A_OPEN_CHANNEL_IT, DISABLE);
+    TIM_SelectOnePulseMode(TIM, TIM_OPMode_Repetitive);
+    TIM_ARRPreloadConfig(TIM, ENABLE);
+    TIM_OC2PreloadConfig(TIM, TIM_OCPreload_Enable);
+    // Первый слот - до открытия, сравнение закрытия в нём не срабатывает.
+    TIM_SetAutoreload(TIM, open_cmp - 1);
+    TIM_SetCompare2(TIM, TRIACS_TIM_NO_COMPARE);
+    TIM_GenerateEvent(TIM, TIM_EventSource_Update);
+    // Следующие слоты загрузятся в момент открытия.
+    TIM_SetAutoreload(TIM, tim_triacs->dma_slot_ticks - 1);
+    TIM_SetCompare2(TIM, tim_triacs->dma_slot_ticks - 1);
+    TIM_ClearFlag(TIM, TIM_FLAG_Update | TIM_FLAG_CC1 | TIM_FLAG_CC2);
+    
+    tim_triacs->dma_active = true;
+    
+    TIM_ITConfig(TIM, TRIACS_A_CLOSE_CHANNEL_IT, ENABLE);
+    TIM_DMACmd(TIM, TIM_DMA_Update, ENABLE);
+    
+    return true;
+}
+
+/**
+ * Запускает таймер для открытия пары тиристоров.
+ * @param fire Вычисленное открытие.
+ * @param offset_ticks Время с начала сектора таймера нуля в тиках таймера.
+ */
+static void timer_triacs_fire_pair(const triacs_fire_t* fire, int32_t offset_ticks)
 {
     // Получим следующий свободный таймер тиристоров.
     timer_triacs_t* tim_trcs = timer_triacs_next();
     // Остановим таймер.
     TIM_Cmd(tim_trcs->timer, DISABLE);
+    // Остановим гребёнку по DMA.
+    timer_triacs_dma_stop(tim_trcs);
     // Сбросим счётчик.
     TIM_SetCounter(tim_trcs->timer, 0);
     // Очистим флаги прерываний на открытие тиристоров.
@@ -920,29 +1258,27 @@ static void timer_triacs_setup_next_pair(triac_pair_number_t triacs_pair, int32_
     //}
     // Установим тиристорные пары таймера.
     // Первая пара тиристоров.
-    tim_trcs->triacs_a = triacs_pair;
+    tim_trcs->triacs_a = fire->pair;
     // Вторая пара тиристоров.
     //tim_trcs->triacs_b = triacs_pair;
     // Время гребёнки.
     tim_trcs->pulse_train_remain = drive_triacs.triacs_pairs_pt_width_ticks;
     // Смещение открытия.
-    tim_trcs->pulse_train_offset = offset_ticks + delay_ticks;
-    // Тики таймера.
-    // Угол открытия.
-    //uint16_t angle_ticks = drive_triacs.triacs_pairs_angle_ticks;
-    // Время открытия.
-    //uint16_t open_ticks = drive_triacs.triacs_pairs_open_ticks;
-    // Задержка открытия.
-    //uint16_t delay_ticks = drive_triacs.triacs_pairs_delay_ticks;
+    tim_trcs->pulse_train_offset = fire->pt_offset_ticks + offset_ticks;
+    // Гребёнка по DMA, иначе - в прерываниях.
+    if(fire->pt_dma && timer_triacs_dma_start(tim_trcs, fire->open_ticks - offset_ticks)){
+        TIM_Cmd(tim_trcs->timer, ENABLE);
+        return;
+    }
+    if(drive_triacs.triacs_pairs_pt_enabled &&
+       drive_triacs.triacs_pairs_pt_mode == DRIVE_TRIACS_PULSE_TRAIN_DMA){
+        drive_triacs.triacs_pairs_pt_dma_fallbacks ++;
+    }
     // Установим каналы таймера.
     // Открытие первой пары тиристоров.
-    TIM_SetCompare1(tim_trcs->timer, timer_triacs_clamp((int32_t)(TRIACS_TIM_MAX_TICKS) -
-                                     angle_ticks - offset_ticks -
-                                     delay_ticks));
+    TIM_SetCompare1(tim_trcs->timer, timer_triacs_clamp(fire->open_ticks - offset_ticks));
     // Закрытие первой пары тиристоров.
-    TIM_SetCompare2(tim_trcs->timer, timer_triacs_clamp((int32_t)(TRIACS_TIM_MAX_TICKS + open_ticks) -
-                                     angle_ticks - offset_ticks -
-                                     delay_ticks));
+    TIM_SetCompare2(tim_trcs->timer, timer_triacs_clamp(fire->close_ticks - offset_ticks));
     // Разрешим прерывания.
     TIM_ITConfig(tim_trcs->timer, TRIACS_A_OPEN_CHANNEL_IT, ENABLE);
     TIM_ITConfig(tim_trcs->timer, TRIACS_A_CLOSE_CHANNEL_IT, ENABLE);
@@ -951,8 +1287,12 @@ static void timer_triacs_setup_next_pair(triac_pair_number_t triacs_pair, int32_
     TIM_Cmd(tim_trcs->timer, ENABLE);
 }
 
-err_t drive_triacs_setup_next_pair(phase_t phase, phase_t last_open_phase, int16_t offset)
+err_t drive_triacs_prepare_next_pair(phase_t phase, phase_t last_open_phase, int16_t offset)
 {
+    triacs_fire_t* fire = &drive_triacs.pairs_fire;
+    
+    fire->pending = false;
+    
     // Нужна определённая фаза.
     if(phase == PHASE_UNK) return E_INVALID_VALUE;
     // Направление вращения.
@@ -1020,21 +1360,23 @@ err_t drive_triacs_setup_next_pair(phase_t phase, phase_t last_open_phase, int16
         triacs_index ++;
     }
     
-    timer_triacs_setup_next_pair(triacs_seq[triacs_index], offset_ticks, angle_ticks,
-                                 open_ticks, delay_ticks);
+    fire->pair = triacs_seq[triacs_index];
+    fire->limit_ticks = angle_ticks - offset_ticks;
+    fire->open_ticks = (int32_t)drive_triacs.pairs_max_ticks - angle_ticks - offset_ticks - delay_ticks;
+    fire->close_ticks = fire->open_ticks + open_ticks;
+    fire->pt_offset_ticks = offset_ticks + delay_ticks;
+    fire->pt_dma = timer_triacs_dma_prepare(timer_triacs_peek_next(), fire, angle_ticks);
+    fire->pending = true;
     
     return E_NO_ERROR;
 }
 
 /**
- * Инициализирует таймер для открытия симистора возбуждения.
- * @param offset_ticks Компенсация времени до запуска открытия симистора в тиках таймера.
- * @param angle_ticks Угол открытия в тиках таймера.
- * @param open_ticks Время открытия в тиках таймера.
- * @param delay_ticks Задержка открытия в тиках таймера.
+ * Запускает таймер для открытия симистора возбуждения.
+ * @param fire Вычисленное открытие.
+ * @param offset_ticks Время с начала сектора таймера нуля в тиках таймера.
  */
-static void timer_triac_exc_setup(int32_t offset_ticks, int32_t angle_ticks,
-                                  int32_t open_ticks, int32_t delay_ticks)
+static void timer_triac_exc_fire(const triacs_fire_t* fire, int32_t offset_ticks)
 {
     // Остановим таймер.
     TIM_Cmd(drive_triacs.timer_exc, DISABLE);
@@ -1051,32 +1393,18 @@ static void timer_triac_exc_setup(int32_t offset_ticks, int32_t angle_ticks,
     drive_triacs.exc_pulse_train_remain_first = drive_triacs.triac_exc_pt_width_ticks;
     drive_triacs.exc_pulse_train_remain_second = drive_triacs.triac_exc_pt_width_ticks;
     // Смещение открытия.
-    drive_triacs.exc_pulse_train_offset = offset_ticks + delay_ticks;
-    // Тики таймера.
-    // Угол открытия.
-    //uint16_t angle_ticks = drive_triacs.triac_exc_angle_ticks;
-    // Время открытия.
-    //uint16_t open_ticks = drive_triacs.triac_exc_open_ticks;
-    // Задержка открытия.
-    //uint16_t delay_ticks = drive_triacs.triac_exc_delay_ticks;
+    drive_triacs.exc_pulse_train_offset = fire->pt_offset_ticks + offset_ticks;
     // Установим каналы таймера.
-    // Открытие первой пары тиристоров.
-    TIM_SetCompare1(drive_triacs.timer_exc, timer_exc_clamp((TRIAC_EXC_MAX_TICKS + TRIAC_EXC_OFFSET) -
-                                            angle_ticks - offset_ticks -
-                                            delay_ticks));
-    // Закрытие первой пары тиристоров.
-    TIM_SetCompare2(drive_triacs.timer_exc, timer_exc_clamp((TRIAC_EXC_MAX_TICKS + TRIAC_EXC_OFFSET + open_ticks) -
-                                            angle_ticks - offset_ticks -
-                                            delay_ticks));
-    // Открытие второй пары тиристоров.
-    TIM_SetCompare3(drive_triacs.timer_exc, timer_exc_clamp((TRIAC_EXC_MAX_TICKS + TRIAC_EXC_OFFSET + TRIAC_EXC_TIM_HALF_CYCLE_OFFSET) -
-                                            angle_ticks - offset_ticks -
-                                            delay_ticks));
-    // Закрытие второй пары тиристоров.
-    TIM_SetCompare4(drive_triacs.timer_exc, timer_exc_clamp((TRIAC_EXC_MAX_TICKS + TRIAC_EXC_OFFSET + TRIAC_EXC_TIM_HALF_CYCLE_OFFSET +
-                                            open_ticks) -
-                                            angle_ticks - offset_ticks -
-                                            delay_ticks));
+    int32_t open_ticks = fire->open_ticks - offset_ticks;
+    int32_t close_ticks = fire->close_ticks - offset_ticks;
+    // Открытие в первом полупериоде.
+    TIM_SetCompare1(drive_triacs.timer_exc, timer_exc_clamp(open_ticks));
+    // Закрытие в первом полупериоде.
+    TIM_SetCompare2(drive_triacs.timer_exc, timer_exc_clamp(close_ticks));
+    // Открытие во втором полупериоде.
+    TIM_SetCompare3(drive_triacs.timer_exc, timer_exc_clamp(open_ticks + drive_triacs.exc_half_cycle_ticks));
+    // Закрытие во втором полупериоде.
+    TIM_SetCompare4(drive_triacs.timer_exc, timer_exc_clamp(close_ticks + drive_triacs.exc_half_cycle_ticks));
     // Разрешить прерывания.
     TIM_ITConfig(drive_triacs.timer_exc, TRIAC_EXC_FIRST_HALF_CYCLE_OPEN_CHANNEL_IT, ENABLE);
     TIM_ITConfig(drive_triacs.timer_exc, TRIAC_EXC_FIRST_HALF_CYCLE_CLOSE_CHANNEL_IT, ENABLE);
@@ -1087,12 +1415,16 @@ static void timer_triac_exc_setup(int32_t offset_ticks, int32_t angle_ticks,
 }
 
 /**
- * Настраивает таймер открытия симистора возбуждения.
+ * Вычисляет открытие симистора возбуждения.
  * @param phase Текущая фаза.
  * @return Код ошибки.
  */
-err_t drive_triacs_setup_exc(phase_t phase, phase_t last_open_phase, int16_t offset)
+err_t drive_triacs_prepare_exc(phase_t phase, phase_t last_open_phase, int16_t offset)
 {
+    triacs_fire_t* fire = &drive_triacs.exc_fire;
+    
+    fire->pending = false;
+    
     // Нужен режим регулирования.
     if(drive_triacs.exc_mode == DRIVE_TRIACS_EXC_EXTERNAL ||
        drive_triacs.exc_mode == DRIVE_TRIACS_EXC_FIXED) return E_NO_ERROR;
@@ -1134,9 +1466,34 @@ err_t drive_triacs_setup_exc(phase_t phase, phase_t last_open_phase, int16_t off
     }
     
     if(exc_ctl_phase == phase){
-        timer_triac_exc_setup(offset_ticks, angle_ticks,
-                              open_ticks, delay_ticks);
+        fire->limit_ticks = angle_ticks - offset_ticks;
+        fire->open_ticks = (int32_t)(drive_triacs.exc_max_ticks + drive_triacs.exc_offset_ticks) -
+                           angle_ticks - offset_ticks - delay_ticks;
+        fire->close_ticks = fire->open_ticks + open_ticks;
+        fire->pt_offset_ticks = offset_ticks + delay_ticks;
+        fire->pending = true;
     }
     
     return E_NO_ERROR;
 }
+
+void drive_triacs_fire(int16_t offset)
+{
+    int32_t offset_ticks = TIME_TO_TICKS(offset);
+    
+    triacs_fire_t* fire = &drive_triacs.pairs_fire;
+    
+    if(fire->pending){
+        fire->pending = false;
+        // Нужен угол открытия не меньше смещения.
+        if(offset_ticks < fire->limit_ticks) timer_triacs_fire_pair(fire, offset_ticks);
+    }
+    
+    fire = &drive_triacs.exc_fire;
+    
+    if(fire->pending){
+        fire->pending = false;
+        // Нужен угол открытия не меньше смещения.
+        if(offset_ticks < fire->limit_ticks) timer_triac_exc_fire(fire, offset_ticks);
+    }
+}
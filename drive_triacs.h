@@ -186,6 +186,9 @@ typedef int8_t triac_pair_number_t;
 //! Перевод тиков таймера в время открытия.
 #define TICKS_TO_TIME(T) (((int32_t)T * 10) / 18) // 1M мкс : 72M / 40 тиков
 
+//! Максимальное число слотов гребёнки, передаваемой по DMA.
+#define TRIACS_PULSE_TRAIN_DMA_SLOTS_MAX 64
+
 
 //! Режим возбуждения.
 typedef enum _Drive_Triacs_Exc_Mode {
@@ -195,6 +198,20 @@ typedef enum _Drive_Triacs_Exc_Mode {
     DRIVE_TRIACS_EXC_FIXED_PULSE = 3 //!< Открытие тиристора на максимальный угол.
 } drive_triacs_exc_mode_t;
 
+/**
+ * Режим формирования гребёнки тиристорных пар.
+ * В режиме DMA импульсы гребёнки вычисляются заранее
+ * и записываются в регистр BSRR порта пары по событиям
+ * обновления таймера. Остаются прерывание таймера на закрытие
+ * первого импульса и прерывание окончания передачи DMA,
+ * освобождающее общий канал.
+ * Гребёнка симистора возбуждения формируется в прерываниях.
+ */
+typedef enum _Drive_Triacs_Pulse_Train_Mode {
+    DRIVE_TRIACS_PULSE_TRAIN_IRQ = 0, //!< Импульсы формируются в прерываниях таймера.
+    DRIVE_TRIACS_PULSE_TRAIN_DMA = 1 //!< Импульсы передаются по DMA.
+} drive_triacs_pulse_train_mode_t;
+
 
 /**
  * Открываемые за период между
@@ -445,6 +462,33 @@ extern bool drive_triacs_pairs_pulse_train_enabled(void);
  */
 extern void drive_triacs_set_pairs_pulse_train_enabled(bool enabled);
 
+/**
+ * Получает режим формирования гребёнки тиристорных пар.
+ * @return Режим формирования гребёнки.
+ */
+extern drive_triacs_pulse_train_mode_t drive_triacs_pairs_pulse_train_mode(void);
+
+/**
+ * Устанавливает режим формирования гребёнки тиристорных пар.
+ * Если канал DMA таймера не задан, занят, или гребёнка
+ * не помещается в буфер, открытие выполняется в прерываниях.
+ * @param mode Режим формирования гребёнки.
+ */
+extern void drive_triacs_set_pairs_pulse_train_mode(drive_triacs_pulse_train_mode_t mode);
+
+/**
+ * Получает число открытий тиристорных пар в режиме гребёнки DMA,
+ * выполненных в прерываниях.
+ * @return Число открытий.
+ */
+extern uint32_t drive_triacs_pairs_pulse_train_dma_fallbacks(void);
+
+/**
+ * Сбрасывает число открытий тиристорных пар в режиме гребёнки DMA,
+ * выполненных в прерываниях.
+ */
+extern void drive_triacs_reset_pairs_pulse_train_dma_fallbacks(void);
+
 /**
  * Получает разрешение гребёнки симистора возбуждения.
  * @return Разрешение гребёнки.
@@ -585,6 +629,16 @@ extern err_t drive_triacs_set_exc_gpio(GPIO_TypeDef* GPIO, uint16_t pin);
  */
 extern err_t drive_triacs_set_pairs_timer(size_t index, TIM_TypeDef* TIM);
 
+/**
+ * Устанавливает канал DMA гребёнки таймера тиристоров.
+ * Канал должен обслуживать запрос события обновления таймера.
+ * @param index Индекс таймера.
+ * @param dma_channel Канал DMA.
+ * @param dma_flags Флаги канала DMA (DMAx_FLAG_GLy).
+ * @return Код ошибки.
+ */
+extern err_t drive_triacs_set_pairs_timer_dma(size_t index, DMA_Channel_TypeDef* dma_channel, uint32_t dma_flags);
+
 /**
  * Устанавливает таймер для открытия симистора возбуждения.
  * @param TIM Таймер.
@@ -592,6 +646,14 @@ extern err_t drive_triacs_set_pairs_timer(size_t index, TIM_TypeDef* TIM);
  */
 extern err_t drive_triacs_set_exc_timer(TIM_TypeDef* TIM);
 
+/**
+ * Устанавливает период сети.
+ * Пересчитывает углы открытия в тики таймеров
+ * и период таймеров открытия.
+ * @param period_us Период сети, мкс.
+ */
+extern void drive_triacs_set_period_us(uint16_t period_us);
+
 /**
  * Обработчик прерывания таймера 0 открытия тиристоров.
  */
@@ -602,27 +664,49 @@ extern void drive_triacs_timer0_irq_handler(void);
  */
 extern void drive_triacs_timer1_irq_handler(void);
 
+/**
+ * Обработчик прерывания канала DMA гребёнки таймера 0.
+ * @return Флаг обработки прерывания.
+ */
+extern bool drive_triacs_timer0_dma_irq_handler(void);
+
+/**
+ * Обработчик прерывания канала DMA гребёнки таймера 1.
+ * @return Флаг обработки прерывания.
+ */
+extern bool drive_triacs_timer1_dma_irq_handler(void);
+
 /**
  * Обработчик прерывания таймера открытия тиристора возбуждения.
  */
 extern void drive_triacs_exc_timer_irq_handler(void);
 
 /**
- * Настраивает таймер открытия тиристорной пары.
+ * Вычисляет открытие тиристорной пары.
+ * Таймер запускается функцией drive_triacs_fire.
  * @param phase Текущая фаза.
  * @param last_open_phase Фаза последней открытой пары тиристоров.
  * @param offset Компенсация времени до запуска открытия тиристоров.
  * @return Код ошибки.
  */
-extern err_t drive_triacs_setup_next_pair(phase_t phase, phase_t last_open_phase, int16_t offset);
+extern err_t drive_triacs_prepare_next_pair(phase_t phase, phase_t last_open_phase, int16_t offset);
 
 /**
- * Настраивает таймер открытия симистора возбуждения.
+ * Вычисляет открытие симистора возбуждения.
+ * Таймер запускается функцией drive_triacs_fire.
  * @param phase Текущая фаза.
  * @param last_open_phase Фаза последней открытой симистора возбуждения.
  * @param offset Компенсация времени до запуска открытия симистора.
  * @return Код ошибки.
  */
-extern err_t drive_triacs_setup_exc(phase_t phase, phase_t last_open_phase, int16_t offset);
+extern err_t drive_triacs_prepare_exc(phase_t phase, phase_t last_open_phase, int16_t offset);
+
+/**
+ * Запускает таймеры вычисленных открытий.
+ * Выполняется с запрещёнными прерываниями
+ * непосредственно после получения времени таймера нуля.
+ * @param offset Время с начала сектора таймера нуля, мкс.
+ */
+extern void drive_triacs_fire(int16_t offset);
 
 #endif /* DRIVE_TRIACS_H */
@@ -324,30 +324,14 @@ void gui_menu_event_title(char* title, size_t size, const char* format, drive_ev
 
 drive_event_type_t gui_menu_events_max_level(void)
 {
-    drive_event_type_t type = DRIVE_EVENT_TYPE_STATUS;
-    size_t cnt = drive_events_count();
-    if (cnt > 0) {
-        int i;
-        for (i = 0; i < cnt; i++) {
-            drive_event_t event;
-            drive_event_index_t id = drive_events_index_by_number((size_t)i);
-            
-            err_t err = E_NO_ERROR;
-            do {
-                err = drive_events_read_event((drive_event_t*)&event, id);
-            } while(err == E_BUSY);
-            
-            if (err == E_NO_ERROR) {
-                if (event.type == DRIVE_EVENT_TYPE_ERROR) {
-                    type = DRIVE_EVENT_TYPE_ERROR;
-                    break;
-                } else if (event.type == DRIVE_EVENT_TYPE_WARNING) {
-                    type = DRIVE_EVENT_TYPE_WARNING;
-                }
-            }
-        }
+    // Типы событий берутся из индекса без чтения событий из хранилища.
+    if (drive_events_select(DRIVE_EVENT_TYPE_MASK(DRIVE_EVENT_TYPE_ERROR), 0, 0, NULL, NULL, 1, NULL) != 0) {
+        return DRIVE_EVENT_TYPE_ERROR;
+    }
+    if (drive_events_select(DRIVE_EVENT_TYPE_MASK(DRIVE_EVENT_TYPE_WARNING), 0, 0, NULL, NULL, 1, NULL) != 0) {
+        return DRIVE_EVENT_TYPE_WARNING;
     }
-    return type;
+    return DRIVE_EVENT_TYPE_STATUS;
 }
 
 void gui_menu_draw_event_page(gui_menu_t* menu, painter_t* painter, gui_metro_theme_t* theme, graphics_pos_t width)
@@ -29,6 +29,8 @@
 #include "drive_nvdata.h"
 #include "drive_temp.h"
 #include "drive_hires_timer.h"
+#include "drive_modbus_timer.h"
+#include "drive_prof.h"
 #include "utils/critical.h"
 #include "drive_selftuning.h"
 #include "drive_task_selftune.h"
@@ -159,6 +161,13 @@ static tft9341_t tft;
 #define EXTI_RTC_ALARM_LINE EXTI_Line17
 
 
+//! Таймер межкадровых интервалов Modbus RS485.
+#define MODBUS_485_TIM TIM5
+//! Скорость Modbus RS485 по умолчанию.
+#define MODBUS_485_BAUD_DEFAULT 9600
+//! Скорость Modbus RS485, с которой инициализирован таймер.
+static uint32_t modbus_485_baud_rate = MODBUS_485_BAUD_DEFAULT;
+
 //! Таймер открытия тиристоров и итераций привода.
 #define DRIVE_MAIN_TIM TIM7
 //! Делитель (счётчик) частоты основного таймера привода.
@@ -200,12 +209,17 @@ static volatile uint16_t adc3_raw_buffer[ADC3_RAW_BUFFER_SIZE] = {0};
 
 //! Количество каналов трёх АЦП суммарно.
 #define ADC_CHANNELS_COUNT (ADC12_CHANNELS_COUNT + ADC12_CHANNELS_COUNT + ADC3_CHANNELS_COUNT)
+
+#if ADC_FREQ_MULT_MAX > DRIVE_TASK_ADC_BLOCK_FRAMES_MAX
+#error ADC_FREQ_MULT_MAX must not exceed DRIVE_TASK_ADC_BLOCK_FRAMES_MAX!
+#endif
+#if ADC_CHANNELS_COUNT != DRIVE_POWER_ADC_CHANNELS_COUNT
+#error ADC_CHANNELS_COUNT must be equal to DRIVE_POWER_ADC_CHANNELS_COUNT!
+#endif
 //! Размер данных буфера ADC12
 #define ADC12_DATA_SIZE ((ADC12_CHANNELS_COUNT + ADC12_CHANNELS_COUNT) * 2)
 //! Размер данных буфера ADC3
 #define ADC3_DATA_SIZE (ADC3_CHANNELS_COUNT * 2)
-//! Буфер ADC однократного измерения каналов.
-static uint16_t adc_raw_buffer[ADC_CHANNELS_COUNT] = {0};
 //! Буфер ADC.
 //static volatile uint16_t adc_raw_buffer[ADC12_RAW_BUFFER_SIZE + ADC3_RAW_BUFFER_SIZE] = {0};
 // Количество каналов самонастройки.
@@ -258,6 +272,7 @@ static uint16_t adc_raw_tuning_buffer[ADC_TUNING_BUFFER_LEN];
 #define IRQ_PRIOR_RTC (IRQ_PRIOR_RTOS_MAX + 3)
 
 #define IRQ_PRIOR_MODBUS_USART (IRQ_PRIOR_RTOS_MAX + 4)
+#define IRQ_PRIOR_MODBUS_TIMER (IRQ_PRIOR_RTOS_MAX + 4)
 #define IRQ_PRIOR_I2C1 (IRQ_PRIOR_RTOS_MAX + 5)
 #define IRQ_PRIOR_I2C2 (IRQ_PRIOR_RTOS_MAX + 5)
 #define IRQ_PRIOR_SPI1 (IRQ_PRIOR_RTOS_MAX + 5)
@@ -384,6 +399,11 @@ IRQ_ATTRIBS void USART1_IRQHandler(void)
     usart_bus_irq_handler(&usart_bus_485);
 }
 
+IRQ_ATTRIBS void TIM5_IRQHandler(void)
+{
+    drive_modbus_timer_irq_handler();
+}
+
 IRQ_ATTRIBS void USART3_IRQHandler(void)
 {
     usart_bus_irq_handler(&usart_bus_bt);
@@ -401,12 +421,14 @@ IRQ_ATTRIBS void SPI2_IRQHandler(void)
 
 IRQ_ATTRIBS void DMA1_Channel2_IRQHandler(void)
 {
+    if(drive_triacs_timer0_dma_irq_handler()) return;
     if(usart_bus_dma_tx_channel_irq_handler(&usart_bus_bt)) return;
     if(spi_bus_dma_rx_channel_irq_handler(&spi)) return;
 }
 
 IRQ_ATTRIBS void DMA1_Channel3_IRQHandler(void)
 {
+    if(drive_triacs_timer1_dma_irq_handler()) return;
     if(usart_bus_dma_rx_channel_irq_handler(&usart_bus_bt)) return;
     if(spi_bus_dma_tx_channel_irq_handler(&spi)) return;
 }
@@ -572,6 +594,8 @@ static void adc_set_rate_impl(uint32_t rate);
  */
 IRQ_ATTRIBS void DMA1_Channel1_IRQHandler(void)
 {
+    uint32_t prof_begin = drive_prof_begin();
+    
     if(DMA1->ISR & DMA_ISR_TCIF1){
         DMA1->IFCR = DMA_IFCR_CTCIF1;
         
@@ -579,20 +603,28 @@ IRQ_ATTRIBS void DMA1_Channel1_IRQHandler(void)
             adc_set_rate_impl(adc_new_rate);
         }
         
-        memcpy(
-                (void*)&adc_raw_buffer[0],
-                (void*)&adc12_raw_buffer[(ADC12_CHANNELS_COUNT + ADC12_CHANNELS_COUNT) * (adc_rate - 1)],
-                ADC12_DATA_SIZE
-            );
-        memcpy(
-                (void*)&adc_raw_buffer[ADC12_CHANNELS_COUNT + ADC12_CHANNELS_COUNT],
-                (void*)&adc3_raw_buffer[(ADC3_CHANNELS_COUNT) * (adc_rate - 1)],
-                ADC3_DATA_SIZE
-            );
-        
         BaseType_t pxHigherPriorityTaskWoken = 0;
         
-        drive_task_adc_process_data_isr((uint16_t*)adc_raw_buffer, &pxHigherPriorityTaskWoken);
+        // Все кадры записываются сразу в буфер задачи АЦП.
+        uint16_t* adc_block = drive_task_adc_block_isr();
+        if(adc_block){
+            size_t frame;
+            for(frame = 0; frame < adc_rate; frame ++){
+                memcpy(
+                        (void*)&adc_block[0],
+                        (void*)&adc12_raw_buffer[(ADC12_CHANNELS_COUNT + ADC12_CHANNELS_COUNT) * frame],
+                        ADC12_DATA_SIZE
+                    );
+                memcpy(
+                        (void*)&adc_block[ADC12_CHANNELS_COUNT + ADC12_CHANNELS_COUNT],
+                        (void*)&adc3_raw_buffer[(ADC3_CHANNELS_COUNT) * frame],
+                        ADC3_DATA_SIZE
+                    );
+                adc_block += ADC_CHANNELS_COUNT;
+            }
+            
+            drive_task_adc_block_commit_isr(adc_rate, &pxHigherPriorityTaskWoken);
+        }
         
         // Самонастройка.
         size_t i, rindex, tindex;
@@ -619,6 +651,8 @@ IRQ_ATTRIBS void DMA1_Channel1_IRQHandler(void)
             adc_change_rate = false;
         }
         
+        drive_prof_end(DRIVE_PROF_ADC_DMA_IRQ, prof_begin);
+        
         portYIELD_FROM_ISR(pxHigherPriorityTaskWoken);
     }
 }
@@ -637,17 +671,29 @@ IRQ_ATTRIBS void EXTI9_5_IRQHandler(void)
 
 IRQ_ATTRIBS void TIM2_IRQHandler(void)
 {
+    uint32_t prof_begin = drive_prof_begin();
+    
     drive_triac_pairs_timer0_irq_handler();
+    
+    drive_prof_end(DRIVE_PROF_TRIACS_PAIRS0_IRQ, prof_begin);
 }
 
 IRQ_ATTRIBS void TIM3_IRQHandler(void)
 {
+    uint32_t prof_begin = drive_prof_begin();
+    
     drive_triac_pairs_timer1_irq_handler();
+    
+    drive_prof_end(DRIVE_PROF_TRIACS_PAIRS1_IRQ, prof_begin);
 }
 
 IRQ_ATTRIBS void TIM4_IRQHandler(void)
 {
+    uint32_t prof_begin = drive_prof_begin();
+    
     drive_triac_exc_timer_irq_handler();
+    
+    drive_prof_end(DRIVE_PROF_TRIAC_EXC_IRQ, prof_begin);
 }
 
 // Функция сброса сторожевого таймера.
@@ -723,6 +769,8 @@ static void modbus_rs485_set_output(void)
 
 static bool usart_485_rx_byte_callback(uint8_t byte)
 {
+    drive_modbus_timer_byte_received();
+    
     return modbus_rtu_usart_rx_byte_callback(&modbus_485, byte);
 }
 
@@ -740,6 +788,8 @@ static bool usart_485_tc_callback(void)
 {
     modbus_rs485_set_input();
     
+    drive_modbus_timer_response_sent();
+    
     return true;
 }
 
@@ -747,6 +797,12 @@ static void modbus_485_on_msg_recv(void)
 {
     drive_gui_modbus_set_last_time();
     
+    // Кадр обрабатывается по истечении интервала t3.5.
+    drive_modbus_timer_frame_end();
+}
+
+static void modbus_485_on_frame_ready(void)
+{
     BaseType_t pxHigherPriorityTaskWoken = pdFALSE;
 
     if(drive_task_modbus_process_isr(&modbus_485, true, &pxHigherPriorityTaskWoken)){
@@ -863,6 +919,8 @@ static void init_periph_clock(void)
     RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM3, ENABLE);    // Включаем тактирование General-purpose TIM3
     // TIM4.
     RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM4, ENABLE);    // Включаем тактирование General-purpose TIM4
+    // TIM5 - MODBUS_485_TIM.
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM5, ENABLE);    // Включаем тактирование General-purpose TIM5
     // TIM6.
     RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM6, ENABLE);    // Включаем тактирование Basic TIM6
     // TIM7 - DRIVE_MAIN_TIM.
@@ -1064,6 +1122,30 @@ static void init_modbus_usart_bt(void)
     //NVIC_EnableIRQ(DMA1_Channel3_IRQn);
 }
 
+/**
+ * Получает скорость Modbus RS485 из настроек.
+ * @return Скорость, бит/с.
+ */
+static uint32_t modbus_485_baud(void)
+{
+    uint32_t baud = MODBUS_485_BAUD_DEFAULT;
+    
+    param_t* baud_param = settings_param_by_id(PARAM_ID_MODBUS_BAUD);
+    if(baud_param){
+        baud = settings_param_valueu(baud_param);
+    }
+    
+    // Скорости выше 57600 задаются в сотнях бит/с,
+    // значения ниже минимума параметра (0) не используются.
+    param_t* baud_high_param = settings_param_by_id(PARAM_ID_MODBUS_BAUD_HIGH);
+    if(baud_high_param &&
+       settings_param_valueu(baud_high_param) >= settings_param_min(baud_high_param).uint_value){
+        baud = settings_param_valueu(baud_high_param) * 100;
+    }
+    
+    return baud;
+}
+
 static void init_modbus_usart_485(void)
 {
     GPIO_InitTypeDef gpio_tx =
@@ -1072,7 +1154,7 @@ static void init_modbus_usart_485(void)
         {.GPIO_Pin = GPIO_Pin_10, .GPIO_Speed = GPIO_Speed_10MHz, .GPIO_Mode = GPIO_Mode_IN_FLOATING};
     
     USART_InitTypeDef usart_is =
-        {.USART_BaudRate = 9600, .USART_WordLength = USART_WordLength_8b, .USART_StopBits = USART_StopBits_1,
+        {.USART_BaudRate = MODBUS_485_BAUD_DEFAULT, .USART_WordLength = USART_WordLength_8b, .USART_StopBits = USART_StopBits_1,
          .USART_Parity = USART_Parity_No, .USART_Mode = USART_Mode_Rx | USART_Mode_Tx, .USART_HardwareFlowControl = USART_HardwareFlowControl_None};
     
     usart_bus_init_t usartb_is = {
@@ -1081,10 +1163,7 @@ static void init_modbus_usart_485(void)
         .dma_rx_channel = DMA1_Channel5
     };
     
-    param_t* baud_param = settings_param_by_id(PARAM_ID_MODBUS_BAUD);
-    if(baud_param){
-        usart_is.USART_BaudRate = settings_param_valueu(baud_param);
-    }
+    usart_is.USART_BaudRate = modbus_485_baud_rate;
     
     GPIO_Init(GPIOA, &gpio_tx);
     GPIO_Init(GPIOA, &gpio_rx);
@@ -1146,6 +1225,27 @@ static void init_modbus_485(void)
     modbus_rs485_set_input();
 }
 
+static void init_modbus_timer_485(void)
+{
+    drive_modbus_timer_init_t timer_is;
+    
+    timer_is.timer = MODBUS_485_TIM;
+    timer_is.baud = modbus_485_baud();
+    timer_is.frame_callback = modbus_485_on_frame_ready;
+    
+    // Скорость, для которой интервалы не помещаются в таймер,
+    // заменяется скоростью по умолчанию.
+    if(drive_modbus_timer_init(&timer_is) != E_NO_ERROR){
+        timer_is.baud = MODBUS_485_BAUD_DEFAULT;
+        drive_modbus_timer_init(&timer_is);
+    }
+    
+    modbus_485_baud_rate = timer_is.baud;
+    
+    NVIC_SetPriority(TIM5_IRQn, IRQ_PRIOR_MODBUS_TIMER);
+    NVIC_EnableIRQ(TIM5_IRQn);
+}
+
 static void init_drive_modbus(void)
 {
     drive_modbus_init_t drive_modbus_is;
@@ -1597,6 +1697,11 @@ static void init_adc(void)
 
 #define ADC_TIM_PRESCALER (1)
 #define ADC_TIM_PERIOD (72000000UL / ADC_TIM_PRESCALER / POWER_ADC_FREQ)
+//! Число тиков таймера АЦП в микросекунде.
+#define ADC_TIM_TICKS_PER_US (72000000UL / ADC_TIM_PRESCALER / 1000000)
+
+//! Период таймера АЦП при нормальной частоте, следует за периодом сети.
+static uint32_t adc_tim_period = ADC_TIM_PERIOD;
 
 static void init_adc_timer(void)
 {
@@ -1635,7 +1740,7 @@ static void adc_timer_set_rate(uint32_t rate)
 {
     ADC_TIM->CR1 &= ~TIM_CR1_CEN;
     
-    ADC_TIM->ARR = (ADC_TIM_PERIOD / rate) - 1;
+    ADC_TIM->ARR = (adc_tim_period / rate) - 1;
     
     if(ADC_TIM->CNT > ADC_TIM->ARR){
         ADC_TIM->CNT = ADC_TIM->ARR - 1;
@@ -1679,6 +1784,23 @@ static void adc_set_rate_impl(uint32_t rate)
     adc_timer_set_rate(rate);
 }
 
+/**
+ * Устанавливает период таймера АЦП по периоду сети
+ * с сохранением числа измерений за период.
+ * Таймер не останавливается, чтобы не сбивать фазу измерений.
+ * @param period_us Период сети, мкс.
+ */
+static void adc_set_period(uint32_t period_us)
+{
+    adc_tim_period = period_us * ADC_TIM_TICKS_PER_US / POWER_ADC_MEASUREMENTS_PER_PERIOD;
+    
+    ADC_TIM->ARR = (adc_tim_period / adc_rate) - 1;
+    
+    if(ADC_TIM->CNT > ADC_TIM->ARR){
+        ADC_TIM->CNT = ADC_TIM->ARR - 1;
+    }
+}
+
 static void adc_set_rate(uint32_t rate)
 {
     if(rate >= ADC_FREQ_MULT_MIN && rate <= ADC_FREQ_MULT_MAX){
@@ -1691,6 +1813,7 @@ static void adc_set_rate(uint32_t rate)
     }
 }
 
+#undef ADC_TIM_TICKS_PER_US
 #undef ADC_TIM_PERIOD
 #undef ADC_TIM_PRESCALER
 
@@ -1731,6 +1854,7 @@ static void init_drive(void)
     drive_set_warning_callback((drive_warning_callback_t)drive_tasks_write_warning_event);
     drive_set_reset_callback(on_drive_reset);
     drive_set_adc_rate_proc(adc_set_rate);
+    drive_set_adc_period_proc(adc_set_period);
 }
 
 static void reset_ioport(void)
@@ -1846,6 +1970,8 @@ static void init_hires_timer(void)
     drive_hires_timer_irq_set_enabled(true);
     
     drive_hires_timer_start();
+    
+    drive_prof_init();
 
     NVIC_SetPriority(TIM6_IRQn, IRQ_PRIOR_HIRES_TIMER);
     NVIC_EnableIRQ(TIM6_IRQn);
@@ -1909,6 +2035,11 @@ static void init_triacs_timers(void)
     drive_set_triacs_pairs_timer(TRIACS_TIMER_1, TIM3);
     drive_set_triac_exc_timer(TIM4);
     
+    // Запросы обновления TIM2 и TIM3 обслуживаются
+    // каналами DMA1, общими с SPI1 и USART3.
+    drive_set_triacs_pairs_timer_dma(TRIACS_TIMER_0, DMA1_Channel2, DMA1_FLAG_GL2);
+    drive_set_triacs_pairs_timer_dma(TRIACS_TIMER_1, DMA1_Channel3, DMA1_FLAG_GL3);
+    
     NVIC_SetPriority(TIM2_IRQn, IRQ_PRIOR_TRIACS_TIMER);
     NVIC_EnableIRQ (TIM2_IRQn);         // Разрешаем прерывания по Таймеру2
     NVIC_SetPriority(TIM3_IRQn, IRQ_PRIOR_TRIACS_TIMER);
@@ -2322,13 +2453,21 @@ int main(void)
     init_nvdata();
 
     drive_events_init();
-    if(drive_events_read() != E_NO_ERROR){
+    // Индекс строится только по прочитанной карте событий,
+    // при ошибке чтения событий журнал сбрасывается.
+    if(drive_events_read() != E_NO_ERROR ||
+       drive_events_read_index() != E_NO_ERROR){
         drive_events_reset();
     }
     
-    settings_init();
+    // Таблица параметров прошивки не соответствует
+    // PARAMETERS_ID_MAX - запуск привода невозможен.
+    if(settings_init() != E_NO_ERROR){
+        for(;;);
+    }
     if(settings_read() != E_NO_ERROR){
         settings_default();
+        settings_read_shared();
     }
     
     __disable_irq();
@@ -2357,6 +2496,8 @@ int main(void)
         drive_watchdog_timeout();
     }
     
+    // Скорость USART задаётся по результату инициализации таймера.
+    init_modbus_timer_485();
     init_modbus_usart_485();
     init_modbus_485();
     init_modbus_usart_bt();
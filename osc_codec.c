@@ -0,0 +1,218 @@
+#include "osc_codec.h"
+
+
+//! Маска числа бит в заголовке блока.
+#define OSC_CODEC_HEADER_BITS_MASK 0x1f
+
+//! Флаг разностей второго порядка в заголовке блока.
+#define OSC_CODEC_HEADER_DELTA2 0x80
+
+//! Максимальное число бит на значение.
+#define OSC_CODEC_BITS_MAX 16
+
+
+/**
+ * Переводит знаковое значение в беззнаковое
+ * чередованием знака (0, -1, 1, -2, ...).
+ * @param value Значение.
+ * @return Беззнаковое значение.
+ */
+ALWAYS_INLINE static uint16_t osc_codec_zigzag(int16_t value)
+{
+    return (uint16_t)(((uint16_t)value << 1) ^ (uint16_t)(value >> 15));
+}
+
+/**
+ * Переводит беззнаковое значение в знаковое.
+ * @param value Беззнаковое значение.
+ * @return Значение.
+ */
+ALWAYS_INLINE static int16_t osc_codec_unzigzag(uint16_t value)
+{
+    return (int16_t)((value >> 1) ^ (uint16_t)(-(int16_t)(value & 0x1)));
+}
+
+/**
+ * Получает число бит, необходимое для хранения значения.
+ * @param value Значение.
+ * @return Число бит.
+ */
+static size_t osc_codec_bits(uint16_t value)
+{
+    size_t bits = 0;
+    while(value){
+        bits ++;
+        value >>= 1;
+    }
+    return bits;
+}
+
+void osc_codec_state_init(osc_codec_state_t* state)
+{
+    state->value = 0;
+    state->delta = 0;
+}
+
+size_t osc_codec_encode_block(osc_codec_state_t* state, const int16_t* values, size_t count, uint8_t* data)
+{
+    uint16_t z1[OSC_CODEC_BLOCK_LEN];
+    uint16_t z2[OSC_CODEC_BLOCK_LEN];
+    uint16_t or1 = 0;
+    uint16_t or2 = 0;
+    
+    int16_t value = state->value;
+    int16_t delta = state->delta;
+    int16_t d1;
+    
+    size_t i;
+    for(i = 0; i < count; i ++){
+        d1 = (int16_t)(values[i] - value);
+        
+        z1[i] = osc_codec_zigzag(d1);
+        z2[i] = osc_codec_zigzag((int16_t)(d1 - delta));
+        or1 |= z1[i];
+        or2 |= z2[i];
+        
+        value = values[i];
+        delta = d1;
+    }
+    
+    state->value = value;
+    state->delta = delta;
+    
+    size_t bits1 = osc_codec_bits(or1);
+    size_t bits2 = osc_codec_bits(or2);
+    
+    const uint16_t* z = z1;
+    size_t bits = bits1;
+    uint8_t header = (uint8_t)bits1;
+    
+    if(bits2 < bits1){
+        z = z2;
+        bits = bits2;
+        header = (uint8_t)bits2 | OSC_CODEC_HEADER_DELTA2;
+    }
+    
+    uint8_t* p = data;
+    *p ++ = header;
+    
+    uint32_t acc = 0;
+    size_t acc_bits = 0;
+    
+    for(i = 0; i < count; i ++){
+        acc |= (uint32_t)z[i] << acc_bits;
+        acc_bits += bits;
+        while(acc_bits >= 8){
+            *p ++ = (uint8_t)acc;
+            acc >>= 8;
+            acc_bits -= 8;
+        }
+    }
+    
+    if(acc_bits != 0){
+        *p ++ = (uint8_t)acc;
+    }
+    
+    return (size_t)(p - data);
+}
+
+size_t osc_codec_block_size(uint8_t header, size_t count)
+{
+    size_t bits = header & OSC_CODEC_HEADER_BITS_MASK;
+    
+    if(bits > OSC_CODEC_BITS_MAX) return 0;
+    
+    return 1 + (count * bits + 7) / 8;
+}
+
+size_t osc_codec_decode_block(osc_codec_state_t* state, const uint8_t* data, size_t size, int16_t* values, size_t count)
+{
+    if(size == 0) return 0;
+    
+    uint8_t header = data[0];
+    size_t block_size = osc_codec_block_size(header, count);
+    
+    if(block_size == 0 || block_size > size) return 0;
+    
+    size_t bits = header & OSC_CODEC_HEADER_BITS_MASK;
+    uint32_t mask = (1UL << bits) - 1;
+    
+    const uint8_t* p = data + 1;
+    uint32_t acc = 0;
+    size_t acc_bits = 0;
+    
+    int16_t value = state->value;
+    int16_t delta = state->delta;
+    int16_t d;
+    
+    size_t i;
+    for(i = 0; i < count; i ++){
+        while(acc_bits < bits){
+            acc |= (uint32_t)(*p ++) << acc_bits;
+            acc_bits += 8;
+        }
+        
+        d = osc_codec_unzigzag((uint16_t)(acc & mask));
+        acc >>= bits;
+        acc_bits -= bits;
+        
+        if(header & OSC_CODEC_HEADER_DELTA2){
+            d = (int16_t)(delta + d);
+        }
+        
+        value = (int16_t)(value + d);
+        delta = d;
+        
+        values[i] = value;
+    }
+    
+    state->value = value;
+    state->delta = delta;
+    
+    return block_size;
+}
+
+size_t osc_codec_encode(const int16_t* values, size_t count, uint8_t* data, size_t size)
+{
+    osc_codec_state_t state;
+    osc_codec_state_init(&state);
+    
+    size_t offset = 0;
+    size_t n;
+    
+    while(count != 0){
+        n = (count > OSC_CODEC_BLOCK_LEN) ? OSC_CODEC_BLOCK_LEN : count;
+        
+        if(offset + 1 + n * sizeof(int16_t) > size) return 0;
+        
+        offset += osc_codec_encode_block(&state, values, n, data + offset);
+        
+        values += n;
+        count -= n;
+    }
+    
+    return offset;
+}
+
+err_t osc_codec_decode(const uint8_t* data, size_t size, int16_t* values, size_t count)
+{
+    osc_codec_state_t state;
+    osc_codec_state_init(&state);
+    
+    size_t offset = 0;
+    size_t block_size;
+    size_t n;
+    
+    while(count != 0){
+        n = (count > OSC_CODEC_BLOCK_LEN) ? OSC_CODEC_BLOCK_LEN : count;
+        
+        block_size = osc_codec_decode_block(&state, data + offset, size - offset, values, n);
+        if(block_size == 0) return E_INVALID_VALUE;
+        
+        offset += block_size;
+        values += n;
+        count -= n;
+    }
+    
+    return E_NO_ERROR;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file osc_codec.h Библиотека сжатия данных осциллограмм без потерь.
+ * Значения кодируются блоками по OSC_CODEC_BLOCK_LEN:
+ * разности первого или второго порядка (выбирается меньшая),
+ * знаковое значение переводится в беззнаковое (zigzag)
+ * и упаковывается в минимальное для блока число бит.
+ * Формат блока: байт заголовка (биты 0-4 - число бит на значение,
+ * бит 7 - разности второго порядка), далее упакованные значения
+ * начиная с младших бит.
+ */
+
+#ifndef OSC_CODEC_H
+#define OSC_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "errors/errors.h"
+#include "defs/defs.h"
+
+
+//! Число значений в блоке.
+#define OSC_CODEC_BLOCK_LEN 16
+
+//! Максимальный размер закодированного блока.
+#define OSC_CODEC_BLOCK_SIZE_MAX (1 + OSC_CODEC_BLOCK_LEN * sizeof(int16_t))
+
+//! Тип состояния кодека потока значений.
+typedef struct _Osc_Codec_State {
+    int16_t value; //!< Предыдущее значение.
+    int16_t delta; //!< Предыдущая разность первого порядка.
+} osc_codec_state_t;
+
+
+/**
+ * Инициализирует состояние кодека.
+ * @param state Состояние кодека.
+ */
+EXTERN void osc_codec_state_init(osc_codec_state_t* state);
+
+/**
+ * Кодирует блок значений.
+ * @param state Состояние кодека.
+ * @param values Значения.
+ * @param count Число значений (не более OSC_CODEC_BLOCK_LEN).
+ * @param data Буфер для закодированных данных
+ * (не менее 1 + count * sizeof(int16_t) байт).
+ * @return Размер закодированного блока.
+ */
+EXTERN size_t osc_codec_encode_block(osc_codec_state_t* state, const int16_t* values, size_t count, uint8_t* data);
+
+/**
+ * Получает размер закодированного блока по его заголовку.
+ * @param header Байт заголовка блока.
+ * @param count Число значений в блоке.
+ * @return Размер закодированного блока, 0 при ошибке в заголовке.
+ */
+EXTERN size_t osc_codec_block_size(uint8_t header, size_t count);
+
+/**
+ * Декодирует блок значений.
+ * @param state Состояние кодека.
+ * @param data Закодированные данные.
+ * @param size Размер закодированных данных.
+ * @param values Буфер для значений.
+ * @param count Число значений (не более OSC_CODEC_BLOCK_LEN).
+ * @return Размер декодированного блока, 0 при ошибке.
+ */
+EXTERN size_t osc_codec_decode_block(osc_codec_state_t* state, const uint8_t* data, size_t size, int16_t* values, size_t count);
+
+/**
+ * Кодирует массив значений.
+ * @param values Значения.
+ * @param count Число значений.
+ * @param data Буфер для закодированных данных.
+ * @param size Размер буфера.
+ * @return Размер закодированных данных, 0 если данные не помещаются в буфер.
+ */
+EXTERN size_t osc_codec_encode(const int16_t* values, size_t count, uint8_t* data, size_t size);
+
+/**
+ * Декодирует массив значений.
+ * @param data Закодированные данные.
+ * @param size Размер закодированных данных.
+ * @param values Буфер для значений.
+ * @param count Число значений.
+ * @return Код ошибки.
+ */
+EXTERN err_t osc_codec_decode(const uint8_t* data, size_t size, int16_t* values, size_t count);
+
+#endif /* OSC_CODEC_H */
@@ -35,6 +35,10 @@
  * Контрольная сумма общих параметров.
  */
 #define PARAM_ID_SHARED_CRC 10
+/**
+ * Повышенная скорость, сотни бит/с (0 - не используется, минимум 12).
+ */
+#define PARAM_ID_MODBUS_BAUD_HIGH 11
 
 //////////////////////
 // Общие параметры. //
@@ -408,6 +412,11 @@
  * Использование гребёнки при открытии тиристоров возбуждения.
  */
 #define PARAM_ID_TRIAC_EXC_PULSE_TRAIN_ENABLED 1421
+/**
+ * Режим формирования гребёнки тиристорных пар
+ * (0 - прерывания, 1 - DMA).
+ */
+#define PARAM_ID_TRIACS_PAIRS_PULSE_TRAIN_MODE 1422
 /**
  * Длительность гребёнки при открытии тиристорных пар.
  */
@@ -1589,6 +1598,60 @@
  * Время усреднения канала момента.
  */
 #define PARAM_ID_AVERAGING_TIME_TORQUE 7181
+/*
+ * Скользящее окно вычисления действующих значений.
+ * Окон не более шести, они выделяются включённым каналам
+ * по порядку идентификаторов, остальные включённые каналы
+ * вычисляются по периодам.
+ */
+/**
+ * Вычисление канала Ua в скользящем окне.
+ */
+#define PARAM_ID_SLIDING_WINDOW_Ua 7190
+/**
+ * Вычисление канала Ub в скользящем окне.
+ */
+#define PARAM_ID_SLIDING_WINDOW_Ub 7191
+/**
+ * Вычисление канала Uc в скользящем окне.
+ */
+#define PARAM_ID_SLIDING_WINDOW_Uc 7192
+/**
+ * Вычисление канала Urot в скользящем окне.
+ */
+#define PARAM_ID_SLIDING_WINDOW_Urot 7193
+/**
+ * Вычисление канала Ia в скользящем окне.
+ */
+#define PARAM_ID_SLIDING_WINDOW_Ia 7194
+/**
+ * Вычисление канала Ib в скользящем окне.
+ */
+#define PARAM_ID_SLIDING_WINDOW_Ib 7195
+/**
+ * Вычисление канала Ic в скользящем окне.
+ */
+#define PARAM_ID_SLIDING_WINDOW_Ic 7196
+/**
+ * Вычисление канала Irot в скользящем окне.
+ */
+#define PARAM_ID_SLIDING_WINDOW_Irot 7197
+/**
+ * Вычисление канала Iexc в скользящем окне.
+ */
+#define PARAM_ID_SLIDING_WINDOW_Iexc 7198
+/**
+ * Вычисление канала Iref в скользящем окне.
+ */
+#define PARAM_ID_SLIDING_WINDOW_Iref 7199
+/**
+ * Вычисление канала Ifan в скользящем окне.
+ */
+#define PARAM_ID_SLIDING_WINDOW_Ifan 7200
+/**
+ * Вычисление канала Erot в скользящем окне.
+ */
+#define PARAM_ID_SLIDING_WINDOW_Erot 7201
 
 
 ////////////////////////////
@@ -1809,6 +1872,106 @@
  */
 #define PARAM_ID_PID_ROT_CURRENT 9053
 
+/*
+ * Профилирование.
+ */
+/**
+ * Максимальное время прерывания DMA АЦП.
+ */
+#define PARAM_ID_PROF_ADC_DMA_IRQ_MAX 9060
+/**
+ * 99-й процентиль времени прерывания DMA АЦП.
+ */
+#define PARAM_ID_PROF_ADC_DMA_IRQ_P99 9061
+/**
+ * Загрузка процессора прерывания DMA АЦП.
+ */
+#define PARAM_ID_PROF_ADC_DMA_IRQ_LOAD 9062
+/**
+ * Максимальное время прерывания первого таймера пар тиристоров.
+ */
+#define PARAM_ID_PROF_TRIACS_PAIRS0_IRQ_MAX 9063
+/**
+ * 99-й процентиль времени прерывания первого таймера пар тиристоров.
+ */
+#define PARAM_ID_PROF_TRIACS_PAIRS0_IRQ_P99 9064
+/**
+ * Загрузка процессора прерывания первого таймера пар тиристоров.
+ */
+#define PARAM_ID_PROF_TRIACS_PAIRS0_IRQ_LOAD 9065
+/**
+ * Максимальное время прерывания таймера тиристора возбуждения.
+ */
+#define PARAM_ID_PROF_TRIAC_EXC_IRQ_MAX 9066
+/**
+ * 99-й процентиль времени прерывания таймера тиристора возбуждения.
+ */
+#define PARAM_ID_PROF_TRIAC_EXC_IRQ_P99 9067
+/**
+ * Загрузка процессора прерывания таймера тиристора возбуждения.
+ */
+#define PARAM_ID_PROF_TRIAC_EXC_IRQ_LOAD 9068
+/**
+ * Максимальное время обработки данных АЦП в задаче.
+ */
+#define PARAM_ID_PROF_ADC_TASK_MAX 9069
+/**
+ * 99-й процентиль времени обработки данных АЦП в задаче.
+ */
+#define PARAM_ID_PROF_ADC_TASK_P99 9070
+/**
+ * Загрузка процессора обработки данных АЦП в задаче.
+ */
+#define PARAM_ID_PROF_ADC_TASK_LOAD 9071
+/**
+ * Максимальное время итерации открытия тиристоров.
+ */
+#define PARAM_ID_PROF_TRIACS_ITER_MAX 9072
+/**
+ * 99-й процентиль времени итерации открытия тиристоров.
+ */
+#define PARAM_ID_PROF_TRIACS_ITER_P99 9073
+/**
+ * Загрузка процессора итерации открытия тиристоров.
+ */
+#define PARAM_ID_PROF_TRIACS_ITER_LOAD 9074
+/**
+ * Максимальное время итерации синхронизации с фазами.
+ */
+#define PARAM_ID_PROF_SYNC_ITER_MAX 9075
+/**
+ * 99-й процентиль времени итерации синхронизации с фазами.
+ */
+#define PARAM_ID_PROF_SYNC_ITER_P99 9076
+/**
+ * Загрузка процессора итерации синхронизации с фазами.
+ */
+#define PARAM_ID_PROF_SYNC_ITER_LOAD 9077
+/**
+ * Максимальное время основной итерации привода.
+ */
+#define PARAM_ID_PROF_MAIN_ITER_MAX 9078
+/**
+ * 99-й процентиль времени основной итерации привода.
+ */
+#define PARAM_ID_PROF_MAIN_ITER_P99 9079
+/**
+ * Загрузка процессора основной итерации привода.
+ */
+#define PARAM_ID_PROF_MAIN_ITER_LOAD 9080
+/**
+ * Максимальное время прерывания второго таймера пар тиристоров.
+ */
+#define PARAM_ID_PROF_TRIACS_PAIRS1_IRQ_MAX 9081
+/**
+ * 99-й процентиль времени прерывания второго таймера пар тиристоров.
+ */
+#define PARAM_ID_PROF_TRIACS_PAIRS1_IRQ_P99 9082
+/**
+ * Загрузка процессора прерывания второго таймера пар тиристоров.
+ */
+#define PARAM_ID_PROF_TRIACS_PAIRS1_IRQ_LOAD 9083
+
 /**
  * Отладочный параметр 0
  */
@@ -18,11 +18,18 @@
 #define NOUNITS (NULL)
 
 // Число реальных параметров.
-#define PARAMETERS_REAL_COUNT 435
+// Образ настроек - значения реальных параметров по порядку,
+// поэтому при добавлении реального параметра его идентификатор
+// вносится в таблицу прежних раскладок (settings.c),
+// иначе сохранённые настройки не будут прочитаны.
+#define PARAMETERS_REAL_COUNT 449
 // Число виртуальных параметров.
-#define PARAMETERS_VIRT_COUNT 55
+#define PARAMETERS_VIRT_COUNT 79
 // Общее число параметров.
 #define PARAMETERS_COUNT (PARAMETERS_REAL_COUNT + PARAMETERS_VIRT_COUNT)
+// Верхняя граница идентификаторов параметров (конец группы 91xx),
+// проверяется тестом settings_id_table_test и при запуске.
+#define PARAMETERS_ID_MAX 9199
 // Число общих параметров с загрузчиком.
 #define PARAMETERS_BOOT_SHARED_COUNT 5
 
@@ -53,6 +60,8 @@ PARAM_DESCRS(parameters_descrs, PARAMETERS_COUNT) {
     PARAM_DESCR(PARAM_ID_MODBUS_STOP_BITS, PARAM_TYPE_UINT,     1,      2,     1,  0, NOUNITS),
     PARAM_DESCR(PARAM_ID_MODBUS_ADDRESS,   PARAM_TYPE_UINT,     1,    255,     1,  0, NOUNITS),
     PARAM_DESCR(PARAM_ID_SHARED_CRC,       PARAM_TYPE_UINT,     0,  65536,     0,  0, NOUNITS),
+    // Скорость Modbus выше 57600 бит/с, не используется загрузчиком.
+    PARAM_DESCR(PARAM_ID_MODBUS_BAUD_HIGH, PARAM_TYPE_UINT,    12,   9216,     0,  0, NOUNITS),
     
     // Общие параметры.
     PARAM_DESCR(PARAM_ID_U_NOM,           PARAM_TYPE_UINT,      0,       1000,      220,        0, TEXT(TR_ID_UNITS_V)),
@@ -152,6 +161,7 @@ PARAM_DESCRS(parameters_descrs, PARAMETERS_COUNT) {
     
     PARAM_DESCR(PARAM_ID_TRIACS_PAIRS_PULSE_TRAIN_ENABLED,    PARAM_TYPE_UINT,            0,          1,        0,   0, NOUNITS),
     PARAM_DESCR(PARAM_ID_TRIAC_EXC_PULSE_TRAIN_ENABLED,       PARAM_TYPE_UINT,            0,          1,        0,   0, NOUNITS),
+    PARAM_DESCR(PARAM_ID_TRIACS_PAIRS_PULSE_TRAIN_MODE,       PARAM_TYPE_UINT,            0,          1,        0,   0, NOUNITS),
     PARAM_DESCR(PARAM_ID_TRIACS_PAIRS_PULSE_TRAIN_WIDTH,      PARAM_TYPE_FRACT_100, F32I(0),  F32I(120), F32I(60),   0, TEXT(TR_ID_UNITS_DEGREE)),
     PARAM_DESCR(PARAM_ID_TRIAC_EXC_PULSE_TRAIN_WIDTH,         PARAM_TYPE_FRACT_100, F32I(0),  F32I(150), F32I(60),   0, TEXT(TR_ID_UNITS_DEGREE)),
     PARAM_DESCR(PARAM_ID_TRIACS_PAIRS_PULSE_TRAIN_DUTY_RATIO, PARAM_TYPE_UINT,            0,         50,       50,   0, TEXT(TR_ID_UNITS_PERCENT)),
@@ -597,6 +607,19 @@ PARAM_DESCRS(parameters_descrs, PARAMETERS_COUNT) {
     PARAM_DESCR(PARAM_ID_AVERAGING_TIME_RPM,   PARAM_TYPE_UINT,  1,    1000,     60,    0, TEXT(TR_ID_UNITS_MS)),
     PARAM_DESCR(PARAM_ID_AVERAGING_TIME_TORQUE,  PARAM_TYPE_UINT,  1,    1000,     60,    0, TEXT(TR_ID_UNITS_MS)),
     
+    PARAM_DESCR(PARAM_ID_SLIDING_WINDOW_Ua,      PARAM_TYPE_UINT,  0,    1,     0,    0, NOUNITS),
+    PARAM_DESCR(PARAM_ID_SLIDING_WINDOW_Ub,      PARAM_TYPE_UINT,  0,    1,     0,    0, NOUNITS),
+    PARAM_DESCR(PARAM_ID_SLIDING_WINDOW_Uc,      PARAM_TYPE_UINT,  0,    1,     0,    0, NOUNITS),
+    PARAM_DESCR(PARAM_ID_SLIDING_WINDOW_Urot,    PARAM_TYPE_UINT,  0,    1,     0,    0, NOUNITS),
+    PARAM_DESCR(PARAM_ID_SLIDING_WINDOW_Ia,      PARAM_TYPE_UINT,  0,    1,     0,    0, NOUNITS),
+    PARAM_DESCR(PARAM_ID_SLIDING_WINDOW_Ib,      PARAM_TYPE_UINT,  0,    1,     0,    0, NOUNITS),
+    PARAM_DESCR(PARAM_ID_SLIDING_WINDOW_Ic,      PARAM_TYPE_UINT,  0,    1,     0,    0, NOUNITS),
+    PARAM_DESCR(PARAM_ID_SLIDING_WINDOW_Irot,    PARAM_TYPE_UINT,  0,    1,     0,    0, NOUNITS),
+    PARAM_DESCR(PARAM_ID_SLIDING_WINDOW_Iexc,    PARAM_TYPE_UINT,  0,    1,     0,    0, NOUNITS),
+    PARAM_DESCR(PARAM_ID_SLIDING_WINDOW_Iref,    PARAM_TYPE_UINT,  0,    1,     0,    0, NOUNITS),
+    PARAM_DESCR(PARAM_ID_SLIDING_WINDOW_Ifan,    PARAM_TYPE_UINT,  0,    1,     0,    0, NOUNITS),
+    PARAM_DESCR(PARAM_ID_SLIDING_WINDOW_Erot,    PARAM_TYPE_UINT,  0,    1,     0,    0, NOUNITS),
+    
     // Виртуальные параметры.
             
     // данные питания
@@ -651,6 +674,31 @@ PARAM_DESCRS(parameters_descrs, PARAMETERS_COUNT) {
     PARAM_DESCR(PARAM_ID_PID_EXC_CURRENT, PARAM_TYPE_FRACT_100,  0, 0, 0, PARAM_FLAG_VIRTUAL, NOUNITS),
     PARAM_DESCR(PARAM_ID_PID_ROT_SPEED, PARAM_TYPE_FRACT_100,  0, 0, 0, PARAM_FLAG_VIRTUAL, NOUNITS),
     PARAM_DESCR(PARAM_ID_PID_ROT_CURRENT, PARAM_TYPE_FRACT_100,  0, 0, 0, PARAM_FLAG_VIRTUAL, NOUNITS),
+    // Профилирование.
+    PARAM_DESCR(PARAM_ID_PROF_ADC_DMA_IRQ_MAX,         PARAM_TYPE_FRACT_10, 0, 0, 0, PARAM_FLAG_VIRTUAL, TEXT(TR_ID_UNITS_US)),
+    PARAM_DESCR(PARAM_ID_PROF_ADC_DMA_IRQ_P99,         PARAM_TYPE_FRACT_10, 0, 0, 0, PARAM_FLAG_VIRTUAL, TEXT(TR_ID_UNITS_US)),
+    PARAM_DESCR(PARAM_ID_PROF_ADC_DMA_IRQ_LOAD,        PARAM_TYPE_FRACT_10, 0, 0, 0, PARAM_FLAG_VIRTUAL, TEXT(TR_ID_UNITS_PERCENT)),
+    PARAM_DESCR(PARAM_ID_PROF_TRIACS_PAIRS0_IRQ_MAX,   PARAM_TYPE_FRACT_10, 0, 0, 0, PARAM_FLAG_VIRTUAL, TEXT(TR_ID_UNITS_US)),
+    PARAM_DESCR(PARAM_ID_PROF_TRIACS_PAIRS0_IRQ_P99,   PARAM_TYPE_FRACT_10, 0, 0, 0, PARAM_FLAG_VIRTUAL, TEXT(TR_ID_UNITS_US)),
+    PARAM_DESCR(PARAM_ID_PROF_TRIACS_PAIRS0_IRQ_LOAD,  PARAM_TYPE_FRACT_10, 0, 0, 0, PARAM_FLAG_VIRTUAL, TEXT(TR_ID_UNITS_PERCENT)),
+    PARAM_DESCR(PARAM_ID_PROF_TRIAC_EXC_IRQ_MAX,       PARAM_TYPE_FRACT_10, 0, 0, 0, PARAM_FLAG_VIRTUAL, TEXT(TR_ID_UNITS_US)),
+    PARAM_DESCR(PARAM_ID_PROF_TRIAC_EXC_IRQ_P99,       PARAM_TYPE_FRACT_10, 0, 0, 0, PARAM_FLAG_VIRTUAL, TEXT(TR_ID_UNITS_US)),
+    PARAM_DESCR(PARAM_ID_PROF_TRIAC_EXC_IRQ_LOAD,      PARAM_TYPE_FRACT_10, 0, 0, 0, PARAM_FLAG_VIRTUAL, TEXT(TR_ID_UNITS_PERCENT)),
+    PARAM_DESCR(PARAM_ID_PROF_ADC_TASK_MAX,            PARAM_TYPE_FRACT_10, 0, 0, 0, PARAM_FLAG_VIRTUAL, TEXT(TR_ID_UNITS_US)),
+    PARAM_DESCR(PARAM_ID_PROF_ADC_TASK_P99,            PARAM_TYPE_FRACT_10, 0, 0, 0, PARAM_FLAG_VIRTUAL, TEXT(TR_ID_UNITS_US)),
+    PARAM_DESCR(PARAM_ID_PROF_ADC_TASK_LOAD,           PARAM_TYPE_FRACT_10, 0, 0, 0, PARAM_FLAG_VIRTUAL, TEXT(TR_ID_UNITS_PERCENT)),
+    PARAM_DESCR(PARAM_ID_PROF_TRIACS_ITER_MAX,         PARAM_TYPE_FRACT_10, 0, 0, 0, PARAM_FLAG_VIRTUAL, TEXT(TR_ID_UNITS_US)),
+    PARAM_DESCR(PARAM_ID_PROF_TRIACS_ITER_P99,         PARAM_TYPE_FRACT_10, 0, 0, 0, PARAM_FLAG_VIRTUAL, TEXT(TR_ID_UNITS_US)),
+    PARAM_DESCR(PARAM_ID_PROF_TRIACS_ITER_LOAD,        PARAM_TYPE_FRACT_10, 0, 0, 0, PARAM_FLAG_VIRTUAL, TEXT(TR_ID_UNITS_PERCENT)),
+    PARAM_DESCR(PARAM_ID_PROF_SYNC_ITER_MAX,           PARAM_TYPE_FRACT_10, 0, 0, 0, PARAM_FLAG_VIRTUAL, TEXT(TR_ID_UNITS_US)),
+    PARAM_DESCR(PARAM_ID_PROF_SYNC_ITER_P99,           PARAM_TYPE_FRACT_10, 0, 0, 0, PARAM_FLAG_VIRTUAL, TEXT(TR_ID_UNITS_US)),
+    PARAM_DESCR(PARAM_ID_PROF_SYNC_ITER_LOAD,          PARAM_TYPE_FRACT_10, 0, 0, 0, PARAM_FLAG_VIRTUAL, TEXT(TR_ID_UNITS_PERCENT)),
+    PARAM_DESCR(PARAM_ID_PROF_MAIN_ITER_MAX,           PARAM_TYPE_FRACT_10, 0, 0, 0, PARAM_FLAG_VIRTUAL, TEXT(TR_ID_UNITS_US)),
+    PARAM_DESCR(PARAM_ID_PROF_MAIN_ITER_P99,           PARAM_TYPE_FRACT_10, 0, 0, 0, PARAM_FLAG_VIRTUAL, TEXT(TR_ID_UNITS_US)),
+    PARAM_DESCR(PARAM_ID_PROF_MAIN_ITER_LOAD,          PARAM_TYPE_FRACT_10, 0, 0, 0, PARAM_FLAG_VIRTUAL, TEXT(TR_ID_UNITS_PERCENT)),
+    PARAM_DESCR(PARAM_ID_PROF_TRIACS_PAIRS1_IRQ_MAX,   PARAM_TYPE_FRACT_10, 0, 0, 0, PARAM_FLAG_VIRTUAL, TEXT(TR_ID_UNITS_US)),
+    PARAM_DESCR(PARAM_ID_PROF_TRIACS_PAIRS1_IRQ_P99,   PARAM_TYPE_FRACT_10, 0, 0, 0, PARAM_FLAG_VIRTUAL, TEXT(TR_ID_UNITS_US)),
+    PARAM_DESCR(PARAM_ID_PROF_TRIACS_PAIRS1_IRQ_LOAD,  PARAM_TYPE_FRACT_10, 0, 0, 0, PARAM_FLAG_VIRTUAL, TEXT(TR_ID_UNITS_PERCENT)),
     // Отладка.
     PARAM_DESCR(PARAM_ID_DEBUG_0, PARAM_TYPE_INT,        0, 0, 0, PARAM_FLAG_VIRTUAL, NOUNITS),
     PARAM_DESCR(PARAM_ID_DEBUG_1, PARAM_TYPE_INT,        0, 0, 0, PARAM_FLAG_VIRTUAL, NOUNITS),
@@ -160,7 +160,7 @@ MENU_VALUE_ENUM(menu_val_gui_tiles_for_warnings, 0, MENU_ENUM_LEN(menu_enum_gui_
 MENU_VALUE_STRING(menu_val_firmware_version, MAKE_STRING(__GIT_VERSION));
 MENU_VALUE_STRING(menu_val_firmware_datetime, MAKE_STRING(__GIT_DATETIME));
 
-DECLARE_MENU_ITEMS(m_item1, m_item2, m_item3, m_item4, m_item5, m_item6, m_item7, m_item8, m_item9, m_item10, m_item11, m_item12, m_item13, m_item14, m_item15, m_item16, m_item17, m_item18, m_item19, m_item20, m_item21, m_item22, m_item23, m_item24, m_item25, m_item26, m_item27, m_item28, m_item29, m_item30, m_item31, m_item32, m_item33, m_item34, m_item35, m_item36, m_item37, m_item38, m_item39, m_item40, m_item41, m_item42, m_item43, m_item44, m_item45, m_item46, m_item47, m_item48, m_item49, m_item50, m_item51, m_item52, m_item53, m_item54, m_item55, m_item56, m_item57, m_item58, m_item59, m_item60, m_item61, m_item62, m_item63, m_item64, m_item65, m_item66, m_item67, m_item68, m_item69, m_item70, m_item71, m_item72, m_item73, m_item74, m_item75, m_item76, m_item77, m_item78, m_item79, m_item80, m_item81, m_item82, m_item83, m_item84, m_item85, m_item86, m_item87, m_item88, m_item89, m_item90, m_item91, m_item92, m_item93, m_item94, m_item95, m_item96, m_item97, m_item98, m_item99, m_item100, m_item101, m_item102, m_item103, m_item104, m_item105, m_item106, m_item107, m_item108, m_item109, m_item110, m_item111, m_item112, m_item113, m_item114, m_item115, m_item116, m_item117, m_item118, m_item119, m_item120, m_item121, m_item122, m_item123, m_item124, m_item125, m_item126, m_item127, m_item128, m_item129, m_item130, m_item131, m_item132, m_item133, m_item134, m_item135, m_item136, m_item137, m_item138, m_item139, m_item140, m_item141, m_item142, m_item143, m_item144, m_item145, m_item146, m_item147, m_item148, m_item149, m_item150, m_item151, m_item152, m_item153, m_item154, m_item155, m_item156, m_item157, m_item158, m_item159, m_item160, m_item161, m_item162, m_item163, m_item164, m_item165, m_item166, m_item167, m_item168, m_item169, m_item170, m_item171, m_item172, m_item173, m_item174, m_item175, m_item176, m_item177, m_item178, m_item179, m_item180, m_item181, m_item182, m_item183, m_item184, m_item185, m_item186, m_item187, m_item188, m_item189, m_item190, m_item191, m_item192, m_item193, m_item194, m_item195, m_item196, m_item197, m_item198, m_item199, m_item200, m_item201, m_item202, m_item203, m_item204, m_item205, m_item206, m_item207, m_item208, m_item209, m_item210, m_item211, m_item212, m_item213, m_item214, m_item215, m_item216, m_item217, m_item218, m_item219, m_item220, m_item221, m_item222, m_item223, m_item224, m_item225, m_item226, m_item227, m_item228, m_item229, m_item230, m_item231, m_item232, m_item233, m_item234, m_item235, m_item236, m_item237, m_item238, m_item239, m_item240, m_item241, m_item242, m_item243, m_item244, m_item245, m_item246, m_item247, m_item248, m_item249, m_item250, m_item251, m_item252, m_item253, m_item254, m_item255, m_item256, m_item257, m_item258, m_item259, m_item260, m_item261, m_item262, m_item263, m_item264, m_item265, m_item266, m_item267, m_item268, m_item269, m_item270, m_item271, m_item272, m_item273, m_item274, m_item275, m_item276, m_item277, m_item278, m_item279, m_item280, m_item281, m_item282, m_item283, m_item284, m_item285, m_item286, m_item287, m_item288, m_item289, m_item290, m_item291, m_item292, m_item293, m_item294, m_item295, m_item296, m_item297, m_item298, m_item299, m_item300, m_item301, m_item302, m_item303, m_item304, m_item305, m_item306, m_item307, m_item308, m_item309, m_item310, m_item311, m_item312, m_item313, m_item314, m_item315, m_item316, m_item317, m_item318, m_item319, m_item320, m_item321, m_item322, m_item323, m_item324, m_item325, m_item326, m_item327, m_item328, m_item329, m_item330, m_item331, m_item332, m_item333, m_item334, m_item335, m_item336, m_item337, m_item338, m_item339, m_item340, m_item341, m_item342, m_item343, m_item344, m_item345, m_item346, m_item347, m_item348, m_item349, m_item350, m_item351, m_item352, m_item353, m_item354, m_item355, m_item356, m_item357, m_item358, m_item359, m_item360, m_item361, m_item362, m_item363, m_item364, m_item365, m_item366, m_item367, m_item368, m_item369, m_item370, m_item371, m_item372, m_item373, m_item374, m_item375, m_item376, m_item377, m_item378, m_item379, m_item380, m_item381, m_item382, m_item383, m_item384, m_item385, m_item386, m_item387, m_item388, m_item389, m_item390, m_item391, m_item392, m_item393, m_item394, m_item395, m_item396, m_item397, m_item398, m_item399, m_item400, m_item401, m_item402, m_item403, m_item404, m_item405, m_item406, m_item407, m_item408, m_item409, m_item410, m_item411, m_item412, m_item413, m_item414, m_item415, m_item416, m_item417, m_item418, m_item419, m_item420, m_item421, m_item422, m_item423, m_item424, m_item425, m_item426, m_item427, m_item428, m_item429, m_item430, m_item431, m_item432, m_item433, m_item434, m_item435, m_item436, m_item437, m_item438, m_item439, m_item440, m_item441, m_item442, m_item443, m_item444, m_item445, m_item446, m_item447, m_item448, m_item449, m_item450, m_item451, m_item452, m_item453, m_item454, m_item455, m_item456, m_item457, m_item458, m_item459, m_item460, m_item461, m_item462, m_item463, m_item464, m_item465, m_item466, m_item467, m_item468, m_item469, m_item470, m_item471, m_item472, m_item473, m_item474, m_item475, m_item476, m_item477, m_item478, m_item479, m_item480, m_item481, m_item482, m_item483, m_item484, m_item485, m_item486, m_item487, m_item488, m_item489, m_item490, m_item491, m_item492, m_item493, m_item4110, m_item8_1, m_item144_1, m_item144_2, m_item144_3);
+DECLARE_MENU_ITEMS(m_item1, m_item2, m_item3, m_item4, m_item5, m_item6, m_item7, m_item8, m_item9, m_item10, m_item11, m_item12, m_item13, m_item14, m_item15, m_item16, m_item17, m_item18, m_item19, m_item20, m_item21, m_item22, m_item23, m_item24, m_item25, m_item26, m_item27, m_item28, m_item29, m_item30, m_item31, m_item32, m_item33, m_item34, m_item35, m_item36, m_item37, m_item38, m_item39, m_item40, m_item41, m_item42, m_item43, m_item44, m_item45, m_item46, m_item47, m_item48, m_item49, m_item50, m_item51, m_item52, m_item53, m_item54, m_item55, m_item56, m_item57, m_item58, m_item59, m_item60, m_item61, m_item62, m_item63, m_item64, m_item65, m_item66, m_item67, m_item68, m_item69, m_item70, m_item71, m_item72, m_item73, m_item74, m_item75, m_item76, m_item77, m_item78, m_item79, m_item80, m_item81, m_item82, m_item83, m_item84, m_item85, m_item86, m_item87, m_item88, m_item89, m_item90, m_item91, m_item92, m_item93, m_item94, m_item95, m_item96, m_item97, m_item98, m_item99, m_item100, m_item101, m_item102, m_item103, m_item104, m_item105, m_item106, m_item107, m_item108, m_item109, m_item110, m_item111, m_item112, m_item113, m_item114, m_item115, m_item116, m_item117, m_item118, m_item119, m_item120, m_item121, m_item122, m_item123, m_item124, m_item125, m_item126, m_item127, m_item128, m_item129, m_item130, m_item131, m_item132, m_item133, m_item134, m_item135, m_item136, m_item137, m_item138, m_item139, m_item140, m_item141, m_item142, m_item143, m_item144, m_item145, m_item146, m_item147, m_item148, m_item149, m_item150, m_item151, m_item152, m_item153, m_item154, m_item155, m_item156, m_item157, m_item158, m_item159, m_item160, m_item161, m_item162, m_item163, m_item164, m_item165, m_item166, m_item167, m_item168, m_item169, m_item170, m_item171, m_item172, m_item173, m_item174, m_item175, m_item176, m_item177, m_item178, m_item179, m_item180, m_item181, m_item182, m_item183, m_item184, m_item185, m_item186, m_item187, m_item188, m_item189, m_item190, m_item191, m_item192, m_item193, m_item194, m_item195, m_item196, m_item197, m_item198, m_item199, m_item200, m_item201, m_item202, m_item203, m_item204, m_item205, m_item206, m_item207, m_item208, m_item209, m_item210, m_item211, m_item212, m_item213, m_item214, m_item215, m_item216, m_item217, m_item218, m_item219, m_item220, m_item221, m_item222, m_item223, m_item224, m_item225, m_item226, m_item227, m_item228, m_item229, m_item230, m_item231, m_item232, m_item233, m_item234, m_item235, m_item236, m_item237, m_item238, m_item239, m_item240, m_item241, m_item242, m_item243, m_item244, m_item245, m_item246, m_item247, m_item248, m_item249, m_item250, m_item251, m_item252, m_item253, m_item254, m_item255, m_item256, m_item257, m_item258, m_item259, m_item260, m_item261, m_item262, m_item263, m_item264, m_item265, m_item266, m_item267, m_item268, m_item269, m_item270, m_item271, m_item272, m_item273, m_item274, m_item275, m_item276, m_item277, m_item278, m_item279, m_item280, m_item281, m_item282, m_item283, m_item284, m_item285, m_item286, m_item287, m_item288, m_item289, m_item290, m_item291, m_item292, m_item293, m_item294, m_item295, m_item296, m_item297, m_item298, m_item299, m_item300, m_item301, m_item302, m_item303, m_item304, m_item305, m_item306, m_item307, m_item308, m_item309, m_item310, m_item311, m_item312, m_item313, m_item314, m_item315, m_item316, m_item317, m_item318, m_item319, m_item320, m_item321, m_item322, m_item323, m_item324, m_item325, m_item326, m_item327, m_item328, m_item329, m_item330, m_item331, m_item332, m_item333, m_item334, m_item335, m_item336, m_item337, m_item338, m_item339, m_item340, m_item341, m_item342, m_item343, m_item344, m_item345, m_item346, m_item347, m_item348, m_item349, m_item350, m_item351, m_item352, m_item353, m_item354, m_item355, m_item356, m_item357, m_item358, m_item359, m_item360, m_item361, m_item362, m_item363, m_item364, m_item365, m_item366, m_item367, m_item368, m_item369, m_item370, m_item371, m_item372, m_item373, m_item374, m_item375, m_item376, m_item377, m_item378, m_item379, m_item380, m_item381, m_item382, m_item383, m_item384, m_item385, m_item386, m_item387, m_item388, m_item389, m_item390, m_item391, m_item392, m_item393, m_item394, m_item395, m_item396, m_item397, m_item398, m_item399, m_item400, m_item401, m_item402, m_item403, m_item404, m_item405, m_item406, m_item407, m_item408, m_item409, m_item410, m_item411, m_item412, m_item413, m_item414, m_item415, m_item416, m_item417, m_item418, m_item419, m_item420, m_item421, m_item422, m_item423, m_item424, m_item425, m_item426, m_item427, m_item428, m_item429, m_item430, m_item431, m_item432, m_item433, m_item434, m_item435, m_item436, m_item437, m_item438, m_item439, m_item440, m_item441, m_item442, m_item443, m_item444, m_item445, m_item446, m_item447, m_item448, m_item449, m_item450, m_item451, m_item452, m_item453, m_item454, m_item455, m_item456, m_item457, m_item458, m_item459, m_item460, m_item461, m_item462, m_item463, m_item464, m_item465, m_item466, m_item467, m_item468, m_item469, m_item470, m_item471, m_item472, m_item473, m_item474, m_item475, m_item476, m_item477, m_item478, m_item479, m_item480, m_item481, m_item482, m_item483, m_item484, m_item485, m_item486, m_item487, m_item488, m_item489, m_item490, m_item491, m_item492, m_item493, m_item494, m_item495, m_item496, m_item497, m_item498, m_item499, m_item500, m_item501, m_item502, m_item503, m_item504, m_item505, m_item506, m_item4110, m_item8_1, m_item144_1, m_item144_2, m_item144_3, m_item42_1, m_item42_2, m_item42_3, m_item42_4, m_item42_5, m_item42_6, m_item42_7, m_item42_8, m_item42_9, m_item42_10, m_item42_11, m_item42_12, m_item42_13, m_item42_14, m_item42_15, m_item42_16, m_item42_17, m_item42_18, m_item42_19, m_item42_20, m_item42_21, m_item42_22, m_item42_23, m_item42_24, m_item42_25, m_item42_26, m_item42_27, m_item42_28, m_item42_29);
 
 SUBMENU(m_item1, 0, NULL, &m_item2, NULL, &m_item9, TEXT(TR_ID_MENU_COMMANDS), NULL, 0, 0, 0);
 	MENU_ITEM(m_item2, CMD_ID_START_STOP, &m_item1, NULL, NULL, &m_item3, TEXT(TR_ID_MENU_CMD_START_STOP), NULL, 0, 0, MENU_FLAG_CMD | MENU_FLAG_ADMIN, 0);
@@ -204,11 +204,44 @@ SUBMENU(m_item9, 0, NULL, &m_item10, &m_item1, &m_item47, TEXT(TR_ID_MENU_STATUS
 		MENU_ITEM(m_item39, PARAM_ID_DIGITAL_OUT_2_STATE, &m_item37, NULL, &m_item38, &m_item40, TEXT(TR_ID_MENU_DIGITAL_OUT_2_STATE), NULL, 0, &menu_val_gui_digital_states, MENU_FLAG_VALUE, 0);
 		MENU_ITEM(m_item40, PARAM_ID_DIGITAL_OUT_3_STATE, &m_item37, NULL, &m_item39, &m_item41, TEXT(TR_ID_MENU_DIGITAL_OUT_3_STATE), NULL, 0, &menu_val_gui_digital_states, MENU_FLAG_VALUE, 0);
 		MENU_ITEM(m_item41, PARAM_ID_DIGITAL_OUT_4_STATE, &m_item37, NULL, &m_item40, NULL, TEXT(TR_ID_MENU_DIGITAL_OUT_4_STATE), NULL, 0, &menu_val_gui_digital_states, MENU_FLAG_VALUE, 0);
-	SUBMENU(m_item42, 0, &m_item9, &m_item43, &m_item37, NULL, TEXT(TR_ID_MENU_RUNTIMES), NULL, 0, 0, 0);
+	SUBMENU(m_item42, 0, &m_item9, &m_item43, &m_item37, &m_item42_1, TEXT(TR_ID_MENU_RUNTIMES), NULL, 0, 0, 0);
 		MENU_ITEM(m_item43, PARAM_ID_LAST_RUNTIME, &m_item42, NULL, NULL, &m_item44, TEXT(TR_ID_MENU_LAST_RUNTIME), NULL, 0, 0, MENU_FLAG_VALUE, 0);
 		MENU_ITEM(m_item44, PARAM_ID_RUNTIME, &m_item42, NULL, &m_item43, &m_item45, TEXT(TR_ID_MENU_RUNTIME), NULL, 0, 0, MENU_FLAG_VALUE, 0);
 		MENU_ITEM(m_item45, PARAM_ID_FAN_RUNTIME, &m_item42, NULL, &m_item44, &m_item46, TEXT(TR_ID_MENU_FAN_RUNTIME), NULL, 0, 0, MENU_FLAG_VALUE, 0);
 		MENU_ITEM(m_item46, PARAM_ID_LIFETIME, &m_item42, NULL, &m_item45, NULL, TEXT(TR_ID_MENU_LIFETIME), NULL, 0, 0, MENU_FLAG_VALUE, 0);
+	SUBMENU(m_item42_1, 0, &m_item9, &m_item42_2, &m_item42, NULL, TEXT(TR_ID_MENU_DIAG), NULL, 0, 0, 0);
+		SUBMENU(m_item42_2, 0, &m_item42_1, &m_item42_3, NULL, &m_item42_6, TEXT(TR_ID_MENU_DIAG_ADC_DMA_IRQ), NULL, 0, 0, 0);
+			MENU_ITEM(m_item42_3, PARAM_ID_PROF_ADC_DMA_IRQ_MAX, &m_item42_2, NULL, NULL, &m_item42_4, TEXT(TR_ID_MENU_DIAG_MAX), NULL, 0, 0, MENU_FLAG_VALUE, 0);
+			MENU_ITEM(m_item42_4, PARAM_ID_PROF_ADC_DMA_IRQ_P99, &m_item42_2, NULL, &m_item42_3, &m_item42_5, TEXT(TR_ID_MENU_DIAG_P99), NULL, 0, 0, MENU_FLAG_VALUE, 0);
+			MENU_ITEM(m_item42_5, PARAM_ID_PROF_ADC_DMA_IRQ_LOAD, &m_item42_2, NULL, &m_item42_4, NULL, TEXT(TR_ID_MENU_DIAG_LOAD), NULL, 0, 0, MENU_FLAG_VALUE, 0);
+		SUBMENU(m_item42_6, 0, &m_item42_1, &m_item42_7, &m_item42_2, &m_item42_30, TEXT(TR_ID_MENU_DIAG_TRIACS_PAIRS0_IRQ), NULL, 0, 0, 0);
+			MENU_ITEM(m_item42_7, PARAM_ID_PROF_TRIACS_PAIRS0_IRQ_MAX, &m_item42_6, NULL, NULL, &m_item42_8, TEXT(TR_ID_MENU_DIAG_MAX), NULL, 0, 0, MENU_FLAG_VALUE, 0);
+			MENU_ITEM(m_item42_8, PARAM_ID_PROF_TRIACS_PAIRS0_IRQ_P99, &m_item42_6, NULL, &m_item42_7, &m_item42_9, TEXT(TR_ID_MENU_DIAG_P99), NULL, 0, 0, MENU_FLAG_VALUE, 0);
+			MENU_ITEM(m_item42_9, PARAM_ID_PROF_TRIACS_PAIRS0_IRQ_LOAD, &m_item42_6, NULL, &m_item42_8, NULL, TEXT(TR_ID_MENU_DIAG_LOAD), NULL, 0, 0, MENU_FLAG_VALUE, 0);
+		SUBMENU(m_item42_30, 0, &m_item42_1, &m_item42_31, &m_item42_6, &m_item42_10, TEXT(TR_ID_MENU_DIAG_TRIACS_PAIRS1_IRQ), NULL, 0, 0, 0);
+			MENU_ITEM(m_item42_31, PARAM_ID_PROF_TRIACS_PAIRS1_IRQ_MAX, &m_item42_30, NULL, NULL, &m_item42_32, TEXT(TR_ID_MENU_DIAG_MAX), NULL, 0, 0, MENU_FLAG_VALUE, 0);
+			MENU_ITEM(m_item42_32, PARAM_ID_PROF_TRIACS_PAIRS1_IRQ_P99, &m_item42_30, NULL, &m_item42_31, &m_item42_33, TEXT(TR_ID_MENU_DIAG_P99), NULL, 0, 0, MENU_FLAG_VALUE, 0);
+			MENU_ITEM(m_item42_33, PARAM_ID_PROF_TRIACS_PAIRS1_IRQ_LOAD, &m_item42_30, NULL, &m_item42_32, NULL, TEXT(TR_ID_MENU_DIAG_LOAD), NULL, 0, 0, MENU_FLAG_VALUE, 0);
+		SUBMENU(m_item42_10, 0, &m_item42_1, &m_item42_11, &m_item42_30, &m_item42_14, TEXT(TR_ID_MENU_DIAG_TRIAC_EXC_IRQ), NULL, 0, 0, 0);
+			MENU_ITEM(m_item42_11, PARAM_ID_PROF_TRIAC_EXC_IRQ_MAX, &m_item42_10, NULL, NULL, &m_item42_12, TEXT(TR_ID_MENU_DIAG_MAX), NULL, 0, 0, MENU_FLAG_VALUE, 0);
+			MENU_ITEM(m_item42_12, PARAM_ID_PROF_TRIAC_EXC_IRQ_P99, &m_item42_10, NULL, &m_item42_11, &m_item42_13, TEXT(TR_ID_MENU_DIAG_P99), NULL, 0, 0, MENU_FLAG_VALUE, 0);
+			MENU_ITEM(m_item42_13, PARAM_ID_PROF_TRIAC_EXC_IRQ_LOAD, &m_item42_10, NULL, &m_item42_12, NULL, TEXT(TR_ID_MENU_DIAG_LOAD), NULL, 0, 0, MENU_FLAG_VALUE, 0);
+		SUBMENU(m_item42_14, 0, &m_item42_1, &m_item42_15, &m_item42_10, &m_item42_18, TEXT(TR_ID_MENU_DIAG_ADC_TASK), NULL, 0, 0, 0);
+			MENU_ITEM(m_item42_15, PARAM_ID_PROF_ADC_TASK_MAX, &m_item42_14, NULL, NULL, &m_item42_16, TEXT(TR_ID_MENU_DIAG_MAX), NULL, 0, 0, MENU_FLAG_VALUE, 0);
+			MENU_ITEM(m_item42_16, PARAM_ID_PROF_ADC_TASK_P99, &m_item42_14, NULL, &m_item42_15, &m_item42_17, TEXT(TR_ID_MENU_DIAG_P99), NULL, 0, 0, MENU_FLAG_VALUE, 0);
+			MENU_ITEM(m_item42_17, PARAM_ID_PROF_ADC_TASK_LOAD, &m_item42_14, NULL, &m_item42_16, NULL, TEXT(TR_ID_MENU_DIAG_LOAD), NULL, 0, 0, MENU_FLAG_VALUE, 0);
+		SUBMENU(m_item42_18, 0, &m_item42_1, &m_item42_19, &m_item42_14, &m_item42_22, TEXT(TR_ID_MENU_DIAG_TRIACS_ITER), NULL, 0, 0, 0);
+			MENU_ITEM(m_item42_19, PARAM_ID_PROF_TRIACS_ITER_MAX, &m_item42_18, NULL, NULL, &m_item42_20, TEXT(TR_ID_MENU_DIAG_MAX), NULL, 0, 0, MENU_FLAG_VALUE, 0);
+			MENU_ITEM(m_item42_20, PARAM_ID_PROF_TRIACS_ITER_P99, &m_item42_18, NULL, &m_item42_19, &m_item42_21, TEXT(TR_ID_MENU_DIAG_P99), NULL, 0, 0, MENU_FLAG_VALUE, 0);
+			MENU_ITEM(m_item42_21, PARAM_ID_PROF_TRIACS_ITER_LOAD, &m_item42_18, NULL, &m_item42_20, NULL, TEXT(TR_ID_MENU_DIAG_LOAD), NULL, 0, 0, MENU_FLAG_VALUE, 0);
+		SUBMENU(m_item42_22, 0, &m_item42_1, &m_item42_23, &m_item42_18, &m_item42_26, TEXT(TR_ID_MENU_DIAG_SYNC_ITER), NULL, 0, 0, 0);
+			MENU_ITEM(m_item42_23, PARAM_ID_PROF_SYNC_ITER_MAX, &m_item42_22, NULL, NULL, &m_item42_24, TEXT(TR_ID_MENU_DIAG_MAX), NULL, 0, 0, MENU_FLAG_VALUE, 0);
+			MENU_ITEM(m_item42_24, PARAM_ID_PROF_SYNC_ITER_P99, &m_item42_22, NULL, &m_item42_23, &m_item42_25, TEXT(TR_ID_MENU_DIAG_P99), NULL, 0, 0, MENU_FLAG_VALUE, 0);
+			MENU_ITEM(m_item42_25, PARAM_ID_PROF_SYNC_ITER_LOAD, &m_item42_22, NULL, &m_item42_24, NULL, TEXT(TR_ID_MENU_DIAG_LOAD), NULL, 0, 0, MENU_FLAG_VALUE, 0);
+		SUBMENU(m_item42_26, 0, &m_item42_1, &m_item42_27, &m_item42_22, NULL, TEXT(TR_ID_MENU_DIAG_MAIN_ITER), NULL, 0, 0, 0);
+			MENU_ITEM(m_item42_27, PARAM_ID_PROF_MAIN_ITER_MAX, &m_item42_26, NULL, NULL, &m_item42_28, TEXT(TR_ID_MENU_DIAG_MAX), NULL, 0, 0, MENU_FLAG_VALUE, 0);
+			MENU_ITEM(m_item42_28, PARAM_ID_PROF_MAIN_ITER_P99, &m_item42_26, NULL, &m_item42_27, &m_item42_29, TEXT(TR_ID_MENU_DIAG_P99), NULL, 0, 0, MENU_FLAG_VALUE, 0);
+			MENU_ITEM(m_item42_29, PARAM_ID_PROF_MAIN_ITER_LOAD, &m_item42_26, NULL, &m_item42_28, NULL, TEXT(TR_ID_MENU_DIAG_LOAD), NULL, 0, 0, MENU_FLAG_VALUE, 0);
 SUBMENU(m_item47, 0, NULL, &m_item48, &m_item9, &m_item132, TEXT(TR_ID_MENU_GUI), NULL, 0, MENU_FLAG_ROOT, 0);
 	MENU_ITEM(m_item48, PARAM_ID_GUI_PASSWORD_ADMIN, &m_item47, NULL, NULL, &m_item49, TEXT(TR_ID_MENU_GUI_PASSWORD_ADMIN), NULL, 0, 0, MENU_FLAG_DATA | MENU_FLAG_ADMIN, 0);
 	MENU_ITEM(m_item49, PARAM_ID_GUI_PASSWORD_ROOT, &m_item47, NULL, &m_item48, &m_item50, TEXT(TR_ID_MENU_GUI_PASSWORD_ROOT), NULL, 0, 0, MENU_FLAG_DATA | MENU_FLAG_ROOT, 0);
@@ -648,7 +681,7 @@ SUBMENU(m_item470, 0, NULL, &m_item471, &m_item458, &m_item482, TEXT(TR_ID_MENU_
 	MENU_ITEM(m_item479, PARAM_ID_ADC_CALIBRATION_DATA_Iexc, &m_item470, NULL, &m_item478, &m_item480, TEXT(TR_ID_MENU_ADC_CALIBRATION_DATA_Iexc), NULL, 0, 0, MENU_FLAG_DATA, 0);
 	MENU_ITEM(m_item480, PARAM_ID_ADC_CALIBRATION_DATA_Iref, &m_item470, NULL, &m_item479, &m_item481, TEXT(TR_ID_MENU_ADC_CALIBRATION_DATA_Iref), NULL, 0, 0, MENU_FLAG_DATA, 0);
 	MENU_ITEM(m_item481, PARAM_ID_ADC_CALIBRATION_DATA_Ifan, &m_item470, NULL, &m_item480, NULL, TEXT(TR_ID_MENU_ADC_CALIBRATION_DATA_Ifan), NULL, 0, 0, MENU_FLAG_DATA, 0);
-SUBMENU(m_item482, 0, NULL, &m_item483, &m_item470, NULL, TEXT(TR_ID_MENU_VALUE_MULTS), NULL, 0, 0, 0);
+SUBMENU(m_item482, 0, NULL, &m_item483, &m_item470, &m_item494, TEXT(TR_ID_MENU_VALUE_MULTS), NULL, 0, 0, 0);
 	MENU_ITEM(m_item483, PARAM_ID_VALUE_MULTIPLIER_Ua, &m_item482, NULL, NULL, &m_item484, TEXT(TR_ID_MENU_VALUE_MULT_Ua), NULL, 0, 0, MENU_FLAG_DATA, 0);
 	MENU_ITEM(m_item484, PARAM_ID_VALUE_MULTIPLIER_Ub, &m_item482, NULL, &m_item483, &m_item485, TEXT(TR_ID_MENU_VALUE_MULT_Ub), NULL, 0, 0, MENU_FLAG_DATA, 0);
 	MENU_ITEM(m_item485, PARAM_ID_VALUE_MULTIPLIER_Uc, &m_item482, NULL, &m_item484, &m_item486, TEXT(TR_ID_MENU_VALUE_MULT_Uc), NULL, 0, 0, MENU_FLAG_DATA, 0);
@@ -660,6 +693,19 @@ SUBMENU(m_item482, 0, NULL, &m_item483, &m_item470, NULL, TEXT(TR_ID_MENU_VALUE_
 	MENU_ITEM(m_item491, PARAM_ID_VALUE_MULTIPLIER_Iexc, &m_item482, NULL, &m_item490, &m_item492, TEXT(TR_ID_MENU_VALUE_MULT_Iexc), NULL, 0, 0, MENU_FLAG_DATA, 0);
 	MENU_ITEM(m_item492, PARAM_ID_VALUE_MULTIPLIER_Iref, &m_item482, NULL, &m_item491, &m_item493, TEXT(TR_ID_MENU_VALUE_MULT_Iref), NULL, 0, 0, MENU_FLAG_DATA, 0);
 	MENU_ITEM(m_item493, PARAM_ID_VALUE_MULTIPLIER_Ifan, &m_item482, NULL, &m_item492, NULL, TEXT(TR_ID_MENU_VALUE_MULT_Ifan), NULL, 0, 0, MENU_FLAG_DATA, 0);
+SUBMENU(m_item494, 0, NULL, &m_item495, &m_item482, NULL, TEXT(TR_ID_MENU_SLIDING_WINDOWS), NULL, 0, 0, 0);
+	MENU_ITEM(m_item495, PARAM_ID_SLIDING_WINDOW_Ua, &m_item494, NULL, NULL, &m_item496, TEXT(TR_ID_MENU_SLIDING_WINDOW_Ua), NULL, 0, &menu_val_bool, MENU_FLAG_DATA, 0);
+	MENU_ITEM(m_item496, PARAM_ID_SLIDING_WINDOW_Ub, &m_item494, NULL, &m_item495, &m_item497, TEXT(TR_ID_MENU_SLIDING_WINDOW_Ub), NULL, 0, &menu_val_bool, MENU_FLAG_DATA, 0);
+	MENU_ITEM(m_item497, PARAM_ID_SLIDING_WINDOW_Uc, &m_item494, NULL, &m_item496, &m_item498, TEXT(TR_ID_MENU_SLIDING_WINDOW_Uc), NULL, 0, &menu_val_bool, MENU_FLAG_DATA, 0);
+	MENU_ITEM(m_item498, PARAM_ID_SLIDING_WINDOW_Urot, &m_item494, NULL, &m_item497, &m_item499, TEXT(TR_ID_MENU_SLIDING_WINDOW_Urot), NULL, 0, &menu_val_bool, MENU_FLAG_DATA, 0);
+	MENU_ITEM(m_item499, PARAM_ID_SLIDING_WINDOW_Ia, &m_item494, NULL, &m_item498, &m_item500, TEXT(TR_ID_MENU_SLIDING_WINDOW_Ia), NULL, 0, &menu_val_bool, MENU_FLAG_DATA, 0);
+	MENU_ITEM(m_item500, PARAM_ID_SLIDING_WINDOW_Ib, &m_item494, NULL, &m_item499, &m_item501, TEXT(TR_ID_MENU_SLIDING_WINDOW_Ib), NULL, 0, &menu_val_bool, MENU_FLAG_DATA, 0);
+	MENU_ITEM(m_item501, PARAM_ID_SLIDING_WINDOW_Ic, &m_item494, NULL, &m_item500, &m_item502, TEXT(TR_ID_MENU_SLIDING_WINDOW_Ic), NULL, 0, &menu_val_bool, MENU_FLAG_DATA, 0);
+	MENU_ITEM(m_item502, PARAM_ID_SLIDING_WINDOW_Irot, &m_item494, NULL, &m_item501, &m_item503, TEXT(TR_ID_MENU_SLIDING_WINDOW_Irot), NULL, 0, &menu_val_bool, MENU_FLAG_DATA, 0);
+	MENU_ITEM(m_item503, PARAM_ID_SLIDING_WINDOW_Iexc, &m_item494, NULL, &m_item502, &m_item504, TEXT(TR_ID_MENU_SLIDING_WINDOW_Iexc), NULL, 0, &menu_val_bool, MENU_FLAG_DATA, 0);
+	MENU_ITEM(m_item504, PARAM_ID_SLIDING_WINDOW_Iref, &m_item494, NULL, &m_item503, &m_item505, TEXT(TR_ID_MENU_SLIDING_WINDOW_Iref), NULL, 0, &menu_val_bool, MENU_FLAG_DATA, 0);
+	MENU_ITEM(m_item505, PARAM_ID_SLIDING_WINDOW_Ifan, &m_item494, NULL, &m_item504, &m_item506, TEXT(TR_ID_MENU_SLIDING_WINDOW_Ifan), NULL, 0, &menu_val_bool, MENU_FLAG_DATA, 0);
+	MENU_ITEM(m_item506, PARAM_ID_SLIDING_WINDOW_Erot, &m_item494, NULL, &m_item505, NULL, TEXT(TR_ID_MENU_SLIDING_WINDOW_Erot), NULL, 0, &menu_val_bool, MENU_FLAG_DATA, 0);
 
 /**
  * Дескрипторы элементов меню.
@@ -723,6 +769,40 @@ MENU_DESCRS(menu_descrs) {
             MENU_DESCR(2, PARAM_ID_FAN_RUNTIME, TEXT(TR_ID_MENU_FAN_RUNTIME), NULL, 0, MENU_FLAG_VALUE, 0, 0),
             // Время во вкл.состоянии (включая готовность)
             MENU_DESCR(2, PARAM_ID_LIFETIME, TEXT(TR_ID_MENU_LIFETIME), NULL, 0, MENU_FLAG_VALUE, 0, 0),
+        // Диагностика
+        MENU_DESCR(1, 0, TEXT(TR_ID_MENU_DIAG), NULL, 0, 0, 0, 0),
+            MENU_DESCR(2, 0, TEXT(TR_ID_MENU_DIAG_ADC_DMA_IRQ), NULL, 0, 0, 0, 0),
+                MENU_DESCR(3, PARAM_ID_PROF_ADC_DMA_IRQ_MAX, TEXT(TR_ID_MENU_DIAG_MAX), NULL, 0, MENU_FLAG_VALUE, 0, 0),
+                MENU_DESCR(3, PARAM_ID_PROF_ADC_DMA_IRQ_P99, TEXT(TR_ID_MENU_DIAG_P99), NULL, 0, MENU_FLAG_VALUE, 0, 0),
+                MENU_DESCR(3, PARAM_ID_PROF_ADC_DMA_IRQ_LOAD, TEXT(TR_ID_MENU_DIAG_LOAD), NULL, 0, MENU_FLAG_VALUE, 0, 0),
+            MENU_DESCR(2, 0, TEXT(TR_ID_MENU_DIAG_TRIACS_PAIRS0_IRQ), NULL, 0, 0, 0, 0),
+                MENU_DESCR(3, PARAM_ID_PROF_TRIACS_PAIRS0_IRQ_MAX, TEXT(TR_ID_MENU_DIAG_MAX), NULL, 0, MENU_FLAG_VALUE, 0, 0),
+                MENU_DESCR(3, PARAM_ID_PROF_TRIACS_PAIRS0_IRQ_P99, TEXT(TR_ID_MENU_DIAG_P99), NULL, 0, MENU_FLAG_VALUE, 0, 0),
+                MENU_DESCR(3, PARAM_ID_PROF_TRIACS_PAIRS0_IRQ_LOAD, TEXT(TR_ID_MENU_DIAG_LOAD), NULL, 0, MENU_FLAG_VALUE, 0, 0),
+            MENU_DESCR(2, 0, TEXT(TR_ID_MENU_DIAG_TRIACS_PAIRS1_IRQ), NULL, 0, 0, 0, 0),
+                MENU_DESCR(3, PARAM_ID_PROF_TRIACS_PAIRS1_IRQ_MAX, TEXT(TR_ID_MENU_DIAG_MAX), NULL, 0, MENU_FLAG_VALUE, 0, 0),
+                MENU_DESCR(3, PARAM_ID_PROF_TRIACS_PAIRS1_IRQ_P99, TEXT(TR_ID_MENU_DIAG_P99), NULL, 0, MENU_FLAG_VALUE, 0, 0),
+                MENU_DESCR(3, PARAM_ID_PROF_TRIACS_PAIRS1_IRQ_LOAD, TEXT(TR_ID_MENU_DIAG_LOAD), NULL, 0, MENU_FLAG_VALUE, 0, 0),
+            MENU_DESCR(2, 0, TEXT(TR_ID_MENU_DIAG_TRIAC_EXC_IRQ), NULL, 0, 0, 0, 0),
+                MENU_DESCR(3, PARAM_ID_PROF_TRIAC_EXC_IRQ_MAX, TEXT(TR_ID_MENU_DIAG_MAX), NULL, 0, MENU_FLAG_VALUE, 0, 0),
+                MENU_DESCR(3, PARAM_ID_PROF_TRIAC_EXC_IRQ_P99, TEXT(TR_ID_MENU_DIAG_P99), NULL, 0, MENU_FLAG_VALUE, 0, 0),
+                MENU_DESCR(3, PARAM_ID_PROF_TRIAC_EXC_IRQ_LOAD, TEXT(TR_ID_MENU_DIAG_LOAD), NULL, 0, MENU_FLAG_VALUE, 0, 0),
+            MENU_DESCR(2, 0, TEXT(TR_ID_MENU_DIAG_ADC_TASK), NULL, 0, 0, 0, 0),
+                MENU_DESCR(3, PARAM_ID_PROF_ADC_TASK_MAX, TEXT(TR_ID_MENU_DIAG_MAX), NULL, 0, MENU_FLAG_VALUE, 0, 0),
+                MENU_DESCR(3, PARAM_ID_PROF_ADC_TASK_P99, TEXT(TR_ID_MENU_DIAG_P99), NULL, 0, MENU_FLAG_VALUE, 0, 0),
+                MENU_DESCR(3, PARAM_ID_PROF_ADC_TASK_LOAD, TEXT(TR_ID_MENU_DIAG_LOAD), NULL, 0, MENU_FLAG_VALUE, 0, 0),
+            MENU_DESCR(2, 0, TEXT(TR_ID_MENU_DIAG_TRIACS_ITER), NULL, 0, 0, 0, 0),
+                MENU_DESCR(3, PARAM_ID_PROF_TRIACS_ITER_MAX, TEXT(TR_ID_MENU_DIAG_MAX), NULL, 0, MENU_FLAG_VALUE, 0, 0),
+                MENU_DESCR(3, PARAM_ID_PROF_TRIACS_ITER_P99, TEXT(TR_ID_MENU_DIAG_P99), NULL, 0, MENU_FLAG_VALUE, 0, 0),
+                MENU_DESCR(3, PARAM_ID_PROF_TRIACS_ITER_LOAD, TEXT(TR_ID_MENU_DIAG_LOAD), NULL, 0, MENU_FLAG_VALUE, 0, 0),
+            MENU_DESCR(2, 0, TEXT(TR_ID_MENU_DIAG_SYNC_ITER), NULL, 0, 0, 0, 0),
+                MENU_DESCR(3, PARAM_ID_PROF_SYNC_ITER_MAX, TEXT(TR_ID_MENU_DIAG_MAX), NULL, 0, MENU_FLAG_VALUE, 0, 0),
+                MENU_DESCR(3, PARAM_ID_PROF_SYNC_ITER_P99, TEXT(TR_ID_MENU_DIAG_P99), NULL, 0, MENU_FLAG_VALUE, 0, 0),
+                MENU_DESCR(3, PARAM_ID_PROF_SYNC_ITER_LOAD, TEXT(TR_ID_MENU_DIAG_LOAD), NULL, 0, MENU_FLAG_VALUE, 0, 0),
+            MENU_DESCR(2, 0, TEXT(TR_ID_MENU_DIAG_MAIN_ITER), NULL, 0, 0, 0, 0),
+                MENU_DESCR(3, PARAM_ID_PROF_MAIN_ITER_MAX, TEXT(TR_ID_MENU_DIAG_MAX), NULL, 0, MENU_FLAG_VALUE, 0, 0),
+                MENU_DESCR(3, PARAM_ID_PROF_MAIN_ITER_P99, TEXT(TR_ID_MENU_DIAG_P99), NULL, 0, MENU_FLAG_VALUE, 0, 0),
+                MENU_DESCR(3, PARAM_ID_PROF_MAIN_ITER_LOAD, TEXT(TR_ID_MENU_DIAG_LOAD), NULL, 0, MENU_FLAG_VALUE, 0, 0),
     // Настройки интерфейса
     MENU_DESCR(0, 0, TEXT(TR_ID_MENU_GUI), NULL, 0, MENU_FLAG_ROOT, 0, 0),
         // Пароль администратора
@@ -1241,6 +1321,20 @@ MENU_DESCRS(menu_descrs) {
         MENU_DESCR(1, PARAM_ID_VALUE_MULTIPLIER_Iexc, TEXT(TR_ID_MENU_VALUE_MULT_Iexc), NULL, 0, MENU_FLAG_DATA, 0, 0),
         MENU_DESCR(1, PARAM_ID_VALUE_MULTIPLIER_Iref, TEXT(TR_ID_MENU_VALUE_MULT_Iref), NULL, 0, MENU_FLAG_DATA, 0, 0),
         MENU_DESCR(1, PARAM_ID_VALUE_MULTIPLIER_Ifan, TEXT(TR_ID_MENU_VALUE_MULT_Ifan), NULL, 0, MENU_FLAG_DATA, 0, 0),
+    // Скользящее окно.
+    MENU_DESCR(0, 0, TEXT(TR_ID_MENU_SLIDING_WINDOWS), NULL, 0, 0, 0, 0),
+        MENU_DESCR(1, PARAM_ID_SLIDING_WINDOW_Ua, TEXT(TR_ID_MENU_SLIDING_WINDOW_Ua), NULL, 0, MENU_FLAG_DATA, 0, &menu_val_bool),
+        MENU_DESCR(1, PARAM_ID_SLIDING_WINDOW_Ub, TEXT(TR_ID_MENU_SLIDING_WINDOW_Ub), NULL, 0, MENU_FLAG_DATA, 0, &menu_val_bool),
+        MENU_DESCR(1, PARAM_ID_SLIDING_WINDOW_Uc, TEXT(TR_ID_MENU_SLIDING_WINDOW_Uc), NULL, 0, MENU_FLAG_DATA, 0, &menu_val_bool),
+        MENU_DESCR(1, PARAM_ID_SLIDING_WINDOW_Urot, TEXT(TR_ID_MENU_SLIDING_WINDOW_Urot), NULL, 0, MENU_FLAG_DATA, 0, &menu_val_bool),
+        MENU_DESCR(1, PARAM_ID_SLIDING_WINDOW_Ia, TEXT(TR_ID_MENU_SLIDING_WINDOW_Ia), NULL, 0, MENU_FLAG_DATA, 0, &menu_val_bool),
+        MENU_DESCR(1, PARAM_ID_SLIDING_WINDOW_Ib, TEXT(TR_ID_MENU_SLIDING_WINDOW_Ib), NULL, 0, MENU_FLAG_DATA, 0, &menu_val_bool),
+        MENU_DESCR(1, PARAM_ID_SLIDING_WINDOW_Ic, TEXT(TR_ID_MENU_SLIDING_WINDOW_Ic), NULL, 0, MENU_FLAG_DATA, 0, &menu_val_bool),
+        MENU_DESCR(1, PARAM_ID_SLIDING_WINDOW_Irot, TEXT(TR_ID_MENU_SLIDING_WINDOW_Irot), NULL, 0, MENU_FLAG_DATA, 0, &menu_val_bool),
+        MENU_DESCR(1, PARAM_ID_SLIDING_WINDOW_Iexc, TEXT(TR_ID_MENU_SLIDING_WINDOW_Iexc), NULL, 0, MENU_FLAG_DATA, 0, &menu_val_bool),
+        MENU_DESCR(1, PARAM_ID_SLIDING_WINDOW_Iref, TEXT(TR_ID_MENU_SLIDING_WINDOW_Iref), NULL, 0, MENU_FLAG_DATA, 0, &menu_val_bool),
+        MENU_DESCR(1, PARAM_ID_SLIDING_WINDOW_Ifan, TEXT(TR_ID_MENU_SLIDING_WINDOW_Ifan), NULL, 0, MENU_FLAG_DATA, 0, &menu_val_bool),
+        MENU_DESCR(1, PARAM_ID_SLIDING_WINDOW_Erot, TEXT(TR_ID_MENU_SLIDING_WINDOW_Erot), NULL, 0, MENU_FLAG_DATA, 0, &menu_val_bool),
     //MENU_DESCR(0, 0, TEXT(TR_ID_MENU_), NULL, 0, 0, 0, 0)
 };
 
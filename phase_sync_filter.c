@@ -0,0 +1,99 @@
+#include "phase_sync_filter.h"
+#include <stddef.h>
+#include <string.h>
+#include "cordic/cordic32.h"
+
+
+
+/**
+ * Приводит угол к интервалу -180 ... +180.
+ * @param angle Угол.
+ * @return Приведённый угол.
+ */
+ALWAYS_INLINE static fixed32_t phase_sync_filter_angle_normalize(fixed32_t angle)
+{
+    while(angle > CORDIC32_ANGLE_180) angle -= CORDIC32_ANGLE_360;
+    while(angle <= -CORDIC32_ANGLE_180) angle += CORDIC32_ANGLE_360;
+    
+    return angle;
+}
+
+void phase_sync_filter_reset(phase_sync_filter_t* filter)
+{
+    memset(filter, 0x0, sizeof(phase_sync_filter_t));
+}
+
+void phase_sync_filter_put(phase_sync_filter_t* filter, fixed32_t angle)
+{
+    size_t count = filter->count;
+    size_t pos = count;
+    
+    if(count != 0){
+        // Развернём угол к ближайшему к медиане окна.
+        fixed32_t median = filter->sorted[count / 2];
+        angle = median + phase_sync_filter_angle_normalize(angle - median);
+    }
+    
+    if(count == PHASE_SYNC_FILTER_SIZE){
+        // Освободим место вытесняемого угла.
+        fixed32_t old = filter->values[filter->index];
+        for(pos = 0; pos < count - 1; pos ++){
+            if(filter->sorted[pos] == old) break;
+        }
+    }else{
+        count ++;
+    }
+    
+    // Сдвинем свободное место к позиции нового угла.
+    while(pos > 0 && filter->sorted[pos - 1] > angle){
+        filter->sorted[pos] = filter->sorted[pos - 1];
+        pos --;
+    }
+    while(pos < count - 1 && filter->sorted[pos + 1] < angle){
+        filter->sorted[pos] = filter->sorted[pos + 1];
+        pos ++;
+    }
+    filter->sorted[pos] = angle;
+    
+    filter->values[filter->index] = angle;
+    if(++ filter->index >= PHASE_SYNC_FILTER_SIZE) filter->index = 0;
+    filter->count = count;
+    
+    // Вернём медиану окна в интервал -180 ... +180,
+    // сдвиг всех углов не меняет их порядок.
+    fixed32_t median = filter->sorted[count / 2];
+    fixed32_t shift = phase_sync_filter_angle_normalize(median) - median;
+    
+    if(shift != 0){
+        for(pos = 0; pos < count; pos ++){
+            filter->values[pos] += shift;
+            filter->sorted[pos] += shift;
+        }
+    }
+}
+
+fixed32_t phase_sync_filter_calc(phase_sync_filter_t* filter)
+{
+    if(filter->count == 0) return 0;
+    
+    size_t count = filter->count;
+    
+    fixed32_t val = 0;
+    size_t from = 0;
+    size_t to = count;
+    
+    if(count > (PHASE_SYNC_FILTER_SKIP_MIN + PHASE_SYNC_FILTER_SKIP_MAX)){
+        from += PHASE_SYNC_FILTER_SKIP_MIN;
+        to -= PHASE_SYNC_FILTER_SKIP_MAX;
+        count -= (PHASE_SYNC_FILTER_SKIP_MIN + PHASE_SYNC_FILTER_SKIP_MAX);
+    }
+    
+    while(from < to){
+        val  += filter->sorted[from];
+        from ++;
+    }
+    
+    val /= (fixed32_t)count;
+    
+    return phase_sync_filter_angle_normalize(val);
+}
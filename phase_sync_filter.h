@@ -0,0 +1,73 @@
+/**
+ * @file phase_sync_filter.h Библиотека фильтра углов фаз.
+ */
+
+#ifndef PHASE_SYNC_FILTER_H
+#define PHASE_SYNC_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fixed/fixed32.h"
+#include "defs/defs.h"
+
+
+//! Размер фильтра углов.
+#define PHASE_SYNC_FILTER_SIZE 7
+
+//! Отбрасывать минимальных значений фильтра.
+#define PHASE_SYNC_FILTER_SKIP_MIN 2
+
+//! Отбрасывать максимальных значений фильтра.
+#define PHASE_SYNC_FILTER_SKIP_MAX 2
+
+//! Тип индекса в буфере фильтра.
+typedef uint8_t phase_sync_filter_index_t;
+
+/**
+ * Структура фильтра углов.
+ * Окно хранится одновременно в порядке поступления
+ * и в порядке возрастания, упорядоченное окно обновляется
+ * вставкой за линейное время.
+ * Углы хранятся развёрнутыми относительно медианы окна,
+ * поэтому окно, расположенное около +-180 градусов, не разрывается.
+ */
+typedef struct _Phase_Sync_Filter {
+    fixed32_t values[PHASE_SYNC_FILTER_SIZE]; //!< Углы в порядке поступления.
+    fixed32_t sorted[PHASE_SYNC_FILTER_SIZE]; //!< Углы в порядке возрастания.
+    phase_sync_filter_index_t index; //!< Индекс следующего угла.
+    phase_sync_filter_index_t count; //!< Число углов.
+} phase_sync_filter_t;
+
+
+/**
+ * Сбрасывает фильтр.
+ * @param filter Фильтр.
+ */
+EXTERN void phase_sync_filter_reset(phase_sync_filter_t* filter);
+
+/**
+ * Добавляет угол в фильтр с вытеснением самого старого угла.
+ * @param filter Фильтр.
+ * @param angle Угол.
+ */
+EXTERN void phase_sync_filter_put(phase_sync_filter_t* filter, fixed32_t angle);
+
+/**
+ * Вычисляет значение фильтра -
+ * среднее окна без крайних значений.
+ * @param filter Фильтр.
+ * @return Вычисленное значение фильтра в интервале -180 ... +180.
+ */
+EXTERN fixed32_t phase_sync_filter_calc(phase_sync_filter_t* filter);
+
+/**
+ * Получает флаг заполнения фильтра.
+ * @param filter Фильтр.
+ * @return Флаг заполнения фильтра.
+ */
+ALWAYS_INLINE static bool phase_sync_filter_full(phase_sync_filter_t* filter)
+{
+    return filter->count == PHASE_SYNC_FILTER_SIZE;
+}
+
+#endif /* PHASE_SYNC_FILTER_H */
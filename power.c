@@ -59,6 +59,80 @@ static int32_t power_filter_calculate(power_filter_t* filter, int32_t* ret_count
     return val;
 }
 
+//! Число дробных бит обратного корня из числа значений.
+#define POWER_RSQRT_FRACT_BITS 24
+
+#if POWER_RSQRT_FRACT_BITS < FIXED32_FRACT_BITS
+#error "POWER_RSQRT_FRACT_BITS must not be less than FIXED32_FRACT_BITS"
+#endif
+
+/**
+ * Вычисляет обратный корень из числа значений.
+ * @param count Число значений.
+ * @return Обратный корень с POWER_RSQRT_FRACT_BITS дробных бит.
+ */
+static uint32_t power_rsqrt(uint32_t count)
+{
+    if(count == 0) return 0;
+    if(count > 0xffff) count = 0xffff;
+    
+    // Корень с 8 дробными битами.
+    uint32_t sqrt_count = bsqrti(count << 16);
+    
+    return (uint32_t)(((uint64_t)1 << (POWER_RSQRT_FRACT_BITS + 8)) / sqrt_count);
+}
+
+/**
+ * Получает обратный корень из числа значений канала.
+ * Значение кэшируется до изменения числа значений.
+ * @param channel Канал АЦП.
+ * @param count Число значений.
+ * @return Обратный корень с POWER_RSQRT_FRACT_BITS дробных бит.
+ */
+ALWAYS_INLINE static uint32_t power_channel_rsqrt_count(power_value_t* channel, int32_t count)
+{
+    if(channel->rsqrt_count_n != count){
+        channel->rsqrt_count = power_rsqrt((uint32_t)count);
+        channel->rsqrt_count_n = count;
+    }
+    return channel->rsqrt_count;
+}
+
+/**
+ * Вычисляет RMS в СИ по сумме квадратов сырых значений.
+ * @param channel Канал АЦП.
+ * @param sum_val Сумма квадратов.
+ * @param rsqrt_count Обратный корень из числа значений.
+ * @return RMS в СИ.
+ */
+ALWAYS_INLINE static fixed32_t power_channel_rms(power_value_t* channel, int32_t sum_val, uint32_t rsqrt_count)
+{
+    uint32_t sq_sum = bsqrti((uint32_t)sum_val);
+    
+    fixed32_t real_val = (fixed32_t)(((uint64_t)sq_sum * rsqrt_count) >> (POWER_RSQRT_FRACT_BITS - FIXED32_FRACT_BITS));
+    
+    return fixed32_mul((int64_t)real_val, channel->adc_mult);
+}
+
+static void power_window_reset(power_window_t* window)
+{
+    memset(window, 0x0, sizeof(power_window_t));
+}
+
+/**
+ * Помещает значение в скользящее окно.
+ * @param window Скользящее окно.
+ * @param value Значение.
+ */
+ALWAYS_INLINE static void power_window_put(power_window_t* window, int32_t value)
+{
+    window->sum += value - window->buffer[window->index];
+    window->buffer[window->index] = value;
+    
+    if(++ window->index >= POWER_WINDOW_SIZE) window->index = 0;
+    if(window->count < POWER_WINDOW_SIZE) window->count ++;
+}
+
 err_t power_value_init(power_value_t* value, power_channel_type_t type, size_t filter_size, fixed32_t k)
 {
     memset(value, 0x0, sizeof(power_value_t));
@@ -78,10 +152,52 @@ err_t power_init(power_t* power, power_value_t* channels, size_t channels_count)
 {
     if(channels == NULL) return E_NULL_POINTER;
     if(channels_count == 0) return E_INVALID_VALUE;
+    if(channels_count > POWER_CHANNELS_MAX) return E_OUT_OF_RANGE;
     
     power->channels = channels;
     power->channels_count = channels_count;
     
+    memset(&power->acc, 0x0, sizeof(power_acc_t));
+    memset(&power->adc_map, 0x0, sizeof(power_adc_map_t));
+    
+    return E_NO_ERROR;
+}
+
+err_t power_set_adc_channels(power_t* power, power_channels_t channels)
+{
+    if(channels == POWER_CHANNEL_NONE) return E_INVALID_VALUE;
+    
+    power_adc_map_t map;
+    memset(&map, 0x0, sizeof(power_adc_map_t));
+    
+    size_t offset = 0;
+    
+    size_t i = 0;
+    for(; channels >> i != 0x0; i ++){
+        if(!((channels >> i) & 0x1)) continue;
+        
+        if(i >= power->channels_count) return E_OUT_OF_RANGE;
+        
+        if(power->channels[i].type == POWER_CHANNEL_AC){
+            map.ac_channels[map.ac_count] = (uint8_t)i;
+            map.ac_offsets[map.ac_count] = (uint8_t)offset;
+            map.ac_count ++;
+        }else{
+            map.dc_channels[map.dc_count] = (uint8_t)i;
+            map.dc_offsets[map.dc_count] = (uint8_t)offset;
+            map.dc_count ++;
+        }
+        
+        offset ++;
+    }
+    
+    map.frame_size = (uint8_t)offset;
+    map.channels = channels;
+    
+    CRITICAL_ENTER();
+    power->adc_map = map;
+    CRITICAL_EXIT();
+    
     return E_NO_ERROR;
 }
 
@@ -94,23 +210,103 @@ err_t power_set_soft_channel(power_t* power, size_t channel, bool is_soft)
     return E_NO_ERROR;
 }
 
-static void power_channel_set_soft_value(power_value_t* channel, fixed32_t value)
+/**
+ * Отбрасывает младшие биты сырого значения.
+ * @param value Сырое значение.
+ * @return Сырое значение без младших бит.
+ */
+ALWAYS_INLINE static int32_t power_ignore_bits(int32_t value)
+{
+    #if POWER_IGNORE_BITS != 0
+    if(value >= 0){
+        value &= POWER_IGNORE_BITS_MASK;
+    }else{
+        value = -((-value) & POWER_IGNORE_BITS_MASK);
+    }
+    #endif
+    
+    return value;
+}
+
+err_t power_channel_set_window(power_t* power, size_t channel, power_window_t* window)
+{
+    if(channel >= power->channels_count) return E_OUT_OF_RANGE;
+    
+    power_value_t* value = &power->channels[channel];
+    
+    if(value->window == window) return E_NO_ERROR;
+    
+    CRITICAL_ENTER();
+    if(window) power_window_reset(window);
+    value->window = window;
+    CRITICAL_EXIT();
+    
+    return E_NO_ERROR;
+}
+
+err_t power_set_windows(power_t* power, power_window_t* const* windows)
+{
+    if(windows == NULL) return E_NULL_POINTER;
+    
+    // Окна переназначаются все сразу, чтобы одно окно
+    // не оказалось одновременно у двух каналов.
+    CRITICAL_ENTER();
+    
+    size_t i;
+    for(i = 0; i < power->channels_count; i ++){
+        power_value_t* value = &power->channels[i];
+        
+        if(value->window == windows[i]) continue;
+        
+        if(windows[i]) power_window_reset(windows[i]);
+        value->window = windows[i];
+    }
+    
+    CRITICAL_EXIT();
+    
+    return E_NO_ERROR;
+}
+
+/**
+ * Вычисляет значение канала по скользящему окну.
+ * @param channel Канал АЦП.
+ */
+static void power_channel_calc_window(power_value_t* channel)
+{
+    power_window_t* window = channel->window;
+    
+    if(window->count < POWER_WINDOW_SIZE) return;
+    
+    int32_t sum_val = window->sum;
+    fixed32_t real_val = 0;
+    
+    if(channel->type == POWER_CHANNEL_AC){
+        channel->raw_value = bsqrti(sum_val / POWER_WINDOW_SIZE);
+        
+        real_val = power_channel_rms(channel, sum_val, power_channel_rsqrt_count(channel, POWER_WINDOW_SIZE));
+    }else{
+        channel->raw_value = sum_val / POWER_WINDOW_SIZE;
+        
+        int64_t real_sum = (int64_t)sum_val * channel->adc_mult;
+        real_val = real_sum / POWER_WINDOW_SIZE;
+    }
+    
+    channel->real_value = fixed32_mul((int64_t)real_val, channel->value_mult);
+    
+    channel->data_avail = true;
+}
+
+static void power_channel_set_soft_value(power_t* power, size_t channel_n, fixed32_t value)
 {
+    power_value_t* channel = &power->channels[channel_n];
+    
     // Отфильтруем значение.
     //mid_filter3i_put(&channel->filter_mid_adc, value);
     //value = mid_filter3i_value(&channel->filter_mid_adc);
     
     fixed32_t raw_valuef = fixed32_div((int64_t)value, channel->adc_mult);
     raw_valuef = fixed32_round(raw_valuef);
-    int32_t raw_value = fixed32_get_int(raw_valuef);
-    
-    #if POWER_IGNORE_BITS != 0
-    if(raw_value >= 0){
-        raw_value &= POWER_IGNORE_BITS_MASK;
-    }else{
-        raw_value = -((-raw_value) & POWER_IGNORE_BITS_MASK);
-    }
-    #endif
+    int32_t raw_value = power_ignore_bits(fixed32_get_int(raw_valuef));
     
     // Мгновенное сырое значение канала АЦП.
     channel->raw_value_inst = raw_value;
@@ -118,15 +314,19 @@ static void power_channel_set_soft_value(power_value_t* channel, fixed32_t value
     channel->real_value_inst = value;
     
     // Увеличим число значений в сумме.
-    channel->count ++;
+    power->acc.count[channel_n] ++;
     
     // Если канал питания - AC.
     if(channel->type == POWER_CHANNEL_AC){
         // Квадрат значения для RMS.
-        channel->sum += raw_value * raw_value;
-    }else{
-        // Значение для среднего.
-        channel->sum += raw_value;
+        raw_value = raw_value * raw_value;
+    }
+    
+    power->acc.sum[channel_n] += raw_value;
+    
+    if(channel->window){
+        power_window_put(channel->window, raw_value);
+        power_channel_calc_window(channel);
     }
 }
 
@@ -135,22 +335,14 @@ err_t power_process_soft_channel_value(power_t* power, size_t channel, fixed32_t
     if(channel >= power->channels_count) return E_OUT_OF_RANGE;
     if(!power->channels[channel].is_soft) return E_INVALID_VALUE;
     
-    power_channel_set_soft_value(&power->channels[channel], value);
+    power_channel_set_soft_value(power, channel, value);
     
     return E_NO_ERROR;
 }
 
 fixed32_t power_calc_inst_value(power_value_t* channel, uint16_t adc_value)
 {
-    int32_t value = (int32_t)adc_value - channel->raw_zero_cal;
-
-    #if POWER_IGNORE_BITS != 0
-    if(value >= 0){
-        value &= POWER_IGNORE_BITS_MASK;
-    }else{
-        value = -((-value) & POWER_IGNORE_BITS_MASK);
-    }
-    #endif
+    int32_t value = power_ignore_bits((int32_t)adc_value - channel->raw_zero_cal);
 
     // Мгновенное реальное значение канала АЦП.
     return (fixed32_t)value * channel->adc_mult;
@@ -163,106 +355,208 @@ fixed32_t power_channel_calc_inst_value(power_t* power, size_t channel, uint16_t
     return power_calc_inst_value(&power->channels[channel], adc_value);
 }
 
-static void power_channel_process_adc_value(power_value_t* channel, uint16_t adc_value)
+/**
+ * Вычисляет среднее значение суммы блока с округлением.
+ * @param sum Сумма значений блока.
+ * @param count Число значений блока.
+ * @return Среднее значение.
+ */
+ALWAYS_INLINE static int32_t power_block_mean(int32_t sum, int32_t count)
 {
-    // Отфильтруем значение АЦП.
-    if(channel->adc_filter_enabled){
-        mid_filter3i_put(&channel->filter_mid_adc, adc_value);
-        adc_value = mid_filter3i_value(&channel->filter_mid_adc);
+    if(count == 1) return sum;
+    
+    if(sum >= 0){
+        return (sum + (count >> 1)) / count;
+    }
+    return (sum - (count >> 1)) / count;
+}
+
+/**
+ * Фильтрует медианным фильтром значения АЦП канала в блоке по месту.
+ * @param channel Канал АЦП.
+ * @param adc_values Значения АЦП первого кадра.
+ * @param stride Шаг между значениями соседних кадров.
+ * @param count Число кадров.
+ */
+static void power_channel_filter_adc_block(power_value_t* channel, uint16_t* adc_values, size_t stride, size_t count)
+{
+    uint16_t* adc_values_end = adc_values + stride * count;
+    
+    for(; adc_values != adc_values_end; adc_values += stride){
+        mid_filter3i_put(&channel->filter_mid_adc, *adc_values);
+        *adc_values = mid_filter3i_value(&channel->filter_mid_adc);
     }
+}
+
+/**
+ * Накапливает суммы блока значений канала АЦП.
+ * Суммы блока усредняются и накапливаются
+ * как одно измерение, мгновенные значения
+ * соответствуют последнему значению блока.
+ * @param power Питание.
+ * @param channel_n Номер канала.
+ * @param adc_value Последнее значение АЦП блока.
+ * @param sum_zero Сумма значений АЦП блока.
+ * @param sum Сумма значений (квадратов значений) блока.
+ * @param count Число кадров.
+ */
+ALWAYS_INLINE static void power_channel_put_block(power_t* power, size_t channel_n, uint16_t adc_value, int32_t sum_zero, int32_t sum, int32_t count)
+{
+    power_value_t* channel = &power->channels[channel_n];
+    power_acc_t* acc = &power->acc;
     
     channel->raw_adc_value_inst = adc_value;
     
     // Значение нуля АЦП.
-    channel->sum_zero += adc_value;
+    acc->sum_zero[channel_n] += power_block_mean(sum_zero, count);
     // Увеличим число измерений значения нуля.
-    channel->count_zero ++;
+    acc->count_zero[channel_n] ++;
     
     // Если канал вычисляется программно.
     if(channel->is_soft) return;
     
-    // Вычтем значение АЦП при нуле.
-    int32_t value = (int32_t)adc_value - channel->raw_zero_cal;
-
-    #if POWER_IGNORE_BITS != 0
-    if(value >= 0){
-        value &= POWER_IGNORE_BITS_MASK;
-    }else{
-        value = -((-value) & POWER_IGNORE_BITS_MASK);
-    }
-    #endif
-
+    int32_t value = power_ignore_bits((int32_t)adc_value - channel->raw_zero_cal);
+    
     // Мгновенное сырое значение канала АЦП.
     channel->raw_value_inst = value;
     // Мгновенное реальное значение канала АЦП.
-    channel->real_value_inst = (fixed32_t)channel->raw_value_inst * channel->adc_mult;
-
+    channel->real_value_inst = (fixed32_t)value * channel->adc_mult;
+    
+    // Среднее значение (квадрат значения) блока.
+    int32_t mean = power_block_mean(sum, count);
+    
     // Увеличим число измерений значений.
-    channel->count ++;
-    // Если канал питания - AC.
-    if(channel->type == POWER_CHANNEL_AC){
-        // Квадрат значения для RMS.
-        channel->sum += value * value;
-    }else{
-        // Значение для среднего.
-        channel->sum += value;
+    acc->count[channel_n] ++;
+    acc->sum[channel_n] += mean;
+    
+    if(channel->window){
+        power_window_put(channel->window, mean);
+        power_channel_calc_window(channel);
     }
 }
 
 /**
- * Обрабатывает очередное значение АЦП.
+ * Обрабатывает блок значений АЦП канала переменного тока.
  * @param power Питание.
- * @param channel Номер канала АЦП.
- * @param adc_value Значение АЦП.
- * @return Код ошибки.
+ * @param channel_n Номер канала.
+ * @param adc_values Значения АЦП первого кадра.
+ * @param stride Шаг между значениями соседних кадров.
+ * @param count Число кадров.
  */
-ALWAYS_INLINE static err_t power_process_adc_value(power_t* power, size_t channel, uint16_t adc_value)
+static void power_process_adc_block_ac(power_t* power, size_t channel_n, uint16_t* adc_values, size_t stride, size_t count)
 {
-    if(power->channels_count <= channel) return E_OUT_OF_RANGE;
+    power_value_t* channel = &power->channels[channel_n];
     
-    power_channel_process_adc_value(&power->channels[channel], adc_value);
+    if(channel->adc_filter_enabled){
+        power_channel_filter_adc_block(channel, adc_values, stride, count);
+    }
     
-    return E_NO_ERROR;
+    const uint16_t* adc_value = adc_values;
+    const uint16_t* adc_values_end = adc_values + stride * count;
+    
+    int32_t raw_zero_cal = channel->raw_zero_cal;
+    int32_t sum_zero = 0;
+    int32_t sum = 0;
+    int32_t value;
+    
+    // Сумма блока помещается в 32 бита, накопление через MLA.
+    for(; adc_value != adc_values_end; adc_value += stride){
+        sum_zero += *adc_value;
+        value = power_ignore_bits((int32_t)*adc_value - raw_zero_cal);
+        sum += value * value;
+    }
+    
+    power_channel_put_block(power, channel_n, adc_values[stride * (count - 1)], sum_zero, sum, (int32_t)count);
+}
+
+/**
+ * Обрабатывает блок значений АЦП канала постоянного тока.
+ * @param power Питание.
+ * @param channel_n Номер канала.
+ * @param adc_values Значения АЦП первого кадра.
+ * @param stride Шаг между значениями соседних кадров.
+ * @param count Число кадров.
+ */
+static void power_process_adc_block_dc(power_t* power, size_t channel_n, uint16_t* adc_values, size_t stride, size_t count)
+{
+    power_value_t* channel = &power->channels[channel_n];
+    
+    if(channel->adc_filter_enabled){
+        power_channel_filter_adc_block(channel, adc_values, stride, count);
+    }
+    
+    const uint16_t* adc_value = adc_values;
+    const uint16_t* adc_values_end = adc_values + stride * count;
+    
+    int32_t raw_zero_cal = channel->raw_zero_cal;
+    int32_t sum_zero = 0;
+    int32_t sum = 0;
+    
+    for(; adc_value != adc_values_end; adc_value += stride){
+        sum_zero += *adc_value;
+        sum += power_ignore_bits((int32_t)*adc_value - raw_zero_cal);
+    }
+    
+    power_channel_put_block(power, channel_n, adc_values[stride * (count - 1)], sum_zero, sum, (int32_t)count);
 }
 
 err_t power_process_adc_values(power_t* power, power_channels_t channels, uint16_t* adc_values)
+{
+    return power_process_adc_values_block(power, channels, adc_values, 1);
+}
+
+err_t power_process_adc_values_block(power_t* power, power_channels_t channels, uint16_t* adc_values, size_t frames_count)
 {
     if(adc_values == NULL) return E_NULL_POINTER;
     if(channels == POWER_CHANNEL_NONE) return E_INVALID_VALUE;
+    if(frames_count == 0) return E_INVALID_VALUE;
     
-    size_t adc_i = 0;
+    // Список каналов строится заранее при применении настроек.
+    if(power->adc_map.channels != channels){
+        RETURN_ERR_IF_FAIL(power_set_adc_channels(power, channels));
+    }
     
-    size_t i = 0;
-    for(; i < power->channels_count && channels != 0x0; i ++, channels >>= 1){
-        if(channels & 0x1){
-            RETURN_ERR_IF_FAIL(power_process_adc_value(power, i, adc_values[adc_i ++]));
-        }
+    const power_adc_map_t* map = &power->adc_map;
+    size_t stride = map->frame_size;
+    
+    size_t i;
+    
+    for(i = 0; i < map->ac_count; i ++){
+        power_process_adc_block_ac(power, map->ac_channels[i], &adc_values[map->ac_offsets[i]], stride, frames_count);
+    }
+    
+    for(i = 0; i < map->dc_count; i ++){
+        power_process_adc_block_dc(power, map->dc_channels[i], &adc_values[map->dc_offsets[i]], stride, frames_count);
     }
     
     return E_NO_ERROR;
 }
 
-ALWAYS_INLINE static void power_channel_reset_sums(power_value_t* channel)
+ALWAYS_INLINE static void power_channel_reset_sums(power_t* power, size_t channel_n)
 {
-    channel->sum = 0;
-    channel->sum_zero = 0;
-    channel->count = 0;
-    channel->count_zero = 0;
+    power->acc.sum[channel_n] = 0;
+    power->acc.sum_zero[channel_n] = 0;
+    power->acc.count[channel_n] = 0;
+    power->acc.count_zero[channel_n] = 0;
 }
 
 /**
  * Обрабатывает накопленные значения заданного канала АЦП.
- * @param channel Канал АЦП.
+ * @param power Питание.
+ * @param channel_n Номер канала АЦП.
  */
-static void power_channel_process_acc_data(power_value_t* channel)
+static void power_channel_process_acc_data(power_t* power, size_t channel_n)
 {
-    if(channel->count != 0)
-        power_filter_put(&channel->filter_value, channel->sum, channel->count);
+    power_value_t* channel = &power->channels[channel_n];
+    power_acc_t* acc = &power->acc;
     
-    if(channel->count_zero != 0)
-        power_filter_put(&channel->filter_zero, channel->sum_zero, channel->count_zero);
+    if(acc->count[channel_n] != 0)
+        power_filter_put(&channel->filter_value, acc->sum[channel_n], acc->count[channel_n]);
     
-    power_channel_reset_sums(channel);
+    if(acc->count_zero[channel_n] != 0)
+        power_filter_put(&channel->filter_zero, acc->sum_zero[channel_n], acc->count_zero[channel_n]);
+    
+    power_channel_reset_sums(power, channel_n);
 }
 
 err_t power_process_accumulated_data(power_t* power, power_channels_t channels)
@@ -272,7 +566,7 @@ err_t power_process_accumulated_data(power_t* power, power_channels_t channels)
     size_t i = 0;
     for(; i < power->channels_count && channels != 0x0; i ++, channels >>= 1){
         if(channels & 0x1){
-            power_channel_process_acc_data(&power->channels[i]);
+            power_channel_process_acc_data(power, i);
         }
     }
     
@@ -290,6 +584,9 @@ static void power_channel_calc(power_value_t* channel)
     
     channel->raw_zero_cur = power_filter_calculate(&channel->filter_zero, NULL);
     
+    // Значение вычисляется при каждом измерении.
+    if(channel->window) return;
+    
     if(count_val == 0) return;
     
     int32_t raw_val = sum_val / count_val;
@@ -305,14 +602,7 @@ static void power_channel_calc(power_value_t* channel)
     //if(!channel->is_soft){
         if(channel->type == POWER_CHANNEL_AC){
             //real_val = (fixed32_t)channel->raw_value * channel->adc_mult;
-            int32_t sq_sum = bsqrti(sum_val);
-            int64_t sq_sumf = fixed32_make_from_int((int64_t)sq_sum);
-            
-            fixed32_t count_valf = fixed32_make_from_int(count_val);
-            fixed32_t sq_countf = bsqrtf(count_valf);
-            
-            real_val = (int32_t)fixed32_div(sq_sumf, sq_countf);
-            real_val = fixed32_mul((int64_t)real_val, channel->adc_mult);
+            real_val = power_channel_rms(channel, sum_val, power_channel_rsqrt_count(channel, count_val));
         }else{
             int64_t real_sum = (int64_t)sum_val * channel->adc_mult;
             real_val = real_sum / count_val;
@@ -414,10 +704,11 @@ err_t power_reset_channels(power_t* power, power_channels_t channels)
     size_t i = 0;
     for(; i < power->channels_count && channels != 0x0; i ++, channels >>= 1){
         if(channels & 0x1){
-            power_channel_reset_sums(&power->channels[i]);
+            power_channel_reset_sums(power, i);
             power_filter_reset(&power->channels[i].filter_value);
             power_filter_reset(&power->channels[i].filter_zero);
             mid_filter3i_reset(&power->channels[i].filter_mid_adc);
+            if(power->channels[i].window) power_window_reset(power->channels[i].window);
         }
     }
     
@@ -20,6 +20,15 @@
 //! Частота сети.
 #define POWER_FREQ 50
 
+//! Минимальная частота сети.
+#define POWER_FREQ_MIN 45
+
+//! Максимальная частота сети.
+#define POWER_FREQ_MAX 65
+
+//! Номинальный период сети, мкс.
+#define POWER_PERIOD_US (1000000 / POWER_FREQ)
+
 //! Число измерений ADC за период.
 #define POWER_ADC_MEASUREMENTS_PER_PERIOD (POWER_ADC_FREQ / POWER_FREQ)
 
@@ -41,6 +50,12 @@
 #endif
 
 
+//! Максимальное число каналов.
+#define POWER_CHANNELS_MAX 16
+
+//! Число измерений в скользящем окне (полупериод сети).
+#define POWER_WINDOW_SIZE (POWER_ADC_MEASUREMENTS_PER_PERIOD / 2)
+
 //! Число элементов в буфере фильтра.
 #define POWER_FILTER_SIZE_MAX (POWER_PERIOD_ITERS_MAX)
 
@@ -94,6 +109,19 @@ typedef struct _Power_Filter {
     uint16_t size; //!< Максимальное число элементов в буфере.
 } power_filter_t;
 
+/**
+ * Структура скользящего окна значений.
+ * Для сигналов с полуволновой симметрией
+ * квадрат значения периодичен с полупериодом сети,
+ * поэтому окна в полупериод достаточно для RMS.
+ */
+typedef struct _Power_Window {
+    int32_t buffer[POWER_WINDOW_SIZE]; //!< Значения (квадраты значений) измерений.
+    int32_t sum; //!< Сумма значений окна.
+    uint16_t index; //!< Индекс следующего значения.
+    uint16_t count; //!< Число значений в окне.
+} power_window_t;
+
 /**
  * Структура значения, полученного с канала АЦП.
  */
@@ -108,13 +136,12 @@ typedef struct _Power_Value {
     int16_t raw_value; //!< Сырое значение с АЦП.
     fixed32_t real_value_inst; //!< Значение в СИ (мгновенное).
     fixed32_t real_value; //!< Значение в СИ.
-    int32_t sum; //!< Сумма значений.
-    int32_t sum_zero; //!< Сумма значений для вычисления нуля.
-    uint16_t count; //!< Число значений.
-    uint16_t count_zero; //!< Число значений нуля.
     mid_filter3i_t filter_mid_adc; //!< Медианный фильтр значений АЦП.
     power_filter_t filter_value; //!< Фильтр значенией.
     power_filter_t filter_zero; //!< Фильтр нуля.
+    power_window_t* window; //!< Скользящее окно, NULL - вычисление по блокам.
+    int32_t rsqrt_count_n; //!< Число значений для кэшированного обратного корня.
+    uint32_t rsqrt_count; //!< Обратный корень из числа значений.
     bool is_soft; //!< Флаг программного вычисления канала.
     bool calibrated; //!< Флаг калибровки.
     bool data_avail; //!< Флаг доступности данных.
@@ -126,22 +153,48 @@ typedef struct _Power_Value {
                                     .raw_zero_cal = 0, .raw_zero_cur = 0,\
                                     .raw_value_inst = 0, .raw_value = 0,\
                                     .real_value_inst = 0, .real_value = 0,\
-                                    .sum = 0, .sum_zero = 0,\
-                                    .count = 0, .count_zero = 0,\
                                     .filter_value = {0}, .filter_zero = {0},\
                                     .is_soft = false, .calibrated = false,\
                                     .data_avail = false, adc_filter_enabled = true }
 
+/**
+ * Структура накопленных сумм каналов.
+ * Суммы всех каналов хранятся подряд.
+ */
+typedef struct _Power_Acc {
+    int32_t sum[POWER_CHANNELS_MAX]; //!< Сумма значений.
+    int32_t sum_zero[POWER_CHANNELS_MAX]; //!< Сумма значений для вычисления нуля.
+    uint16_t count[POWER_CHANNELS_MAX]; //!< Число значений.
+    uint16_t count_zero[POWER_CHANNELS_MAX]; //!< Число значений нуля.
+} power_acc_t;
+
+/**
+ * Структура списков обрабатываемых каналов АЦП.
+ */
+typedef struct _Power_Adc_Map {
+    power_channels_t channels; //!< Маска каналов АЦП.
+    uint8_t frame_size; //!< Число значений в кадре.
+    uint8_t ac_count; //!< Число каналов AC.
+    uint8_t dc_count; //!< Число каналов DC.
+    uint8_t ac_channels[POWER_CHANNELS_MAX]; //!< Номера каналов AC.
+    uint8_t ac_offsets[POWER_CHANNELS_MAX]; //!< Смещения значений каналов AC в кадре.
+    uint8_t dc_channels[POWER_CHANNELS_MAX]; //!< Номера каналов DC.
+    uint8_t dc_offsets[POWER_CHANNELS_MAX]; //!< Смещения значений каналов DC в кадре.
+} power_adc_map_t;
+
 /**
  * Структура питания.
  */
 typedef struct _Power{
     power_value_t* channels; //!< Каналы АЦП.
     size_t channels_count; //!< Число каналов АЦП.
+    power_acc_t acc; //!< Накопленные суммы.
+    power_adc_map_t adc_map; //!< Списки обрабатываемых каналов АЦП.
 } power_t;
 
 //! Инициализирует структуру питания по месту объявления.
-#define MAKE_POWER(arg_channels, arg_count) { .channels = arg_channels, .channels_count = arg_count }
+#define MAKE_POWER(arg_channels, arg_count) { .channels = arg_channels, .channels_count = arg_count,\
+                                              .acc = {{0}}, .adc_map = {0} }
 
 
 /**
@@ -163,6 +216,16 @@ extern err_t power_value_init(power_value_t* value, power_channel_type_t type, s
  */
 extern err_t power_init(power_t* power, power_value_t* channels, size_t channels_count);
 
+/**
+ * Устанавливает маску обрабатываемых каналов АЦП.
+ * Строит списки каналов AC и DC
+ * и смещения их значений в кадре.
+ * @param power Питание.
+ * @param channels Маска каналов АЦП.
+ * @return Код ошибки.
+ */
+extern err_t power_set_adc_channels(power_t* power, power_channels_t channels);
+
 /**
  * Устанавливает программное вычисление для заданного канала.
  * @param power Питание.
@@ -198,6 +261,27 @@ extern fixed32_t power_calc_inst_value(power_value_t* channel, uint16_t adc_valu
  */
 extern fixed32_t power_channel_calc_inst_value(power_t* power, size_t channel, uint16_t adc_value);
 
+/**
+ * Устанавливает скользящее окно вычисления значения канала.
+ * В режиме скользящего окна действующее (среднее) значение
+ * канала обновляется при каждом измерении.
+ * @param power Питание.
+ * @param channel Номер канала.
+ * @param window Скользящее окно, NULL для вычисления по блокам.
+ * @return Код ошибки.
+ */
+extern err_t power_channel_set_window(power_t* power, size_t channel, power_window_t* window);
+
+/**
+ * Устанавливает скользящие окна всех каналов.
+ * Окна, переходящие к другому каналу, сбрасываются.
+ * @param power Питание.
+ * @param windows Скользящие окна каналов (NULL - по блокам),
+ * число элементов равно числу каналов.
+ * @return Код ошибки.
+ */
+extern err_t power_set_windows(power_t* power, power_window_t* const* windows);
+
 /**
  * Обрабатывает очередные значения АЦП.
  * @param power Питание.
@@ -207,6 +291,23 @@ extern fixed32_t power_channel_calc_inst_value(power_t* power, size_t channel, u
  */
 extern err_t power_process_adc_values(power_t* power, power_channels_t channels, uint16_t* adc_values);
 
+/**
+ * Обрабатывает блок кадров значений АЦП.
+ * Каждый кадр содержит значения каналов маски
+ * в порядке возрастания номера канала,
+ * кадры следуют друг за другом.
+ * Значения кадров блока усредняются
+ * и накапливаются как одно измерение.
+ * Фильтруемые значения АЦП заменяются
+ * отфильтрованными по месту.
+ * @param power Питание.
+ * @param channels Маска каналов АЦП.
+ * @param adc_values Значения АЦП.
+ * @param frames_count Число кадров.
+ * @return Код ошибки.
+ */
+extern err_t power_process_adc_values_block(power_t* power, power_channels_t channels, uint16_t* adc_values, size_t frames_count);
+
 /**
  * Обрабатывает накопленные данные АЦП.
  * @param power Питание.
@@ -375,6 +476,17 @@ ALWAYS_INLINE static void power_channel_set_adc_filter_enabled(power_t* power, s
     power->channels[channel].adc_filter_enabled = enabled;
 }
 
+/**
+ * Получает флаг вычисления значения канала в скользящем окне.
+ * @param power Питание.
+ * @param channel Номер канала питания.
+ * @return Флаг вычисления значения в скользящем окне.
+ */
+ALWAYS_INLINE static bool power_channel_window_enabled(const power_t* power, size_t channel)
+{
+    return power->channels[channel].window != NULL;
+}
+
 /**
  * Получает флаг заполнения фильтра данных.
  * @param power Питание.
@@ -471,7 +583,7 @@ ALWAYS_INLINE static int16_t power_channel_raw_zero_current(const power_t* power
  */
 ALWAYS_INLINE static size_t power_channel_samples_count(const power_t* power, size_t channel)
 {
-    return (size_t)power->channels[channel].count;
+    return (size_t)power->acc.count[channel];
 }
 
 #endif	/* POWER_H */
@@ -3,8 +3,9 @@
 #include "utils/utils.h"
 #include "crc/crc16_ccitt.h"
 #include "storage.h"
+#include "utils/critical.h"
 #include <stddef.h>
-#include <stdlib.h>
+#include <string.h>
 
 
 
@@ -29,6 +30,7 @@
 #include "gui/widgets/gui_home.h"
 #define NEED_DESCRS
 #include "parameters_list.h"
+#include "settings_id_table.h"
 
 // Данные параметров.
 #pragma pack(push, 1)
@@ -39,6 +41,114 @@ PARAMETERS_DATA(parameters_data, PARAMETERS_REAL_COUNT);
 PARAMETERS(parameters, PARAMETERS_COUNT);
 
 
+/*
+ * Настройки хранятся в двух копиях: основной
+ * (читается загрузчиком) и резервной.
+ * При сохранении записываются только изменённые страницы,
+ * сначала в резервную копию, затем в основную,
+ * поэтому при пропадании питания во время записи
+ * хотя бы одна копия остаётся целой,
+ * а целая резервная копия всегда не старше основной.
+ */
+
+//! Размер образа настроек в хранилище.
+#define SETTINGS_IMAGE_SIZE (sizeof(parameters_data))
+
+_Static_assert(SETTINGS_IMAGE_SIZE <= STORAGE_RGN_SETTINGS_SIZE &&
+               SETTINGS_IMAGE_SIZE <= STORAGE_RGN_SETTINGS_BAK_SIZE,
+               "Settings image does not fit the settings storage regions");
+
+//! Число страниц образа настроек в хранилище (не более 32).
+#define SETTINGS_PAGES_COUNT ((SETTINGS_IMAGE_SIZE + STORAGE_PAGE_SIZE - 1) / STORAGE_PAGE_SIZE)
+
+//! Маска всех страниц образа настроек.
+#define SETTINGS_PAGES_ALL ((settings_pages_t)((1ULL << SETTINGS_PAGES_COUNT) - 1))
+
+//! Тип маски страниц образа настроек.
+typedef uint32_t settings_pages_t;
+
+//! Копии настроек в хранилище.
+typedef enum _Settings_Copy {
+    SETTINGS_COPY_BAK = 0, //!< Резервная копия.
+    SETTINGS_COPY_MAIN = 1, //!< Основная копия.
+    SETTINGS_COPIES_COUNT = 2
+} settings_copy_t;
+
+//! Адреса копий настроек в порядке записи.
+static const storage_address_t settings_copies_addresses[SETTINGS_COPIES_COUNT] = {
+    STORAGE_RGN_SETTINGS_BAK_ADDRESS,
+    STORAGE_RGN_SETTINGS_ADDRESS
+};
+
+//! Изменённые и не записанные страницы каждой копии.
+static settings_pages_t settings_dirty_pages[SETTINGS_COPIES_COUNT];
+
+
+/*
+ * Прежние раскладки образа настроек.
+ * Образ - значения реальных параметров по порядку идентификаторов,
+ * поэтому добавление реального параметра меняет раскладку и CRC образа.
+ * Для каждой прежней раскладки, начиная с последней, перечисляются
+ * параметры, добавленные после неё. Образ прежней раскладки
+ * при чтении переносится в текущую, добавленные параметры
+ * получают значения по умолчанию.
+ * При добавлении реальных параметров в начало таблицы
+ * добавляется раскладка с их идентификаторами.
+ */
+
+//! Параметры, добавленные после исходной раскладки (435 параметров).
+static const param_id_t settings_layout_0_added_ids[] = {
+    PARAM_ID_MODBUS_BAUD_HIGH,
+    PARAM_ID_TRIACS_PAIRS_PULSE_TRAIN_MODE,
+    PARAM_ID_SLIDING_WINDOW_Ua,
+    PARAM_ID_SLIDING_WINDOW_Ub,
+    PARAM_ID_SLIDING_WINDOW_Uc,
+    PARAM_ID_SLIDING_WINDOW_Urot,
+    PARAM_ID_SLIDING_WINDOW_Ia,
+    PARAM_ID_SLIDING_WINDOW_Ib,
+    PARAM_ID_SLIDING_WINDOW_Ic,
+    PARAM_ID_SLIDING_WINDOW_Irot,
+    PARAM_ID_SLIDING_WINDOW_Iexc,
+    PARAM_ID_SLIDING_WINDOW_Iref,
+    PARAM_ID_SLIDING_WINDOW_Ifan,
+    PARAM_ID_SLIDING_WINDOW_Erot
+};
+
+//! Тип прежней раскладки образа настроек.
+typedef struct _Settings_Layout {
+    const param_id_t* added_ids; //!< Параметры, добавленные после раскладки.
+    size_t added_count; //!< Число добавленных параметров.
+} settings_layout_t;
+
+//! Прежние раскладки образа настроек, от последней к исходной.
+static const settings_layout_t settings_layouts[] = {
+    {settings_layout_0_added_ids, sizeof(settings_layout_0_added_ids) / sizeof(param_id_t)}
+};
+
+//! Число прежних раскладок образа настроек.
+#define SETTINGS_LAYOUTS_COUNT (sizeof(settings_layouts) / sizeof(settings_layout_t))
+
+_Static_assert(PARAMETERS_REAL_COUNT == 435 + sizeof(settings_layout_0_added_ids) / sizeof(param_id_t),
+               "Settings layouts do not match the real parameters count");
+
+
+//! Таблица поиска параметра по идентификатору.
+static settings_id_table_t settings_id_table;
+
+
+//! Число слов маски изменённых параметров.
+#define SETTINGS_CHANGED_WORDS ((PARAMETERS_COUNT + 31) / 32)
+
+//! Тип маски параметров.
+typedef uint32_t settings_params_mask_t[SETTINGS_CHANGED_WORDS];
+
+//! Изменённые и не применённые параметры.
+static settings_params_mask_t settings_changed_params;
+
+//! Подписки на изменение параметров.
+static settings_subscription_t* settings_subscriptions = NULL;
+
+
 //! Флаг только для чтения.
 static bool _settings_readonly = false;
 
@@ -78,6 +188,57 @@ ALWAYS_INLINE static param_data_t* settings_param_data_by_index(size_t index)
     return &parameters_data.data[index];
 }
 
+/**
+ * Помечает изменёнными страницы образа настроек.
+ * @param pages Маска страниц.
+ */
+static void settings_set_dirty_pages(settings_pages_t pages)
+{
+    CRITICAL_ENTER();
+    
+    size_t i;
+    for(i = 0; i < SETTINGS_COPIES_COUNT; i ++){
+        settings_dirty_pages[i] |= pages;
+    }
+    
+    CRITICAL_EXIT();
+}
+
+/**
+ * Помечает изменённой страницу образа настроек
+ * с данными по заданному смещению.
+ * @param offset Смещение данных в образе.
+ */
+ALWAYS_INLINE static void settings_set_dirty_offset(size_t offset)
+{
+    settings_set_dirty_pages((settings_pages_t)1 << (offset / STORAGE_PAGE_SIZE));
+}
+
+/**
+ * Помечает изменёнными параметр и страницу с его данными,
+ * если значение параметра изменилось.
+ * @param param Параметр.
+ * @param old_data Прежнее значение параметра.
+ */
+static void settings_param_update_dirty(param_t* param, param_data_t old_data)
+{
+    const param_descr_t* descr = settings_param_descr_by_index(param->descr_index);
+    
+    if(descr->flags & PARAM_FLAG_VIRTUAL) return;
+    
+    param_data_t* data = settings_param_data_by_index(param->data_index);
+    
+    if(*data == old_data) return;
+    
+    settings_set_dirty_offset((size_t)((uint8_t*)data - (uint8_t*)&parameters_data));
+    
+    size_t index = param->descr_index;
+    
+    CRITICAL_ENTER();
+    settings_changed_params[index / 32] |= 1UL << (index % 32);
+    CRITICAL_EXIT();
+}
+
 /**
  * Получает значение параметра как знаковое целое.
  * @param param Параметр.
@@ -364,11 +525,16 @@ err_t settings_init(void)
     
     _settings_readonly = false;
     
+    settings_id_table_reset(&settings_id_table);
+    
     for(; i < PARAMETERS_COUNT; i ++){
         
         descr = settings_param_descr_by_index(i);
         param = settings_parameter_by_index(i);
         
+        // Параметры должны быть упорядочены по идентификатору.
+        RETURN_ERR_IF_FAIL(settings_id_table_append(&settings_id_table, descr->id));
+        
         if(!(descr->flags & PARAM_FLAG_VIRTUAL)){
             if(index >= PARAMETERS_REAL_COUNT) return E_OUT_OF_RANGE;
             parameters_data.data[index] = 0;
@@ -382,38 +548,185 @@ err_t settings_init(void)
     
     parameters_data.crc = 0;
     
+    settings_set_dirty_pages(SETTINGS_PAGES_ALL);
+    
     return E_NO_ERROR;
 }
 
+/**
+ * Устанавливает параметру значение по умолчанию.
+ * @param param Параметр.
+ */
+static void settings_param_set_default(param_t* param)
+{
+    const param_descr_t* descr = settings_param_descr_by_index(param->descr_index);
+    
+    switch(descr->type){
+    default:
+    case PARAM_TYPE_INT:
+        settings_param_set_valuei(param, descr->def.int_value);
+        break;
+    case PARAM_TYPE_UINT:
+        settings_param_set_valueu(param, descr->def.uint_value);
+        break;
+    case PARAM_TYPE_FRACT_10:
+    case PARAM_TYPE_FRACT_100:
+    case PARAM_TYPE_FRACT_1000:
+    case PARAM_TYPE_FRACT_10000:
+        settings_param_set_valuef(param, descr->def.fixed_value);
+        break;
+    }
+}
+
 err_t settings_default(void)
 {
     if(ro()) return E_STATE;
     
     size_t i = 0;
     
-    const param_descr_t* descr;
+    for(; i < PARAMETERS_COUNT; i ++){
+        settings_param_set_default(settings_parameter_by_index(i));
+    }
+    
+    return E_NO_ERROR;
+}
+
+/**
+ * Читает копию настроек в образ настроек.
+ * @param copy Копия настроек.
+ * @return Код ошибки.
+ */
+static err_t settings_read_copy(settings_copy_t copy)
+{
+    RETURN_ERR_IF_FAIL(
+            storage_read(settings_copies_addresses[copy], &parameters_data, SETTINGS_IMAGE_SIZE)
+        );
+    
+    uint16_t crc = crc16_ccitt(parameters_data.data, SETTINGS_IMAGE_SIZE - sizeof(uint16_t));
+    
+    if(crc != parameters_data.crc) return E_CRC;
+    
+    return E_NO_ERROR;
+}
+
+/**
+ * Помечает изменёнными страницы копии настроек,
+ * отличающиеся от образа настроек.
+ * @param copy Копия настроек.
+ * @return Код ошибки.
+ */
+static err_t settings_compare_copy(settings_copy_t copy)
+{
+    uint8_t page[STORAGE_PAGE_SIZE];
+    
+    const uint8_t* image = (const uint8_t*)&parameters_data;
+    storage_address_t address = settings_copies_addresses[copy];
+    settings_pages_t pages = 0;
+    
+    size_t offset = 0;
+    size_t size = 0;
+    size_t i;
+    
+    for(i = 0; i < SETTINGS_PAGES_COUNT; i ++){
+        size = MIN(STORAGE_PAGE_SIZE, SETTINGS_IMAGE_SIZE - offset);
+        
+        RETURN_ERR_IF_FAIL(storage_read(address + offset, page, size));
+        
+        if(memcmp(page, image + offset, size) != 0){
+            pages |= (settings_pages_t)1 << i;
+        }
+        
+        offset += size;
+    }
+    
+    settings_dirty_pages[copy] = pages;
+    
+    return E_NO_ERROR;
+}
+
+/**
+ * Получает флаг добавления параметра после прежней раскладки.
+ * @param layout Индекс прежней раскладки.
+ * @param id Идентификатор параметра.
+ * @return Флаг добавления параметра.
+ */
+static bool settings_layout_added(size_t layout, param_id_t id)
+{
+    size_t i, j;
+    for(i = 0; i <= layout; i ++){
+        for(j = 0; j < settings_layouts[i].added_count; j ++){
+            if(settings_layouts[i].added_ids[j] == id) return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Получает число реальных параметров прежней раскладки.
+ * @param layout Индекс прежней раскладки.
+ * @return Число реальных параметров.
+ */
+static size_t settings_layout_count(size_t layout)
+{
+    size_t count = PARAMETERS_REAL_COUNT;
+    size_t i;
+    for(i = 0; i <= layout; i ++){
+        count -= settings_layouts[i].added_count;
+    }
+    return count;
+}
+
+/**
+ * Читает основную копию настроек прежней раскладки
+ * и переносит её в образ настроек.
+ * Основная копия записывается последней и есть
+ * во всех прежних версиях, поэтому читается только она.
+ * @param layout Индекс прежней раскладки.
+ * @return Код ошибки.
+ */
+static err_t settings_read_layout(size_t layout)
+{
+    size_t count = settings_layout_count(layout);
+    size_t old_index = count;
+    size_t i;
+    uint16_t crc;
+    
     param_t* param;
+    const param_descr_t* descr;
     
-    for(; i < PARAMETERS_COUNT; i ++){
+    RETURN_ERR_IF_FAIL(
+            storage_read(settings_copies_addresses[SETTINGS_COPY_MAIN], &parameters_data,
+                         count * sizeof(param_data_t) + sizeof(uint16_t))
+        );
+    
+    memcpy(&crc, &parameters_data.data[count], sizeof(uint16_t));
+    
+    if(crc != crc16_ccitt(parameters_data.data, count * sizeof(param_data_t))) return E_CRC;
+    
+    // Перенос с конца, индекс в текущей раскладке не меньше прежнего.
+    for(i = PARAMETERS_COUNT; i != 0; i --){
+        param = settings_parameter_by_index(i - 1);
+        descr = settings_param_descr_by_index(param->descr_index);
+        
+        if(descr->flags & PARAM_FLAG_VIRTUAL) continue;
+        if(settings_layout_added(layout, descr->id)) continue;
         
+        // Все добавленные параметры должны быть реальными.
+        if(old_index == 0) return E_INVALID_VALUE;
+        
+        parameters_data.data[param->data_index] = parameters_data.data[-- old_index];
+    }
+    
+    if(old_index != 0) return E_INVALID_VALUE;
+    
+    for(i = 0; i < PARAMETERS_COUNT; i ++){
         param = settings_parameter_by_index(i);
         descr = settings_param_descr_by_index(param->descr_index);
         
-        switch(descr->type){
-        default:
-        case PARAM_TYPE_INT:
-            settings_param_set_valuei(param, descr->def.int_value);
-            break;
-        case PARAM_TYPE_UINT:
-            settings_param_set_valueu(param, descr->def.uint_value);
-            break;
-        case PARAM_TYPE_FRACT_10:
-        case PARAM_TYPE_FRACT_100:
-        case PARAM_TYPE_FRACT_1000:
-        case PARAM_TYPE_FRACT_10000:
-            settings_param_set_valuef(param, descr->def.fixed_value);
-            break;
-    }
+        if(descr->flags & PARAM_FLAG_VIRTUAL) continue;
+        if(!settings_layout_added(layout, descr->id)) continue;
+        
+        settings_param_set_default(param);
     }
     
     return E_NO_ERROR;
@@ -423,27 +736,136 @@ err_t settings_read(void)
 {
     if(ro()) return E_STATE;
     
-    RETURN_ERR_IF_FAIL(
-            storage_read(STORAGE_RGN_SETTINGS_ADDRESS, &parameters_data, sizeof(parameters_data))
-        );
+    settings_set_dirty_pages(SETTINGS_PAGES_ALL);
     
-    uint16_t crc = crc16_ccitt(parameters_data.data, sizeof(parameters_data) - sizeof(uint16_t));
+    // Целая резервная копия не старше основной.
+    settings_copy_t copy = SETTINGS_COPY_BAK;
+    settings_copy_t other = SETTINGS_COPY_MAIN;
     
-    if(crc != parameters_data.crc) return E_CRC;
+    if(settings_read_copy(copy) != E_NO_ERROR){
+        copy = SETTINGS_COPY_MAIN;
+        other = SETTINGS_COPY_BAK;
+        if(settings_read_copy(copy) != E_NO_ERROR){
+            // Образ прежней версии прошивки
+            // будет полностью записан в обе копии.
+            size_t i;
+            for(i = 0; i < SETTINGS_LAYOUTS_COUNT; i ++){
+                if(settings_read_layout(i) == E_NO_ERROR) return E_NO_ERROR;
+            }
+            return E_CRC;
+        }
+    }
+    
+    settings_dirty_pages[copy] = 0;
+    
+    // Другая копия будет дописана при следующем сохранении,
+    // при ошибке чтения - полностью.
+    settings_compare_copy(other);
     
     return E_NO_ERROR;
 }
 
+err_t settings_read_shared(void)
+{
+    if(ro()) return E_STATE;
+    
+    params_shared_t shared;
+    uint16_t crc;
+    size_t i;
+    
+    // Основную копию читает загрузчик.
+    for(i = SETTINGS_COPIES_COUNT; i != 0; i --){
+        if(storage_read(settings_copies_addresses[i - 1], &shared, sizeof(params_shared_t)) != E_NO_ERROR) continue;
+        
+        crc = crc16_ccitt(&shared, sizeof(params_shared_t) - sizeof(uint16_t));
+        if(crc != shared.crc) continue;
+        
+        memcpy(parameters_data.data, &shared, sizeof(params_shared_t));
+        settings_set_dirty_pages(SETTINGS_PAGES_ALL);
+        
+        return E_NO_ERROR;
+    }
+    
+    return E_CRC;
+}
+
+/**
+ * Записывает изменённые страницы образа настроек в копию настроек.
+ * @param copy Копия настроек.
+ * @return Код ошибки.
+ */
+static err_t settings_write_copy(settings_copy_t copy)
+{
+    CRITICAL_ENTER();
+    settings_pages_t pages = settings_dirty_pages[copy];
+    settings_dirty_pages[copy] = 0;
+    CRITICAL_EXIT();
+    
+    const uint8_t* image = (const uint8_t*)&parameters_data;
+    storage_address_t address = settings_copies_addresses[copy];
+    
+    err_t err = E_NO_ERROR;
+    size_t first = 0;
+    size_t last = 0;
+    size_t offset = 0;
+    size_t size = 0;
+    
+    while(first < SETTINGS_PAGES_COUNT){
+        if(!(pages & ((settings_pages_t)1 << first))){
+            first ++;
+            continue;
+        }
+        
+        // Смежные страницы записываются одним запросом.
+        last = first + 1;
+        while(last < SETTINGS_PAGES_COUNT && (pages & ((settings_pages_t)1 << last))){
+            last ++;
+        }
+        
+        offset = first * STORAGE_PAGE_SIZE;
+        size = MIN(last * STORAGE_PAGE_SIZE, SETTINGS_IMAGE_SIZE) - offset;
+        
+        err = storage_write(address + offset, image + offset, size);
+        if(err != E_NO_ERROR) break;
+        
+        pages &= ~(((settings_pages_t)1 << last) - ((settings_pages_t)1 << first));
+        first = last;
+    }
+    
+    if(pages != 0){
+        CRITICAL_ENTER();
+        settings_dirty_pages[copy] |= pages;
+        CRITICAL_EXIT();
+    }
+    
+    return err;
+}
+
 err_t settings_write(void)
 {
     // Контрольная сумма общих параметров.
     params_shared_t* shared = (params_shared_t*)parameters_data.data;
-    shared->crc = crc16_ccitt(shared, sizeof(params_shared_t) - sizeof(uint16_t));
+    uint16_t crc = crc16_ccitt(shared, sizeof(params_shared_t) - sizeof(uint16_t));
+    
+    if(crc != shared->crc){
+        shared->crc = crc;
+        settings_set_dirty_offset((size_t)((uint8_t*)&shared->crc - (uint8_t*)&parameters_data));
+    }
+    
+    if(settings_dirty_pages[SETTINGS_COPY_BAK] == 0 &&
+       settings_dirty_pages[SETTINGS_COPY_MAIN] == 0) return E_NO_ERROR;
     
     // Контрольная сумма всех параметров.
-    parameters_data.crc = crc16_ccitt(parameters_data.data, sizeof(parameters_data) - sizeof(uint16_t));
+    crc = crc16_ccitt(parameters_data.data, SETTINGS_IMAGE_SIZE - sizeof(uint16_t));
+    
+    if(crc != parameters_data.crc){
+        parameters_data.crc = crc;
+        settings_set_dirty_offset(SETTINGS_IMAGE_SIZE - sizeof(uint16_t));
+    }
     
-    return storage_write(STORAGE_RGN_SETTINGS_ADDRESS, &parameters_data, sizeof(parameters_data));
+    RETURN_ERR_IF_FAIL(settings_write_copy(SETTINGS_COPY_BAK));
+    
+    return settings_write_copy(SETTINGS_COPY_MAIN);
 }
 
 bool settings_readonly(void)
@@ -456,28 +878,145 @@ void settings_set_readonly(bool readonly)
     _settings_readonly = readonly;
 }
 
+param_t* settings_param_by_id(param_id_t id)
+{
+    size_t index;
+    
+    if(!settings_id_table_find(&settings_id_table, id, &index)) return NULL;
+    
+    return settings_parameter_by_index(index);
+}
+
 /**
- * Функция сравнения двух параметров по идентификатору.
- * @param a Параметр А.
- * @param b Параметр Б.
- * @return Результат сравнения.
+ * Загружает значение параметра в переменную дескриптора.
+ * @param handle Дескриптор параметра.
  */
-static int settings_compare_params_ids (const void * key, const void * item)
+static void settings_handle_load(settings_handle_t* handle)
+{
+    if(handle->value == NULL) return;
+    
+    switch(handle->type){
+        default:
+        case PARAM_VALUE_TYPE_FIXED:
+            *(fixed32_t*)handle->value = settings_param_valuef(handle->param);
+            break;
+        case PARAM_VALUE_TYPE_INT:
+            *(int32_t*)handle->value = settings_param_valuei(handle->param);
+            break;
+        case PARAM_VALUE_TYPE_UINT:
+            *(uint32_t*)handle->value = settings_param_valueu(handle->param);
+            break;
+    }
+}
+
+err_t settings_subscribe(settings_subscription_t* subscription)
 {
-    const param_descr_t* item_descr = settings_param_descr_by_index(((param_t*)item)->descr_index);
-    param_id_t item_id = item_descr->id;
-    param_id_t id = (param_id_t)(unsigned long)key;
+    if(subscription == NULL) return E_NULL_POINTER;
     
-    if(id > item_id) return 1;
-    if(id < item_id) return -1;
+    settings_subscription_t* sub = settings_subscriptions;
+    for(; sub != NULL; sub = sub->next){
+        if(sub == subscription) return E_STATE;
+    }
     
-    return 0;
+    settings_handle_t* handle;
+    size_t index;
+    size_t i;
+    
+    for(i = 0; i < subscription->handles_count; i ++){
+        handle = &subscription->handles[i];
+        handle->changed = false;
+        
+        if(handle->id_last == handle->id){
+            handle->param = settings_param_by_id(handle->id);
+            if(handle->param == NULL) return E_INVALID_VALUE;
+            
+            handle->count = 1;
+            
+            settings_handle_load(handle);
+        }else{
+            if(handle->id_last < handle->id) return E_INVALID_VALUE;
+            
+            // Параметры упорядочены по идентификатору.
+            for(index = 0; index < PARAMETERS_COUNT; index ++){
+                if(settings_param_descr_by_index(index)->id >= handle->id) break;
+            }
+            
+            handle->param = (index < PARAMETERS_COUNT) ? settings_parameter_by_index(index) : NULL;
+            handle->count = 0;
+            
+            for(; index < PARAMETERS_COUNT; index ++){
+                if(settings_param_descr_by_index(index)->id > handle->id_last) break;
+                handle->count ++;
+            }
+        }
+    }
+    
+    // Подписки уведомляются в порядке подписки.
+    settings_subscription_t** next = &settings_subscriptions;
+    while(*next != NULL) next = &(*next)->next;
+    
+    subscription->next = NULL;
+    *next = subscription;
+    
+    return E_NO_ERROR;
 }
 
-param_t* settings_param_by_id(param_id_t id)
+bool settings_apply_changes(void)
 {
-    param_t* param = bsearch((void*)(unsigned long)id, parameters, PARAMETERS_COUNT, sizeof(param_t), settings_compare_params_ids);
-    return param;
+    settings_params_mask_t changed;
+    
+    CRITICAL_ENTER();
+    memcpy(changed, settings_changed_params, sizeof(settings_params_mask_t));
+    memset(settings_changed_params, 0x0, sizeof(settings_params_mask_t));
+    CRITICAL_EXIT();
+    
+    settings_params_mask_t handled;
+    memset(handled, 0x0, sizeof(settings_params_mask_t));
+    
+    settings_subscription_t* sub = settings_subscriptions;
+    settings_handle_t* handle;
+    
+    size_t index;
+    size_t index_end;
+    uint32_t bit;
+    bool notify;
+    size_t i;
+    
+    for(; sub != NULL; sub = sub->next){
+        notify = false;
+        
+        for(i = 0; i < sub->handles_count; i ++){
+            handle = &sub->handles[i];
+            handle->changed = false;
+            
+            if(handle->count == 0) continue;
+            
+            index = handle->param->descr_index;
+            index_end = index + handle->count;
+            
+            for(; index < index_end; index ++){
+                bit = 1UL << (index % 32);
+                
+                if(!(changed[index / 32] & bit)) continue;
+                
+                handled[index / 32] |= bit;
+                handle->changed = true;
+            }
+            
+            if(!handle->changed) continue;
+            
+            settings_handle_load(handle);
+            notify = true;
+        }
+        
+        if(notify && sub->notify) sub->notify();
+    }
+    
+    for(i = 0; i < SETTINGS_CHANGED_WORDS; i ++){
+        if(changed[i] & ~handled[i]) return true;
+    }
+    
+    return false;
 }
 
 bool settings_param_is_virtual(param_t* param)
@@ -513,7 +1052,9 @@ param_units_t settings_param_units(param_t* param)
     const param_descr_t* descr = settings_param_descr_by_index(param->descr_index);
     param_data_t* data = (descr->flags & PARAM_FLAG_VIRTUAL) ? (&param->virt_data):
                          (settings_param_data_by_index(param->data_index));
+    param_data_t old_data = *data;
     *data = value;
+    settings_param_update_dirty(param, old_data);
     return true;
  }
 
@@ -526,8 +1067,12 @@ bool settings_param_set_valuei(param_t* param, int32_t value)
 {
     if(ro()) return false;
     
+    param_data_t old_data = settings_param_value_raw(param);
+    
     settings_param_set_int32(param, value);
     
+    settings_param_update_dirty(param, old_data);
+    
     return true;
 }
 
@@ -540,8 +1085,12 @@ bool settings_param_set_valueu(param_t* param, uint32_t value)
 {
     if(ro()) return false;
     
+    param_data_t old_data = settings_param_value_raw(param);
+    
     settings_param_set_uint32(param, value);
     
+    settings_param_update_dirty(param, old_data);
+    
     return true;
 }
 
@@ -554,8 +1103,12 @@ bool settings_param_set_valuef(param_t* param, fixed32_t value)
 {
     if(ro()) return false;
     
+    param_data_t old_data = settings_param_value_raw(param);
+    
     settings_param_set_fixed32(param, value);
     
+    settings_param_update_dirty(param, old_data);
+    
     return true;
 }
 
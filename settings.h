@@ -5,6 +5,7 @@
 #ifndef SETTINGS_H
 #define	SETTINGS_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include "fixed/fixed32.h"
@@ -92,6 +93,45 @@ typedef struct _Param {
 } param_t;
 
 
+//! Тип типизированного дескриптора параметра модуля.
+typedef struct _Settings_Handle {
+    param_id_t id; //!< Идентификатор параметра (первого параметра диапазона).
+    param_id_t id_last; //!< Идентификатор последнего параметра диапазона.
+    param_value_type_t type; //!< Тип значения переменной.
+    void* value; //!< Переменная для значения, NULL - только уведомление.
+    param_t* param; //!< Параметр (первый параметр диапазона), заполняется при подписке.
+    param_index_t count; //!< Число параметров диапазона, заполняется при подписке.
+    bool changed; //!< Флаг изменения параметра при последнем применении изменений.
+} settings_handle_t;
+
+//! Тип функции уведомления об изменении параметров подписки.
+typedef void (*settings_notify_t)(void);
+
+//! Тип подписки модуля на изменение параметров.
+typedef struct _Settings_Subscription {
+    settings_handle_t* handles; //!< Дескрипторы параметров.
+    size_t handles_count; //!< Число дескрипторов параметров.
+    settings_notify_t notify; //!< Функция уведомления, может быть NULL.
+    struct _Settings_Subscription* next; //!< Следующая подписка.
+} settings_subscription_t;
+
+//! Описывает дескриптор параметра модуля.
+#define SETTINGS_HANDLE(arg_id, arg_type, arg_value)\
+        { .id = arg_id, .id_last = arg_id, .type = arg_type, .value = arg_value,\
+          .param = NULL, .count = 0, .changed = false }
+
+//! Описывает дескриптор диапазона параметров модуля (только уведомление).
+#define SETTINGS_HANDLE_RANGE(arg_id_first, arg_id_last)\
+        { .id = arg_id_first, .id_last = arg_id_last, .type = PARAM_VALUE_TYPE_INT, .value = NULL,\
+          .param = NULL, .count = 0, .changed = false }
+
+//! Объявляет подписку на изменение параметров.
+#define SETTINGS_SUBSCRIPTION(arg_name, arg_handles, arg_notify)\
+        static settings_subscription_t arg_name = { .handles = arg_handles,\
+          .handles_count = sizeof(arg_handles) / sizeof(settings_handle_t),\
+          .notify = arg_notify, .next = NULL }
+
+
 //! Макрос для обновления параметра fixed32.
 #define DRIVE_UPDATE_PARAM_FIXED(PARAM, VALUE)\
     do {\
@@ -125,12 +165,26 @@ extern err_t settings_default(void);
 
 /**
  * Читает настройки.
+ * Загружает целую копию настроек из хранилища
+ * и определяет отличающиеся страницы другой копии.
+ * Образ прежней раскладки переносится в текущую.
  * @return Код ошибки.
  */
 extern err_t settings_read(void);
 
+/**
+ * Читает общие с загрузчиком параметры.
+ * Восстанавливает параметры связи из целого
+ * общего блока копии настроек, когда
+ * сами настройки прочитать не удалось.
+ * @return Код ошибки.
+ */
+extern err_t settings_read_shared(void);
+
 /**
  * Записывает настройки.
+ * Записывает только изменённые страницы
+ * в резервную, затем в основную копию настроек.
  * @return Код ошибки.
  */
 extern err_t settings_write(void);
@@ -154,6 +208,24 @@ extern void settings_set_readonly(bool readonly);
  */
 extern param_t* settings_param_by_id(param_id_t id);
 
+/**
+ * Подписывает модуль на изменение параметров.
+ * Находит параметры дескрипторов и загружает их значения в переменные.
+ * Параметры диапазона могут отсутствовать.
+ * Вызывается при инициализации модуля, после чтения настроек.
+ * @param subscription Подписка.
+ * @return Код ошибки.
+ */
+extern err_t settings_subscribe(settings_subscription_t* subscription);
+
+/**
+ * Применяет изменения параметров к подпискам.
+ * Обновляет переменные и флаги изменения дескрипторов
+ * и уведомляет подписки с изменёнными параметрами.
+ * @return Флаг изменения параметров, на которые нет подписок.
+ */
+extern bool settings_apply_changes(void);
+
 /**
  * Получает флаг виртуального параметра.
  * @param param Параметр.
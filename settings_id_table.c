@@ -0,0 +1,43 @@
+#include "settings_id_table.h"
+#include <string.h>
+
+
+
+/**
+ * Получает флаг отсутствия идентификаторов в блоке таблицы поиска.
+ * @param table Таблица поиска.
+ * @param block Индекс блока.
+ * @return Флаг отсутствия идентификаторов.
+ */
+static bool settings_id_table_block_empty(const settings_id_table_t* table, size_t block)
+{
+    size_t i;
+    for(i = 0; i < SETTINGS_ID_TABLE_BLOCK_WORDS; i ++){
+        if(table->mask[block][i] != 0) return false;
+    }
+    return true;
+}
+
+void settings_id_table_reset(settings_id_table_t* table)
+{
+    memset(table, 0x0, sizeof(settings_id_table_t));
+}
+
+err_t settings_id_table_append(settings_id_table_t* table, param_id_t id)
+{
+    if(id > PARAMETERS_ID_MAX) return E_OUT_OF_RANGE;
+    if(table->count != 0 && id <= table->last_id) return E_INVALID_VALUE;
+    
+    size_t block = id / SETTINGS_ID_TABLE_BLOCK_LEN;
+    size_t bit = id % SETTINGS_ID_TABLE_BLOCK_LEN;
+    
+    if(settings_id_table_block_empty(table, block)){
+        table->base[block] = table->count;
+    }
+    table->mask[block][bit / 32] |= 1UL << (bit % 32);
+    
+    table->last_id = id;
+    table->count ++;
+    
+    return E_NO_ERROR;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file settings_id_table.h Таблица поиска параметра по идентификатору.
+ * Идентификаторы разбиты на блоки, для каждого блока
+ * хранятся индекс его первого параметра и маска имеющихся
+ * идентификаторов. Индекс параметра - индекс первого параметра
+ * блока плюс число бит маски перед битом идентификатора.
+ */
+
+#ifndef SETTINGS_ID_TABLE_H
+#define SETTINGS_ID_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "errors/errors.h"
+#include "defs/defs.h"
+#include "settings.h"
+#include "parameters_list.h"
+
+
+//! Число идентификаторов в блоке таблицы поиска.
+#define SETTINGS_ID_TABLE_BLOCK_LEN 64
+
+//! Число слов маски блока таблицы поиска.
+#define SETTINGS_ID_TABLE_BLOCK_WORDS (SETTINGS_ID_TABLE_BLOCK_LEN / 32)
+
+//! Число блоков таблицы поиска.
+#define SETTINGS_ID_TABLE_BLOCKS_COUNT (PARAMETERS_ID_MAX / SETTINGS_ID_TABLE_BLOCK_LEN + 1)
+
+//! Тип таблицы поиска параметра по идентификатору.
+typedef struct _Settings_Id_Table {
+    param_index_t base[SETTINGS_ID_TABLE_BLOCKS_COUNT]; //!< Индексы первых параметров блоков.
+    uint32_t mask[SETTINGS_ID_TABLE_BLOCKS_COUNT][SETTINGS_ID_TABLE_BLOCK_WORDS]; //!< Маски идентификаторов блоков.
+    param_id_t last_id; //!< Последний добавленный идентификатор.
+    param_index_t count; //!< Число добавленных идентификаторов.
+} settings_id_table_t;
+
+
+/**
+ * Сбрасывает таблицу поиска.
+ * @param table Таблица поиска.
+ */
+EXTERN void settings_id_table_reset(settings_id_table_t* table);
+
+/**
+ * Добавляет в таблицу поиска идентификатор
+ * параметра со следующим индексом.
+ * Идентификаторы должны добавляться по возрастанию.
+ * @param table Таблица поиска.
+ * @param id Идентификатор параметра.
+ * @return Код ошибки: E_OUT_OF_RANGE если идентификатор
+ * больше PARAMETERS_ID_MAX, E_INVALID_VALUE если
+ * идентификатор не больше предыдущего.
+ */
+EXTERN err_t settings_id_table_append(settings_id_table_t* table, param_id_t id);
+
+/**
+ * Получает число единичных бит.
+ * @param value Значение.
+ * @return Число единичных бит.
+ */
+ALWAYS_INLINE static size_t settings_id_table_bits_count(uint32_t value)
+{
+    value = value - ((value >> 1) & 0x55555555);
+    value = (value & 0x33333333) + ((value >> 2) & 0x33333333);
+    value = (value + (value >> 4)) & 0x0f0f0f0f;
+    return (value * 0x01010101) >> 24;
+}
+
+/**
+ * Ищет индекс параметра по идентификатору.
+ * @param table Таблица поиска.
+ * @param id Идентификатор параметра.
+ * @param index Индекс параметра.
+ * @return Флаг наличия параметра.
+ */
+ALWAYS_INLINE static bool settings_id_table_find(const settings_id_table_t* table, param_id_t id, size_t* index)
+{
+    if(id > PARAMETERS_ID_MAX) return false;
+    
+    size_t block = id / SETTINGS_ID_TABLE_BLOCK_LEN;
+    size_t bit = id % SETTINGS_ID_TABLE_BLOCK_LEN;
+    size_t word = bit / 32;
+    uint32_t word_bit = 1UL << (bit % 32);
+    
+    const uint32_t* mask = table->mask[block];
+    
+    if(!(mask[word] & word_bit)) return false;
+    
+    size_t res = table->base[block] + settings_id_table_bits_count(mask[word] & (word_bit - 1));
+    
+    size_t i;
+    for(i = 0; i < word; i ++){
+        res += settings_id_table_bits_count(mask[i]);
+    }
+    
+    *index = res;
+    
+    return true;
+}
+
+#endif /* SETTINGS_ID_TABLE_H */
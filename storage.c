@@ -1,6 +1,9 @@
 #include "storage.h"
 #include <string.h>
 #include <stdint.h>
+#include <stdbool.h>
+#include <FreeRTOS.h>
+#include <task.h>
 #include "utils/utils.h"
 #include "utils/delay.h"
 
@@ -8,6 +11,9 @@
 //! Время между запросами флага WIP.
 #define EEPROM_WAIT_ITER_TIME_US 1
 
+//! Период опроса флага WIP после запуска планировщика, тиков.
+#define STORAGE_WIP_POLL_PERIOD_TICKS 1
+
 
 //! Тип структуры хранилища данных.
 typedef struct _Storage {
@@ -20,15 +26,23 @@ static storage_t storage;
 
 /**
  * Ждёт завершения записи данных.
- * @param storage Хранилище данных.
+ * После запуска планировщика вызывающая задача
+ * засыпает между опросами флага WIP,
+ * до запуска - опрашивает его в цикле.
  * @return Код ошибки.
  */
 static err_t storage_wait_eeprom_wip(void)
 {
     m95x_status_t status;
     
+    bool scheduler_running = xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+    
     do {
-        delay_us(EEPROM_WAIT_ITER_TIME_US);
+        if(scheduler_running){
+            vTaskDelay(STORAGE_WIP_POLL_PERIOD_TICKS);
+        }else{
+            delay_us(EEPROM_WAIT_ITER_TIME_US);
+        }
         RETURN_ERR_IF_FAIL(m95x_read_status(storage.eeprom, &status));
     } while(status.write_in_progress);
     
@@ -7,6 +7,9 @@
 
 
 
+//! Размер страницы памяти хранилища (M95X_PAGE_128).
+#define STORAGE_PAGE_SIZE 128
+
 // Адреса и размеры регионов.
 //! Адрес региона настроек.
 #define STORAGE_RGN_SETTINGS_ADDRESS 0x0
@@ -28,10 +31,17 @@
 //! Размер региона.
 #define STORAGE_RGN_EVENTS_SIZE 0xb80
 
+//! Адрес региона резервной копии настроек.
+#define STORAGE_RGN_SETTINGS_BAK_ADDRESS 0x1000
+//! Размер региона резервной копии настроек.
+#define STORAGE_RGN_SETTINGS_BAK_SIZE 0x400
+
+// 0x1400 - 0x2000 - резерв.
+
 //! Адрес региона.
-#define STORAGE_RGN_OSC_ADDRESS 0x1000
+#define STORAGE_RGN_OSC_ADDRESS 0x2000
 //! Размер региона.
-#define STORAGE_RGN_OSC_SIZE 0xf000//0x3000
+#define STORAGE_RGN_OSC_SIZE 0xe000//0x3000
 
 /*
 //! Адрес региона.
@@ -63,6 +73,8 @@ extern err_t storage_read(storage_address_t address, void* data, size_t size);
 
 /**
  * Записывает данные в хранилище данных.
+ * После запуска планировщика вызывающая задача
+ * спит между опросами завершения записи страниц.
  * @param address Адрес.
  * @param data Данные.
  * @param size Размер.
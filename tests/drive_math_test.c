@@ -0,0 +1,360 @@
+/**
+ * @file drive_math_test.c Тест и замер математических функций привода.
+ * Проходит область определения каждой функции, выводит
+ * максимальную погрешность относительно вычислений
+ * в double и время вызова.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+#include "drive_math.h"
+
+
+//! Число значений для замера.
+#define BENCH_VALUES_COUNT 4096
+//! Число повторов замера.
+#define BENCH_ROUNDS 2000
+
+//! Допустимая погрешность арксинуса и арккосинуса на всей области, градусы.
+#define ASIN_TOLERANCE 1.3
+//! Допустимая погрешность арксинуса и арккосинуса при |x| <= 0.99, градусы.
+#define ASIN_TOLERANCE_099 0.05
+//! Допустимая погрешность интерполяции, единицы младшего разряда.
+#define LERP_TOLERANCE 2.0
+//! Допустимая погрешность корня числа с фиксированной запятой, единицы младшего разряда.
+#define SQRTF_TOLERANCE 256.0
+
+//! Число ошибок.
+static int failures = 0;
+
+//! Значения для замера.
+static uint32_t bench_values[BENCH_VALUES_COUNT];
+
+//! Состояние генератора псевдослучайных чисел.
+static uint32_t rand_seed = 1;
+
+
+
+/**
+ * Получает текущее время.
+ * @return Время в наносекундах.
+ */
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * Получает псевдослучайное число.
+ * @return Число.
+ */
+static uint32_t rand_next(void)
+{
+    rand_seed = rand_seed * 1103515245 + 12345;
+    return rand_seed;
+}
+
+/**
+ * Проверяет погрешность.
+ * @param name Имя функции.
+ * @param err Максимальная погрешность.
+ * @param tolerance Допустимая погрешность.
+ */
+static void check_error(const char* name, double err, double tolerance)
+{
+    printf("%s: max error %f\n", name, err);
+    
+    if(err > tolerance){
+        printf("FAIL %s: max error %f, tolerance %f\n", name, err, tolerance);
+        failures ++;
+    }
+}
+
+/**
+ * Получает разность углов с учётом перехода через 360 градусов.
+ * @param a Угол А в градусах.
+ * @param b Угол Б в градусах.
+ * @return Разность в градусах.
+ */
+static double angle_diff(double a, double b)
+{
+    double diff = fabs(a - b);
+    if(diff > 180.0) diff = 360.0 - diff;
+    return diff;
+}
+
+//! Арксинус и арккосинус.
+static void test_asin_acos(void)
+{
+    double err_asin = 0.0, err_asin_099 = 0.0;
+    double err_acos = 0.0, err_acos_099 = 0.0;
+    double x, expected, err;
+    int32_t value;
+    
+    // Вся область определения с шагом младшего разряда.
+    for(value = -0x10000; value <= 0x10000; value ++){
+        x = value / 65536.0;
+        
+        expected = asin(x) * 180.0 / M_PI;
+        if(expected < 0.0) expected += 360.0;
+        err = angle_diff(fixed32_asin(value) / 65536.0, expected);
+        if(err > err_asin) err_asin = err;
+        if(fabs(x) <= 0.99 && err > err_asin_099) err_asin_099 = err;
+        
+        expected = acos(x) * 180.0 / M_PI;
+        err = angle_diff(fixed32_acos(value) / 65536.0, expected);
+        if(err > err_acos) err_acos = err;
+        if(fabs(x) <= 0.99 && err > err_acos_099) err_acos_099 = err;
+    }
+    
+    check_error("fixed32_asin, deg", err_asin, ASIN_TOLERANCE);
+    check_error("fixed32_asin |x| <= 0.99, deg", err_asin_099, ASIN_TOLERANCE_099);
+    check_error("fixed32_acos, deg", err_acos, ASIN_TOLERANCE);
+    check_error("fixed32_acos |x| <= 0.99, deg", err_acos_099, ASIN_TOLERANCE_099);
+}
+
+//! Линейная интерполяция.
+static void test_lerp(void)
+{
+    double err_max = 0.0, expected, err;
+    fixed32_t a, b, t;
+    int i;
+    
+    for(i = 0; i < 1000000; i ++){
+        a = (fixed32_t)(rand_next() >> 8) - 0x800000;
+        b = (fixed32_t)(rand_next() >> 8) - 0x800000;
+        t = (fixed32_t)(rand_next() % 0x10001);
+        
+        expected = a + ((double)b - a) * t / 65536.0;
+        err = fabs(fixed32_lerp(a, b, t) - expected);
+        if(err > err_max) err_max = err;
+    }
+    
+    check_error("fixed32_lerp, lsb", err_max, LERP_TOLERANCE);
+}
+
+/**
+ * Вычисляет квадратный корень побитовым методом.
+ * Прежняя реализация bsqrti.
+ * @param value Значение.
+ * @return Целая часть корня.
+ */
+static uint32_t ref_sqrti(uint32_t value)
+{
+    uint32_t rem = 0;
+    uint32_t root = 0;
+    uint32_t i = 0;
+    for(; i < 16; i ++){
+        root <<= 1;
+        rem = ((rem << 2) + (value >> 30));
+        value <<= 2;
+        root ++;
+        if(root <= rem){
+            rem -= root;
+            root ++;
+        }else{
+            root --;
+        }
+    }
+    return root >> 1;
+}
+
+/**
+ * Проверяет корень значения.
+ * @param value Значение.
+ */
+static void check_sqrti(uint32_t value)
+{
+    uint32_t root = bsqrti(value);
+    uint32_t expected = ref_sqrti(value);
+    
+    if(root != expected){
+        printf("FAIL bsqrti(%u): %u, expected %u\n", value, root, expected);
+        failures ++;
+    }
+}
+
+//! Корень целого числа.
+static void test_sqrti(void)
+{
+    uint64_t value;
+    uint32_t root;
+    
+    for(value = 0; value < (1UL << 24) && failures == 0; value ++){
+        check_sqrti((uint32_t)value);
+    }
+    
+    for(value = 1UL << 24; value <= 0xffffffff && failures == 0; value += 251){
+        check_sqrti((uint32_t)value);
+    }
+    check_sqrti(0xffffffff);
+    
+    for(root = 1; root <= 0xffff && failures == 0; root ++){
+        check_sqrti(root * root - 1);
+        check_sqrti(root * root);
+        if(root != 0xffff) check_sqrti(root * root + 1);
+    }
+}
+
+//! Корень числа с фиксированной запятой.
+static void test_sqrtf(void)
+{
+    uint32_t value;
+    
+    for(value = 0; value < 0x7fff0000; value += 97){
+        if(bsqrtf((fixed32_t)value) != (fixed32_t)(ref_sqrti(value) << 8)){
+            printf("FAIL bsqrtf(0x%x)\n", value);
+            failures ++;
+            return;
+        }
+    }
+}
+
+//! Погрешность корня числа с фиксированной запятой.
+static void test_sqrtf_error(void)
+{
+    double err_max = 0.0, err;
+    uint32_t value;
+    
+    for(value = 0; value < 0x7fff0000; value += 97){
+        err = fabs(bsqrtf((fixed32_t)value) - sqrt(value / 65536.0) * 65536.0);
+        if(err > err_max) err_max = err;
+    }
+    
+    check_error("bsqrtf, lsb", err_max, SQRTF_TOLERANCE);
+}
+
+/**
+ * Замеряет время вычисления корня.
+ * @param name Имя функции.
+ * @param sqrt_func Функция.
+ */
+static void bench_sqrt(const char* name, uint32_t (*sqrt_func)(uint32_t))
+{
+    volatile uint32_t sink = 0;
+    uint32_t sum = 0;
+    double t;
+    int round;
+    size_t i;
+    
+    t = now_ns();
+    for(round = 0; round < BENCH_ROUNDS; round ++){
+        for(i = 0; i < BENCH_VALUES_COUNT; i ++){
+            sum += sqrt_func(bench_values[i]);
+        }
+    }
+    t = now_ns() - t;
+    sink = sum;
+    (void)sink;
+    
+    printf("%s: %.1f ns/call\n", name, t / ((double)BENCH_ROUNDS * BENCH_VALUES_COUNT));
+}
+
+/**
+ * Замеряет время вычисления функции числа с фиксированной запятой.
+ * @param name Имя функции.
+ * @param func Функция.
+ */
+static void bench_fixed(const char* name, fixed32_t (*func)(fixed32_t))
+{
+    volatile fixed32_t sink = 0;
+    fixed32_t sum = 0;
+    double t;
+    int round;
+    size_t i;
+    
+    t = now_ns();
+    for(round = 0; round < BENCH_ROUNDS; round ++){
+        for(i = 0; i < BENCH_VALUES_COUNT; i ++){
+            sum += func((fixed32_t)bench_values[i]);
+        }
+    }
+    t = now_ns() - t;
+    sink = sum;
+    (void)sink;
+    
+    printf("%s: %.1f ns/call\n", name, t / ((double)BENCH_ROUNDS * BENCH_VALUES_COUNT));
+}
+
+//! Замер линейной интерполяции.
+static void bench_lerp(void)
+{
+    volatile fixed32_t sink = 0;
+    fixed32_t sum = 0;
+    double t;
+    int round;
+    size_t i;
+    
+    t = now_ns();
+    for(round = 0; round < BENCH_ROUNDS; round ++){
+        for(i = 0; i < BENCH_VALUES_COUNT; i ++){
+            sum += fixed32_lerp(sum, (fixed32_t)bench_values[i], (fixed32_t)(bench_values[i] & 0xffff));
+        }
+    }
+    t = now_ns() - t;
+    sink = sum;
+    (void)sink;
+    
+    printf("fixed32_lerp: %.1f ns/call\n", t / ((double)BENCH_ROUNDS * BENCH_VALUES_COUNT));
+}
+
+//! Замер арксинуса и арккосинуса.
+static void bench_asin_acos(void)
+{
+    size_t i;
+    
+    // Значения от -1 до 1.
+    for(i = 0; i < BENCH_VALUES_COUNT; i ++){
+        bench_values[i] = (uint32_t)((fixed32_t)(rand_next() % 0x20001) - 0x10000);
+    }
+    
+    bench_fixed("fixed32_asin", fixed32_asin);
+    bench_fixed("fixed32_acos", fixed32_acos);
+    bench_lerp();
+}
+
+//! Замер корня целого числа.
+static void bench_sqrti(void)
+{
+    uint32_t value;
+    size_t i;
+    
+    // Значения, характерные для сумм квадратов отсчётов АЦП.
+    for(i = 0; i < BENCH_VALUES_COUNT; i ++){
+        value = rand_next();
+        bench_values[i] = value >> (value & 0xf);
+    }
+    
+    bench_sqrt("bsqrti", bsqrti);
+    bench_sqrt("bit-by-bit sqrt", ref_sqrti);
+    
+    for(i = 0; i < BENCH_VALUES_COUNT; i ++){
+        bench_values[i] &= 0x7fffffff;
+    }
+    
+    bench_fixed("bsqrtf", bsqrtf);
+}
+
+int main(void)
+{
+    test_sqrti();
+    test_sqrtf();
+    test_sqrtf_error();
+    test_asin_acos();
+    test_lerp();
+    bench_sqrti();
+    bench_asin_acos();
+    
+    if(failures){
+        printf("drive_math: %d failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    
+    printf("drive_math: ok\n");
+    
+    return EXIT_SUCCESS;
+}
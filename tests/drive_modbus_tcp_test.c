@@ -0,0 +1,431 @@
+/**
+ * @file drive_modbus_tcp_test.c Тест обработки кадров Modbus TCP.
+ * Обработчики запросов привода заменены моделью регистров,
+ * соединения моделируются буферами приёма с разбиением потока.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "drive_modbus_tcp.h"
+#include "drive_modbus.h"
+
+
+//! Число регистров хранения модели.
+#define HOLD_REGS_COUNT 16
+//! Число флагов модели.
+#define COILS_COUNT 16
+//! Пользовательская функция модели.
+#define CUSTOM_FUNC 0x42
+
+//! Число ошибок.
+static int failures = 0;
+
+//! Регистры хранения модели.
+static uint16_t hold_regs[HOLD_REGS_COUNT];
+//! Флаги модели.
+static modbus_rtu_coil_value_t coils[COILS_COUNT];
+//! Число начатых запросов.
+static int requests = 0;
+
+
+// Модель обработчиков запросов привода.
+
+static modbus_rtu_error_t model_read_coil(uint16_t address, modbus_rtu_coil_value_t* value)
+{
+    if(address >= COILS_COUNT) return MODBUS_RTU_ERROR_INVALID_ADDRESS;
+    *value = coils[address];
+    return MODBUS_RTU_ERROR_NONE;
+}
+
+static modbus_rtu_error_t model_read_din(uint16_t address, modbus_rtu_din_value_t* value)
+{
+    if(address >= COILS_COUNT) return MODBUS_RTU_ERROR_INVALID_ADDRESS;
+    *value = (address & 0x1);
+    return MODBUS_RTU_ERROR_NONE;
+}
+
+static modbus_rtu_error_t model_read_hold_reg(uint16_t address, uint16_t* value)
+{
+    if(address >= HOLD_REGS_COUNT) return MODBUS_RTU_ERROR_INVALID_ADDRESS;
+    *value = hold_regs[address];
+    return MODBUS_RTU_ERROR_NONE;
+}
+
+static modbus_rtu_error_t model_read_inp_reg(uint16_t address, uint16_t* value)
+{
+    if(address >= HOLD_REGS_COUNT) return MODBUS_RTU_ERROR_INVALID_ADDRESS;
+    *value = 0x1000 + address;
+    return MODBUS_RTU_ERROR_NONE;
+}
+
+static modbus_rtu_error_t model_write_coil(uint16_t address, modbus_rtu_coil_value_t value)
+{
+    if(address >= COILS_COUNT) return MODBUS_RTU_ERROR_INVALID_ADDRESS;
+    coils[address] = value;
+    return MODBUS_RTU_ERROR_NONE;
+}
+
+static modbus_rtu_error_t model_write_reg(uint16_t address, uint16_t value)
+{
+    if(address >= HOLD_REGS_COUNT) return MODBUS_RTU_ERROR_INVALID_ADDRESS;
+    hold_regs[address] = value;
+    return MODBUS_RTU_ERROR_NONE;
+}
+
+static modbus_rtu_error_t model_report_slave_id(modbus_rtu_slave_id_t* slave_id)
+{
+    static const char data[] = "DRIVE";
+    
+    slave_id->id = 0x10;
+    slave_id->status = MODBUS_RTU_RUN_STATUS_ON;
+    slave_id->data = data;
+    slave_id->data_size = sizeof(data) - 1;
+    
+    return MODBUS_RTU_ERROR_NONE;
+}
+
+static modbus_rtu_error_t model_custom_func(modbus_rtu_func_t func, const void* rx_data, size_t rx_size, void* tx_data, size_t* tx_size)
+{
+    if(func != CUSTOM_FUNC) return MODBUS_RTU_ERROR_FUNC;
+    
+    // Ответ - данные запроса в обратном порядке.
+    const uint8_t* rx = rx_data;
+    uint8_t* tx = tx_data;
+    size_t i;
+    for(i = 0; i < rx_size; i ++){
+        tx[i] = rx[rx_size - 1 - i];
+    }
+    *tx_size = rx_size;
+    
+    return MODBUS_RTU_ERROR_NONE;
+}
+
+//! Обработчики модели.
+static const drive_modbus_handlers_t model_handlers = {
+    .read_coil = model_read_coil,
+    .read_din = model_read_din,
+    .read_hold_reg = model_read_hold_reg,
+    .read_inp_reg = model_read_inp_reg,
+    .write_coil = model_write_coil,
+    .write_reg = model_write_reg,
+    .report_slave_id = model_report_slave_id,
+    .read_file_record = NULL,
+    .write_file_record = NULL,
+    .custom_func = model_custom_func
+};
+
+const drive_modbus_handlers_t* drive_modbus_handlers(void)
+{
+    return &model_handlers;
+}
+
+void drive_modbus_begin_request(void)
+{
+    requests ++;
+}
+
+
+/**
+ * Собирает кадр запроса.
+ * @param adu Буфер кадра.
+ * @param transaction Идентификатор транзакции.
+ * @param pdu PDU запроса.
+ * @param pdu_size Размер PDU.
+ * @return Размер кадра.
+ */
+static size_t make_adu(uint8_t* adu, uint16_t transaction, const uint8_t* pdu, size_t pdu_size)
+{
+    adu[0] = transaction >> 8;
+    adu[1] = transaction & 0xff;
+    adu[2] = 0;
+    adu[3] = 0;
+    adu[4] = (uint8_t)((pdu_size + 1) >> 8);
+    adu[5] = (uint8_t)((pdu_size + 1) & 0xff);
+    adu[6] = 1;
+    memcpy(&adu[DRIVE_MODBUS_TCP_MBAP_SIZE], pdu, pdu_size);
+    
+    return DRIVE_MODBUS_TCP_MBAP_SIZE + pdu_size;
+}
+
+/**
+ * Обрабатывает запрос и сверяет PDU ответа.
+ * @param name Имя проверки.
+ * @param pdu PDU запроса.
+ * @param pdu_size Размер PDU запроса.
+ * @param expected Ожидаемый PDU ответа.
+ * @param expected_size Размер ожидаемого PDU ответа.
+ */
+static void check_request(const char* name, const uint8_t* pdu, size_t pdu_size,
+                          const uint8_t* expected, size_t expected_size)
+{
+    uint8_t rx[DRIVE_MODBUS_TCP_ADU_SIZE_MAX];
+    uint8_t tx[DRIVE_MODBUS_TCP_ADU_SIZE_MAX];
+    size_t tx_size = 0;
+    
+    size_t rx_size = make_adu(rx, 0x1234, pdu, pdu_size);
+    
+    err_t err = drive_modbus_tcp_process(rx, rx_size, tx, &tx_size);
+    
+    if(err != E_NO_ERROR){
+        printf("FAIL %s: error %d\n", name, (int)err);
+        failures ++;
+        return;
+    }
+    
+    // Заголовок ответа: транзакция, протокол и устройство запроса, длина ответа.
+    if(tx_size != DRIVE_MODBUS_TCP_MBAP_SIZE + expected_size ||
+       memcmp(tx, rx, 4) != 0 || tx[6] != rx[6] ||
+       ((tx[4] << 8) | tx[5]) != (int)(expected_size + 1)){
+        printf("FAIL %s: bad MBAP, size %u\n", name, (unsigned)tx_size);
+        failures ++;
+        return;
+    }
+    
+    if(memcmp(&tx[DRIVE_MODBUS_TCP_MBAP_SIZE], expected, expected_size) != 0){
+        printf("FAIL %s: bad PDU\n", name);
+        failures ++;
+    }
+}
+
+//! Чтение и запись регистров хранения.
+static void test_regs(void)
+{
+    static const uint8_t write_req[] = {0x10, 0x00, 0x02, 0x00, 0x02, 0x04, 0xbe, 0xef, 0x12, 0x34};
+    static const uint8_t write_resp[] = {0x10, 0x00, 0x02, 0x00, 0x02};
+    static const uint8_t read_req[] = {0x03, 0x00, 0x01, 0x00, 0x03};
+    static const uint8_t read_resp[] = {0x03, 0x06, 0x00, 0x00, 0xbe, 0xef, 0x12, 0x34};
+    static const uint8_t write1_req[] = {0x06, 0x00, 0x01, 0x55, 0xaa};
+    static const uint8_t inp_req[] = {0x04, 0x00, 0x0f, 0x00, 0x01};
+    static const uint8_t inp_resp[] = {0x04, 0x02, 0x10, 0x0f};
+    
+    memset(hold_regs, 0x0, sizeof(hold_regs));
+    
+    check_request("write regs", write_req, sizeof(write_req), write_resp, sizeof(write_resp));
+    check_request("read regs", read_req, sizeof(read_req), read_resp, sizeof(read_resp));
+    check_request("write reg", write1_req, sizeof(write1_req), write1_req, sizeof(write1_req));
+    
+    if(hold_regs[1] != 0x55aa){
+        printf("FAIL write reg: value %04x\n", hold_regs[1]);
+        failures ++;
+    }
+    
+    check_request("read inp regs", inp_req, sizeof(inp_req), inp_resp, sizeof(inp_resp));
+}
+
+//! Чтение и запись флагов.
+static void test_bits(void)
+{
+    static const uint8_t write_req[] = {0x0f, 0x00, 0x00, 0x00, 0x0a, 0x02, 0x05, 0x02};
+    static const uint8_t write_resp[] = {0x0f, 0x00, 0x00, 0x00, 0x0a};
+    static const uint8_t read_req[] = {0x01, 0x00, 0x00, 0x00, 0x0a};
+    static const uint8_t read_resp[] = {0x01, 0x02, 0x05, 0x02};
+    static const uint8_t coil_req[] = {0x05, 0x00, 0x03, 0xff, 0x00};
+    static const uint8_t bad_coil_req[] = {0x05, 0x00, 0x03, 0x12, 0x34};
+    static const uint8_t bad_coil_resp[] = {0x85, 0x03};
+    static const uint8_t din_req[] = {0x02, 0x00, 0x00, 0x00, 0x04};
+    static const uint8_t din_resp[] = {0x02, 0x01, 0x0a};
+    
+    memset(coils, 0x0, sizeof(coils));
+    
+    check_request("write coils", write_req, sizeof(write_req), write_resp, sizeof(write_resp));
+    check_request("read coils", read_req, sizeof(read_req), read_resp, sizeof(read_resp));
+    check_request("write coil", coil_req, sizeof(coil_req), coil_req, sizeof(coil_req));
+    
+    if(coils[3] != MODBUS_RTU_COIL_ON){
+        printf("FAIL write coil: coil is off\n");
+        failures ++;
+    }
+    
+    check_request("bad coil value", bad_coil_req, sizeof(bad_coil_req), bad_coil_resp, sizeof(bad_coil_resp));
+    check_request("read dins", din_req, sizeof(din_req), din_resp, sizeof(din_resp));
+}
+
+//! Исключения.
+static void test_exceptions(void)
+{
+    static const uint8_t addr_req[] = {0x03, 0x00, 0x0f, 0x00, 0x02};
+    static const uint8_t addr_resp[] = {0x83, 0x02};
+    static const uint8_t count_req[] = {0x03, 0x00, 0x00, 0x00, 0x7e};
+    static const uint8_t count_resp[] = {0x83, 0x03};
+    static const uint8_t size_req[] = {0x03, 0x00, 0x00, 0x00};
+    static const uint8_t size_resp[] = {0x83, 0x03};
+    static const uint8_t func_req[] = {0x41, 0x00};
+    static const uint8_t func_resp[] = {0xc1, 0x01};
+    static const uint8_t exc_req[] = {0x83};
+    static const uint8_t exc_resp[] = {0x83, 0x01};
+    
+    check_request("illegal address", addr_req, sizeof(addr_req), addr_resp, sizeof(addr_resp));
+    check_request("illegal count", count_req, sizeof(count_req), count_resp, sizeof(count_resp));
+    check_request("short request", size_req, sizeof(size_req), size_resp, sizeof(size_resp));
+    check_request("unknown func", func_req, sizeof(func_req), func_resp, sizeof(func_resp));
+    check_request("exception func", exc_req, sizeof(exc_req), exc_resp, sizeof(exc_resp));
+}
+
+//! Идентификатор устройства и пользовательская функция.
+static void test_slave_id_custom(void)
+{
+    static const uint8_t id_req[] = {0x11};
+    static const uint8_t id_resp[] = {0x11, 0x07, 0x10, 0xff, 'D', 'R', 'I', 'V', 'E'};
+    static const uint8_t custom_req[] = {CUSTOM_FUNC, 0x01, 0x02, 0x03};
+    static const uint8_t custom_resp[] = {CUSTOM_FUNC, 0x03, 0x02, 0x01};
+    
+    check_request("slave id", id_req, sizeof(id_req), id_resp, sizeof(id_resp));
+    check_request("custom func", custom_req, sizeof(custom_req), custom_resp, sizeof(custom_resp));
+}
+
+//! Неверные кадры закрывают соединение.
+static void test_bad_frames(void)
+{
+    static const uint8_t pdu[] = {0x03, 0x00, 0x00, 0x00, 0x01};
+    uint8_t rx[DRIVE_MODBUS_TCP_ADU_SIZE_MAX];
+    uint8_t tx[DRIVE_MODBUS_TCP_ADU_SIZE_MAX];
+    size_t tx_size = 0;
+    size_t rx_size;
+    
+    rx_size = make_adu(rx, 1, pdu, sizeof(pdu));
+    rx[3] = 1;
+    if(drive_modbus_tcp_process(rx, rx_size, tx, &tx_size) != E_INVALID_VALUE){
+        printf("FAIL bad protocol accepted\n");
+        failures ++;
+    }
+    
+    rx_size = make_adu(rx, 1, pdu, sizeof(pdu));
+    if(drive_modbus_tcp_process(rx, rx_size - 1, tx, &tx_size) != E_INVALID_VALUE){
+        printf("FAIL truncated frame accepted\n");
+        failures ++;
+    }
+    
+    if(drive_modbus_tcp_process(rx, DRIVE_MODBUS_TCP_MBAP_SIZE, tx, &tx_size) != E_INVALID_VALUE){
+        printf("FAIL empty PDU accepted\n");
+        failures ++;
+    }
+    
+    if(drive_modbus_tcp_adu_size(rx, DRIVE_MODBUS_TCP_MBAP_SIZE - 1) != 0){
+        printf("FAIL partial MBAP has size\n");
+        failures ++;
+    }
+}
+
+
+//! Число моделируемых соединений.
+#define CONNS_COUNT 3
+
+//! Соединение.
+typedef struct _Conn {
+    uint8_t stream[DRIVE_MODBUS_TCP_ADU_SIZE_MAX * 4]; //!< Данные от клиента.
+    size_t stream_size; //!< Размер данных от клиента.
+    size_t sent; //!< Число переданных серверу байт.
+    uint8_t rx[DRIVE_MODBUS_TCP_ADU_SIZE_MAX]; //!< Буфер приёма сервера.
+    size_t rx_size; //!< Число принятых байт.
+    int responses; //!< Число ответов.
+} conn_t;
+
+/**
+ * Передаёт серверу очередную порцию данных соединения
+ * и обрабатывает принятые полностью кадры.
+ * @param conn Соединение.
+ * @param index Индекс соединения.
+ * @param chunk Размер порции.
+ */
+static void conn_feed(conn_t* conn, int index, size_t chunk)
+{
+    uint8_t tx[DRIVE_MODBUS_TCP_ADU_SIZE_MAX];
+    size_t tx_size = 0;
+    size_t adu_size;
+    
+    chunk = (chunk < conn->stream_size - conn->sent) ? chunk : conn->stream_size - conn->sent;
+    
+    memcpy(&conn->rx[conn->rx_size], &conn->stream[conn->sent], chunk);
+    conn->rx_size += chunk;
+    conn->sent += chunk;
+    
+    for(;;){
+        adu_size = drive_modbus_tcp_adu_size(conn->rx, conn->rx_size);
+        if(adu_size == 0 || adu_size > conn->rx_size) break;
+        
+        if(drive_modbus_tcp_process(conn->rx, adu_size, tx, &tx_size) != E_NO_ERROR){
+            printf("FAIL conn %d: frame rejected\n", index);
+            failures ++;
+            return;
+        }
+        
+        // Ответ на чтение регистра соединения - его номер, транзакция - номер запроса.
+        if(tx[0] != index || tx[1] != conn->responses ||
+           tx_size != DRIVE_MODBUS_TCP_MBAP_SIZE + 4 ||
+           tx[DRIVE_MODBUS_TCP_MBAP_SIZE + 2] != 0 || tx[DRIVE_MODBUS_TCP_MBAP_SIZE + 3] != index){
+            printf("FAIL conn %d: bad response %d\n", index, conn->responses);
+            failures ++;
+        }
+        
+        conn->responses ++;
+        conn->rx_size -= adu_size;
+        memmove(conn->rx, &conn->rx[adu_size], conn->rx_size);
+    }
+}
+
+//! Несколько клиентов с чередующимися и разбитыми на части кадрами.
+static void test_conns(void)
+{
+    static conn_t conns[CONNS_COUNT];
+    static const size_t chunks[] = {1, 3, 7, 2, 12, 5};
+    const int frames = 4;
+    
+    uint8_t pdu[5] = {0x03, 0x00, 0x00, 0x00, 0x01};
+    int i, j;
+    size_t step = 0;
+    bool pending;
+    
+    memset(conns, 0x0, sizeof(conns));
+    
+    for(i = 0; i < CONNS_COUNT; i ++){
+        hold_regs[i] = i;
+        pdu[2] = i;
+        for(j = 0; j < frames; j ++){
+            conns[i].stream_size += make_adu(&conns[i].stream[conns[i].stream_size], (i << 8) | j, pdu, sizeof(pdu));
+        }
+    }
+    
+    do{
+        pending = false;
+        for(i = 0; i < CONNS_COUNT; i ++){
+            if(conns[i].sent == conns[i].stream_size) continue;
+            conn_feed(&conns[i], i, chunks[(step + i) % (sizeof(chunks) / sizeof(chunks[0]))]);
+            pending = true;
+        }
+        step ++;
+    }while(pending);
+    
+    for(i = 0; i < CONNS_COUNT; i ++){
+        if(conns[i].responses != frames || conns[i].rx_size != 0){
+            printf("FAIL conn %d: %d responses\n", i, conns[i].responses);
+            failures ++;
+        }
+    }
+}
+
+int main(void)
+{
+    test_regs();
+    test_bits();
+    test_exceptions();
+    test_slave_id_custom();
+    test_bad_frames();
+    
+    requests = 0;
+    test_conns();
+    
+    if(requests != CONNS_COUNT * 4){
+        printf("FAIL %d requests begun\n", requests);
+        failures ++;
+    }
+    
+    if(failures){
+        printf("drive_modbus_tcp: %d failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    
+    printf("drive_modbus_tcp: ok\n");
+    
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,210 @@
+/**
+ * @file osc_codec_test.c Тест кодека осциллограмм.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "osc_codec.h"
+
+
+//! Число значений канала осциллограммы.
+#define TEST_CHANNEL_LEN 225
+//! Размер канала без сжатия.
+#define TEST_CHANNEL_SIZE (TEST_CHANNEL_LEN * sizeof(int16_t))
+//! Размер буфера сжатых данных.
+#define TEST_BUF_SIZE (TEST_CHANNEL_LEN / OSC_CODEC_BLOCK_LEN + 1 + TEST_CHANNEL_SIZE)
+
+//! Число ошибок.
+static int failures = 0;
+
+//! Состояние генератора псевдослучайных чисел.
+static uint32_t rand_seed = 1;
+
+
+/**
+ * Получает псевдослучайное число.
+ * @return Число.
+ */
+static uint32_t rand_next(void)
+{
+    rand_seed = rand_seed * 1103515245 + 12345;
+    return rand_seed >> 8;
+}
+
+/**
+ * Кодирует и декодирует значения, сравнивает результат.
+ * @param name Имя проверки.
+ * @param values Значения.
+ * @param count Число значений.
+ * @return Размер сжатых данных.
+ */
+static size_t check_round_trip(const char* name, const int16_t* values, size_t count)
+{
+    uint8_t data[TEST_BUF_SIZE];
+    int16_t decoded[TEST_CHANNEL_LEN];
+    
+    size_t size = osc_codec_encode(values, count, data, sizeof(data));
+    
+    if(size == 0){
+        printf("FAIL %s: not encoded\n", name);
+        failures ++;
+        return 0;
+    }
+    
+    memset(decoded, 0x55, sizeof(decoded));
+    
+    if(osc_codec_decode(data, size, decoded, count) != E_NO_ERROR ||
+       memcmp(values, decoded, count * sizeof(int16_t)) != 0){
+        printf("FAIL %s: decoded values differ\n", name);
+        failures ++;
+    }
+    
+    return size;
+}
+
+//! Сжатие каналов разной формы.
+static void test_round_trip(void)
+{
+    int16_t values[TEST_CHANNEL_LEN];
+    size_t size;
+    size_t i;
+    
+    // Синус 64 точки на период с шумом АЦП.
+    for(i = 0; i < TEST_CHANNEL_LEN; i ++){
+        values[i] = (int16_t)(lround(3000.0 * sin(2.0 * M_PI * i / 64.0)) + (int)(rand_next() % 7) - 3);
+    }
+    size = check_round_trip("sine", values, TEST_CHANNEL_LEN);
+    printf("sine: %u of %u bytes\n", (unsigned)size, (unsigned)TEST_CHANNEL_SIZE);
+    
+    memset(values, 0x0, sizeof(values));
+    size = check_round_trip("zero", values, TEST_CHANNEL_LEN);
+    if(size != (TEST_CHANNEL_LEN + OSC_CODEC_BLOCK_LEN - 1) / OSC_CODEC_BLOCK_LEN){
+        printf("FAIL zero: %u bytes\n", (unsigned)size);
+        failures ++;
+    }
+    
+    for(i = 0; i < TEST_CHANNEL_LEN; i ++){
+        values[i] = (int16_t)(i * 37 - 4000);
+    }
+    check_round_trip("ramp", values, TEST_CHANNEL_LEN);
+    
+    // Крайние значения: разности выходят за int16.
+    for(i = 0; i < TEST_CHANNEL_LEN; i ++){
+        values[i] = (i & 1) ? INT16_MIN : INT16_MAX;
+    }
+    check_round_trip("extremes", values, TEST_CHANNEL_LEN);
+    
+    for(i = 0; i < TEST_CHANNEL_LEN; i ++){
+        values[i] = (int16_t)rand_next();
+    }
+    check_round_trip("random", values, TEST_CHANNEL_LEN);
+    
+    // Неполный последний блок.
+    for(i = 1; i <= OSC_CODEC_BLOCK_LEN * 2 + 1; i ++){
+        check_round_trip("partial", values, i);
+    }
+}
+
+//! Поблочное кодирование с сохранением состояния (тренд).
+static void test_blocks(void)
+{
+    int16_t values[TEST_CHANNEL_LEN];
+    int16_t decoded[TEST_CHANNEL_LEN];
+    uint8_t data[TEST_BUF_SIZE];
+    osc_codec_state_t enc_state, dec_state;
+    size_t offset = 0, pos = 0;
+    size_t block_size, n, i;
+    
+    for(i = 0; i < TEST_CHANNEL_LEN; i ++){
+        values[i] = (int16_t)(1000 + i * 3 + (int)(rand_next() % 5));
+    }
+    
+    osc_codec_state_init(&enc_state);
+    for(i = 0; i < TEST_CHANNEL_LEN; i += n){
+        n = (TEST_CHANNEL_LEN - i < 7) ? TEST_CHANNEL_LEN - i : 7;
+        
+        block_size = osc_codec_encode_block(&enc_state, &values[i], n, data + offset);
+        
+        if(osc_codec_block_size(data[offset], n) != block_size){
+            printf("FAIL blocks: block size %u, header size %u\n", (unsigned)block_size,
+                   (unsigned)osc_codec_block_size(data[offset], n));
+            failures ++;
+        }
+        
+        offset += block_size;
+    }
+    
+    osc_codec_state_init(&dec_state);
+    for(i = 0; i < TEST_CHANNEL_LEN; i += n){
+        n = (TEST_CHANNEL_LEN - i < 7) ? TEST_CHANNEL_LEN - i : 7;
+        
+        block_size = osc_codec_decode_block(&dec_state, data + pos, offset - pos, &decoded[i], n);
+        if(block_size == 0){
+            printf("FAIL blocks: block at %u not decoded\n", (unsigned)i);
+            failures ++;
+            return;
+        }
+        
+        pos += block_size;
+    }
+    
+    if(pos != offset || memcmp(values, decoded, sizeof(values)) != 0){
+        printf("FAIL blocks: decoded values differ\n");
+        failures ++;
+    }
+}
+
+//! Ошибки в данных и нехватка места.
+static void test_errors(void)
+{
+    int16_t values[TEST_CHANNEL_LEN];
+    int16_t decoded[TEST_CHANNEL_LEN];
+    uint8_t data[TEST_BUF_SIZE];
+    size_t size, i;
+    
+    for(i = 0; i < TEST_CHANNEL_LEN; i ++){
+        values[i] = (int16_t)rand_next();
+    }
+    
+    if(osc_codec_encode(values, TEST_CHANNEL_LEN, data, TEST_CHANNEL_SIZE) != 0){
+        printf("FAIL errors: random data encoded into raw size\n");
+        failures ++;
+    }
+    
+    size = osc_codec_encode(values, TEST_CHANNEL_LEN, data, sizeof(data));
+    
+    if(osc_codec_decode(data, size - 1, decoded, TEST_CHANNEL_LEN) == E_NO_ERROR){
+        printf("FAIL errors: truncated data decoded\n");
+        failures ++;
+    }
+    
+    // Больше 16 бит на значение.
+    data[0] = 17;
+    if(osc_codec_decode(data, size, decoded, TEST_CHANNEL_LEN) == E_NO_ERROR){
+        printf("FAIL errors: bad block header decoded\n");
+        failures ++;
+    }
+    
+    if(osc_codec_block_size(0x1f, OSC_CODEC_BLOCK_LEN) != 0){
+        printf("FAIL errors: bad block header size\n");
+        failures ++;
+    }
+}
+
+int main(void)
+{
+    test_round_trip();
+    test_blocks();
+    test_errors();
+    
+    if(failures){
+        printf("osc_codec: %d failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    
+    printf("osc_codec: ok\n");
+    
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,178 @@
+/**
+ * @file phase_sync_filter_test.c Тест фильтра углов фаз.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "phase_sync_filter.h"
+#include "cordic/cordic32.h"
+
+
+//! Допустимая погрешность сравнения углов (0.01 градуса).
+#define ANGLE_TOLERANCE (CORDIC32_ANGLE_360 / 36000)
+
+//! Число ошибок.
+static int failures = 0;
+
+/**
+ * Получает угол в формате фильтра.
+ * @param deg Угол в градусах.
+ * @return Угол.
+ */
+static fixed32_t angle_deg(double deg)
+{
+    fixed32_t angle = (fixed32_t)(deg * (CORDIC32_ANGLE_180 / 180.0));
+    
+    while(angle > CORDIC32_ANGLE_180) angle -= CORDIC32_ANGLE_360;
+    while(angle <= -CORDIC32_ANGLE_180) angle += CORDIC32_ANGLE_360;
+    
+    return angle;
+}
+
+/**
+ * Проверяет совпадение углов с учётом перехода через +-180 градусов.
+ * @param name Имя проверки.
+ * @param angle Полученный угол.
+ * @param expected Ожидаемый угол.
+ */
+static void check_angle(const char* name, fixed32_t angle, fixed32_t expected)
+{
+    fixed32_t diff = angle - expected;
+    
+    while(diff > CORDIC32_ANGLE_180) diff -= CORDIC32_ANGLE_360;
+    while(diff <= -CORDIC32_ANGLE_180) diff += CORDIC32_ANGLE_360;
+    
+    if(angle > CORDIC32_ANGLE_180 || angle <= -CORDIC32_ANGLE_180 ||
+       abs(diff) > ANGLE_TOLERANCE){
+        printf("FAIL %s: %f, expected %f\n", name,
+               angle * 180.0 / CORDIC32_ANGLE_180,
+               expected * 180.0 / CORDIC32_ANGLE_180);
+        failures ++;
+    }
+}
+
+/**
+ * Заполняет фильтр углами.
+ * @param filter Фильтр.
+ * @param degs Углы в градусах.
+ * @param count Число углов.
+ */
+static void filter_fill(phase_sync_filter_t* filter, const double* degs, size_t count)
+{
+    size_t i;
+    
+    phase_sync_filter_reset(filter);
+    
+    for(i = 0; i < count; i ++){
+        phase_sync_filter_put(filter, angle_deg(degs[i]));
+    }
+}
+
+//! Отбрасывание выбросов вдали от +-180 градусов.
+static void test_outliers(void)
+{
+    static const double degs[] = {30, 31, 29, 120, 30, -60, 30};
+    phase_sync_filter_t filter;
+    
+    filter_fill(&filter, degs, PHASE_SYNC_FILTER_SIZE);
+    
+    // Отбрасываются 120, 31 и -60, 29.
+    check_angle("outliers", phase_sync_filter_calc(&filter), angle_deg(30));
+}
+
+//! Окно вокруг +-180 градусов.
+static void test_wrap(void)
+{
+    static const double degs[] = {178, -178, 179, -179, 180, -177, 177};
+    phase_sync_filter_t filter;
+    
+    filter_fill(&filter, degs, PHASE_SYNC_FILTER_SIZE);
+    
+    // Без развёртки среднее было бы около 0.
+    check_angle("wrap", phase_sync_filter_calc(&filter), angle_deg(180));
+}
+
+//! Отбрасывание выбросов в окне вокруг +-180 градусов.
+static void test_wrap_outliers(void)
+{
+    static const double degs[] = {-178, 179, 60, -176, 178, -60, -179};
+    phase_sync_filter_t filter;
+    
+    filter_fill(&filter, degs, PHASE_SYNC_FILTER_SIZE);
+    
+    // Развёрнутое окно: -300, -182, -181, -179, -178, -176, -60.
+    // Отбрасываются -300, -182 и -176, -60.
+    check_angle("wrap outliers", phase_sync_filter_calc(&filter), angle_deg(-538.0 / 3));
+}
+
+//! Неполное окно без отбрасывания значений.
+static void test_partial(void)
+{
+    static const double degs[] = {-170, 170, 180};
+    phase_sync_filter_t filter;
+    
+    filter_fill(&filter, degs, 3);
+    
+    check_angle("partial", phase_sync_filter_calc(&filter), angle_deg(180));
+    
+    if(phase_sync_filter_full(&filter)){
+        printf("FAIL partial: filter is full\n");
+        failures ++;
+    }
+}
+
+//! Вращающийся угол, многократно проходящий через +-180 градусов.
+static void test_rotation(void)
+{
+    phase_sync_filter_t filter;
+    int i;
+    
+    phase_sync_filter_reset(&filter);
+    
+    for(i = 0; i < 1000; i ++){
+        phase_sync_filter_put(&filter, angle_deg(i * 7.0));
+        
+        if(!phase_sync_filter_full(&filter)) continue;
+        
+        // Среднее центральных значений равномерного окна - его середина.
+        check_angle("rotation", phase_sync_filter_calc(&filter),
+                    angle_deg((i - PHASE_SYNC_FILTER_SIZE / 2) * 7.0));
+        
+        if(failures) break;
+    }
+}
+
+//! Выброс вытесняется из окна при поступлении новых углов.
+static void test_eviction(void)
+{
+    static const double degs[] = {-179, 179, -179, 179, -179, 179, 0};
+    phase_sync_filter_t filter;
+    int i;
+    
+    filter_fill(&filter, degs, PHASE_SYNC_FILTER_SIZE);
+    
+    for(i = 0; i < PHASE_SYNC_FILTER_SIZE; i ++){
+        phase_sync_filter_put(&filter, angle_deg(-175));
+    }
+    
+    check_angle("eviction", phase_sync_filter_calc(&filter), angle_deg(-175));
+}
+
+int main(void)
+{
+    test_outliers();
+    test_wrap();
+    test_wrap_outliers();
+    test_partial();
+    test_rotation();
+    test_eviction();
+    
+    if(failures){
+        printf("phase_sync_filter: %d failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    
+    printf("phase_sync_filter: ok\n");
+    
+    return EXIT_SUCCESS;
+}
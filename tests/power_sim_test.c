@@ -0,0 +1,262 @@
+/**
+ * @file power_sim_test.c Симулятор измерительного тракта привода.
+ * Модель трёхфазной сети, тиристорного моста и двигателя
+ * постоянного тока формирует кадры АЦП, которые обрабатываются
+ * модулем power так же, как в прошивке: блоками кадров,
+ * с накоплением и вычислением значений раз в период сети.
+ * Проверяет вычисленные значения по модели и выводит
+ * скорость симуляции относительно реального времени.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "power.h"
+
+
+//! Номера каналов.
+#define SIM_Ua 0
+#define SIM_Ub 1
+#define SIM_Uc 2
+#define SIM_Urot 3
+#define SIM_Irot 4
+//! Число каналов.
+#define SIM_CHANNELS_COUNT 5
+//! Маска каналов.
+#define SIM_CHANNELS (POWER_CHANNEL_0 | POWER_CHANNEL_1 | POWER_CHANNEL_2 |\
+                      POWER_CHANNEL_3 | POWER_CHANNEL_4)
+
+//! Число кадров в блоке АЦП.
+#define SIM_BLOCK_FRAMES 8
+//! Число шагов модели на одно измерение АЦП.
+#define SIM_SUBSTEPS 10
+//! Время симуляции, с.
+#define SIM_TIME_S 4.0
+
+//! Ноль АЦП.
+#define SIM_ADC_ZERO 2048
+//! Амплитуда шума АЦП, LSB.
+#define SIM_ADC_NOISE 2
+
+//! Напряжение фазы (RMS), В.
+#define SIM_U_PHASE 220.0
+//! Угол открытия тиристоров, градусы.
+#define SIM_OPEN_ANGLE 60.0
+
+//! Коэффициенты АЦП, единицы на LSB.
+#define SIM_K_U 0.2
+#define SIM_K_Urot 0.3
+#define SIM_K_Irot 0.05
+
+//! Параметры двигателя.
+#define SIM_R 0.5 //!< Сопротивление якоря, Ом.
+#define SIM_L 0.05 //!< Индуктивность якоря, Гн.
+#define SIM_KF 2.0 //!< Постоянная ЭДС и момента, В*с/рад.
+#define SIM_J 0.5 //!< Момент инерции, кг*м^2.
+#define SIM_M_LOAD 20.0 //!< Момент нагрузки, Н*м.
+
+//! Допустимая относительная погрешность каналов переменного тока.
+#define SIM_TOLERANCE_AC 0.01
+//! Допустимая относительная погрешность каналов выпрямленного тока.
+//! Среднее по отсчётам напряжения со скачками коммутации
+//! и медианный фильтр АЦП смещают значение до ~1.5%.
+#define SIM_TOLERANCE_DC 0.02
+
+//! Число ошибок.
+static int failures = 0;
+
+//! Состояние генератора шума.
+static uint32_t noise_seed = 1;
+
+//! Состояние модели двигателя.
+typedef struct _Sim_Motor {
+    double i; //!< Ток якоря, А.
+    double w; //!< Скорость, рад/с.
+} sim_motor_t;
+
+
+/**
+ * Получает значение АЦП.
+ * @param value Значение в единицах канала.
+ * @param k Коэффициент АЦП.
+ * @return Значение АЦП.
+ */
+static uint16_t sim_adc(double value, double k)
+{
+    noise_seed = noise_seed * 1103515245 + 12345;
+    int32_t noise = (int32_t)((noise_seed >> 16) % (2 * SIM_ADC_NOISE + 1)) - SIM_ADC_NOISE;
+    
+    int32_t adc = SIM_ADC_ZERO + (int32_t)lround(value / k) + noise;
+    
+    if(adc < 0) adc = 0;
+    if(adc > 4095) adc = 4095;
+    
+    return (uint16_t)adc;
+}
+
+/**
+ * Получает выходное напряжение моста
+ * при непрерывном токе.
+ * @param theta Фаза сети, рад.
+ * @return Напряжение, В.
+ */
+static double sim_bridge_voltage(double theta)
+{
+    double seg = M_PI / 3.0;
+    double um_ll = SIM_U_PHASE * sqrt(2.0) * sqrt(3.0);
+    double phi = fmod(theta, seg);
+    
+    return um_ll * cos(phi - seg / 2.0 + SIM_OPEN_ANGLE * M_PI / 180.0);
+}
+
+/**
+ * Выполняет шаг модели двигателя.
+ * @param motor Двигатель.
+ * @param u Напряжение якоря, В.
+ * @param dt Шаг, с.
+ */
+static void sim_motor_step(sim_motor_t* motor, double u, double dt)
+{
+    motor->i += (u - SIM_R * motor->i - SIM_KF * motor->w) / SIM_L * dt;
+    // Мост не проводит обратный ток.
+    if(motor->i < 0.0) motor->i = 0.0;
+    
+    motor->w += (SIM_KF * motor->i - SIM_M_LOAD) / SIM_J * dt;
+}
+
+/**
+ * Проверяет значение канала.
+ * @param power Питание.
+ * @param name Имя канала.
+ * @param channel Номер канала.
+ * @param expected Ожидаемое значение.
+ * @param tolerance Допустимая относительная погрешность.
+ */
+static void check_channel(power_t* power, const char* name, size_t channel, double expected, double tolerance)
+{
+    double value = power_channel_real_value(power, channel) / 65536.0;
+    
+    printf("%s: %.2f, model %.2f\n", name, value, expected);
+    
+    if(!power_channel_data_avail(power, channel) ||
+       fabs(value - expected) > fabs(expected) * tolerance){
+        printf("FAIL %s: %f, expected %f\n", name, value, expected);
+        failures ++;
+    }
+}
+
+int main(void)
+{
+    static power_value_t values[SIM_CHANNELS_COUNT];
+    static power_t power;
+    uint16_t adc_values[SIM_BLOCK_FRAMES * SIM_CHANNELS_COUNT];
+    sim_motor_t motor = {0};
+    
+    const double k[SIM_CHANNELS_COUNT] = {SIM_K_U, SIM_K_U, SIM_K_U, SIM_K_Urot, SIM_K_Irot};
+    const double dt = 1.0 / POWER_ADC_FREQ;
+    const double w_mains = 2.0 * M_PI * POWER_FREQ;
+    
+    size_t frames_total = (size_t)(SIM_TIME_S * POWER_ADC_FREQ);
+    size_t frame, block_frame, i, s;
+    
+    double t = 0.0, ud = 0.0;
+    double ud_sum = 0.0, i_sum = 0.0;
+    double ud_mean = 0.0, i_mean = 0.0;
+    size_t period_frames = 0;
+    double host_ns;
+    struct timespec ts_begin, ts_end;
+    
+    for(i = 0; i < SIM_CHANNELS_COUNT; i ++){
+        power_value_init(&values[i], (i <= SIM_Uc) ? POWER_CHANNEL_AC : POWER_CHANNEL_DC,
+                         (i <= SIM_Uc) ? POWER_PERIOD_ITERS : 1, fixed32_make_from_fract((int32_t)(k[i] * 10000), 10000));
+    }
+    power_init(&power, values, SIM_CHANNELS_COUNT);
+    for(i = 0; i < SIM_CHANNELS_COUNT; i ++){
+        power_set_value_multiplier(&power, i, fixed32_make_from_int(1));
+    }
+    
+    // Калибровка нуля при отключенном питании.
+    for(frame = 0; frame < POWER_ADC_MEASUREMENTS_PER_PERIOD * POWER_PERIOD_ITERS; frame ++){
+        for(i = 0; i < SIM_CHANNELS_COUNT; i ++){
+            adc_values[i] = sim_adc(0.0, k[i]);
+        }
+        power_process_adc_values(&power, SIM_CHANNELS, adc_values);
+        
+        if((frame + 1) % POWER_ADC_MEASUREMENTS_PER_PERIOD == 0){
+            power_process_accumulated_data(&power, SIM_CHANNELS);
+            power_calc_values(&power, SIM_CHANNELS);
+        }
+    }
+    power_calibrate(&power, SIM_CHANNELS);
+    power_reset_channels(&power, SIM_CHANNELS);
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts_begin);
+    
+    for(frame = 0; frame < frames_total; frame += SIM_BLOCK_FRAMES){
+        
+        for(block_frame = 0; block_frame < SIM_BLOCK_FRAMES; block_frame ++){
+            
+            uint16_t* adc_frame = &adc_values[block_frame * SIM_CHANNELS_COUNT];
+            
+            adc_frame[SIM_Ua] = sim_adc(SIM_U_PHASE * sqrt(2.0) * sin(w_mains * t), SIM_K_U);
+            adc_frame[SIM_Ub] = sim_adc(SIM_U_PHASE * sqrt(2.0) * sin(w_mains * t - 2.0 * M_PI / 3.0), SIM_K_U);
+            adc_frame[SIM_Uc] = sim_adc(SIM_U_PHASE * sqrt(2.0) * sin(w_mains * t + 2.0 * M_PI / 3.0), SIM_K_U);
+            adc_frame[SIM_Urot] = sim_adc(ud, SIM_K_Urot);
+            adc_frame[SIM_Irot] = sim_adc(motor.i, SIM_K_Irot);
+            
+            for(s = 0; s < SIM_SUBSTEPS; s ++){
+                ud = sim_bridge_voltage(w_mains * t);
+                sim_motor_step(&motor, ud, dt / SIM_SUBSTEPS);
+                t += dt / SIM_SUBSTEPS;
+                
+                // Средние значения модели за период.
+                ud_sum += ud / SIM_SUBSTEPS;
+                i_sum += motor.i / SIM_SUBSTEPS;
+            }
+            
+            if(++ period_frames == POWER_ADC_MEASUREMENTS_PER_PERIOD){
+                ud_mean = ud_sum / period_frames;
+                i_mean = i_sum / period_frames;
+                ud_sum = 0.0;
+                i_sum = 0.0;
+                period_frames = 0;
+            }
+        }
+        
+        power_process_adc_values_block(&power, SIM_CHANNELS, adc_values, SIM_BLOCK_FRAMES);
+        
+        if(period_frames == 0){
+            power_process_accumulated_data(&power, SIM_CHANNELS);
+            power_calc_values(&power, SIM_CHANNELS);
+        }
+    }
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts_end);
+    host_ns = (ts_end.tv_sec - ts_begin.tv_sec) * 1e9 + (ts_end.tv_nsec - ts_begin.tv_nsec);
+    
+    check_channel(&power, "Ua", SIM_Ua, SIM_U_PHASE, SIM_TOLERANCE_AC);
+    check_channel(&power, "Ub", SIM_Ub, SIM_U_PHASE, SIM_TOLERANCE_AC);
+    check_channel(&power, "Uc", SIM_Uc, SIM_U_PHASE, SIM_TOLERANCE_AC);
+    check_channel(&power, "Urot", SIM_Urot, ud_mean, SIM_TOLERANCE_DC);
+    check_channel(&power, "Irot", SIM_Irot, i_mean, SIM_TOLERANCE_DC);
+    
+    // Установившийся режим: ток задан нагрузкой.
+    if(fabs(i_mean - SIM_M_LOAD / SIM_KF) > SIM_M_LOAD / SIM_KF * SIM_TOLERANCE_DC){
+        printf("FAIL motor current %f, expected %f\n", i_mean, SIM_M_LOAD / SIM_KF);
+        failures ++;
+    }
+    
+    printf("simulated %.1f s in %.1f ms, x%.0f real time, %.0f ns/frame\n",
+           SIM_TIME_S, host_ns / 1e6, SIM_TIME_S * 1e9 / host_ns, host_ns / frames_total);
+    
+    if(failures){
+        printf("power_sim: %d failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    
+    printf("power_sim: ok\n");
+    
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,189 @@
+/**
+ * @file settings_id_table_test.c Тест и замер таблицы поиска параметров.
+ * Проверяет таблицу дескрипторов параметров прошивки:
+ * упорядоченность идентификаторов, PARAMETERS_ID_MAX
+ * и число реальных и виртуальных параметров.
+ * Сравнивает поиск по таблице с двоичным поиском
+ * на чтении 125 регистров хранения одним запросом Modbus.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "ramp.h"
+#include "drive_regulator.h"
+
+// Значения из заголовков, зависящих от периферии,
+// на идентификаторы параметров не влияют.
+#define PHASE_A 1
+#define PHASE_C 3
+#define DRIVE_TRIACS_EXC_FIXED 0
+#define DRIVE_TRIACS_EXC_REGULATED 1
+#define DRIVE_TRIACS_EXC_FIXED_PULSE 2
+#define GUI_HOME_TILES_COUNT 4
+#define GUI_TILE_TYPES_MIN 0
+#define GUI_TILE_TYPES_MAX 1
+
+#define NEED_DESCRS
+#include "parameters_list.h"
+#include "settings_id_table.h"
+
+
+//! Число регистров в запросе чтения.
+#define BENCH_REGS_COUNT 125
+//! Число повторов замера.
+#define BENCH_ROUNDS 200
+
+//! Число ошибок.
+static int failures = 0;
+
+//! Таблица поиска.
+static settings_id_table_t table;
+
+
+/**
+ * Ищет индекс параметра двоичным поиском по дескрипторам.
+ * @param id Идентификатор параметра.
+ * @param index Индекс параметра.
+ * @return Флаг наличия параметра.
+ */
+static bool bsearch_index(param_id_t id, size_t* index)
+{
+    size_t first = 0;
+    size_t last = PARAMETERS_COUNT;
+    size_t mid;
+    
+    while(first < last){
+        mid = (first + last) / 2;
+        
+        if(parameters_descrs[mid].id == id){
+            *index = mid;
+            return true;
+        }
+        
+        if(parameters_descrs[mid].id < id) first = mid + 1;
+        else last = mid;
+    }
+    
+    return false;
+}
+
+/**
+ * Получает текущее время.
+ * @return Время в наносекундах.
+ */
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+//! Таблица дескрипторов прошивки.
+static void test_descrs(void)
+{
+    size_t real = 0;
+    size_t virt = 0;
+    err_t err;
+    size_t i;
+    
+    settings_id_table_reset(&table);
+    
+    for(i = 0; i < PARAMETERS_COUNT; i ++){
+        err = settings_id_table_append(&table, parameters_descrs[i].id);
+        if(err != E_NO_ERROR){
+            printf("FAIL descrs: param %u at index %u: error %d\n",
+                   (unsigned)parameters_descrs[i].id, (unsigned)i, (int)err);
+            failures ++;
+        }
+        
+        if(parameters_descrs[i].flags & PARAM_FLAG_VIRTUAL) virt ++;
+        else real ++;
+    }
+    
+    if(real != PARAMETERS_REAL_COUNT || virt != PARAMETERS_VIRT_COUNT){
+        printf("FAIL descrs: %u real, %u virtual params\n", (unsigned)real, (unsigned)virt);
+        failures ++;
+    }
+    
+    // Запас идентификаторов - не более блока таблицы поиска.
+    if(PARAMETERS_ID_MAX - parameters_descrs[PARAMETERS_COUNT - 1].id >= SETTINGS_ID_TABLE_BLOCK_LEN * 2){
+        printf("FAIL descrs: PARAMETERS_ID_MAX %u is far above the last id %u\n",
+               (unsigned)PARAMETERS_ID_MAX, (unsigned)parameters_descrs[PARAMETERS_COUNT - 1].id);
+        failures ++;
+    }
+}
+
+//! Поиск всех идентификаторов.
+static void test_find(void)
+{
+    size_t index = 0;
+    size_t expected = 0;
+    bool found;
+    bool expected_found;
+    unsigned id;
+    
+    for(id = 0; id <= 0xffff; id ++){
+        found = settings_id_table_find(&table, (param_id_t)id, &index);
+        expected_found = bsearch_index((param_id_t)id, &expected);
+        
+        if(found != expected_found || (found && index != expected)){
+            printf("FAIL find %u: %d %u, expected %d %u\n", id,
+                   found, (unsigned)index, expected_found, (unsigned)expected);
+            failures ++;
+            return;
+        }
+    }
+}
+
+//! Замер чтения регистров хранения.
+static void bench_bulk_read(void)
+{
+    volatile size_t sink = 0;
+    size_t index = 0;
+    size_t lookups = 0;
+    double t_table, t_bsearch, t;
+    int round;
+    size_t i, j;
+    
+    t = now_ns();
+    for(round = 0; round < BENCH_ROUNDS; round ++){
+        for(i = 0; i < PARAMETERS_COUNT; i ++){
+            for(j = 0; j < BENCH_REGS_COUNT; j ++){
+                if(settings_id_table_find(&table, parameters_descrs[i].id + j, &index)) sink += index;
+            }
+        }
+    }
+    t_table = now_ns() - t;
+    
+    t = now_ns();
+    for(round = 0; round < BENCH_ROUNDS; round ++){
+        for(i = 0; i < PARAMETERS_COUNT; i ++){
+            for(j = 0; j < BENCH_REGS_COUNT; j ++){
+                if(bsearch_index(parameters_descrs[i].id + j, &index)) sink += index;
+            }
+        }
+    }
+    t_bsearch = now_ns() - t;
+    
+    lookups = (size_t)BENCH_ROUNDS * PARAMETERS_COUNT;
+    
+    printf("read %d regs: table %.0f ns, bsearch %.0f ns per request\n",
+           BENCH_REGS_COUNT, t_table / lookups, t_bsearch / lookups);
+}
+
+int main(void)
+{
+    test_descrs();
+    test_find();
+    bench_bulk_read();
+    
+    if(failures){
+        printf("settings_id_table: %d failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    
+    printf("settings_id_table: ok\n");
+    
+    return EXIT_SUCCESS;
+}
@@ -203,6 +203,19 @@ TEXT_TR(TR_ID_MENU_PHASES_ANGLES_PROT, "Phases angles")
 TEXT_TR(TR_ID_MENU_PHASES_SYNC_PROT, "Phases sync")
 TEXT_TR(TR_ID_MENU_ROT_BREAK_PROT, "Rotor break")
 TEXT_TR(TR_ID_MENU_HEATSINK_TEMP_PROT, "Heatsink overtemp")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOWS, "Sliding window")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOW_Ua, "Window Ua")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOW_Ub, "Window Ub")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOW_Uc, "Window Uc")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOW_Urot, "Window Urot")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOW_Ia, "Window Ia")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOW_Ib, "Window Ib")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOW_Ic, "Window Ic")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOW_Irot, "Window Irot")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOW_Iexc, "Window Iexc")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOW_Iref, "Window Iref")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOW_Ifan, "Window Ifan")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOW_Erot, "Window Erot")
 //TEXT_TR(TR_ID_MENU_, "")
 //TEXT_TR(TR_ID_ENUM_, "")
 //TEXT_TR(TR_ID_, "")
@@ -229,6 +229,19 @@ TEXT_TR(TR_ID_MENU_CMD_CLEAR_EVENTS, "Очистить историю событ
 TEXT_TR(TR_ID_MENU_STATUS, "Статус привода")
 TEXT_TR(TR_ID_MENU_EVENTS, "История событий")
 TEXT_TR(TR_ID_MENU_MEASUREMENTS, "Измерения") 
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOWS, "Скользящее окно")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOW_Ua, "Окно Ua")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOW_Ub, "Окно Ub")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOW_Uc, "Окно Uc")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOW_Urot, "Окно Urot")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOW_Ia, "Окно Ia")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOW_Ib, "Окно Ib")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOW_Ic, "Окно Ic")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOW_Irot, "Окно Irot")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOW_Iexc, "Окно Iexc")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOW_Iref, "Окно Iref")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOW_Ifan, "Окно Ifan")
+TEXT_TR(TR_ID_MENU_SLIDING_WINDOW_Erot, "Окно Erot")
 
 TEXT_TR(TR_ID_MENU_MESS_PARAM_ID_POWER_U_A, "Напр. фазы A")
 TEXT_TR(TR_ID_MENU_MESS_PARAM_ID_POWER_U_B, "Напр. фазы B")
@@ -593,6 +606,20 @@ TEXT_TR(TR_ID_DRIVE_POWER_WARNING_IDLE_Iexc, "WP#28: Нулевой ток во
 
 TEXT_TR(TR_ID_MENU_VERSION, "Версия")    
 TEXT_TR(TR_ID_MENU_VERSION_DATE, "Дата прошивки") 
+
+// Диагностика
+TEXT_TR(TR_ID_MENU_DIAG, "Диагностика")
+TEXT_TR(TR_ID_MENU_DIAG_ADC_DMA_IRQ, "Прерывание DMA АЦП")
+TEXT_TR(TR_ID_MENU_DIAG_TRIACS_PAIRS0_IRQ, "Прерывание тиристоров 1")
+TEXT_TR(TR_ID_MENU_DIAG_TRIAC_EXC_IRQ, "Прерывание возбуждения")
+TEXT_TR(TR_ID_MENU_DIAG_ADC_TASK, "Задача АЦП")
+TEXT_TR(TR_ID_MENU_DIAG_TRIACS_ITER, "Итерация тиристоров")
+TEXT_TR(TR_ID_MENU_DIAG_SYNC_ITER, "Итерация синхронизации")
+TEXT_TR(TR_ID_MENU_DIAG_MAIN_ITER, "Основная итерация")
+TEXT_TR(TR_ID_MENU_DIAG_TRIACS_PAIRS1_IRQ, "Прерывание тиристоров 2")
+TEXT_TR(TR_ID_MENU_DIAG_MAX, "Макс. время")
+TEXT_TR(TR_ID_MENU_DIAG_P99, "Время 99%")
+TEXT_TR(TR_ID_MENU_DIAG_LOAD, "Загрузка ЦП")
         
 TEXT_TRS_END()
 
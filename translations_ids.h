@@ -485,6 +485,33 @@
 //! Измерения
 #define TR_ID_MENU_MEASUREMENTS 492
 
+//! Скользящее окно.
+#define TR_ID_MENU_SLIDING_WINDOWS  495
+//! Скользящее окно Ua.
+#define TR_ID_MENU_SLIDING_WINDOW_Ua    496
+//! Скользящее окно Ub.
+#define TR_ID_MENU_SLIDING_WINDOW_Ub    497
+//! Скользящее окно Uc.
+#define TR_ID_MENU_SLIDING_WINDOW_Uc    498
+//! Скользящее окно Urot.
+#define TR_ID_MENU_SLIDING_WINDOW_Urot  499
+//! Скользящее окно Ia.
+#define TR_ID_MENU_SLIDING_WINDOW_Ia    500
+//! Скользящее окно Ib.
+#define TR_ID_MENU_SLIDING_WINDOW_Ib    501
+//! Скользящее окно Ic.
+#define TR_ID_MENU_SLIDING_WINDOW_Ic    502
+//! Скользящее окно Irot.
+#define TR_ID_MENU_SLIDING_WINDOW_Irot  503
+//! Скользящее окно Iexc.
+#define TR_ID_MENU_SLIDING_WINDOW_Iexc  504
+//! Скользящее окно Iref.
+#define TR_ID_MENU_SLIDING_WINDOW_Iref  505
+//! Скользящее окно Ifan.
+#define TR_ID_MENU_SLIDING_WINDOW_Ifan  506
+//! Скользящее окно Erot.
+#define TR_ID_MENU_SLIDING_WINDOW_Erot  507
+
 #define TR_ID_MENU_MESS_PARAM_ID_POWER_U_A                      511
 #define TR_ID_MENU_MESS_PARAM_ID_POWER_U_B                      512
 #define TR_ID_MENU_MESS_PARAM_ID_POWER_U_C                      513
@@ -889,6 +916,20 @@
 
 #define TR_ID_MENU_VERSION                            2500
 #define TR_ID_MENU_VERSION_DATE                       2501
+
+// Диагностика
+#define TR_ID_MENU_DIAG                               2510
+#define TR_ID_MENU_DIAG_ADC_DMA_IRQ                   2511
+#define TR_ID_MENU_DIAG_TRIACS_PAIRS0_IRQ             2512
+#define TR_ID_MENU_DIAG_TRIAC_EXC_IRQ                 2513
+#define TR_ID_MENU_DIAG_ADC_TASK                      2514
+#define TR_ID_MENU_DIAG_TRIACS_ITER                   2515
+#define TR_ID_MENU_DIAG_SYNC_ITER                     2516
+#define TR_ID_MENU_DIAG_MAIN_ITER                     2517
+#define TR_ID_MENU_DIAG_TRIACS_PAIRS1_IRQ             2518
+#define TR_ID_MENU_DIAG_MAX                           2520
+#define TR_ID_MENU_DIAG_P99                           2521
+#define TR_ID_MENU_DIAG_LOAD                          2522
         
 #endif /* TRANSLATIONS_IDS_H */
 